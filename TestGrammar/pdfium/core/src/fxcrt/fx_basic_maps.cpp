@@ -6,8 +6,9 @@
 
 #include "../../include/fxcrt/fx_ext.h"
 #include "plex.h"
-// Global to suppress capturing duplicate keys (such as when rebuilding PDFs and encountering multiple trailers)
-FX_BOOL gSuppressDuplicateKeys = FALSE;
+// Per-thread flag to suppress capturing duplicate keys (such as when rebuilding PDFs and encountering multiple trailers).
+// thread_local so that concurrent parsers (TestGrammar --jobs) do not hide each other's duplicate keys.
+thread_local FX_BOOL gSuppressDuplicateKeys = FALSE;
 
 static void ConstructElement(CFX_ByteString* pNewData)
 {
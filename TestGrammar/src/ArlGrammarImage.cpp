@@ -0,0 +1,438 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Compiled (binary) Arlington PDF model files - see TestGrammar --compile
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlGrammarImage.h"
+#include "ArlingtonTSVGrammarFile.h"
+#include "ArlMappedFile.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+
+/// @brief Magic bytes at the start of every compiled grammar file
+static const char ArlGrammarImageMagic[8] = { 'A', 'R', 'L', 'G', 'R', 'A', 'M', '\0' };
+
+/// @brief Written instead of ArlNoSymbol
+static const uint32_t ArlImageNoSymbol = 0xFFFFFFFF;
+
+
+/// @class CArlImageWriter
+/// Builds the body and string pool of a compiled grammar file
+class CArlImageWriter {
+public:
+    std::vector<uint32_t>                       body;
+    std::string                                 pool;
+    std::unordered_map<std::string, uint32_t>   pool_index;
+
+    void u32(const size_t v) {
+        assert(v <= 0xFFFFFFFF);
+        body.push_back((uint32_t)v);
+    };
+
+    void sym(const ArlSymbol s) {
+        body.push_back((s == ArlNoSymbol) ? ArlImageNoSymbol : (uint32_t)s);
+    };
+
+    /// @brief Identical strings are only stored once in the pool
+    void str(const std::string_view s) {
+        auto found = pool_index.find(std::string(s));
+        uint32_t offset;
+        if (found != pool_index.end())
+            offset = found->second;
+        else {
+            offset = (uint32_t)pool.size();
+            pool.append(s);
+            pool_index.emplace(std::string(s), offset);
+        }
+        body.push_back(offset);
+        body.push_back((uint32_t)s.size());
+    };
+};
+
+
+/// @class CArlImageReader
+/// Bounds-checked reading of the body of a (memory-mapped) compiled grammar file.
+/// Once anything is out of bounds all reads return 0 or "" and is_ok() is false.
+class CArlImageReader {
+private:
+    const uint32_t*     pos;
+    const uint32_t*     end;
+    const char*         pool;
+    uint32_t            pool_size;
+    uint32_t            num_symbols;
+    bool                ok;
+
+public:
+    CArlImageReader(const ArlGrammarImageHeader* hdr) :
+        num_symbols(0), ok(true)
+    {
+        pos  = (const uint32_t*)(hdr + 1);
+        end  = pos + hdr->body_words;
+        pool = (const char*)end;
+        pool_size = hdr->pool_size;
+    };
+
+    bool is_ok() const { return ok; };
+
+    bool at_end() const { return ok && (pos == end); };
+
+    void set_num_symbols(const uint32_t n) { num_symbols = n; };
+
+    uint32_t u32() {
+        if (!ok || (pos >= end)) {
+            ok = false;
+            return 0;
+        }
+        return *pos++;
+    };
+
+    /// @brief A count of things that follow, each of which is at least 1 word
+    uint32_t count() {
+        uint32_t n = u32();
+        if (ok && (n > (uint32_t)(end - pos))) {
+            ok = false;
+            return 0;
+        }
+        return n;
+    };
+
+    ArlSymbol sym() {
+        uint32_t v = u32();
+        if (v == ArlImageNoSymbol)
+            return ArlNoSymbol;
+        if (v >= num_symbols) {
+            ok = false;
+            return ArlNoSymbol;
+        }
+        return (ArlSymbol)v;
+    };
+
+    std::string_view str() {
+        uint32_t offset = u32();
+        uint32_t len = u32();
+        if (!ok || (offset > pool_size) || (len > pool_size - offset)) {
+            ok = false;
+            return std::string_view();
+        }
+        return std::string_view(pool + offset, len);
+    };
+};
+
+
+/// @brief Calculates a 64-bit FNV-1a checksum
+///
+/// @param[in] data   bytes to checksum
+///
+/// @returns the checksum
+static uint64_t fnv1a(const std::string_view data)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+
+/// @brief Checks the header of a compiled grammar file and that the rest of the file is intact
+///
+/// @param[in]  data   entire contents of the file
+/// @param[out] hdr    the header (in place) if the file is a compiled grammar of this version
+///
+/// @returns OK, NotAnImage, WrongVersion or Corrupt (truncated or modified)
+static ArlGrammarImageStatus check_image_header(const std::string_view data, const ArlGrammarImageHeader*& hdr)
+{
+    hdr = nullptr;
+    if ((data.size() < sizeof(ArlGrammarImageHeader)) || (memcmp(data.data(), ArlGrammarImageMagic, sizeof(ArlGrammarImageMagic)) != 0))
+        return ArlGrammarImageStatus::NotAnImage;
+    const ArlGrammarImageHeader* h = (const ArlGrammarImageHeader*)data.data();
+    if ((h->format_version != ArlGrammarImageVersion) || (h->byte_order != ArlGrammarImageByteOrder))
+        return ArlGrammarImageStatus::WrongVersion;
+    if ((uint64_t)data.size() != (uint64_t)sizeof(ArlGrammarImageHeader) + ((uint64_t)h->body_words * sizeof(uint32_t)) + h->pool_size)
+        return ArlGrammarImageStatus::Corrupt;
+    if (fnv1a(data.substr(sizeof(ArlGrammarImageHeader))) != h->image_checksum)
+        return ArlGrammarImageStatus::Corrupt;
+    hdr = h;
+    return ArlGrammarImageStatus::OK;
+}
+
+
+/// @brief Calculates a checksum (64-bit FNV-1a) of the names and contents of all TSV
+/// files in a folder, in filename order, so compiled grammar files can detect changes.
+///
+/// @param[in] tsv_folder   folder containing an Arlington TSV file set
+///
+/// @returns the checksum
+uint64_t arl_tsv_checksum(const fs::path& tsv_folder)
+{
+    std::vector<fs::path> tsv_files;
+    for (const auto& entry : fs::directory_iterator(tsv_folder))
+        if (entry.is_regular_file() && (entry.path().extension().string() == ".tsv"))
+            tsv_files.push_back(entry.path());
+    std::sort(tsv_files.begin(), tsv_files.end());
+
+    uint64_t h = 14695981039346656037ULL;
+    auto add = [&h](const std::string_view s) {
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        h ^= 0xFF; // terminator so that "ab"+"c" differs from "a"+"bc"
+        h *= 1099511628211ULL;
+    };
+
+    for (auto& f : tsv_files) {
+        add(f.filename().u8string());
+        CArlMappedFile contents(f);
+        add(contents.view());
+    }
+    return h;
+}
+
+
+/// @brief Checks if a file is a compiled grammar file of this version and, if its source
+/// TSV folder still exists, that the TSV files have not changed since it was compiled.
+///
+/// @param[in]  image_file      the compiled grammar file
+/// @param[out] source_folder   the TSV folder it was compiled from (if a compiled grammar file)
+///
+/// @returns OK, NotAnImage, WrongVersion, Corrupt, Stale (TSV files changed) or SourceMissing (cannot be checked)
+ArlGrammarImageStatus check_grammar_image(const fs::path& image_file, fs::path& source_folder)
+{
+    CArlMappedFile                  image(image_file);
+    const ArlGrammarImageHeader*    hdr;
+
+    source_folder.clear();
+    if (!image.is_open())
+        return ArlGrammarImageStatus::NotAnImage;
+    ArlGrammarImageStatus status = check_image_header(image.view(), hdr);
+    if (status != ArlGrammarImageStatus::OK)
+        return status;
+
+    CArlImageReader rd(hdr);
+    std::string_view folder = rd.str();
+    if (!rd.is_ok())
+        return ArlGrammarImageStatus::Corrupt;
+    source_folder = fs::u8path(folder);
+
+    if (!fs::is_directory(source_folder))
+        return ArlGrammarImageStatus::SourceMissing;
+    return (arl_tsv_checksum(source_folder) == hdr->tsv_checksum) ? ArlGrammarImageStatus::OK : ArlGrammarImageStatus::Stale;
+}
+
+
+/// @brief Writes the Arlington PDF model as a compiled grammar file: all TSV fields, the symbol
+/// table, the Key symbol and Link sets of every row and all Link set discriminators. Loading it
+/// avoids reading and splitting TSV files, interning names and calculating discriminators.
+///
+/// @param[in] image_file   the compiled grammar file to write (overwritten)
+///
+/// @returns true if the file was written, false otherwise
+bool CArlingtonGrammar::write_image(const fs::path& image_file) const
+{
+    CArlImageWriter w;
+
+    w.str(fs::absolute(grammar_folder).lexically_normal().u8string());
+
+    w.u32(symbols.size());
+    for (ArlSymbol i = 0; i < symbols.size(); i++)
+        w.str(symbols.get_name(i));
+
+    w.u32(grammar_map.size());
+    for (auto& g : grammar_map) {
+        const CArlingtonTSVGrammarFile* f = g.second.get();
+        w.sym(symbols.find(g.first));
+        w.u32(f->data_list.size() + 1);
+        w.u32(f->header_list.size());
+        for (auto& field : f->header_list)
+            w.str(field);
+        for (auto& row : f->data_list) {
+            w.u32(row.size());
+            for (auto& field : row)
+                w.str(field);
+        }
+        for (auto& row : f->typed_data_list) {
+            w.sym(row.key_sym);
+            w.u32(row.full_links.size());
+            for (auto& linkset : row.full_links) {
+                w.u32(linkset.size());
+                for (auto l : linkset)
+                    w.sym(l);
+            }
+        }
+    }
+
+    // Sorted so that the same TSV file set always compiles to the same file
+    std::vector<const std::pair<const std::vector<ArlSymbol>, ArlLinkDiscriminator>*> sorted_discriminators;
+    for (auto& d : discriminators)
+        sorted_discriminators.push_back(&d);
+    std::sort(sorted_discriminators.begin(), sorted_discriminators.end(), [](auto a, auto b) { return a->first < b->first; });
+
+    w.u32(sorted_discriminators.size());
+    for (auto d : sorted_discriminators) {
+        w.u32(d->first.size());
+        for (auto l : d->first)
+            w.sym(l);
+        w.u32(d->second.memoizable ? 1 : 0);
+        w.u32(d->second.all_element_values ? 1 : 0);
+        w.u32(d->second.value_keys.size());
+        for (auto& k : d->second.value_keys)
+            w.str(k);
+        w.u32(d->second.keys.size());
+        for (auto& k : d->second.keys) {
+            w.str(k.key);
+            w.u32(k.is_array_index ? 1 : 0);
+            std::vector<std::pair<std::string, uint64_t>> values;
+            for (auto& v : k.links_for_value)
+                values.push_back({ ToUtf8(v.first), v.second });
+            std::sort(values.begin(), values.end());
+            w.u32(values.size());
+            for (auto& v : values) {
+                w.str(v.first);
+                w.u32((uint32_t)(v.second & 0xFFFFFFFF));
+                w.u32((uint32_t)(v.second >> 32));
+            }
+        }
+    }
+
+    ArlGrammarImageHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, ArlGrammarImageMagic, sizeof(hdr.magic));
+    hdr.format_version = ArlGrammarImageVersion;
+    hdr.byte_order = ArlGrammarImageByteOrder;
+    hdr.tsv_checksum = arl_tsv_checksum(grammar_folder);
+    hdr.body_words = (uint32_t)w.body.size();
+    hdr.pool_size = (uint32_t)w.pool.size();
+
+    std::string contents((const char*)w.body.data(), w.body.size() * sizeof(uint32_t));
+    contents.append(w.pool.data(), w.pool.size());
+    hdr.image_checksum = fnv1a(contents);
+
+    std::ofstream ofs(image_file, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open())
+        return false;
+    ofs.write((const char*)&hdr, sizeof(hdr));
+    ofs.write(contents.data(), contents.size());
+    ofs.close();
+    return !ofs.fail();
+}
+
+
+/// @brief Loads the Arlington PDF model from a compiled grammar file (see write_image()).
+/// The file is memory-mapped and all TSV fields are views into the mapping.
+///
+/// @param[in] image_file   the compiled grammar file
+///
+/// @returns true if loaded, false if the file is not a valid compiled grammar of this version
+bool CArlingtonGrammar::load_image(const fs::path& image_file)
+{
+    auto image = std::make_shared<const CArlMappedFile>(image_file);
+    const ArlGrammarImageHeader* hdr;
+    if (!image->is_open() || (check_image_header(image->view(), hdr) != ArlGrammarImageStatus::OK))
+        return false;
+
+    CArlImageReader rd(hdr);
+    fs::path source_folder = fs::u8path(rd.str());
+
+    uint32_t num_symbols = rd.count();
+    for (uint32_t i = 0; (i < num_symbols) && rd.is_ok(); i++)
+        if (symbols.intern(std::string(rd.str())) != (ArlSymbol)i)
+            return false; // duplicate or empty name
+    rd.set_num_symbols(num_symbols);
+
+    uint32_t num_files = rd.count();
+    for (uint32_t i = 0; (i < num_files) && rd.is_ok(); i++) {
+        ArlSymbol name = rd.sym();
+        if (name == ArlNoSymbol)
+            return false;
+        const std::string& tsv_name = symbols.get_name(name);
+        std::unique_ptr<CArlingtonTSVGrammarFile> f(new CArlingtonTSVGrammarFile(source_folder / (tsv_name + ".tsv")));
+        f->tsv_contents = image;
+
+        uint32_t num_rows = rd.count();
+        for (uint32_t r = 0; (r < num_rows) && rd.is_ok(); r++) {
+            ArlTSVRow row;
+            uint32_t num_fields = rd.count();
+            for (uint32_t c = 0; (c < num_fields) && rd.is_ok(); c++)
+                row.push_back(rd.str());
+            if (r == 0)
+                f->header_list = std::move(row);
+            else
+                f->data_list.push_back(std::move(row));
+        }
+        if (!rd.is_ok() || f->data_list.empty())
+            return false;
+
+        f->precompute();
+        for (auto& row : f->typed_data_list) {
+            row.key_sym = rd.sym();
+            row.full_links.resize(rd.count());
+            for (auto& linkset : row.full_links) {
+                linkset.resize(rd.count());
+                for (auto& l : linkset)
+                    l = rd.sym();
+                if (!rd.is_ok())
+                    return false;
+            }
+        }
+        grammar_map.insert(std::make_pair(tsv_name, std::move(f)));
+    }
+
+    grammar_by_symbol.assign(symbols.size(), nullptr);
+    for (auto& g : grammar_map)
+        grammar_by_symbol[symbols.find(g.first)] = g.second.get();
+
+    uint32_t num_discriminators = rd.count();
+    for (uint32_t i = 0; (i < num_discriminators) && rd.is_ok(); i++) {
+        std::vector<ArlSymbol> links(rd.count());
+        for (auto& l : links)
+            l = rd.sym();
+        ArlLinkDiscriminator d;
+        d.memoizable = (rd.u32() != 0);
+        d.all_element_values = (rd.u32() != 0);
+        d.value_keys.resize(rd.count());
+        for (auto& k : d.value_keys)
+            k = std::string(rd.str());
+        d.id = i;
+        d.keys.resize(rd.count());
+        for (auto& k : d.keys) {
+            k.key = std::string(rd.str());
+            k.is_array_index = (rd.u32() != 0);
+            uint32_t num_values = rd.count();
+            for (uint32_t v = 0; (v < num_values) && rd.is_ok(); v++) {
+                std::wstring value = ToWString(rd.str());
+                uint64_t lo = rd.u32();
+                uint64_t hi = rd.u32();
+                k.links_for_value[value] = (hi << 32) | lo;
+            }
+            if (!rd.is_ok())
+                return false;
+        }
+        discriminators.emplace(std::move(links), std::move(d));
+    }
+
+    return rd.at_end();
+}
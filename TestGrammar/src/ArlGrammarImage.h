@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Compiled (binary) Arlington PDF model files - see TestGrammar --compile
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlGrammarImage_h
+#define ArlGrammarImage_h
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+
+/// @brief Version of the compiled grammar file layout. Incremented whenever the layout changes.
+const uint32_t ArlGrammarImageVersion = 3;
+
+/// @brief Written in native byte order so a compiled grammar from a different architecture is rejected
+const uint32_t ArlGrammarImageByteOrder = 0x01020304;
+
+
+/// @brief Header at the start of a compiled grammar file. It is memory-mapped and used in place.
+///
+/// The header is followed by body_words uint32_t values and then pool_size bytes of UTF-8 strings.
+/// A string in the body is 2 words: offset and length into the pool. Identical strings are only
+/// stored once. The body is, in order:
+/// - the source TSV folder (string)
+/// - the symbol table: count, then the name of each symbol (string) in symbol order
+/// - the TSV files: count, then for each file:
+///   - TSV filename symbol, number of rows (including the header row)
+///   - for each row: number of fields, then each field (string)
+///   - for each data row: Key symbol, number of Link sets, then each Link set (count, symbols)
+/// - the Link set discriminators: count, then for each:
+///   - Link set (count, symbols), memoizable (0 or 1), all element values (0 or 1),
+///     number of value keys, then each value key (string), number of keys
+///   - for each key: Key (string), is array index (0 or 1), number of values,
+///     then each value (string) and its bitmask of Links (low word, high word)
+struct ArlGrammarImageHeader {
+    /// @brief "ARLGRAM\0"
+    char        magic[8];
+
+    /// @brief ArlGrammarImageVersion
+    uint32_t    format_version;
+
+    /// @brief ArlGrammarImageByteOrder
+    uint32_t    byte_order;
+
+    /// @brief arl_tsv_checksum() of the source TSV folder
+    uint64_t    tsv_checksum;
+
+    /// @brief checksum (64-bit FNV-1a) of the body and string pool to detect a corrupt file
+    uint64_t    image_checksum;
+
+    /// @brief number of uint32_t words after this header
+    uint32_t    body_words;
+
+    /// @brief number of bytes in the string pool after the body
+    uint32_t    pool_size;
+};
+
+
+/// @brief Status of a compiled grammar file (see check_grammar_image())
+enum class ArlGrammarImageStatus { OK = 0, NotAnImage, WrongVersion, Corrupt, Stale, SourceMissing };
+
+
+/// @brief Calculates a checksum of all TSV files in a folder (names and contents)
+uint64_t arl_tsv_checksum(const fs::path& tsv_folder);
+
+/// @brief Checks a compiled grammar file and whether it is up to date with its source TSV folder
+ArlGrammarImageStatus check_grammar_image(const fs::path& image_file, fs::path& source_folder);
+
+#endif // ArlGrammarImage_h
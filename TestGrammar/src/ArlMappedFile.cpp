@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Read-only, memory-mapped view of an entire file
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlMappedFile.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(_WIN32) || defined(WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32/WIN32
+
+
+/// @brief Opens a file. If memory-mapping fails (or is not allowed) then the file is read
+/// into an owned copy. Check is_open() afterwards.
+///
+/// @param[in] fname        the file to open
+/// @param[in] allow_mmap   false to always use an owned copy
+CArlMappedFile::CArlMappedFile(const fs::path& fname, const bool allow_mmap) :
+    data_ptr(nullptr), data_size(0), opened(false), mapped(false)
+#if defined(_WIN32) || defined(WIN32)
+    , mapping_handle(nullptr)
+#endif // _WIN32/WIN32
+{
+    if (allow_mmap && map_file(fname))
+        opened = mapped = true;
+    else
+        opened = read_file(fname);
+}
+
+
+/// @brief Destructor - unmaps the file
+CArlMappedFile::~CArlMappedFile()
+{
+    if (!mapped)
+        return;
+#if defined(_WIN32) || defined(WIN32)
+    if (data_ptr != nullptr)
+        UnmapViewOfFile(data_ptr);
+    if (mapping_handle != nullptr)
+        CloseHandle((HANDLE)mapping_handle);
+#else
+    if (data_ptr != nullptr)
+        munmap((void*)data_ptr, data_size);
+#endif // _WIN32/WIN32
+}
+
+
+/// @brief Memory-maps an entire file read-only. Empty files are opened but not mapped.
+///
+/// @param[in] fname   the file to map
+///
+/// @returns true if the file was mapped (or is empty), false otherwise
+bool CArlMappedFile::map_file(const fs::path& fname)
+{
+#if defined(_WIN32) || defined(WIN32)
+    HANDLE h = CreateFileW(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(h, &sz)) {
+        CloseHandle(h);
+        return false;
+    }
+    data_size = (size_t)sz.QuadPart;
+    if (data_size > 0) {
+        mapping_handle = CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle != nullptr)
+            data_ptr = (const char*)MapViewOfFile((HANDLE)mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    }
+    CloseHandle(h); // mapping (if any) keeps the file open
+    if ((data_size > 0) && (data_ptr == nullptr)) {
+        if (mapping_handle != nullptr)
+            CloseHandle((HANDLE)mapping_handle);
+        mapping_handle = nullptr;
+        data_size = 0;
+        return false;
+    }
+    return true;
+#else
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    data_size = (size_t)st.st_size;
+    if (data_size > 0) {
+        void* p = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            data_size = 0;
+            return false;
+        }
+        data_ptr = (const char*)p;
+    }
+    close(fd); // mapping (if any) keeps the file open
+    return true;
+#endif // _WIN32/WIN32
+}
+
+
+/// @brief Reads an entire file into owned_copy
+///
+/// @param[in] fname   the file to read
+///
+/// @returns true if the file was read, false otherwise
+bool CArlMappedFile::read_file(const fs::path& fname)
+{
+    std::ifstream file(fname, std::ios::in | std::ios::binary);
+    if (!file.is_open() || file.bad())
+        return false;
+    owned_copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (file.bad())
+        return false;
+    data_ptr = owned_copy.data();
+    data_size = owned_copy.size();
+    return true;
+}
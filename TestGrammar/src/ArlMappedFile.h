@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Read-only, memory-mapped view of an entire file
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlMappedFile_h
+#define ArlMappedFile_h
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+
+/// @class CArlMappedFile
+/// Read-only contents of an entire file that stay valid (at the same address) for the
+/// lifetime of this object. The file is memory-mapped where possible (POSIX mmap() or
+/// Windows MapViewOfFile()), otherwise the contents are read into an owned copy.
+class CArlMappedFile {
+private:
+    /// @brief Start of the file contents (mapping or owned copy). nullptr if empty or not open.
+    const char*     data_ptr;
+
+    /// @brief Size of the file contents in bytes
+    size_t          data_size;
+
+    /// @brief true if the file was opened (even if it is empty)
+    bool            opened;
+
+    /// @brief true if data_ptr is a memory mapping, false if it is owned_copy
+    bool            mapped;
+
+    /// @brief Owned copy of the file contents if memory-mapping was not possible or not allowed
+    std::string     owned_copy;
+
+#if defined(_WIN32) || defined(WIN32)
+    /// @brief Windows file mapping handle (HANDLE)
+    void*           mapping_handle;
+#endif // _WIN32/WIN32
+
+    /// @brief Memory-maps a file. Returns false if it could not be mapped.
+    bool map_file(const fs::path& fname);
+
+    /// @brief Reads a file into owned_copy. Returns false if it could not be read.
+    bool read_file(const fs::path& fname);
+
+public:
+    /// @brief Opens a file, memory-mapping it if allow_mmap and falling back to an owned copy
+    explicit CArlMappedFile(const fs::path& fname, const bool allow_mmap = true);
+
+    ~CArlMappedFile();
+
+    CArlMappedFile(const CArlMappedFile&) = delete;
+    CArlMappedFile& operator=(const CArlMappedFile&) = delete;
+
+    /// @brief true if the file was opened and all its contents are available
+    bool is_open() const { return opened; };
+
+    /// @brief true if the contents are memory-mapped rather than an owned copy
+    bool is_mapped() const { return mapped; };
+
+    /// @brief Returns the entire contents of the file
+    std::string_view view() const { return std::string_view(data_ptr, data_size); };
+};
+
+#endif // ArlMappedFile_h
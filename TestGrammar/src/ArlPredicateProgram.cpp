@@ -0,0 +1,351 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Compiles Arlington predicate ASTs into post-order bytecode programs.
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlPredicateProgram.h"
+#include "ArlPredicates.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+/// @brief Arlington predicate function names (as parsed, including the opening bracket)
+static const struct {
+    const char*     name;
+    ArlPredicateFn  fn;
+} predicate_functions[] = {
+    { "fn:AlwaysUnencrypted(",              ArlPredicateFn::ARLFN_AlwaysUnencrypted },
+    { "fn:ArrayLength(",                    ArlPredicateFn::ARLFN_ArrayLength },
+    { "fn:ArraySortAscending(",             ArlPredicateFn::ARLFN_ArraySortAscending },
+    { "fn:BeforeVersion(",                  ArlPredicateFn::ARLFN_BeforeVersion },
+    { "fn:BitClear(",                       ArlPredicateFn::ARLFN_BitClear },
+    { "fn:BitSet(",                         ArlPredicateFn::ARLFN_BitSet },
+    { "fn:BitsClear(",                      ArlPredicateFn::ARLFN_BitsClear },
+    { "fn:BitsSet(",                        ArlPredicateFn::ARLFN_BitsSet },
+    { "fn:Contains(",                       ArlPredicateFn::ARLFN_Contains },
+    { "fn:DefaultValue(",                   ArlPredicateFn::ARLFN_DefaultValue },
+    { "fn:Deprecated(",                     ArlPredicateFn::ARLFN_Deprecated },
+    { "fn:Eval(",                           ArlPredicateFn::ARLFN_Eval },
+    { "fn:Extension(",                      ArlPredicateFn::ARLFN_Extension },
+    { "fn:FileSize(",                       ArlPredicateFn::ARLFN_FileSize },
+    { "fn:FontHasLatinChars(",              ArlPredicateFn::ARLFN_FontHasLatinChars },
+    { "fn:HasProcessColorants(",            ArlPredicateFn::ARLFN_HasProcessColorants },
+    { "fn:HasSpotColorants(",               ArlPredicateFn::ARLFN_HasSpotColorants },
+    { "fn:Ignore(",                         ArlPredicateFn::ARLFN_Ignore },
+    { "fn:ImageIsStructContentItem(",       ArlPredicateFn::ARLFN_ImageIsStructContentItem },
+    { "fn:ImplementationDependent(",        ArlPredicateFn::ARLFN_ImplementationDependent },
+    { "fn:InKeyMap(",                       ArlPredicateFn::ARLFN_InKeyMap },
+    { "fn:InNameTree(",                     ArlPredicateFn::ARLFN_InNameTree },
+    { "fn:IsAssociatedFile(",               ArlPredicateFn::ARLFN_IsAssociatedFile },
+    { "fn:IsEncryptedWrapper(",             ArlPredicateFn::ARLFN_IsEncryptedWrapper },
+    { "fn:IsFieldName(",                    ArlPredicateFn::ARLFN_IsFieldName },
+    { "fn:IsHexString(",                    ArlPredicateFn::ARLFN_IsHexString },
+    { "fn:IsLastInNumberFormatArray(",      ArlPredicateFn::ARLFN_IsLastInNumberFormatArray },
+    { "fn:IsMeaningful(",                   ArlPredicateFn::ARLFN_IsMeaningful },
+    { "fn:IsPDFTagged(",                    ArlPredicateFn::ARLFN_IsPDFTagged },
+    { "fn:IsPDFVersion(",                   ArlPredicateFn::ARLFN_IsPDFVersion },
+    { "fn:IsPresent(",                      ArlPredicateFn::ARLFN_IsPresent },
+    { "fn:IsRequired(",                     ArlPredicateFn::ARLFN_IsRequired },
+    { "fn:KeyNameIsColorant(",              ArlPredicateFn::ARLFN_KeyNameIsColorant },
+    { "fn:MustBeDirect(",                   ArlPredicateFn::ARLFN_MustBeDirect },
+    { "fn:MustBeIndirect(",                 ArlPredicateFn::ARLFN_MustBeIndirect },
+    { "fn:NoCycle(",                        ArlPredicateFn::ARLFN_NoCycle },
+    { "fn:Not(",                            ArlPredicateFn::ARLFN_Not },
+    { "fn:NotStandard14Font(",              ArlPredicateFn::ARLFN_NotStandard14Font },
+    { "fn:NumberOfPages(",                  ArlPredicateFn::ARLFN_NumberOfPages },
+    { "fn:PageContainsStructContentItems(", ArlPredicateFn::ARLFN_PageContainsStructContentItems },
+    { "fn:PageProperty(",                   ArlPredicateFn::ARLFN_PageProperty },
+    { "fn:RectHeight(",                     ArlPredicateFn::ARLFN_RectHeight },
+    { "fn:RectWidth(",                      ArlPredicateFn::ARLFN_RectWidth },
+    { "fn:RequiredValue(",                  ArlPredicateFn::ARLFN_RequiredValue },
+    { "fn:SinceVersion(",                   ArlPredicateFn::ARLFN_SinceVersion },
+    { "fn:StreamLength(",                   ArlPredicateFn::ARLFN_StreamLength },
+    { "fn:StringLength(",                   ArlPredicateFn::ARLFN_StringLength }
+};
+
+
+/// @brief Math comparison, math and logical operators (as parsed, with any SPACEs)
+static const struct {
+    const char*     name;
+    ArlOperator     oper;
+} operators[] = {
+    { "==",     ArlOperator::ARLOPR_Equal },
+    { "!=",     ArlOperator::ARLOPR_NotEqual },
+    { "<=",     ArlOperator::ARLOPR_LessEqual },
+    { "<",      ArlOperator::ARLOPR_Less },
+    { ">=",     ArlOperator::ARLOPR_GreaterEqual },
+    { ">",      ArlOperator::ARLOPR_Greater },
+    { "+",      ArlOperator::ARLOPR_Add },
+    { " + ",    ArlOperator::ARLOPR_Add },
+    { "-",      ArlOperator::ARLOPR_Subtract },
+    { " - ",    ArlOperator::ARLOPR_Subtract },
+    { "*",      ArlOperator::ARLOPR_Multiply },
+    { " * ",    ArlOperator::ARLOPR_Multiply },
+    { " mod ",  ArlOperator::ARLOPR_Modulo },
+    { " && ",   ArlOperator::ARLOPR_And },
+    { " || ",   ArlOperator::ARLOPR_Or }
+};
+
+
+/// @brief Recursively emits the instructions for an AST node in post-order
+///
+/// @param[in]     ast    AST node. Never nullptr.
+/// @param[in,out] prog   program being compiled
+/// @param[in]     depth  number of values already on the value stack
+static void compile_node(const ASTNode* ast, ArlPredicateProgram& prog, int depth) {
+    assert(ast != nullptr);
+
+    ArlPredicateInstr instr;
+    instr.has_arg[0] = (ast->arg[0] != nullptr);
+    instr.has_arg[1] = (ast->arg[1] != nullptr);
+
+    if (instr.has_arg[0]) {
+        compile_node(ast->arg[0], prog, depth);
+        depth++;
+    }
+    if (instr.has_arg[1]) {
+        compile_node(ast->arg[1], prog, depth);
+        depth++;
+    }
+
+    instr.value.node = ast->node;
+    instr.value.type = ast->type;
+
+    switch (ast->type) {
+    case ASTNodeType::ASTNT_ConstPDFBoolean:
+    case ASTNodeType::ASTNT_ConstString:
+    case ASTNodeType::ASTNT_ConstInt:
+    case ASTNodeType::ASTNT_ConstNum:
+    case ASTNodeType::ASTNT_Key:
+        instr.opcode = ArlOpcode::ARLOP_Const;
+        break;
+
+    case ASTNodeType::ASTNT_Predicate:
+        instr.opcode = ArlOpcode::ARLOP_Function;
+        for (auto& f : predicate_functions)
+            if (ast->node == f.name) {
+                instr.fn = f.fn;
+                break;
+            }
+        break;
+
+    case ASTNodeType::ASTNT_MathComp:
+    case ASTNodeType::ASTNT_MathOp:
+    case ASTNodeType::ASTNT_LogicalOp:
+        if (ast->type == ASTNodeType::ASTNT_MathComp)
+            instr.opcode = ArlOpcode::ARLOP_MathComp;
+        else if (ast->type == ASTNodeType::ASTNT_MathOp)
+            instr.opcode = ArlOpcode::ARLOP_MathOp;
+        else
+            instr.opcode = ArlOpcode::ARLOP_LogicalOp;
+        for (auto& o : operators)
+            if (ast->node == o.name) {
+                instr.oper = o.oper;
+                break;
+            }
+        break;
+
+    case ASTNodeType::ASTNT_KeyValue:
+        {
+            // "@key", "@0" or "parent::@key", "Catalog::Names::@Dests", etc.
+            // Split the path on "::" once here rather than every time it is evaluated.
+            instr.opcode = ArlOpcode::ARLOP_KeyValue;
+            std::string key = ast->node;
+            auto sep = key.find("::");
+            while (sep != std::string::npos) {
+                instr.key_parts.push_back(key.substr(0, sep));
+                key = key.substr(sep + 2);
+                sep = key.find("::");
+            }
+            assert(key[0] == '@');
+            instr.key_parts.push_back(key.substr(1)); // strip the '@' off
+        }
+        break;
+
+    case ASTNodeType::ASTNT_Unknown:
+    case ASTNodeType::ASTNT_Type:
+    default:
+        // Likely a parsing error! Reported when executed.
+        instr.opcode = ArlOpcode::ARLOP_Invalid;
+        break;
+    } // switch
+
+    prog.code.push_back(instr);
+
+    // Operands plus a slot for the result
+    prog.max_stack = std::max(prog.max_stack, depth + 1);
+}
+
+
+/// @brief Compiles an AST into a post-order bytecode program where function names and
+/// operators are resolved to enums. All AST nodes are compiled, including constants.
+/// DefaultValues of key-values are not resolved as they need the TSV data
+/// (see CArlingtonTSVGrammarFile::compile_program()).
+///
+/// @param[in]  ast    AST. Never nullptr.
+/// @param[out] prog   the compiled program
+void CompilePredicate(const ASTNode* ast, ArlPredicateProgram& prog) {
+    assert(ast != nullptr);
+    prog.code.clear();
+    prog.max_stack = 0;
+    compile_node(ast, prog, 0);
+}
+
+
+/// @brief Evaluates a version or extension predicate function for a specific PDF version and set of
+/// extensions, the same way as CPDFFile::ExecutePredicate(). Only constant 1st arguments can be evaluated.
+///
+/// @param[in]  instr        the predicate function instruction
+/// @param[in]  arg          the instruction of the 1st argument
+/// @param[in]  pdf_version  PDF version multiplied by 10
+/// @param[in]  extns        supported extensions (can include the wildcard '*')
+/// @param[out] cond         whether the version or extension condition holds
+/// @param[out] deprecated   whether a fn:Deprecated() predicate is deprecated for pdf_version
+///
+/// @returns true if the function could be evaluated, false if it needs to be executed
+static bool fold_version_function(const ArlPredicateInstr& instr, const ArlPredicateInstr& arg, const int pdf_version,
+                                  const std::vector<std::string>& extns, bool& cond, bool& deprecated)
+{
+    deprecated = false;
+    if ((arg.opcode != ArlOpcode::ARLOP_Const) || arg.has_arg[0] || arg.has_arg[1])
+        return false;
+
+    if (instr.fn == ArlPredicateFn::ARLFN_Extension) {
+        if (arg.value.type != ASTNodeType::ASTNT_Key)
+            return false;
+        cond = false;
+        for (auto& e : extns)
+            if ((arg.value.node == e) || (e == "*")) {
+                cond = true;
+                break;
+            }
+        return true;
+    }
+
+    if ((arg.value.type != ASTNodeType::ASTNT_ConstNum) || !FindInVector(v_ArlPDFVersions, arg.value.node))
+        return false;
+    const int arl_v = string_to_pdf_version(arg.value.node);
+    switch (instr.fn) {
+    case ArlPredicateFn::ARLFN_SinceVersion:    cond = (pdf_version >= arl_v); break;
+    case ArlPredicateFn::ARLFN_BeforeVersion:   cond = (pdf_version < arl_v);  break;
+    case ArlPredicateFn::ARLFN_IsPDFVersion:    cond = (pdf_version == arl_v); break;
+    case ArlPredicateFn::ARLFN_Deprecated:
+        cond = (pdf_version < arl_v);
+        deprecated = !cond;
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+
+/// @brief Constant-folds fn:SinceVersion, fn:BeforeVersion, fn:IsPDFVersion, fn:Deprecated and fn:Extension
+/// for a specific PDF version and set of extensions so they are never executed for a PDF file:
+/// - 1 argument forms become a constant "true" or "false"
+/// - 2 argument forms become their 2nd argument when the condition holds, otherwise indeterminate.
+///   A 2nd argument that is not constant is still executed (and its result discarded) so any
+///   side effects are kept.
+///
+/// A folded fn:Deprecated() flags the predicate as deprecated when executed (see ArlPredicateInstr::sets_deprecated).
+/// The number of value stack slots needed never increases so max_stack is unchanged.
+///
+/// @param[in,out] prog         compiled program (for all PDF versions)
+/// @param[in]     pdf_version  PDF version multiplied by 10
+/// @param[in]     extns        supported extensions (can include the wildcard '*')
+void SpecializePredicate(ArlPredicateProgram& prog, const int pdf_version, const std::vector<std::string>& extns)
+{
+    std::vector<ArlPredicateInstr>  code;
+    std::vector<size_t>             starts;  // start (in code) of the instructions of each value on the stack
+    code.reserve(prog.code.size());
+
+    for (auto& instr : prog.code) {
+        const int nargs = (instr.has_arg[0] ? 1 : 0) + (instr.has_arg[1] ? 1 : 0);
+        assert((int)starts.size() >= nargs);
+        const size_t start = (nargs > 0) ? starts[starts.size() - nargs] : code.size();
+        starts.resize(starts.size() - nargs);
+
+        bool cond = false;
+        bool deprecated = false;
+        const bool is_version_fn = (instr.opcode == ArlOpcode::ARLOP_Function) && instr.has_arg[0] &&
+            ((instr.fn == ArlPredicateFn::ARLFN_SinceVersion) || (instr.fn == ArlPredicateFn::ARLFN_BeforeVersion) ||
+             (instr.fn == ArlPredicateFn::ARLFN_IsPDFVersion) || (instr.fn == ArlPredicateFn::ARLFN_Deprecated) ||
+             (instr.fn == ArlPredicateFn::ARLFN_Extension));
+
+        if (!is_version_fn || !fold_version_function(instr, code[start], pdf_version, extns, cond, deprecated)) {
+            code.push_back(instr);
+            starts.push_back(start);
+            continue;
+        }
+
+        ArlPredicateInstr folded;
+        folded.opcode = ArlOpcode::ARLOP_Const;
+        folded.sets_deprecated = deprecated;
+        if (!instr.has_arg[1]) {
+            // fn:Xxx(arg) --> true or false
+            folded.value.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+            folded.value.node = cond ? "true" : "false";
+            code.resize(start);
+            code.push_back(folded);
+        }
+        else if (cond) {
+            // fn:Xxx(arg,thing) --> thing (never deprecated)
+            assert(!deprecated);
+            code.erase(code.begin() + start);
+        }
+        else {
+            // fn:Xxx(arg,thing) --> indeterminate
+            bool thing_is_const = true;
+            for (size_t i = start + 1; i < code.size(); i++) {
+                thing_is_const = thing_is_const && (code[i].opcode == ArlOpcode::ARLOP_Const);
+                folded.sets_deprecated = folded.sets_deprecated || code[i].sets_deprecated;
+            }
+            folded.value.type = ASTNodeType::ASTNT_Unknown;
+            if (thing_is_const)
+                code.resize(start);
+            else {
+                // thing still needs to be executed, then its result is discarded
+                code.erase(code.begin() + start);
+                folded.has_arg[0] = true;
+                folded.sets_deprecated = deprecated;
+            }
+            code.push_back(folded);
+        }
+        starts.push_back(start);
+    } // for
+
+    assert(starts.size() == 1);
+    prog.code.swap(code);
+}
+
+
+/// @brief Returns the name of a predicate function without the opening bracket
+///
+/// @param[in] fn   the predicate function
+///
+/// @returns e.g. "fn:SinceVersion" or "" for ARLFN_Unknown
+std::string PredicateFunctionName(const ArlPredicateFn fn) {
+    for (auto& f : predicate_functions)
+        if (f.fn == fn) {
+            std::string s = f.name;
+            return s.substr(0, s.size() - 1);
+        }
+    return "";
+}
@@ -0,0 +1,211 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Compiled (bytecode) form of Arlington predicate ASTs.
+///
+/// An ASTNode tree is flattened into a post-order sequence of instructions with
+/// all predicate function names and operators resolved to enums, so that
+/// CPDFFile::ExecutePredicate() can evaluate it with a small value stack and
+/// without any string dispatch or per-node heap allocation.
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlPredicateProgram_h
+#define ArlPredicateProgram_h
+#pragma once
+
+#include "ASTNode.h"
+
+#include <string>
+#include <vector>
+
+/// @enum ArlOpcode
+/// Instruction kinds (one per kind of ASTNode that can be evaluated)
+enum class ArlOpcode {
+    ARLOP_Invalid = 0,  // Unknown or Type AST nodes - a parsing error
+    ARLOP_Const,        // boolean, string, integer, number or key: push the constant
+    ARLOP_KeyValue,     // "@key" - push the value of a key from the PDF
+    ARLOP_Function,     // "fn:Xxx(" predicate function
+    ARLOP_MathComp,     // ==, !=, <, <=, >, >=
+    ARLOP_MathOp,       // +, -, *, mod
+    ARLOP_LogicalOp     // &&, ||
+};
+
+
+/// @enum ArlPredicateFn
+/// Arlington predicate functions, resolved from "fn:Xxx(" when compiled
+enum class ArlPredicateFn {
+    ARLFN_Unknown = 0,
+    ARLFN_AlwaysUnencrypted,
+    ARLFN_ArrayLength,
+    ARLFN_ArraySortAscending,
+    ARLFN_BeforeVersion,
+    ARLFN_BitClear,
+    ARLFN_BitSet,
+    ARLFN_BitsClear,
+    ARLFN_BitsSet,
+    ARLFN_Contains,
+    ARLFN_DefaultValue,
+    ARLFN_Deprecated,
+    ARLFN_Eval,
+    ARLFN_Extension,
+    ARLFN_FileSize,
+    ARLFN_FontHasLatinChars,
+    ARLFN_HasProcessColorants,
+    ARLFN_HasSpotColorants,
+    ARLFN_Ignore,
+    ARLFN_ImageIsStructContentItem,
+    ARLFN_ImplementationDependent,
+    ARLFN_InKeyMap,
+    ARLFN_InNameTree,
+    ARLFN_IsAssociatedFile,
+    ARLFN_IsEncryptedWrapper,
+    ARLFN_IsFieldName,
+    ARLFN_IsHexString,
+    ARLFN_IsLastInNumberFormatArray,
+    ARLFN_IsMeaningful,
+    ARLFN_IsPDFTagged,
+    ARLFN_IsPDFVersion,
+    ARLFN_IsPresent,
+    ARLFN_IsRequired,
+    ARLFN_KeyNameIsColorant,
+    ARLFN_MustBeDirect,
+    ARLFN_MustBeIndirect,
+    ARLFN_NoCycle,
+    ARLFN_Not,
+    ARLFN_NotStandard14Font,
+    ARLFN_NumberOfPages,
+    ARLFN_PageContainsStructContentItems,
+    ARLFN_PageProperty,
+    ARLFN_RectHeight,
+    ARLFN_RectWidth,
+    ARLFN_RequiredValue,
+    ARLFN_SinceVersion,
+    ARLFN_StreamLength,
+    ARLFN_StringLength
+};
+
+/// @brief Number of ArlPredicateFn values (including ARLFN_Unknown)
+const int ArlPredicateFnCount = (int)ArlPredicateFn::ARLFN_StringLength + 1;
+
+
+/// @enum ArlOperator
+/// Math comparison, math and logical operators, resolved when compiled
+enum class ArlOperator {
+    ARLOPR_Unknown = 0,
+    ARLOPR_Equal,
+    ARLOPR_NotEqual,
+    ARLOPR_LessEqual,
+    ARLOPR_Less,
+    ARLOPR_GreaterEqual,
+    ARLOPR_Greater,
+    ARLOPR_Add,
+    ARLOPR_Subtract,
+    ARLOPR_Multiply,
+    ARLOPR_Modulo,
+    ARLOPR_And,
+    ARLOPR_Or
+};
+
+
+/// @brief A constant or operand of a bytecode instruction: the type and text of an AST node (without arguments).
+/// Unlike ASTNode this is safe to copy, so instructions and programs can be copied.
+struct ArlPredicateValue {
+    /// @brief operand or constant
+    std::string     node;
+
+    /// @brief type of operand or constant
+    ASTNodeType     type;
+
+    ArlPredicateValue() : type(ASTNodeType::ASTNT_Unknown) { /* constructor */ }
+
+    /// @brief output operator << (same format as ASTNode)
+    friend std::ostream& operator <<(std::ostream& ofs, const ArlPredicateValue& v) {
+        if (v.node.size() > 0)
+            ofs << "{" << ASTNodeType_strings[(int)v.type] << ":'" << v.node << "'}";
+        else
+            ofs << "{''}";
+        return ofs;
+    }
+};
+
+
+/// @brief A single bytecode instruction. Operands are the results of earlier instructions
+/// on the value stack: the 1st argument (if has_arg[0]) below the 2nd argument (if has_arg[1]).
+struct ArlPredicateInstr {
+    /// @brief what kind of instruction
+    ArlOpcode                   opcode;
+
+    /// @brief predicate function (ARLOP_Function only)
+    ArlPredicateFn              fn;
+
+    /// @brief operator (ARLOP_MathComp, ARLOP_MathOp and ARLOP_LogicalOp only)
+    ArlOperator                 oper;
+
+    /// @brief whether the AST node had a 1st and/or 2nd argument (optional arguments)
+    bool                        has_arg[2];
+
+    /// @brief the original AST node (no arguments). The constant for ARLOP_Const.
+    ArlPredicateValue           value;
+
+    /// @brief ARLOP_KeyValue: the Arlington path split on "::" with the '@' stripped off
+    std::vector<std::string>    key_parts;
+
+    /// @brief ARLOP_KeyValue: single key that has a DefaultValue in the same TSV file
+    bool                        has_default;
+
+    /// @brief ARLOP_KeyValue: the DefaultValue to use when the key is not present (no arguments)
+    ArlPredicateValue           default_value;
+
+    /// @brief ARLOP_Const: a folded fn:Deprecated() that flags the predicate as deprecated (see SpecializePredicate())
+    bool                        sets_deprecated;
+
+    ArlPredicateInstr() :
+        opcode(ArlOpcode::ARLOP_Invalid), fn(ArlPredicateFn::ARLFN_Unknown), oper(ArlOperator::ARLOPR_Unknown), has_default(false), sets_deprecated(false)
+        { /* constructor */ has_arg[0] = has_arg[1] = false; }
+};
+
+
+/// @brief A compiled predicate: instructions in post-order (arguments before their operator)
+struct ArlPredicateProgram {
+    /// @brief the instructions
+    std::vector<ArlPredicateInstr>  code;
+
+    /// @brief number of value stack slots needed to execute (including a result slot)
+    int                             max_stack;
+
+    ArlPredicateProgram() : max_stack(0) { /* constructor */ }
+};
+
+
+/// @brief A vector (stack) of compiled predicates, matching an ASTNodeStack
+typedef std::vector<ArlPredicateProgram>        ArlPredicateProgramStack;
+
+
+/// @brief A vector of vector of compiled predicates, matching an ASTNodeMatrix
+typedef std::vector<ArlPredicateProgramStack>   ArlPredicateProgramMatrix;
+
+
+/// @brief Compiles an AST into a post-order bytecode program
+void CompilePredicate(const ASTNode* ast, ArlPredicateProgram& prog);
+
+/// @brief Constant-folds version and extension predicates for a specific PDF version and set of extensions
+void SpecializePredicate(ArlPredicateProgram& prog, const int pdf_version, const std::vector<std::string>& extns);
+
+/// @brief Returns the name of a predicate function (e.g. "fn:SinceVersion") or "" for ARLFN_Unknown
+std::string PredicateFunctionName(const ArlPredicateFn fn);
+
+#endif // ArlPredicateProgram_h
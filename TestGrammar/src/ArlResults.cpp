@@ -0,0 +1,404 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Machine-readable validation result sinks (JSON Lines and binary)
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlResults.h"
+#include "utils.h"
+
+#include <cstdlib>
+
+/// @brief Severity names for JSON Lines output
+static const char* severity_names[] = { "error", "warning", "info" };
+
+
+/// @brief Returns the length of a valid UTF-8 sequence at the start of a string
+///
+/// @param[in] s     bytes
+/// @param[in] len   number of bytes available
+///
+/// @returns 1 to 4, or 0 if not a valid (shortest form, non-surrogate) UTF-8 sequence
+static int utf8_sequence_length(const unsigned char* s, size_t len) {
+    int n;
+    unsigned char lo = 0x80, hi = 0xBF;  // valid range of the 2nd byte
+    if (s[0] < 0x80)
+        return 1;
+    else if ((s[0] >= 0xC2) && (s[0] <= 0xDF))
+        n = 2;
+    else if ((s[0] >= 0xE0) && (s[0] <= 0xEF)) {
+        n = 3;
+        if (s[0] == 0xE0)
+            lo = 0xA0;      // overlong
+        else if (s[0] == 0xED)
+            hi = 0x9F;      // surrogates
+    }
+    else if ((s[0] >= 0xF0) && (s[0] <= 0xF4)) {
+        n = 4;
+        if (s[0] == 0xF0)
+            lo = 0x90;      // overlong
+        else if (s[0] == 0xF4)
+            hi = 0x8F;      // > U+10FFFF
+    }
+    else
+        return 0;
+    if ((size_t)n > len)
+        return 0;
+    if ((s[1] < lo) || (s[1] > hi))
+        return 0;
+    for (int i = 2; i < n; i++)
+        if ((s[i] & 0xC0) != 0x80)
+            return 0;
+    return n;
+}
+
+
+/// @brief Appends a string to a JSON string value, escaping as required. Strings are normally UTF-8
+/// but PDF names (keys) are raw bytes, so each byte that is not part of a valid UTF-8 sequence
+/// is output as a \\u00XX escape (i.e. as if Latin-1) so that the JSON is always valid UTF-8.
+///
+/// @param[in,out] out   JSON being built
+/// @param[in]     s     UTF-8 string or raw bytes
+void append_json_string(std::string& out, const std::string& s) {
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char* p = (const unsigned char*)s.data();
+    size_t len = s.size();
+    out += '"';
+    for (size_t i = 0; i < len; ) {
+        unsigned char c = p[i];
+        if (c >= 0x80) {
+            int n = utf8_sequence_length(p + i, len - i);
+            if (n > 0)
+                out.append((const char*)p + i, n);
+            else {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0x0F];
+                n = 1;
+            }
+            i += n;
+            continue;
+        }
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (c < 0x20) {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0x0F];
+            }
+            else
+                out += (char)c;
+            break;
+        }
+        i++;
+    }
+    out += '"';
+}
+
+
+ArlResultSink::ArlResultSink(std::ostream& ofs)
+    : output(ofs), code(ArlMessageCode::Exception), severity(ArlSeverity::Info), object_num(0), generation_num(-1), object_kind(ArlObjectKind::None),
+      counts{ 0, 0, 0 }, text_stream(this), in_message(false), in_escape(false)
+{
+    /* constructor */
+}
+
+
+/// @brief Starts a new message record. The message text is then written to the returned stream
+/// and the record is completed by an end-of-line (i.e. COLOR_RESET).
+///
+/// @param[in] sev        severity
+/// @param[in] c          stable message code
+/// @param[in] tsv_name   Arlington TSV file (link) or empty
+/// @param[in] key_name   PDF key or array index or empty
+/// @param[in] obj        PDF object the message is about or nullptr
+/// @param[in] dom_path   PDF DOM path or empty
+///
+/// @returns stream for the message text
+std::ostream& ArlResultSink::message(const ArlSeverity sev, const ArlMessageCode c, const std::string& tsv_name, const std::string& key_name, ArlPDFObject* obj, const std::string& dom_path) {
+    // Any incomplete previous message (e.g. due to an exception) is discarded
+    severity = sev;
+    code = c;
+    tsv = tsv_name;
+    key = key_name;
+    path = dom_path;
+    object_num = 0;
+    generation_num = -1;
+    object_kind = ArlObjectKind::None;
+    if (obj != nullptr) {
+        // PDF SDK shims give direct objects the negated object and generation number of their container
+        int num = obj->get_object_number();
+        object_kind = (num > 0) ? ArlObjectKind::Indirect : ArlObjectKind::Direct;
+        if (num != 0) {
+            object_num = std::abs(num);
+            generation_num = std::abs(obj->get_generation_number());
+        }
+    }
+    text.clear();
+    in_message = true;
+    in_escape = false;
+    return text_stream;
+}
+
+
+/// @brief Appends message text, dropping ANSI escape sequences and completing the record on end-of-line
+void ArlResultSink::append_text(const char* s, std::streamsize n) {
+    for (std::streamsize i = 0; i < n; i++) {
+        char c = s[i];
+        if (in_escape) {
+            in_escape = (c != 'm');
+        }
+        else if (c == '\033') {
+            in_escape = true;
+        }
+        else if (c == '\n') {
+            if (in_message) {
+                counts[(int)severity]++;
+                write_message();
+                in_message = false;
+            }
+        }
+        else if (in_message)
+            text += c;
+    }
+}
+
+
+std::streambuf::int_type ArlResultSink::overflow(int_type ch) {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        char c = traits_type::to_char_type(ch);
+        append_text(&c, 1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+
+std::streamsize ArlResultSink::xsputn(const char* s, std::streamsize n) {
+    append_text(s, n);
+    return n;
+}
+
+
+void ArlJSONLinesSink::begin_pdf(const std::string& pdf, const std::string& tg_version, const std::string& sdk_version, const std::string& tsv_folder) {
+    pdf_name = pdf;
+    counts[0] = counts[1] = counts[2] = 0;
+    line = "{\"record\":\"begin\",\"pdf\":";
+    append_json_string(line, pdf_name);
+    line += ",\"version\":";
+    append_json_string(line, tg_version);
+    line += ",\"sdk\":";
+    append_json_string(line, sdk_version);
+    line += ",\"tsvdir\":";
+    append_json_string(line, tsv_folder);
+    line += "}\n";
+    output.write(line.data(), line.size());
+}
+
+
+void ArlJSONLinesSink::write_message() {
+    line = "{\"record\":\"message\",\"pdf\":";
+    append_json_string(line, pdf_name);
+    line += ",\"code\":";
+    line += std::to_string((int)code);
+    line += ",\"severity\":\"";
+    line += severity_names[(int)severity];
+    line += "\",\"tsv\":";
+    append_json_string(line, tsv);
+    line += ",\"key\":";
+    append_json_string(line, key);
+    if (object_num != 0) {
+        line += ",\"obj\":";
+        line += std::to_string(object_num);
+        line += ",\"gen\":";
+        line += std::to_string(generation_num);
+    }
+    else
+        line += ",\"obj\":null,\"gen\":null";
+    line += ",\"direct\":";
+    if (object_kind == ArlObjectKind::None)
+        line += "null";
+    else
+        line += ((object_kind == ArlObjectKind::Direct) ? "true" : "false");
+    line += ",\"path\":";
+    append_json_string(line, path);
+    line += ",\"text\":";
+    append_json_string(line, text);
+    line += "}\n";
+    output.write(line.data(), line.size());
+}
+
+
+void ArlJSONLinesSink::end_pdf(const bool ok) {
+    line = "{\"record\":\"end\",\"pdf\":";
+    append_json_string(line, pdf_name);
+    line += ",\"ok\":";
+    line += (ok ? "true" : "false");
+    line += ",\"errors\":" + std::to_string(counts[(int)ArlSeverity::Error]);
+    line += ",\"warnings\":" + std::to_string(counts[(int)ArlSeverity::Warning]);
+    line += ",\"infos\":" + std::to_string(counts[(int)ArlSeverity::Info]);
+    line += "}\n";
+    output.write(line.data(), line.size());
+    output.flush();
+}
+
+
+/// @brief Starts a binary record. The payload length is filled in by finish_record().
+void ArlBinarySink::start_record(const uint8_t type) {
+    record.clear();
+    put_u8(type);
+    put_u32(0);
+}
+
+
+void ArlBinarySink::put_u8(const uint8_t v) {
+    record += (char)v;
+}
+
+
+void ArlBinarySink::put_u16(const uint16_t v) {
+    record += (char)(v & 0xFF);
+    record += (char)((v >> 8) & 0xFF);
+}
+
+
+void ArlBinarySink::put_u32(const uint32_t v) {
+    record += (char)(v & 0xFF);
+    record += (char)((v >> 8) & 0xFF);
+    record += (char)((v >> 16) & 0xFF);
+    record += (char)((v >> 24) & 0xFF);
+}
+
+
+void ArlBinarySink::put_string(const std::string& s) {
+    put_u32((uint32_t)s.size());
+    record += s;
+}
+
+
+/// @brief Patches the payload length and writes the record
+void ArlBinarySink::finish_record() {
+    uint32_t len = (uint32_t)(record.size() - 5);
+    for (int i = 0; i < 4; i++)
+        record[1 + i] = (char)((len >> (8 * i)) & 0xFF);
+    output.write(record.data(), record.size());
+}
+
+
+/// @brief Writes a "stats" record (--stats)
+///
+/// @param[in] json   single line JSON object (see ArlStats::to_json())
+void ArlJSONLinesSink::write_stats(const std::string& json) {
+    output.write(json.data(), json.size());
+    output.put('\n');
+}
+
+
+void ArlBinarySink::begin_pdf(const std::string& pdf, const std::string& tg_version, const std::string& sdk_version, const std::string& tsv_folder) {
+    pdf_name = pdf;
+    counts[0] = counts[1] = counts[2] = 0;
+    start_record(1);
+    record += "ARLR";
+    put_u8(2);
+    put_string(pdf_name);
+    put_string(tg_version);
+    put_string(sdk_version);
+    put_string(tsv_folder);
+    finish_record();
+}
+
+
+void ArlBinarySink::write_message() {
+    start_record(2);
+    put_u16((uint16_t)code);
+    put_u8((uint8_t)severity);
+    put_u32((uint32_t)object_num);
+    put_u32((uint32_t)generation_num);
+    put_u8((uint8_t)object_kind);
+    put_string(tsv);
+    put_string(key);
+    put_string(path);
+    put_string(text);
+    finish_record();
+}
+
+
+/// @brief Writes a "stats" record (--stats) with the statistics as a JSON string
+///
+/// @param[in] json   single line JSON object (see ArlStats::to_json())
+void ArlBinarySink::write_stats(const std::string& json) {
+    start_record(4);
+    put_string(json);
+    finish_record();
+}
+
+
+void ArlBinarySink::end_pdf(const bool ok) {
+    start_record(3);
+    put_u8(ok ? 1 : 0);
+    put_u32(counts[(int)ArlSeverity::Error]);
+    put_u32(counts[(int)ArlSeverity::Warning]);
+    put_u32(counts[(int)ArlSeverity::Info]);
+    finish_record();
+    output.flush();
+}
+
+
+/// @brief Creates a result sink for a format
+///
+/// @param[in] fmt   output format
+/// @param[in] ofs   already open output stream
+///
+/// @returns a new result sink (caller deletes) or nullptr for text output
+ArlResultSink* make_result_sink(const ArlOutputFormat fmt, std::ostream& ofs) {
+    switch (fmt) {
+    case ArlOutputFormat::JSONLines:    return new ArlJSONLinesSink(ofs);
+    case ArlOutputFormat::Binary:       return new ArlBinarySink(ofs);
+    default:                            return nullptr;
+    }
+}
+
+
+/// @brief Starts a message either as colorized text (sink is nullptr) or as a result record.
+/// Callers then write the message text and COLOR_RESET to the returned stream.
+///
+/// @param[in] ofs    output stream for text output
+/// @param[in] sink   result sink or nullptr for text output
+/// @param[in] sev    severity
+/// @param[in] code   stable message code
+/// @param[in] tsv    Arlington TSV file (link) or empty
+/// @param[in] key    PDF key or array index or empty
+/// @param[in] obj    PDF object the message is about or nullptr
+/// @param[in] path   PDF DOM path or empty
+///
+/// @returns stream for the message text
+std::ostream& arl_message(std::ostream& ofs, ArlResultSink* sink, const ArlSeverity sev, const ArlMessageCode code,
+                          const std::string& tsv, const std::string& key, ArlPDFObject* obj, const std::string& path) {
+    if (sink != nullptr)
+        return sink->message(sev, code, tsv, key, obj, path);
+
+    switch (sev) {
+    case ArlSeverity::Error:    ofs << COLOR_ERROR;     break;
+    case ArlSeverity::Warning:  ofs << COLOR_WARNING;   break;
+    default:                    ofs << COLOR_INFO;      break;
+    }
+    return ofs;
+}
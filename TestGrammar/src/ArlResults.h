@@ -0,0 +1,300 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Machine-readable validation result sinks (JSON Lines and binary)
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlResults_h
+#define ArlResults_h
+#pragma once
+
+#include "ArlingtonPDFShim.h"
+
+#include <cstdint>
+#include <string>
+#include <iostream>
+#include <streambuf>
+
+using namespace ArlingtonPDFShim;
+
+
+/// @brief Output format for PDF validation results (--format)
+enum class ArlOutputFormat { Text = 0, JSONLines, Binary };
+
+
+/// @brief Severity of a validation message
+enum class ArlSeverity : uint8_t { Error = 0, Warning = 1, Info = 2 };
+
+
+/// @brief Whether the PDF object of a message is an indirect object, a direct object or there is no PDF object
+enum class ArlObjectKind : uint8_t { Indirect = 0, Direct = 1, None = 255 };
+
+
+/// @brief Stable numeric codes for every validation message.
+/// Values are part of the JSON Lines and binary output formats so NEVER renumber or reuse a code!
+/// New messages get a new code at the end of the relevant range.
+///   - 1xx: PDF file level (versions, trailer, encryption)
+///   - 2xx: PDF objects and Arlington links
+///   - 3xx: PDF dictionary keys
+///   - 4xx: PDF arrays
+///   - 5xx: PDF values (types, indirect references, SpecialCase, PossibleValues)
+///   - 6xx: PDF name and number trees
+enum class ArlMessageCode : uint16_t {
+    HeaderVersion                   = 100,
+    BadHeaderVersion                = 101,
+    CatalogVersion                  = 102,
+    BadCatalogVersion               = 103,
+    CatalogMajorVersionEarlier      = 104,
+    CatalogMinorVersionEarlier      = 105,
+    NoValidVersion                  = 106,
+    XRefStreamBeforePDF15           = 107,
+    XRefStreamWithOldHeader         = 108,
+    RoundedUpVersion                = 109,
+    ForcedVersion                   = 110,
+    ProcessingAsVersion             = 111,
+    XRefStreamDetected              = 112,
+    TraditionalTrailerDetected      = 113,
+    UnsupportedEncryption           = 114,
+    EncryptedPDF                    = 115,
+    LatestFeatureVersion            = 116,
+    NoTrailer                       = 117,
+    OpenFailed                      = 118,
+    Exception                       = 119,
+    MemoryLimitExceeded             = 120,
+    VersionVerdict                  = 121,
+
+    NoLinkSelected                  = 200,
+    InheritanceTooDeep              = 201,
+    DifferentContexts               = 202,
+    MissingTSVFile                  = 203,
+    IllegalObjectNumber             = 204,
+    DuplicateKey                    = 205,
+    IllegalKeyObjectNumber          = 206,
+    IllegalArrayElementObjectNumber = 207,
+    UnexpectedObjectType            = 208,
+    ArrayAsDictionary               = 209,
+    InheritanceCycle                = 210,
+
+    NumberTreeNotDictionary         = 300,
+    NameTreeNotDictionary           = 301,
+    KeyAfterObsolescence            = 302,
+    KeyBeforeIntroduction           = 303,
+    KeyDeprecated                   = 304,
+    KeyOnlyInVersion                = 305,
+    MetadataKey                     = 306,
+    AssociatedFileKey               = 307,
+    WildcardWrongType               = 308,
+    WildcardAfterObsolescence       = 309,
+    WildcardBeforeIntroduction      = 310,
+    WildcardDeprecated              = 311,
+    WildcardOnlyInVersion           = 312,
+    SecondClassKey                  = 313,
+    ThirdClassKey                   = 314,
+    UnknownKey                      = 315,
+    KeyValueMissing                 = 316,
+    RequiredKeyMissing              = 317,
+    RequiredKeyMayBeMissing         = 318,
+    InheritableRequiredKeyMissing   = 319,
+    InheritableRequiredKeyMayBeMissing = 320,
+    RequiredKeyUnknown              = 321,
+
+    ArrayMinimumLength              = 400,
+    ArrayTooShort                   = 401,
+    ArrayNotMultiple                = 402,
+    ArrayAfterObsolescence          = 403,
+    ArrayBeforeIntroduction         = 404,
+    ArrayDeprecated                 = 405,
+    ArrayOnlyInVersion              = 406,
+    ArrayTooLong                    = 407,
+
+    NullNotAllowed                  = 500,
+    NullValue                       = 501,
+    WrongType                       = 502,
+    NotIndirect                     = 503,
+    BitmaskNot32Bit                 = 504,
+    IntegerOutOfRange               = 505,
+    BitmaskNotInteger               = 506,
+    NameTooLong                     = 507,
+    EmptyName                       = 508,
+    StringUTF16LE                   = 509,
+    StringUnprintableASCII          = 510,
+    InvalidDate                     = 511,
+    PossiblyInvalidDate             = 512,
+    RectangleNot4Elements           = 513,
+    RectangleNotNumeric             = 514,
+    MatrixNot6Elements              = 515,
+    MatrixNotNumeric                = 516,
+    SpecialCasePartial              = 517,
+    SpecialCaseFailed               = 518,
+    PossibleValuesPartial           = 519,
+    PossibleValuesFailed            = 520,
+
+    NameTreeMissingValue            = 600,
+    NameTreeNullName                = 601,
+    NameTreeNameNotString           = 602,
+    NameTreeNamesMissing            = 603,
+    NameTreeNamesNotArray           = 604,
+    NameTreeKidNotDictionary        = 605,
+    NameTreeKidsNotArray            = 606,
+    NameTreeLimitsInvalid           = 607,
+    NameTreeOutOfLimits             = 608,
+    NameTreeNotSorted               = 609,
+    NumberTreeNullValue             = 610,
+    NumberTreeKeyNotInteger         = 611,
+    NumberTreeNumsInvalid           = 612,
+    NumberTreeNumsNotArray          = 613,
+    NumberTreeNumsMissing           = 614,
+    NumberTreeKidNotDictionary      = 615,
+    NumberTreeKidsNotArray          = 616,
+    NumberTreeLimitsInvalid         = 617,
+    NumberTreeOutOfLimits           = 618,
+    NumberTreeNotSorted             = 619,
+    TreeKidsCycle                   = 620
+};
+
+
+/// @brief Base class for machine-readable validation results.
+///
+/// Message text is written to the std::ostream returned by message() using the same
+/// "<< ... << COLOR_RESET" idiom as text output. The end-of-line from COLOR_RESET completes
+/// the record which is then written by the derived class. ANSI escape sequences are dropped.
+class ArlResultSink : private std::streambuf {
+protected:
+    /// @brief Output stream for records. Already open
+    std::ostream&   output;
+
+    /// @brief Current PDF file (set by begin_pdf())
+    std::string     pdf_name;
+
+    /// @brief Fields of the current message record
+    ArlMessageCode  code;
+    ArlSeverity     severity;
+
+    /// @brief PDF object of the message: the object number and generation number of the indirect object or,
+    /// for a direct object, of the indirect object containing it. object_num is 0 if there is no such object
+    /// (no PDF object, or a direct object not inside any indirect object such as the trailer).
+    int             object_num;
+    int             generation_num;
+
+    /// @brief Whether the PDF object of the message is a direct object (and thus not object_num itself)
+    ArlObjectKind   object_kind;
+    std::string     tsv;
+    std::string     key;
+    std::string     path;
+    std::string     text;
+
+    /// @brief Number of error, warning and info messages for the current PDF file
+    unsigned int    counts[3];
+
+    /// @brief Writes the current message record
+    virtual void write_message() = 0;
+
+private:
+    /// @brief Stream used to collect message text
+    std::ostream    text_stream;
+
+    /// @brief true between message() and the end-of-line that completes it
+    bool            in_message;
+
+    /// @brief true while skipping an ANSI escape sequence
+    bool            in_escape;
+
+    void append_text(const char* s, std::streamsize n);
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+public:
+    explicit ArlResultSink(std::ostream& ofs);
+    virtual ~ArlResultSink() { /* destructor */ }
+
+    /// @brief Starts the results for a PDF file
+    virtual void begin_pdf(const std::string& pdf, const std::string& tg_version, const std::string& sdk_version, const std::string& tsv_folder) = 0;
+
+    /// @brief Ends the results for a PDF file
+    virtual void end_pdf(const bool ok) = 0;
+
+    /// @brief Writes profiling statistics (--stats) for the current PDF file
+    virtual void write_stats(const std::string& json) = 0;
+
+    std::ostream& message(const ArlSeverity sev, const ArlMessageCode c, const std::string& tsv_name, const std::string& key_name, ArlPDFObject* obj, const std::string& dom_path);
+};
+
+
+/// @brief JSON Lines results (one JSON object per line, https://jsonlines.org)
+class ArlJSONLinesSink : public ArlResultSink {
+private:
+    /// @brief reused line buffer
+    std::string     line;
+
+    void write_message() override;
+
+public:
+    explicit ArlJSONLinesSink(std::ostream& ofs) : ArlResultSink(ofs)
+        { /* constructor */ }
+
+    void begin_pdf(const std::string& pdf, const std::string& tg_version, const std::string& sdk_version, const std::string& tsv_folder) override;
+    void end_pdf(const bool ok) override;
+    void write_stats(const std::string& json) override;
+};
+
+
+/// @brief Compact binary results. All integers are little-endian.
+///
+/// Every record is: u8 record type, u32 payload length, payload. Strings are u32 length + UTF-8 bytes.
+///   - 1 = begin:   "ARLR", u8 format version (2), string PDF, string TestGrammar version, string PDF SDK, string TSV folder
+///   - 2 = message: u16 code, u8 severity, i32 object number, i32 generation number, u8 ArlObjectKind,
+///                  string TSV, string key, string DOM path, string text.
+///                  The object and generation number are of the (containing) indirect object, or 0 and -1 if none.
+///
+/// In JSON Lines, a message has "obj" and "gen" (null if none) and "direct" (true, false or null if no PDF object).
+///   - 3 = end:     u8 ok, u32 errors, u32 warnings, u32 infos
+///   - 4 = stats:   string JSON (--stats only, before end)
+class ArlBinarySink : public ArlResultSink {
+private:
+    /// @brief reused record buffer
+    std::string     record;
+
+    void start_record(const uint8_t type);
+    void put_u8(const uint8_t v);
+    void put_u16(const uint16_t v);
+    void put_u32(const uint32_t v);
+    void put_string(const std::string& s);
+    void finish_record();
+
+    void write_message() override;
+
+public:
+    explicit ArlBinarySink(std::ostream& ofs) : ArlResultSink(ofs)
+        { /* constructor */ }
+
+    void begin_pdf(const std::string& pdf, const std::string& tg_version, const std::string& sdk_version, const std::string& tsv_folder) override;
+    void end_pdf(const bool ok) override;
+    void write_stats(const std::string& json) override;
+};
+
+
+/// @brief Appends a string (UTF-8 or raw PDF name bytes) to a JSON string value, escaping as required
+void append_json_string(std::string& out, const std::string& s);
+
+/// @brief Creates a result sink for a format. nullptr for text output.
+ArlResultSink* make_result_sink(const ArlOutputFormat fmt, std::ostream& ofs);
+
+/// @brief Starts a message either as colorized text or as a result record
+std::ostream& arl_message(std::ostream& ofs, ArlResultSink* sink, const ArlSeverity sev, const ArlMessageCode code,
+                          const std::string& tsv = "", const std::string& key = "", ArlPDFObject* obj = nullptr, const std::string& path = "");
+
+#endif // ArlResults_h
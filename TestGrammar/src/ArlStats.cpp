@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Opt-in profiling counters for validating a PDF file (--stats)
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlStats.h"
+#include "ArlResults.h"
+
+#include <algorithm>
+#include <iomanip>
+
+
+/// @brief A named statistics entry, for sorting
+struct named_entry {
+    std::string     name;
+    ArlStatsEntry   e;
+};
+
+
+/// @brief Non-zero TSV entries, slowest first
+static std::vector<named_entry> sorted_tsv_entries(const std::vector<ArlStatsEntry>& tsv, const CArlingtonGrammar& grammar) {
+    std::vector<named_entry> v;
+    for (int i = 0; i < (int)tsv.size(); i++)
+        if (tsv[i].count > 0)
+            v.push_back({ grammar.get_symbol_name(i), tsv[i] });
+    std::sort(v.begin(), v.end(), [](const named_entry& a, const named_entry& b) { return (a.e.ns > b.e.ns) || ((a.e.ns == b.e.ns) && (a.name < b.name)); });
+    return v;
+}
+
+
+/// @brief Non-zero predicate function entries, slowest first
+static std::vector<named_entry> sorted_fn_entries(const ArlStatsEntry* fn) {
+    std::vector<named_entry> v;
+    for (int i = 0; i < ArlPredicateFnCount; i++)
+        if (fn[i].count > 0)
+            v.push_back({ (i == (int)ArlPredicateFn::ARLFN_Unknown) ? "fn:Unknown" : PredicateFunctionName((ArlPredicateFn)i), fn[i] });
+    std::sort(v.begin(), v.end(), [](const named_entry& a, const named_entry& b) { return (a.e.ns > b.e.ns) || ((a.e.ns == b.e.ns) && (a.name < b.name)); });
+    return v;
+}
+
+
+/// @brief Writes a human-readable summary table. TSV and predicate times are slowest first.
+/// TSV times are the time processing each PDF object (including its predicates) but not its children.
+///
+/// @param[in] ofs       open output stream
+/// @param[in] grammar   the Arlington PDF model (for TSV names)
+void ArlStats::write_table(std::ostream& ofs, const CArlingtonGrammar& grammar) const {
+    auto tsvs = sorted_tsv_entries(tsv, grammar);
+    auto fns = sorted_fn_entries(fn);
+
+    uint64_t objects = 0;
+    for (auto& t : tsvs)
+        objects += t.e.count;
+
+    ofs << std::fixed << std::setprecision(3);
+    ofs << "Statistics: " << objects << " objects validated in " << (total_ns / 1e6) << " ms" << std::endl;
+    ofs << "Peak queue: " << peak_queue_depth << " objects (" << peak_queued_bytes << " bytes)" << std::endl;
+    ofs << "PDF SDK: " << sdk.dict_has_key << " has_key, " << sdk.dict_get_value << " dictionary get_value, "
+        << sdk.dict_get_key_name << " get_key_name_by_index, " << sdk.array_get_value << " array get_value, "
+        << sdk.dict_for_each_key << " for_each_key, " << sdk.array_for_each_element << " for_each_element, "
+        << sdk.objects_allocated << " objects allocated" << std::endl;
+    ofs << "Link selection memo: " << link_memo_hits << " hits, " << link_memo_misses << " misses" << std::endl;
+
+    ofs << std::left << std::setw(48) << "Arlington TSV" << std::right << std::setw(12) << "Visits" << std::setw(14) << "Time (ms)" << std::endl;
+    for (auto& t : tsvs)
+        ofs << std::left << std::setw(48) << t.name << std::right << std::setw(12) << t.e.count << std::setw(14) << (t.e.ns / 1e6) << std::endl;
+
+    ofs << std::left << std::setw(48) << "Predicate" << std::right << std::setw(12) << "Calls" << std::setw(14) << "Time (ms)" << std::endl;
+    for (auto& f : fns)
+        ofs << std::left << std::setw(48) << f.name << std::right << std::setw(12) << f.e.count << std::setw(14) << (f.e.ns / 1e6) << std::endl;
+    ofs << std::defaultfloat << std::setprecision(6);
+}
+
+
+/// @brief Returns all statistics as a single line JSON object. Times are in nanoseconds.
+///
+/// @param[in] pdf       PDF filename
+/// @param[in] grammar   the Arlington PDF model (for TSV names)
+///
+/// @returns {"record":"stats","pdf":...} without a trailing end-of-line
+std::string ArlStats::to_json(const std::string& pdf, const CArlingtonGrammar& grammar) const {
+    std::string s = "{\"record\":\"stats\",\"pdf\":";
+    append_json_string(s, pdf);
+    s += ",\"total_ns\":" + std::to_string(total_ns);
+    s += ",\"peak_queue_depth\":" + std::to_string(peak_queue_depth);
+    s += ",\"peak_queued_bytes\":" + std::to_string(peak_queued_bytes);
+    s += ",\"sdk\":{\"has_key\":" + std::to_string(sdk.dict_has_key);
+    s += ",\"dict_get_value\":" + std::to_string(sdk.dict_get_value);
+    s += ",\"get_key_name_by_index\":" + std::to_string(sdk.dict_get_key_name);
+    s += ",\"array_get_value\":" + std::to_string(sdk.array_get_value);
+    s += ",\"for_each_key\":" + std::to_string(sdk.dict_for_each_key);
+    s += ",\"for_each_element\":" + std::to_string(sdk.array_for_each_element);
+    s += ",\"objects_allocated\":" + std::to_string(sdk.objects_allocated) + "}";
+    s += ",\"link_memo\":{\"hits\":" + std::to_string(link_memo_hits) + ",\"misses\":" + std::to_string(link_memo_misses) + "}";
+
+    s += ",\"tsv\":{";
+    bool first = true;
+    for (auto& t : sorted_tsv_entries(tsv, grammar)) {
+        if (!first)
+            s += ',';
+        first = false;
+        append_json_string(s, t.name);
+        s += ":{\"visits\":" + std::to_string(t.e.count) + ",\"ns\":" + std::to_string(t.e.ns) + "}";
+    }
+
+    s += "},\"predicates\":{";
+    first = true;
+    for (auto& f : sorted_fn_entries(fn)) {
+        if (!first)
+            s += ',';
+        first = false;
+        append_json_string(s, f.name);
+        s += ":{\"calls\":" + std::to_string(f.e.count) + ",\"ns\":" + std::to_string(f.e.ns) + "}";
+    }
+    return s + "}}";
+}
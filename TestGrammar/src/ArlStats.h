@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Opt-in profiling counters for validating a PDF file (--stats)
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlStats_h
+#define ArlStats_h
+#pragma once
+
+#include "ArlingtonPDFShim.h"
+#include "ArlingtonTSVGrammarFile.h"
+#include "ArlPredicateProgram.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ArlingtonPDFShim;
+
+
+/// @brief A call (or visit) count and the cumulative time of those calls
+struct ArlStatsEntry {
+    uint64_t    count;
+    uint64_t    ns;
+
+    ArlStatsEntry() : count(0), ns(0)
+        { /* constructor */ }
+};
+
+
+/// @class ArlStats
+/// Profiling counters for a single PDF file. Only allocated with --stats: everything that
+/// is instrumented holds an ArlStats* which is nullptr when statistics are disabled.
+class ArlStats {
+public:
+    /// @brief Visits and exclusive time in CParsePDF::parse_object() per Arlington TSV file, indexed by ArlSymbol
+    std::vector<ArlStatsEntry>  tsv;
+
+    /// @brief Calls and time in CPDFFile::ExecutePredicate() per predicate function, indexed by ArlPredicateFn
+    ArlStatsEntry               fn[ArlPredicateFnCount];
+
+    /// @brief PDF SDK calls and PDF object allocations (see ArlingtonPDFSDK::counters)
+    ArlSDKCounters              sdk;
+
+    /// @brief Peak number of PDF objects queued for processing
+    size_t                      peak_queue_depth;
+
+    /// @brief Peak estimated memory in bytes of queued PDF objects
+    size_t                      peak_queued_bytes;
+
+    /// @brief Link selections answered from the memo of previously scored PDF objects (hits) or scored (misses)
+    uint64_t                    link_memo_hits;
+    uint64_t                    link_memo_misses;
+
+    /// @brief Total time validating the PDF file
+    uint64_t                    total_ns;
+
+    ArlStats() : peak_queue_depth(0), peak_queued_bytes(0), link_memo_hits(0), link_memo_misses(0), total_ns(0)
+        { /* constructor */ }
+
+    /// @brief Returns the entry for an Arlington TSV file
+    ArlStatsEntry* tsv_entry(const ArlSymbol link) {
+        if (link >= (int)tsv.size())
+            tsv.resize(link + 1);
+        return &tsv[link];
+    };
+
+    /// @brief Records the current size of the queue of PDF objects
+    void note_queue(const size_t depth, const size_t bytes) {
+        if (depth > peak_queue_depth)
+            peak_queue_depth = depth;
+        if (bytes > peak_queued_bytes)
+            peak_queued_bytes = bytes;
+    };
+
+    /// @brief Writes a human-readable summary table
+    void write_table(std::ostream& ofs, const CArlingtonGrammar& grammar) const;
+
+    /// @brief Returns all statistics as a single line JSON object (a "stats" record)
+    std::string to_json(const std::string& pdf, const CArlingtonGrammar& grammar) const;
+};
+
+
+/// @class ArlStatsTimer
+/// Adds the time until it goes out of scope (and a count of 1) to a statistics entry.
+/// Does nothing (not even reading the clock) if the entry is nullptr.
+class ArlStatsTimer {
+private:
+    ArlStatsEntry*                          entry;
+    std::chrono::steady_clock::time_point   start;
+
+public:
+    explicit ArlStatsTimer(ArlStatsEntry* e) : entry(e) {
+        if (entry != nullptr)
+            start = std::chrono::steady_clock::now();
+    };
+
+    ~ArlStatsTimer() {
+        if (entry != nullptr) {
+            entry->count++;
+            entry->ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+};
+
+#endif // ArlStats_h
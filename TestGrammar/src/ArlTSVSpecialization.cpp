@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Version-specialized view of an Arlington TSV file - see CArlTSVSpecialization
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlTSVSpecialization.h"
+
+#include <cassert>
+
+
+/// @brief Precomputes the ArlVersion of every row for each basic type. Predicates are folded on first use.
+///
+/// @param[in] tsv       the Arlington TSV file. Never nullptr. Must outlive this object.
+/// @param[in] pdf_ver   PDF version multiplied by 10
+/// @param[in] extns     supported extensions (can include the wildcard '*')
+CArlTSVSpecialization::CArlTSVSpecialization(const CArlingtonTSVGrammarFile* tsv, const int pdf_ver, const std::vector<std::string>& extns) :
+    tsv_file(tsv), pdf_version(pdf_ver), extensions(extns)
+{
+    assert(tsv_file != nullptr);
+    const ArlTSVTypedMatrix& rows = tsv_file->get_typed_data();
+    versions.reserve(rows.size() * ArlBasicTypeCount);
+    for (auto& row : rows)
+        for (int t = 0; t < ArlBasicTypeCount; t++)
+            versions.emplace_back((ArlBasicType)t, row, pdf_version, extensions);
+}
+
+
+/// @brief Folds the version and extension predicates of a column for all rows (see SpecializePredicate())
+///
+/// @param[in] col   the TSV column
+void CArlTSVSpecialization::specialize_predicates(const ArlingtonTSVColumns col) const
+{
+    const int num_rows = (int)tsv_file->get_typed_data().size();
+    predicate_program[col].resize(num_rows);
+    for (int key_idx = 0; key_idx < num_rows; key_idx++) {
+        ArlPredicateProgramMatrix& pm = predicate_program[col][key_idx];
+        pm = tsv_file->get_predicate_program(key_idx, col);
+        for (auto& stack : pm)
+            for (auto& prog : stack)
+                if (!prog.code.empty())
+                    SpecializePredicate(prog, pdf_version, extensions);
+    }
+}
+
+
+/// @brief Returns the precomputed ArlVersion of a row for a PDF object
+///
+/// @param[in] key_idx   the row index into the TSV data
+/// @param[in] obj       the PDF object. Never nullptr.
+///
+/// @returns the same as ArlVersion(obj, row, pdf_version, extensions)
+const ArlVersion& CArlTSVSpecialization::get_version(const int key_idx, ArlPDFObject* obj) const
+{
+    assert((key_idx >= 0) && (key_idx * ArlBasicTypeCount < (int)versions.size()));
+    return versions[key_idx * ArlBasicTypeCount + (int)ArlVersion::get_basic_type(obj)];
+}
+
+
+/// @brief Returns the compiled predicates for a field of a row with all version and extension predicates folded.
+/// Same shape as CArlingtonTSVGrammarFile::get_predicate_program().
+///
+/// @param[in] key_idx   the row index into the TSV data
+/// @param[in] col       the TSV column (SinceVersion, Required, IndirectRef, DefaultValue, PossibleValues or SpecialCase)
+///
+/// @returns an outer vector per Arlington type of vectors of programs (empty for nullptr ASTs)
+const ArlPredicateProgramMatrix& CArlTSVSpecialization::get_predicate_program(const int key_idx, const ArlingtonTSVColumns col) const
+{
+    assert((key_idx >= 0) && (key_idx < (int)tsv_file->get_typed_data().size()));
+    std::call_once(predicate_program_once[col], [this, col]() { specialize_predicates(col); });
+    return predicate_program[col][key_idx];
+}
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Version-specialized view of an Arlington TSV file - see CArlTSVSpecialization
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlTSVSpecialization_h
+#define ArlTSVSpecialization_h
+#pragma once
+
+#include "ArlingtonTSVGrammarFile.h"
+#include "ArlPredicateProgram.h"
+#include "ArlVersion.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/// @class CArlTSVSpecialization
+/// An Arlington TSV file reduced for a specific PDF version and set of extensions, similar to
+/// gcxml's TSVHandler.reduceComplexForVersion() but in-process. Version and extension predicates
+/// (fn:SinceVersion, fn:BeforeVersion, fn:IsPDFVersion, fn:Deprecated and fn:Extension) are
+/// constant-folded out of the compiled predicates and the ArlVersion of every row is precomputed
+/// for each basic type, so validating a PDF never evaluates them.
+///
+/// Created and owned by CArlingtonTSVGrammarFile::get_specialization(). Immutable once constructed
+/// (predicates are folded once per column, on first use) so can be shared by all threads.
+class CArlTSVSpecialization {
+private:
+    /// @brief the Arlington TSV file being specialized
+    const CArlingtonTSVGrammarFile*     tsv_file;
+
+    /// @brief PDF version multiplied by 10
+    int                                 pdf_version;
+
+    /// @brief supported extensions (can include the wildcard '*')
+    std::vector<std::string>            extensions;
+
+    /// @brief ArlVersion of every row for each basic type, indexed by [row * ArlBasicTypeCount + type]
+    std::vector<ArlVersion>             versions;
+
+    /// @brief Folded copies of CArlingtonTSVGrammarFile::get_predicate_program(), indexed by [column][row]
+    mutable std::vector<ArlPredicateProgramMatrix>  predicate_program[TSV_NOTES + 1];
+
+    /// @brief Ensures each column of predicate_program is only folded once, even across threads
+    mutable std::once_flag              predicate_program_once[TSV_NOTES + 1];
+
+    /// @brief Folds all predicates of a column of the TSV file into predicate_program
+    void specialize_predicates(const ArlingtonTSVColumns col) const;
+
+public:
+    CArlTSVSpecialization(const CArlingtonTSVGrammarFile* tsv, const int pdf_ver, const std::vector<std::string>& extns);
+
+    CArlTSVSpecialization(const CArlTSVSpecialization&) = delete;
+    CArlTSVSpecialization& operator=(const CArlTSVSpecialization&) = delete;
+
+    int get_pdf_version() const { return pdf_version; };
+    const std::vector<std::string>& get_extensions() const { return extensions; };
+
+    /// @brief Returns the precomputed ArlVersion of a row for a PDF object
+    const ArlVersion& get_version(const int key_idx, ArlPDFObject* obj) const;
+
+    /// @brief Returns the folded compiled predicates for a field of a row
+    const ArlPredicateProgramMatrix& get_predicate_program(const int key_idx, const ArlingtonTSVColumns col) const;
+};
+
+#endif // ArlTSVSpecialization_h
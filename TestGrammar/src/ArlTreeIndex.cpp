@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Sorted, searchable indexes of PDF name trees and number trees
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlTreeIndex.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_set>
+
+
+/// @brief Gets a name tree key (a string)
+static bool get_tree_key(ArlPDFObject* o, std::wstring& k) {
+    if ((o == nullptr) || (o->get_object_type() != PDFObjectType::ArlPDFObjTypeString))
+        return false;
+    k = ((ArlPDFString*)o)->get_value();
+    return true;
+}
+
+
+/// @brief Gets a number tree key (an integer)
+static bool get_tree_key(ArlPDFObject* o, int& k) {
+    if ((o == nullptr) || (o->get_object_type() != PDFObjectType::ArlPDFObjTypeNumber) || !((ArlPDFNumber*)o)->is_integer_value())
+        return false;
+    k = ((ArlPDFNumber*)o)->get_integer_value();
+    return true;
+}
+
+
+static std::string tree_key_to_string(const std::wstring& k) {
+    return "(" + ToUtf8(k) + ")";
+}
+
+
+static std::string tree_key_to_string(const int k) {
+    return std::to_string(k);
+}
+
+
+/// @brief Message codes and wording that differ between name trees and number trees
+struct tree_messages {
+    const char*     leaf_key;           // "Names" or "Nums"
+    const char*     tree;               // for message text
+    const char*     key_type;           // for message text
+    ArlMessageCode  limits_invalid;
+    ArlMessageCode  out_of_limits;
+    ArlMessageCode  not_sorted;
+};
+
+static const tree_messages tree_msgs[] = {
+    { "Names", "name tree",   "strings",  ArlMessageCode::NameTreeLimitsInvalid,   ArlMessageCode::NameTreeOutOfLimits,   ArlMessageCode::NameTreeNotSorted },
+    { "Nums",  "number tree", "integers", ArlMessageCode::NumberTreeLimitsInvalid, ArlMessageCode::NumberTreeOutOfLimits, ArlMessageCode::NumberTreeNotSorted }
+};
+
+
+/// @brief Builds the index of a name tree or number tree
+///
+/// @param[in] root  root node of the tree (not deleted)
+/// @param[in] t     type of tree
+CArlTreeIndex::CArlTreeIndex(ArlPDFDictionary* root, const ArlTreeType t)
+    : type(t)
+{
+    assert(root != nullptr);
+    assert(root->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
+    if (type == ArlTreeType::NameTree)
+        build(root, names);
+    else
+        build(root, numbers);
+}
+
+
+/// @brief Walks a tree iteratively (depth-first, left-to-right) collecting all keys and
+/// then sorts them. Keys of a valid tree are already in ascending order.
+///
+/// @param[in]  root  root node of the tree (not deleted)
+/// @param[out] keys  sorted unique keys
+template <typename K>
+void CArlTreeIndex::build(ArlPDFDictionary* root, std::vector<K>& keys) {
+    const tree_messages& m = tree_msgs[(int)type];
+
+    struct tree_frame {
+        ArlPDFDictionary*   node;
+        ArlPDFArray*        kids;
+        int                 next_kid;
+        size_t              first_key;   // first key in keys[] of this subtree
+    };
+
+    std::vector<tree_frame> stack;
+    std::unordered_set<object_id, object_id_hash> visited;
+    bool sorted = true;
+
+    auto enter = [&](ArlPDFDictionary* node) {
+        if (node->get_object_number() > 0)
+            visited.insert(node->get_object_id());
+
+        tree_frame f{ node, nullptr, 0, keys.size() };
+
+        ArlPDFObject* leaf = node->get_value(m.leaf_key);
+        if ((leaf != nullptr) && (leaf->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
+            ArlPDFArray* arr = (ArlPDFArray*)leaf;
+            K k{};
+            for (int i = 0; i < arr->get_num_elements(); i += 2) {
+                ArlPDFObject* o = arr->get_value(i);
+                if (get_tree_key(o, k)) {
+                    if (sorted && !keys.empty() && (k < keys.back())) {
+                        problems.emplace_back(m.not_sorted, std::string(m.tree) + " keys were not in ascending order (" + tree_key_to_string(k) + " after " + tree_key_to_string(keys.back()) + ")", node->get_object_id());
+                        sorted = false;
+                    }
+                    keys.push_back(k);
+                }
+                delete o;
+            }
+        }
+        delete leaf;
+
+        ArlPDFObject* kids = node->get_value("Kids");
+        if ((kids != nullptr) && (kids->get_object_type() == PDFObjectType::ArlPDFObjTypeArray))
+            f.kids = (ArlPDFArray*)kids;
+        else
+            delete kids;
+        stack.push_back(f);
+    };
+
+    enter(root);
+    while (!stack.empty()) {
+        tree_frame& f = stack.back();
+        if ((f.kids != nullptr) && (f.next_kid < f.kids->get_num_elements())) {
+            ArlPDFObject* kid = f.kids->get_value(f.next_kid++);
+            if ((kid != nullptr) && (kid->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
+                if ((kid->get_object_number() > 0) && (visited.count(kid->get_object_id()) > 0)) {
+                    problems.emplace_back(ArlMessageCode::TreeKidsCycle, std::string(m.tree) + " Kids array element #" + std::to_string(f.next_kid - 1) + " referred to an already visited node (cycle or shared node)", f.node->get_object_id());
+                    delete kid;
+                }
+                else
+                    enter((ArlPDFDictionary*)kid);  // invalidates f
+            }
+            else
+                delete kid; // reported when parsing
+        }
+        else {
+            check_limits(f.node, (f.node == root), keys, f.first_key);
+            delete f.kids;
+            if (f.node != root)
+                delete f.node;
+            stack.pop_back();
+        }
+    }
+
+    if (!sorted)
+        std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    keys.shrink_to_fit();
+}
+
+
+/// @brief Checks the Limits of a tree node against the keys of its subtree.
+/// ISO 32000-2:2020 Table 36 and 37 Limits: "(Intermediate and leaf nodes only; required)"
+///
+/// @param[in] node       tree node
+/// @param[in] is_root    true if node is the root of the tree (Limits are optional)
+/// @param[in] keys       all keys so far, in tree order
+/// @param[in] first_key  index in keys of the first key in the subtree of node
+template <typename K>
+void CArlTreeIndex::check_limits(ArlPDFDictionary* node, const bool is_root, const std::vector<K>& keys, const size_t first_key) {
+    const tree_messages& m = tree_msgs[(int)type];
+
+    ArlPDFObject* limits = node->get_value("Limits");
+    if (limits == nullptr) {
+        if (!is_root)
+            problems.emplace_back(m.limits_invalid, std::string(m.tree) + " intermediate or leaf node Limits was missing", node->get_object_id());
+        return;
+    }
+
+    K lo{}, hi{};
+    bool valid = false;
+    if ((limits->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) && (((ArlPDFArray*)limits)->get_num_elements() == 2)) {
+        ArlPDFObject* o1 = ((ArlPDFArray*)limits)->get_value(0);
+        ArlPDFObject* o2 = ((ArlPDFArray*)limits)->get_value(1);
+        valid = get_tree_key(o1, lo) && get_tree_key(o2, hi);
+        delete o1;
+        delete o2;
+    }
+    delete limits;
+
+    if (!valid) {
+        problems.emplace_back(m.limits_invalid, std::string(m.tree) + " Limits was not an array of 2 " + m.key_type, node->get_object_id());
+        return;
+    }
+    if (hi < lo) {
+        problems.emplace_back(m.limits_invalid, std::string(m.tree) + " Limits " + tree_key_to_string(lo) + " was after " + tree_key_to_string(hi), node->get_object_id());
+        return;
+    }
+
+    if (first_key < keys.size()) {
+        auto mm = std::minmax_element(keys.begin() + first_key, keys.end());
+        if ((*mm.first < lo) || (hi < *mm.second))
+            problems.emplace_back(m.out_of_limits, std::string(m.tree) + " keys " + tree_key_to_string(*mm.first) + " to " + tree_key_to_string(*mm.second) +
+                                  " were outside Limits [" + tree_key_to_string(lo) + " " + tree_key_to_string(hi) + "]", node->get_object_id());
+    }
+}
+
+
+/// @brief O(log n) lookup of a name tree key
+bool CArlTreeIndex::contains(const std::wstring& name) const {
+    assert(type == ArlTreeType::NameTree);
+    return std::binary_search(names.begin(), names.end(), name);
+}
+
+
+/// @brief O(log n) lookup of a number tree key
+bool CArlTreeIndex::contains(const int num) const {
+    assert(type == ArlTreeType::NumberTree);
+    return std::binary_search(numbers.begin(), numbers.end(), num);
+}
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Sorted, searchable indexes of PDF name trees and number trees
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ArlTreeIndex_h
+#define ArlTreeIndex_h
+#pragma once
+
+#include "ArlingtonPDFShim.h"
+#include "ArlResults.h"
+
+#include <string>
+#include <vector>
+
+using namespace ArlingtonPDFShim;
+
+
+/// @brief The kinds of PDF tree (ISO 32000-2:2020 7.9.6 and 7.9.7)
+enum class ArlTreeType { NameTree = 0, NumberTree };
+
+
+/// @brief A problem found while indexing a tree (e.g. bad Limits)
+struct ArlTreeProblem {
+    ArlMessageCode  code;
+    std::string     text;   // message text without context
+    object_id       node;   // tree node the problem is about (object_num <= 0 if direct)
+
+    ArlTreeProblem(const ArlMessageCode c, const std::string& t, const object_id& n)
+        : code(c), text(t), node(n)
+        { /* constructor */ }
+};
+
+
+/// @class CArlTreeIndex
+/// An index of all keys in a PDF name tree (strings) or number tree (integers).
+///
+/// The tree is walked once, iteratively and left-to-right, so deep or cyclic Kids cannot
+/// overflow the stack. Keys are then sorted so that lookups are O(log n) regardless of
+/// whether the Limits in the PDF can be trusted. Limits, key ordering and Kids cycles
+/// are checked as a by-product of the walk.
+class CArlTreeIndex {
+private:
+    /// @brief name tree or number tree
+    ArlTreeType                 type;
+
+    /// @brief Sorted unique keys of a name tree (empty for number trees)
+    std::vector<std::wstring>   names;
+
+    /// @brief Sorted unique keys of a number tree (empty for name trees)
+    std::vector<int>            numbers;
+
+    /// @brief Problems found while walking the tree, in tree order
+    std::vector<ArlTreeProblem> problems;
+
+    template <typename K>
+    void build(ArlPDFDictionary* root, std::vector<K>& keys);
+
+    template <typename K>
+    void check_limits(ArlPDFDictionary* node, const bool is_root, const std::vector<K>& keys, const size_t first_key);
+
+public:
+    CArlTreeIndex(ArlPDFDictionary* root, const ArlTreeType t);
+
+    ArlTreeType get_type() const { return type; };
+
+    /// @brief Number of unique keys in the tree
+    size_t size() const { return (type == ArlTreeType::NameTree) ? names.size() : numbers.size(); };
+
+    bool contains(const std::wstring& name) const;
+    bool contains(const int num) const;
+
+    /// @brief Limits, ordering and Kids problems found in the tree
+    const std::vector<ArlTreeProblem>& get_problems() const { return problems; };
+};
+
+#endif // ArlTreeIndex_h
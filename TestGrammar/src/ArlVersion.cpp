@@ -50,159 +50,268 @@ const std::regex  r_ExtensionVersion("^fn:Extension\\((" + ArlKeyBase + ")\\,("
 const std::regex  r_EvalExtensionVersion("^fn:Eval\\(fn:Extension\\((" + ArlKeyBase + ")\\," + ArlPDFVersion + "\\) \\|\\| " + ArlPDFVersion + "\\)");
 
 
+/// @brief Arlington type names of each ArlBasicType
+const std::string v_ArlBasicTypeNames[ArlBasicTypeCount] = {
+    "integer", "number", "boolean", "name", "null", "stream", "string", "array", "dictionary"
+};
+
+
+/// @brief No Arlington type (not matched)
+static const std::string no_arl_type;
+
+
+/// @brief Can an Arlington type be used for a PDF object that directly maps to a basic Arlington type?
+///
+/// @param[in] obj_type   basic Arlington type of the PDF object (e.g. "integer")
+/// @param[in] t          Arlington type (with no predicates)
+///
+/// @returns true if a PDF object of obj_type can be an Arlington t
+static bool is_compatible_type(const std::string& obj_type, const std::string& t)
+{
+    return (obj_type == t) ||
+           ((obj_type == "integer") && (t == "bitmask")) ||
+           ((obj_type == "array") && (t == "rectangle")) ||
+           ((obj_type == "array") && (t == "matrix")) ||
+           ((obj_type == "dictionary") && (t == "name-tree")) ||
+           ((obj_type == "stream") && (t == "name-tree")) ||
+           ((obj_type == "array") && (t == "name-tree")) ||
+           ((obj_type == "dictionary") && (t == "number-tree")) ||
+           ((obj_type == "stream") && (t == "number-tree")) ||
+           ((obj_type == "array") && (t == "number-tree")) ||
+           ((obj_type == "string") && (t == "date")) ||
+           ((obj_type == "string") && (t.find("string-") != std::string::npos));
+}
+
+
+/// @brief Decodes the Type, SinceVersion and DeprecatedIn fields of an Arlington TSV row.
+/// Called once per row when a TSV file is loaded so must not assert on invalid TSV data
+/// (which is reported by --validate).
+///
+/// @param[in] row   a raw row from an Arlington TSV file
+ArlTypeDescriptor::ArlTypeDescriptor(const ArlTSVRow& row) :
+    since_form(ArlSinceVersionForm::Unknown), since_version(0), since_version_no_extn(0), has_deprecated_in(false), deprecated_in(0)
+{
+    // The Type field is complex ([];[];[]) and can have version predicates!
+    std::vector<std::string>  arl_t = split(row[TSV_TYPE], ';');
+    types.reserve(arl_t.size());
+    for (auto& raw : arl_t) {
+        ArlTypeEntry e;
+
+        // Exact matching ignores any enclosing "[...]"
+        std::string t = raw;
+        if ((t.size() > 0) && (t[0] == '['))
+            t = t.substr(1, t.size() - 2);
+        e.is_number = (t == "number");
+        e.contains_mask = e.equals_mask = 0;
+        for (int b = 0; b < ArlBasicTypeCount; b++) {
+            if (t.find(v_ArlBasicTypeNames[b]) != std::string::npos)
+                e.contains_mask |= (uint16_t)(1 << b);
+            if (t == v_ArlBasicTypeNames[b])
+                e.equals_mask |= (uint16_t)(1 << b);
+        }
+
+        // Version predicates
+        e.type = raw;
+        e.predicate = ArlTypePredicate::None;
+        e.predicate_version = 0;
+        if (raw.find("fn:") != std::string::npos) {
+            std::smatch     m;
+            if (std::regex_search(raw, m, r_Types) && m.ready() && (m.size() == 4)) {
+                // m[1] = predicate function name (no "fn:" or '(')
+                // m[2] = PDF version "x.y"
+                // m[3] = Arlington pre-defined type
+                std::string s = m[1].str();
+                if (s == "SinceVersion")
+                    e.predicate = ArlTypePredicate::SinceVersion;
+                else if (s == "Deprecated")
+                    e.predicate = ArlTypePredicate::Deprecated;
+                else if (s == "IsPDFVersion")
+                    e.predicate = ArlTypePredicate::IsPDFVersion;
+                else
+                    e.predicate = ArlTypePredicate::BeforeVersion;
+                e.predicate_version = string_to_pdf_version(m[2].str());
+                e.type = m[3].str();
+            }
+        }
+
+        e.compatible_mask = 0;
+        for (int b = 0; b < ArlBasicTypeCount; b++)
+            if (is_compatible_type(v_ArlBasicTypeNames[b], e.type))
+                e.compatible_mask |= (uint16_t)(1 << b);
+        types.push_back(e);
+    } // for
+
+    // SinceVersion field is a PDF version, or fn:Extension(...), fn:Extension(...,x.y) or a fn:Eval which
+    // evaluates to a PDF version
+    const std::string_view  since_ver_field = row[TSV_SINCEVERSION];
+    std::cmatch             m;
+    if (FindInVector(v_ArlPDFVersions, since_ver_field)) {
+        since_form = ArlSinceVersionForm::Version;
+        since_version = string_to_pdf_version(since_ver_field);
+    }
+    else if (std::regex_search(since_ver_field.data(), since_ver_field.data() + since_ver_field.size(), m, r_ExtensionVersion) && m.ready() && (m.size() >= 3)) {
+        // - m[1] = name of extension
+        // - m[2] = PDF version
+        since_form = ArlSinceVersionForm::ExtensionVersion;
+        since_extension = m[1].str();
+        since_version = string_to_pdf_version(m[2].str());
+    }
+    else if (std::regex_search(since_ver_field.data(), since_ver_field.data() + since_ver_field.size(), m, r_ExtensionOnly) && m.ready() && (m.size() == 2)) {
+        // m[1] = extension name
+        since_form = ArlSinceVersionForm::Extension;
+        since_extension = m[1].str();
+    }
+    else if (std::regex_search(since_ver_field.data(), since_ver_field.data() + since_ver_field.size(), m, r_EvalExtensionVersion) && m.ready() && (m.size() == 4)) {
+        /// - m[1] = name of extension
+        /// - m[2] = PDF version for extension
+        /// - m[3] = PDF version without extension
+        since_form = ArlSinceVersionForm::EvalExtensionVersion;
+        since_extension = m[1].str();
+        since_version = string_to_pdf_version(m[2].str());
+        since_version_no_extn = string_to_pdf_version(m[3].str());
+    }
+
+    // DeprecatedIn field is empty or a PDF version
+    has_deprecated_in = (row[TSV_DEPRECATEDIN] != "");
+    if (FindInVector(v_ArlPDFVersions, row[TSV_DEPRECATEDIN]))
+        deprecated_in = string_to_pdf_version(row[TSV_DEPRECATEDIN]);
+}
+
+
 /// @brief Constructor to handle version complexities
 ///
 /// @param[in] obj          PDF object
-/// @param[in] vec          the row from the Arlington TSV file (including all predicates and complexity ([];[];[]))
+/// @param[in] typed_row    the typed row from the Arlington TSV file (including all predicates and complexity ([];[];[]))
 /// @param[in] pdf_ver      PDF version multiplied by 10
-/// @param[in] extns        a list of extension names to support
-ArlVersion::ArlVersion(ArlPDFObject* obj, std::vector<std::string> vec, const int pdf_ver, const std::vector<std::string>& extns)
-    : arl_version(0), version_reason(ArlVersionReason::Unknown), arl_type_index(-1)
+/// @param[in] extns        a list of extension names to support. Must outlive this object.
+ArlVersion::ArlVersion(ArlPDFObject* obj, const ArlTSVTypedRow& typed_row, const int pdf_ver, const std::vector<std::string>& extns)
+    : ArlVersion(get_basic_type(obj), typed_row, pdf_ver, extns)
 {
-    tsv = vec;
-    supported_extensions = extns; // copy all the extensions being supported
+}
+
 
-    wildcard_extn = false;
+/// @brief Constructor to handle version complexities for any PDF object of a basic Arlington type.
+/// The result only depends on obj_type so can be precomputed (see CArlTSVSpecialization).
+///
+/// @param[in] obj_type     the Arlington equivalent for the PDF Object
+/// @param[in] typed_row    the typed row from the Arlington TSV file (including all predicates and complexity ([];[];[]))
+/// @param[in] pdf_ver      PDF version multiplied by 10
+/// @param[in] extns        a list of extension names to support. Must outlive this object.
+ArlVersion::ArlVersion(const ArlBasicType obj_type, const ArlTSVTypedRow& typed_row, const int pdf_ver, const std::vector<std::string>& extns)
+    : row(typed_row), pdf_version(pdf_ver), arl_version(0), arl_type_index(-1), arl_type_of_pdf_object(ArlBasicType::Null),
+      arl_type(&no_arl_type), version_reason(ArlVersionReason::Unknown), supported_extensions(extns), wildcard_extn(false)
+{
     for (auto& e : supported_extensions)
         if (e == "*") {
             wildcard_extn = true;
             break;
         }
 
-    // Determine the Arlington equivalent for the PDF Object
+    // Set the PDF version being tested
+    assert((pdf_ver >= 10) && ((pdf_ver <= 17) || (pdf_ver == 20)));
+
+    match_type(obj_type);
+}
+
+
+/// @brief Determines the Arlington equivalent for a PDF Object
+///
+/// @param[in] obj   PDF object. Never nullptr.
+///
+/// @returns the basic Arlington type (integer, number, boolean, name, null, stream, string, array or dictionary)
+ArlBasicType ArlVersion::get_basic_type(ArlPDFObject* obj)
+{
     assert(obj != nullptr);
     switch (obj->get_object_type())
     {
     case PDFObjectType::ArlPDFObjTypeNumber:
-    {
-        ArlPDFNumber* numobj = (ArlPDFNumber*)obj;
-        if (numobj->is_integer_value())
-            arl_type_of_pdf_object = "integer";         // or "bitmask"
-        else
-            arl_type_of_pdf_object = "number";
-    }
-    break;
-    case PDFObjectType::ArlPDFObjTypeBoolean:     arl_type_of_pdf_object = "boolean"; break;
-    case PDFObjectType::ArlPDFObjTypeName:        arl_type_of_pdf_object = "name"; break;
-    case PDFObjectType::ArlPDFObjTypeNull:        arl_type_of_pdf_object = "null"; break;
-    case PDFObjectType::ArlPDFObjTypeStream:      arl_type_of_pdf_object = "stream"; break;     // or "name-tree" or "number-tree"
-    case PDFObjectType::ArlPDFObjTypeString:      arl_type_of_pdf_object = "string"; break;     // or "date" or "string-*"...
-    case PDFObjectType::ArlPDFObjTypeArray:       arl_type_of_pdf_object = "array"; break;      // or "rectangle" or "matrix"
-    case PDFObjectType::ArlPDFObjTypeDictionary:  arl_type_of_pdf_object = "dictionary"; break; // or "name-tree" or "number-tree"
+        if (((ArlPDFNumber*)obj)->is_integer_value())
+            return ArlBasicType::Integer;       // or "bitmask"
+        return ArlBasicType::Number;
+    case PDFObjectType::ArlPDFObjTypeBoolean:     return ArlBasicType::Boolean;
+    case PDFObjectType::ArlPDFObjTypeName:        return ArlBasicType::Name;
+    case PDFObjectType::ArlPDFObjTypeNull:        return ArlBasicType::Null;
+    case PDFObjectType::ArlPDFObjTypeStream:      return ArlBasicType::Stream;     // or "name-tree" or "number-tree"
+    case PDFObjectType::ArlPDFObjTypeString:      return ArlBasicType::String;     // or "date" or "string-*"...
+    case PDFObjectType::ArlPDFObjTypeArray:       return ArlBasicType::Array;      // or "rectangle" or "matrix"
+    case PDFObjectType::ArlPDFObjTypeDictionary:  return ArlBasicType::Dictionary; // or "name-tree" or "number-tree"
     case PDFObjectType::ArlPDFObjTypeReference:
         assert(false && "ArlPDFObjTypeReference for ArlVersion()");
-        arl_type_of_pdf_object = "null";
         break;
     default:
         assert(false && "unexpected type for ArlVersion()");
-        arl_type_of_pdf_object = "null";
         break;
     }
-    assert(FindInVector(v_ArlAllTypes, arl_type_of_pdf_object));
+    return ArlBasicType::Null;
+}
 
-    // Set the PDF version being tested
-    assert((pdf_ver >= 10) && ((pdf_ver <= 17) || (pdf_ver == 20)));
-    pdf_version = pdf_ver;
 
-    // Determine the type we will match from Arlington TSV 'Type' field data.
-    // The Type field is complex ([];[];[]) and can have version predicates!
-    // - try exact match first
-    // - if object was integer look for bitmask
-    // - if object was array look for rectangle and matrix
-    // - name-trees and number-trees support dicts, arrays and streams
-    // - if object was string look for date or string-*
-    std::string arl_types = vec[TSV_TYPE];
-    bool found = false;
-    std::vector<std::string>  arl_t = split(arl_types, ';');
-    for (int i = 0; i < (int)arl_t.size(); i++) {
-        std::string t = arl_t[i];
-        if ((t.size() > 0) && (t[0] == '['))
-            t = t.substr(1, t.size() - 2);  // strip enclosing "[...]"
-        if ((t == "number") && (arl_type_of_pdf_object == "integer")) {
+/// @brief Determines the type we will match from the Arlington TSV 'Type' field data and the
+/// version reason, using the pre-decoded row (see ArlTypeDescriptor).
+/// - try exact match first
+/// - if object was integer look for bitmask
+/// - if object was array look for rectangle and matrix
+/// - name-trees and number-trees support dicts, arrays and streams
+/// - if object was string look for date or string-*
+///
+/// @param[in] obj_type   the Arlington equivalent for the PDF Object
+void ArlVersion::match_type(const ArlBasicType obj_type)
+{
+    const ArlTypeDescriptor&    desc = row.type_desc;
+    const uint16_t              obj_bit = (uint16_t)(1 << (int)obj_type);
+    bool                        found = false;
+
+    arl_type_of_pdf_object = obj_type;
+    for (int i = 0; i < (int)desc.types.size(); i++) {
+        const ArlTypeEntry& e = desc.types[i];
+        if (e.is_number && (obj_type == ArlBasicType::Integer)) {
             // Can always use integer in place of a number
-            arl_type = arl_type_of_pdf_object = "number";
+            arl_type_of_pdf_object = ArlBasicType::Number;
+            arl_type = &v_ArlBasicTypeNames[(int)ArlBasicType::Number];
             version_reason = ArlVersionReason::OK;
             arl_type_index = i;
             found = true;
             break;
         }
-        else if (t.find(arl_type_of_pdf_object) != std::string::npos) {
-            if (t == arl_type_of_pdf_object) {
+        else if (e.contains_mask & obj_bit) {
+            if (e.equals_mask & obj_bit) {
                 // Found an exact match without any version predicates
-                arl_type = arl_type_of_pdf_object;
+                arl_type = &v_ArlBasicTypeNames[(int)obj_type];
                 version_reason = ArlVersionReason::OK;
                 arl_type_index = i;
                 found = true;
-                break;
             }
-            else  // Found an exact match but wrapped in version predicates so fallthrough
-                break;
+            // else found an exact match but wrapped in version predicates so fallthrough
+            break;
         }
     } // for
 
     if (!found) {
-        std::smatch     m;
-        for (int i = 0; i < (int)arl_t.size() && !found; i++) {
-            std::string t = arl_t[i];
-            if (t.find("fn:") != std::string::npos) {
-                // Predicate - remove...
-                if (std::regex_search(t, m, r_Types) && m.ready() && (m.size() == 4)) {
-                    // m[1] = predicate function name (no "fn:" or '(')
-                    // m[2] = PDF version "x.y"
-                    // m[3] = Arlington pre-defined type
-                    std::string s = m[1].str();
-                    if (s == "SinceVersion") {
-                        if (pdf_version >= arl_version)
-                            version_reason = ArlVersionReason::OK;
-                        else
-                            version_reason = ArlVersionReason::Before_fnSinceVersion;
-                    }
-                    else if (s == "Deprecated") {
-                        if (pdf_version >= arl_version)
-                            version_reason = ArlVersionReason::Is_fnDeprecated;
-                        else
-                            version_reason = ArlVersionReason::OK;
-                    }
-                    else if (s == "IsPDFVersion") {
-                        if (pdf_version == arl_version)
-                            version_reason = ArlVersionReason::OK;
-                        else
-                            version_reason = ArlVersionReason::Not_fnIsPDFVersion;
-                    }
-                    else {
-                        assert(s == "BeforeVersion");
-                        if (pdf_version < arl_version)
-                            version_reason = ArlVersionReason::OK;
-                        else
-                            version_reason = ArlVersionReason::After_fnBeforeVersion;
-                    }
-
-                    s = m[2].str();
-                    arl_version = string_to_pdf_version(s);
-
-                    assert(FindInVector(v_ArlAllTypes, m[3]));
-                    t = m[3];
-                }
-                else {
-                    assert(false && "unexpected predicate in Type field!");
+        for (int i = 0; (i < (int)desc.types.size()) && !found; i++) {
+            const ArlTypeEntry& e = desc.types[i];
+            if (e.predicate != ArlTypePredicate::None) {
+                switch (e.predicate) {
+                case ArlTypePredicate::SinceVersion:
+                    version_reason = (pdf_version >= arl_version) ? ArlVersionReason::OK : ArlVersionReason::Before_fnSinceVersion;
+                    break;
+                case ArlTypePredicate::Deprecated:
+                    version_reason = (pdf_version >= arl_version) ? ArlVersionReason::Is_fnDeprecated : ArlVersionReason::OK;
+                    break;
+                case ArlTypePredicate::IsPDFVersion:
+                    version_reason = (pdf_version == arl_version) ? ArlVersionReason::OK : ArlVersionReason::Not_fnIsPDFVersion;
+                    break;
+                default:
+                    assert(e.predicate == ArlTypePredicate::BeforeVersion);
+                    version_reason = (pdf_version < arl_version) ? ArlVersionReason::OK : ArlVersionReason::After_fnBeforeVersion;
+                    break;
                 }
+                arl_version = e.predicate_version;
             }
 
-            // 't' should now be cleaned of predicates
-            if ((arl_type_of_pdf_object == t) ||
-                ((arl_type_of_pdf_object == "integer") && (t == "bitmask")) ||
-                ((arl_type_of_pdf_object == "array") && (t =="rectangle")) ||
-                ((arl_type_of_pdf_object == "array") && (t == "matrix")) ||
-                ((arl_type_of_pdf_object == "dictionary") && (t == "name-tree")) ||
-                ((arl_type_of_pdf_object == "stream") && (t == "name-tree")) ||
-                ((arl_type_of_pdf_object == "array") && (t == "name-tree")) ||
-                ((arl_type_of_pdf_object == "dictionary") && (t == "number-tree")) ||
-                ((arl_type_of_pdf_object == "stream") && (t == "number-tree")) ||
-                ((arl_type_of_pdf_object == "array") && (t == "number-tree")) ||
-                ((arl_type_of_pdf_object == "string") && (t == "date")) ||
-                ((arl_type_of_pdf_object == "string") && (t.find("string-") != std::string::npos))) {
+            // Type is now cleaned of predicates
+            if (e.compatible_mask & obj_bit) {
                 arl_type_index = i;
-                arl_type = t;
+                arl_type = &e.type;
                 found = true;
                 if (version_reason == ArlVersionReason::Unknown)
                     version_reason = ArlVersionReason::OK;
@@ -212,50 +321,36 @@ ArlVersion::ArlVersion(ArlPDFObject* obj, std::vector<std::string> vec, const in
 
     // Override predicates with SinceVersion and DeprecatedIn fields
     int since_ver = 0;
-    if (FindInVector(v_ArlPDFVersions, vec[TSV_SINCEVERSION])) {
-        // Simple PDF version
-        since_ver = string_to_pdf_version(vec[TSV_SINCEVERSION]);
+    switch (desc.since_form) {
+    case ArlSinceVersionForm::Version:
+        since_ver = desc.since_version;
         if (found && (pdf_version < since_ver)) {
             arl_version = since_ver;
             version_reason = ArlVersionReason::Before_fnSinceVersion;
         }
-    }
-    else {
-        // Predicate-based "SinceVersion" field with fn:Extension(...), fn:Extension(...,x.y) or a fn:Eval which evaluates
-        // to a PDF version 
-        assert(vec[TSV_SINCEVERSION].find("fn:") != std::string::npos);
-
-        std::smatch       m;
-        if (std::regex_search(vec[TSV_SINCEVERSION], m, r_ExtensionVersion) && m.ready() && (m.size() >= 3)) {
-            // - m[1] = name of extension
-            // - m[2] = PDF version
-            int tsv_ver = string_to_pdf_version(m[2].str());
-            if (FindInVector(extns, m[1].str()) && (pdf_ver >= tsv_ver))
-                since_ver = tsv_ver;
-        }
-        else if (std::regex_search(vec[TSV_SINCEVERSION], m, r_ExtensionOnly) && m.ready() && (m.size() == 2)) {
-            // m[1] = extension name
-            if (FindInVector(extns, m[1].str()))
-                since_ver = pdf_ver;
-        }
-        else if (std::regex_search(vec[TSV_SINCEVERSION], m, r_EvalExtensionVersion) && m.ready() && (m.size() == 4)) {
-            /// - m[1] = name of extension
-            /// - m[2] = PDF version for extension
-            /// - m[3] = PDF version without extension
-            int tsv_ver1 = string_to_pdf_version(m[2].str());
-            int tsv_ver2 = string_to_pdf_version(m[3].str());
-            if (FindInVector(extns, m[1].str()) && (pdf_ver >= tsv_ver1))
-                since_ver = tsv_ver1;
-            else
-                since_ver = tsv_ver2;
-        }
-        else {
-            assert(false && "unexpected SinceVersion predicate!");
-        }
+        break;
+    case ArlSinceVersionForm::ExtensionVersion:
+        if (FindInVector(supported_extensions, desc.since_extension) && (pdf_version >= desc.since_version))
+            since_ver = desc.since_version;
+        break;
+    case ArlSinceVersionForm::Extension:
+        if (FindInVector(supported_extensions, desc.since_extension))
+            since_ver = pdf_version;
+        break;
+    case ArlSinceVersionForm::EvalExtensionVersion:
+        if (FindInVector(supported_extensions, desc.since_extension) && (pdf_version >= desc.since_version))
+            since_ver = desc.since_version;
+        else
+            since_ver = desc.since_version_no_extn;
+        break;
+    default:
+        assert(false && "unexpected SinceVersion predicate!");
+        break;
     }
 
-    if (found && (vec[TSV_DEPRECATEDIN] != "")) {
-        int deprecated_ver = string_to_pdf_version(vec[TSV_DEPRECATEDIN]);
+    if (found && desc.has_deprecated_in) {
+        assert(desc.deprecated_in > 0);
+        int deprecated_ver = desc.deprecated_in;
         if (pdf_version >= deprecated_ver) {
             arl_version = deprecated_ver;
             version_reason = ArlVersionReason::Is_fnDeprecated;
@@ -276,7 +371,7 @@ ArlVersion::ArlVersion(ArlPDFObject* obj, std::vector<std::string> vec, const in
     if (!found)
         version_reason = ArlVersionReason::Unknown;
 
-    assert((found && (arl_type.size() > 0) && (arl_type_index >= 0)) || (!found && (arl_type.size() == 0) && (arl_type_index < 0)));
+    assert((found && (arl_type->size() > 0) && (arl_type_index >= 0)) || (!found && (arl_type->size() == 0) && (arl_type_index < 0)));
     assert((found && (version_reason != ArlVersionReason::Unknown)) || (!found && (version_reason == ArlVersionReason::Unknown)));
 }
 
@@ -284,189 +379,38 @@ ArlVersion::ArlVersion(ArlPDFObject* obj, std::vector<std::string> vec, const in
 
 /// @returns true if the current key is an unsupported extension and not part of an official PDF specification.
 /// This effectively means that a key will be reported as an undocument key if this method returns true.
-bool  ArlVersion::is_unsupported_extension() {
-    if (FindInVector(v_ArlPDFVersions, tsv[TSV_SINCEVERSION])) {
+bool  ArlVersion::is_unsupported_extension() const {
+    const ArlTypeDescriptor& desc = row.type_desc;
+    switch (desc.since_form) {
+    case ArlSinceVersionForm::Version:
         // Simple PDF version
         return false;
-    }
-    else {
-        // Predicate-based "SinceVersion" field with fn:SinceVersion(x.y,fn:Extension(...)) or fn:Extension(...)
-        assert(tsv[TSV_SINCEVERSION].find("fn:") != std::string::npos);
-
-        std::smatch       m;
-        if (std::regex_search(tsv[TSV_SINCEVERSION], m, r_ExtensionVersion) && m.ready() && (m.size() >= 3)) {
-            // m[1] = extension name
-            // m[2] = PDF version "x.y"
-            int tsv_ver = string_to_pdf_version(m[2].str());
-            return !((FindInVector(supported_extensions, m[1].str()) || wildcard_extn) && (pdf_version >= tsv_ver));
-        }
-        else if (std::regex_search(tsv[TSV_SINCEVERSION], m, r_ExtensionOnly) && m.ready() && (m.size() == 2)) {
-            // m[1] = extension name
-            return !(FindInVector(supported_extensions, m[1].str()) || wildcard_extn);
-        }
-        else if (std::regex_search(tsv[TSV_SINCEVERSION], m, r_EvalExtensionVersion) && m.ready() && (m.size() == 4)) {
-            /// - m[1] = name of extension
-            /// - m[2] = PDF version for extension
-            /// - m[3] = PDF version without extension
-            int tsv_ver1 = string_to_pdf_version(m[2].str());
-            int tsv_ver2 = string_to_pdf_version(m[3].str());
-            return !(((FindInVector(supported_extensions, m[1].str()) || wildcard_extn) && (pdf_version >= tsv_ver1)) || (pdf_version >= tsv_ver2));
-        }
-        else {
-            assert(false && "unexpected SinceVersion predicate!");
-        }
+    case ArlSinceVersionForm::ExtensionVersion:
+        return !((FindInVector(supported_extensions, desc.since_extension) || wildcard_extn) && (pdf_version >= desc.since_version));
+    case ArlSinceVersionForm::Extension:
+        return !(FindInVector(supported_extensions, desc.since_extension) || wildcard_extn);
+    case ArlSinceVersionForm::EvalExtensionVersion:
+        return !(((FindInVector(supported_extensions, desc.since_extension) || wildcard_extn) && (pdf_version >= desc.since_version)) || (pdf_version >= desc.since_version_no_extn));
+    default:
+        assert(false && "unexpected SinceVersion predicate!");
+        break;
     }
     return true;
 }
 
 
 
-/// @brief Return an appropriate reduced Arlington Link set AFTER processing predicates for the current PDF object and PDF version.
-/// Thus deprecated links will be processed away based on the PDF version and NOT returned.
-///
-/// @param[in] arl_links   a raw Arlington 'Links' field, including complex ([];[];[]) and predicates
+/// @brief Return the full Arlington Link set AFTER blindly removing predicates (i.e. ignore current PDF version).
+/// Only set for rows of a CArlingtonGrammar.
 ///
-/// @returns a reduced set (vector) of Arlington Links appropriate for the type of PDF object and PDF version.
+/// @returns a simplified but full set (vector) of Arlington Link symbols appropriate for the type of PDF object.
 /// Or empty vector if nothing appropriate.
-std::vector<std::string>  ArlVersion::get_appropriate_linkset(std::string arl_links) {
-    std::vector<std::string>      retval;
-
-    if ((arl_type_index < 0) || (arl_links == ""))
-        return retval; // empty vector of strings (i.e. no Links)
-
-    std::vector<std::string>    links = split(arl_links, ';');
-    assert(arl_type_index < (int)links.size());
-    std::string                 appropriate_links = links[arl_type_index];
-    assert(appropriate_links[0] == '[');
-    appropriate_links = appropriate_links.substr(1, appropriate_links.size() - 2); // strip '[' and ']'
-
-    // Special case for performance
-    if (appropriate_links.find("fn:") == std::string::npos) {
-        // No predicates so split on COMMA and return
-        retval = split(appropriate_links, ',');
-        return retval;
-    }
+const std::vector<ArlSymbol>& ArlVersion::get_full_linkset() const {
+    static const std::vector<ArlSymbol> no_links;
 
-    std::string s = appropriate_links;
+    if ((arl_type_index < 0) || row.full_links.empty())
+        return no_links; // empty vector (i.e. no Links)
 
-    while (s.size() > 0) {
-        if (s.rfind("fn:", 0) == 0) {
-            std::smatch     m;
-
-            // next Link starts with "fn:"
-            if (std::regex_search(s, m, r_startsWithSinceVersionExtension) && m.ready() && (m.size() == 4)) {
-                    // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
-                    // m[2] = extension name
-                    // m[3] = Arlington link
-                    // int arl_v = string_to_pdf_version(m[1].str());
-                if (FindInVector(supported_extensions, m[2].str()) || wildcard_extn)
-                    retval.push_back(m[3]);     // m[2] = Arlington link
-                s = m.suffix();
-                if (s[0] == ',')
-                    s = s.substr(1);            // skip COMMA
-            }
-            else if (std::regex_search(s, m, r_startsWithIsPDFVersionExtension) && m.ready() && (m.size() == 4)) {
-                // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
-                // m[2] = extension name
-                // m[3] = Arlington link
-                // int arl_v = string_to_pdf_version(m[1].str());
-                if (FindInVector(supported_extensions, m[2].str()) || wildcard_extn)
-                    retval.push_back(m[3]);     // m[2] = Arlington link
-                s = m.suffix();
-                if (s[0] == ',')
-                    s = s.substr(1);            // skip COMMA
-            }
-            else if (std::regex_search(s, m, r_startsWithSinceVersion) && m.ready() && (m.size() == 3)) {
-                // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
-                int arl_v = string_to_pdf_version(m[1].str());
-                if (pdf_version >= arl_v)
-                    retval.push_back(m[2]);     // m[2] = Arlington link
-                s = m.suffix();
-                if (s[0] == ',')
-                    s = s.substr(1);            // skip COMMA
-            }
-            else if (std::regex_search(s, m, r_startsWithBeforeVersion) && m.ready() && (m.size() == 3)) {
-                // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
-                int arl_v = string_to_pdf_version(m[1].str());
-                if (pdf_version < arl_v)
-                    retval.push_back(m[2]);     // m[2] = Arlington link
-                s = m.suffix();
-                if (s[0] == ',')
-                    s = s.substr(1);            // skip COMMA
-            }
-            else if (std::regex_search(s, m, r_startsWithIsPDFVersion) && m.ready() && (m.size() == 3)) {
-                // m[2] = PDF version "x.y" --> convert to integer as x*10 + y
-                int arl_v = string_to_pdf_version(m[1].str());
-                if (pdf_version == arl_v)
-                    retval.push_back(m[2]);     // m[2] = Arlington link
-                s = m.suffix();
-                if (s[0] == ',')
-                    s = s.substr(1);            // skip COMMA
-            }
-            else if (std::regex_search(s, m, r_startsWithDeprecated) && m.ready() && (m.size() == 3)) {
-                // m[2] = PDF version "x.y" --> convert to integer as x*10 + y
-                int arl_v = string_to_pdf_version(m[1].str());
-                if (pdf_version < arl_v)
-                    retval.push_back(m[2]);     // m[2] = Arlington link
-                s = m.suffix();
-                if (s[0] == ',')
-                    s = s.substr(1);            // skip COMMA
-            }
-            else if (std::regex_search(s, m, r_startsWithLinkExtension) && m.ready() && (m.size() == 3)) {
-                // m[1] = named extension
-                // m[2] = link 
-                if (FindInVector(supported_extensions, m[1].str()) || wildcard_extn)
-                    retval.push_back(m[2]);     // m[2] = Arlington link
-                s = m.suffix();
-                if (s[0] == ',')
-                    s = s.substr(1);            // skip COMMA
-            }
-            else {
-                assert(false && "unexpected predicate in Arlington Links!");
-                s.clear();
-            }
-        }
-        else {
-            // does NOT start with "fn:"
-            // copy link (up to next COMMA) to output
-            auto comma = s.find(',');
-            std::string l;
-            if (comma != std::string::npos) {
-                l = s.substr(0, comma);
-                s = s.substr(comma + 1);
-            }
-            else {
-                l = s;
-                s.clear();
-            }
-            retval.push_back(l);
-        }
-    } // while
-
-    return retval;
-}
-
-
-/// @brief Return the full Arlington Link set AFTER blindly removing predicates (i.e. ignore current PDF version).
-///
-/// @param[in] arl_links   a raw Arlington 'Links' field, including complex ([];[];[]) and predicates
-///
-/// @returns a simplified but full set (vector) of Arlington Links appropriate for the type of PDF object.
-/// Or empty vector if nothing appropriate.
-std::vector<std::string>  ArlVersion::get_full_linkset(std::string arl_links) {
-    std::vector<std::string>      retval;
-
-    if ((arl_type_index < 0) || (arl_links == ""))
-        return retval; // empty vector of strings (i.e. no Links)
-
-    // Brute force removal of all predicates
-    std::string s = remove_type_link_predicates(arl_links);
-
-    std::vector<std::string>    links = split(s, ';');
-    assert(arl_type_index < (int)links.size());
-    std::string                 full_links = links[arl_type_index];
-    assert(full_links[0] == '[');
-    full_links = full_links.substr(1, full_links.size() - 2); // strip '[' and ']'
-    retval = split(full_links, ',');
-    return retval;
+    assert(arl_type_index < (int)row.full_links.size());
+    return row.full_links[arl_type_index];
 }
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "ArlingtonPDFShim.h"
+#include "ArlingtonTSVGrammarFile.h"
 
 #include <string>
 #include <vector>
@@ -61,11 +62,13 @@ using namespace ArlingtonPDFShim;
 enum class ArlVersionReason { Unknown = 0, OK, After_fnBeforeVersion, Before_fnSinceVersion, Not_fnIsPDFVersion, Is_fnDeprecated };
 
 
-/// @brief Class to support versioning of Arlington with a given PDF object and PDF version for a file
+/// @brief Class to support versioning of Arlington with a given PDF object and PDF version for a file.
+/// All Arlington TSV field decoding is done once per row when TSV files are loaded (see ArlTypeDescriptor)
+/// so this is cheap to construct for every key.
 struct ArlVersion {
 private:
-    /// @brief the raw Arlington TSV data row
-    std::vector<std::string>    tsv;
+    /// @brief the typed Arlington TSV data row (including the decoded Type, SinceVersion and DeprecatedIn fields)
+    const ArlTSVTypedRow&       row;
 
     /// @brief PDF version of file being analyzed (multiplied by 10 to make an integer)
     int                 pdf_version;
@@ -79,36 +82,44 @@ private:
     int                 arl_type_index;
 
     /// @brief how the PDF object type directly maps across (e.g. integer)
-    std::string         arl_type_of_pdf_object;
+    ArlBasicType        arl_type_of_pdf_object;
 
     /// @brief more refined Arlington type from Arlington (e.g. bitmask).
-    /// Always compatible with arl_type_of_pdf_object
-    std::string         arl_type;
+    /// Always compatible with arl_type_of_pdf_object. Empty if not matched.
+    const std::string*  arl_type;
 
     /// @brief any versioning from Arlington TSV data
     ArlVersionReason    version_reason;
 
     /// @brief list of supported extensions
-    std::vector<std::string>    supported_extensions;
+    const std::vector<std::string>& supported_extensions;
 
     /// @brief true if supported_extensions contains the wildcard '*'
     bool                        wildcard_extn;
 
+    /// @brief Matches the Arlington 'Type' field and applies all version rules
+    void match_type(const ArlBasicType obj_type);
+
 public:
     /// @brief Constructor
-    ArlVersion(ArlPDFObject* obj, std::vector<std::string> vec, const int pdf_ver, const std::vector<std::string>& extns);
+    ArlVersion(ArlPDFObject* obj, const ArlTSVTypedRow& typed_row, const int pdf_ver, const std::vector<std::string>& extns);
+
+    /// @brief Constructor for a basic Arlington type of PDF object (see get_basic_type())
+    ArlVersion(const ArlBasicType obj_type, const ArlTSVTypedRow& typed_row, const int pdf_ver, const std::vector<std::string>& extns);
+
+    /// @brief Returns the basic Arlington type that a PDF object directly maps to
+    static ArlBasicType get_basic_type(ArlPDFObject* obj);
 
-    bool             object_matched_arlington_type() { return (arl_type.size() > 0); };
-    std::string      get_object_arlington_type() { return arl_type_of_pdf_object; };
-    std::string      get_matched_arlington_type() { return arl_type; };
-    std::vector<std::string> get_appropriate_linkset(std::string arl_links);
-    std::vector<std::string> get_full_linkset(std::string arl_links);
-    int              get_arlington_type_index() { return arl_type_index; };
+    bool             object_matched_arlington_type() const { return (arl_type->size() > 0); };
+    const std::string& get_object_arlington_type() const { return v_ArlBasicTypeNames[(int)arl_type_of_pdf_object]; };
+    const std::string& get_matched_arlington_type() const { return *arl_type; };
+    const std::vector<ArlSymbol>& get_full_linkset() const;
+    int              get_arlington_type_index() const { return arl_type_index; };
 
-    ArlVersionReason get_version_reason() { return version_reason; };
-    int get_reason_version() { return arl_version; };
+    ArlVersionReason get_version_reason() const { return version_reason; };
+    int get_reason_version() const { return arl_version; };
 
-    bool is_unsupported_extension();
+    bool is_unsupported_extension() const;
 };
 
 #endif // ArlVersion_h
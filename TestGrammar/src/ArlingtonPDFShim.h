@@ -26,7 +26,12 @@
 #include <filesystem>
 #include <vector>
 #include <memory>
+#include <functional>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
 
 /// @brief Choose which PDF SDK you want to use. Some may have more functionality than others.
 /// This is set in CMakeLists.txt or the TestGrammar | Properties | Preprocessor dialog for Visual Studio
@@ -87,8 +92,23 @@ namespace ArlingtonPDFShim {
             object_num(0), generation_num(-1)
             { /* default constructor to invalid values */ };
 
+        _object_id(const int obj, const int gen) :
+            object_num(obj), generation_num(gen)
+            { /* constructor */ };
+
+        bool operator==(const _object_id& rhs) const
+            { return (object_num == rhs.object_num) && (generation_num == rhs.generation_num); };
+
+        bool operator!=(const _object_id& rhs) const
+            { return !(*this == rhs); };
     } object_id;
 
+    /// @brief Hash function so that object_id can be used in unordered containers
+    struct object_id_hash {
+        std::size_t operator()(const object_id& id) const
+            { return std::hash<long long>()(((long long)id.object_num << 32) ^ (unsigned int)id.generation_num); };
+    };
+
     /// @class ArlPDFObject
     /// Base class PDF object
     class ArlPDFObject {
@@ -111,8 +131,9 @@ namespace ArlingtonPDFShim {
         /// @brief deleteable underlying PDF SDK object (NO for trailer, doccat)
         bool            deleteable;
         
-        /// @brief Sort all dictionary keys so guaranteed same order across PDF SDKs
-        std::vector<std::wstring>   sorted_keys;
+        /// @brief Sort all dictionary keys so guaranteed same order across PDF SDKs.
+        /// Keys are the raw bytes of the PDF names (no leading '/', #-escapes decoded)
+        std::vector<std::string>    sorted_keys;
 
         /// @brief Checks if keys are sorted and, if not, then sorts
         virtual void sort_keys();
@@ -126,6 +147,11 @@ namespace ArlingtonPDFShim {
 
         ~ArlPDFObject()
             { /* default destructor */ sorted_keys.clear(); assert(deleteable); }
+
+        /// @brief All ArlPDFObjects (and derived classes) live in the per-document arena
+        /// (see ArlPDFObjectArena). delete just recycles the slot.
+        static void* operator new(std::size_t sz);
+        static void  operator delete(void* p);
         
         PDFObjectType get_object_type() { return type; };
         int   get_object_number()       { return obj_id.object_num; };
@@ -134,7 +160,7 @@ namespace ArlingtonPDFShim {
         bool  is_indirect_ref()         { return is_indirect; };
         bool  is_deleteable()           { return deleteable; };
         void  force_deleteable()        { deleteable = true; };
-        std::string get_hash_id();
+        object_id get_object_id();
 
         /// @brief output operator <<
         friend std::ostream& operator << (std::ostream& ofs, const ArlPDFObject& obj) {
@@ -235,6 +261,13 @@ namespace ArlingtonPDFShim {
         int get_num_elements();
         ArlPDFObject* get_value(const int idx);
 
+        /// @brief Visitor for for_each_element(): array index and its value (nullptr if missing).
+        /// The visitor owns the value (deletes or keeps it). Returns false to stop visiting.
+        typedef std::function<bool(const int idx, ArlPDFObject* value)> element_visitor;
+
+        /// @brief Visits every array element in order in a single pass
+        void for_each_element(const element_visitor& visit);
+
         friend std::ostream& operator << (std::ostream& ofs, const ArlPDFArray& obj) {
             ofs << "array " << (ArlPDFObject&)obj;
             return ofs;
@@ -248,13 +281,20 @@ namespace ArlingtonPDFShim {
         ArlPDFDictionary(ArlPDFObject* container, void* obj, const bool can_delete = true) : ArlPDFObject(container, obj, can_delete)
             { /* constructor */ type = PDFObjectType::ArlPDFObjTypeDictionary; };
 
-        // For keys by name...
-        bool          has_key(std::wstring key);
-        ArlPDFObject* get_value(std::wstring key);
+        // For keys by name (raw bytes of the PDF name - no transcoding)...
+        bool          has_key(const std::string_view key);
+        ArlPDFObject* get_value(const std::string_view key);
 
         // For iterating keys...
         int get_num_keys();
-        std::wstring get_key_name_by_index(const int index);
+        const std::string& get_key_name_by_index(const int index);
+
+        /// @brief Visitor for for_each_key(): key (raw bytes of the PDF name) and its value (nullptr if missing).
+        /// The visitor owns the value (deletes or keeps it). Returns false to stop visiting.
+        typedef std::function<bool(const std::string& key, ArlPDFObject* value)> key_visitor;
+
+        /// @brief Visits every key and its value in a single pass, optionally in sorted key order (the same across PDF SDKs)
+        void for_each_key(const key_visitor& visit, const bool sorted = true);
 
         bool has_duplicate_keys();
         std::vector<std::string>& get_duplicate_keys();
@@ -312,13 +352,130 @@ namespace ArlingtonPDFShim {
     };
 
 
+    /// @class ArlPDFObjectArena
+    /// Per-document arena for all ArlPDFObjects so that object access (get_value(), get_dictionary(), etc.)
+    /// does not go to the heap. Deleted objects are recycled via a free list and everything (including objects
+    /// that were never deleted) is released in one shot by ArlingtonPDFSDK::close_pdf(). Use ArlPDFDocumentGuard
+    /// so that this also happens when processing a PDF throws an exception.
+    class ArlPDFObjectArena {
+        /// @brief A fixed size slot big enough for any class derived from ArlPDFObject
+        struct slot {
+            slot*   next_free;
+            bool    live;
+            alignas(ArlPDFTrailer) unsigned char storage[sizeof(ArlPDFTrailer)];
+        };
+
+        // Every class derived from ArlPDFObject must fit in a slot (checked at compile time as
+        // allocate() cannot report an error in release builds). Add new classes here.
+        static_assert(sizeof(ArlPDFBoolean) <= sizeof(slot::storage), "ArlPDFBoolean too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFNumber) <= sizeof(slot::storage), "ArlPDFNumber too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFString) <= sizeof(slot::storage), "ArlPDFString too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFName) <= sizeof(slot::storage), "ArlPDFName too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFNull) <= sizeof(slot::storage), "ArlPDFNull too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFArray) <= sizeof(slot::storage), "ArlPDFArray too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFDictionary) <= sizeof(slot::storage), "ArlPDFDictionary too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFStream) <= sizeof(slot::storage), "ArlPDFStream too big for ArlPDFObjectArena slot");
+        static_assert(sizeof(ArlPDFTrailer) <= sizeof(slot::storage), "ArlPDFTrailer too big for ArlPDFObjectArena slot");
+
+        /// @brief number of slots in each block
+        static const int        slots_per_block = 1024;
+
+        /// @brief all blocks allocated for the current document
+        std::vector<slot*>      blocks;
+
+        /// @brief number of slots used in the last block
+        int                     used_in_last_block;
+
+        /// @brief recycled (deleted) slots
+        slot*                   free_list;
+
+    public:
+        ArlPDFObjectArena() :
+            used_in_last_block(slots_per_block), free_list(nullptr)
+            { /* constructor */ };
+
+        ~ArlPDFObjectArena()
+            { /* destructor */ reset(); };
+
+        /// @brief Returns storage for a new object
+        void* allocate(std::size_t sz) {
+            assert(sz <= sizeof(slot::storage));
+            (void)sz;
+            slot* s = free_list;
+            if (s != nullptr)
+                free_list = s->next_free;
+            else {
+                if (used_in_last_block == slots_per_block) {
+                    blocks.push_back(new slot[slots_per_block]);
+                    used_in_last_block = 0;
+                }
+                s = &blocks.back()[used_in_last_block++];
+            }
+            s->live = true;
+            return s->storage;
+        };
+
+        /// @brief Recycles the storage of a deleted object
+        void deallocate(void* p) {
+            slot* s = reinterpret_cast<slot*>(static_cast<unsigned char*>(p) - offsetof(slot, storage));
+            assert(s->live);
+            s->live = false;
+            s->next_free = free_list;
+            free_list = s;
+        };
+
+        /// @brief Destroys any objects still alive and frees all memory. All ArlPDFObjects become invalid!
+        void reset() {
+            for (size_t b = 0; b < blocks.size(); b++) {
+                int n = (b == blocks.size() - 1) ? used_in_last_block : slots_per_block;
+                for (int i = 0; i < n; i++)
+                    if (blocks[b][i].live) {
+                        ArlPDFObject* obj = reinterpret_cast<ArlPDFObject*>(blocks[b][i].storage);
+                        obj->force_deleteable();
+                        obj->~ArlPDFObject();
+                    }
+                delete[] blocks[b];
+            }
+            blocks.clear();
+            used_in_last_block = slots_per_block;
+            free_list = nullptr;
+        };
+    };
+
+
+
+    /// @brief PDF SDK call and PDF object allocation counts (--stats)
+    struct ArlSDKCounters {
+        uint64_t    dict_has_key;
+        uint64_t    dict_get_value;
+        uint64_t    dict_get_key_name;
+        uint64_t    array_get_value;
+        uint64_t    dict_for_each_key;
+        uint64_t    array_for_each_element;
+        uint64_t    objects_allocated;
+
+        ArlSDKCounters() :
+            dict_has_key(0), dict_get_value(0), dict_get_key_name(0), array_get_value(0), dict_for_each_key(0), array_for_each_element(0), objects_allocated(0)
+            { /* constructor */ };
+    };
+
+
 
     /// @class ArlingtonPDFSDK
     /// Arlington PDF SDK
     class ArlingtonPDFSDK {
     public:
-        /// @brief Untyped PDF SDK context object. Needs casting appropriately
-        static void* ctx;
+        /// @brief Untyped PDF SDK context object. Needs casting appropriately.
+        /// Each thread has its own context so that worker threads (--jobs) can each
+        /// process a different PDF file concurrently. Use one ArlingtonPDFSDK per thread.
+        static thread_local void* ctx;
+
+        /// @brief Arena for all ArlPDFObjects of the currently open PDF in this thread. Only holds objects
+        /// while a PDF is open: it is emptied by close_pdf() (see ArlPDFDocumentGuard).
+        static thread_local ArlPDFObjectArena arena;
+
+        /// @brief Counters for PDF SDK calls in this thread or nullptr (the default) when not counting
+        static thread_local ArlSDKCounters* counters;
 
         /// @brief PDF SDK constructor
         explicit ArlingtonPDFSDK()
@@ -355,6 +512,37 @@ namespace ArlingtonPDFShim {
         int get_pdf_page_count();
     };
 
+
+    /// @class ArlPDFDocumentGuard
+    /// Closes a PDF opened with ArlingtonPDFSDK::open_pdf() when it goes out of scope, including when an
+    /// exception is thrown, so all the PDF's objects are released from the arena. Construct it straight after a
+    /// successful open_pdf() and before anything that holds ArlPDFObjects, so those are destroyed first.
+    class ArlPDFDocumentGuard {
+        ArlingtonPDFSDK&    pdfsdk;
+        bool                is_open;
+
+    public:
+        explicit ArlPDFDocumentGuard(ArlingtonPDFSDK& sdk) :
+            pdfsdk(sdk), is_open(true)
+            { /* constructor */ };
+
+        ~ArlPDFDocumentGuard()
+            { /* destructor */ if (is_open) pdfsdk.close_pdf(); };
+
+        ArlPDFDocumentGuard(const ArlPDFDocumentGuard&) = delete;
+        ArlPDFDocumentGuard& operator=(const ArlPDFDocumentGuard&) = delete;
+
+        /// @brief The PDF has already been closed (e.g. by CPDFFile::close_pdf())
+        void release() { is_open = false; };
+    };
+
+
+    inline void* ArlPDFObject::operator new(std::size_t sz)
+        { if (ArlingtonPDFSDK::counters != nullptr) ArlingtonPDFSDK::counters->objects_allocated++; return ArlingtonPDFSDK::arena.allocate(sz); }
+
+    inline void ArlPDFObject::operator delete(void* p)
+        { if (p != nullptr) ArlingtonPDFSDK::arena.deallocate(p); }
+
 }; // namespace
 
 #endif // ArlingtonPDFShim_h
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <string>
 #include <cassert>
+#include <mutex>
 #include "utils.h"
 
 // pdfium
@@ -39,7 +40,15 @@
 
 using namespace ArlingtonPDFShim;
 
-void* ArlingtonPDFSDK::ctx = nullptr;
+thread_local void* ArlingtonPDFSDK::ctx = nullptr;
+thread_local ArlPDFObjectArena ArlingtonPDFSDK::arena;
+thread_local ArlSDKCounters* ArlingtonPDFSDK::counters = nullptr;
+
+/// @brief pdfium module managers are process-wide singletons so they are shared
+/// by all per-thread pdfium contexts and are reference counted.
+static std::mutex           pdfium_module_mutex;
+static int                  pdfium_module_refs = 0;
+static CCodec_ModuleMgr*    pdfium_codec_module = nullptr;
 
 struct pdfium_context {
     CPDF_Parser*        parser;
@@ -56,20 +65,27 @@ struct pdfium_context {
         pdf_trailer = nullptr;
         pdf_catalog = nullptr;
         parser = nullptr;
-        CPDF_ModuleMgr::Create();
-        codecModule = CCodec_ModuleMgr::Create();
+
+        std::lock_guard<std::mutex> lock(pdfium_module_mutex);
+        if (pdfium_module_refs++ == 0) {
+            CPDF_ModuleMgr::Create();
+            pdfium_codec_module = CCodec_ModuleMgr::Create();
+            CPDF_ModuleMgr::Get()->SetCodecModule(pdfium_codec_module);
+            // CPDF_ModuleMgr::Get()->InitPageModule();
+            // CPDF_ModuleMgr::Get()->InitRenderModule();
+            // CPDF_ModuleMgr::Get()->LoadEmbeddedGB1CMaps();
+            // CPDF_ModuleMgr::Get()->LoadEmbeddedJapan1CMaps();
+            // CPDF_ModuleMgr::Get()->LoadEmbeddedCNS1CMaps();
+            // CPDF_ModuleMgr::Get()->LoadEmbeddedKorea1CMaps();
+        }
+        codecModule = pdfium_codec_module;
         moduleMgr = CPDF_ModuleMgr::Get();
-        moduleMgr->SetCodecModule(codecModule);
-        // moduleMgr->InitPageModule();
-        // moduleMgr->InitRenderModule();
-        // moduleMgr->LoadEmbeddedGB1CMaps();
-        // moduleMgr->LoadEmbeddedJapan1CMaps();
-        // moduleMgr->LoadEmbeddedCNS1CMaps();
-        // moduleMgr->LoadEmbeddedKorea1CMaps();
     };
 
     ~pdfium_context() {
         /* Destructor */
+        std::lock_guard<std::mutex> lock(pdfium_module_mutex);
+        pdfium_module_refs--;
 /// @todo pdfium-based Linux release builds always segfault on exit!!
 ///       NULL-pointer dereference in CFX_Plex::FreeDataChain (fx_basic_plex.cpp:24)
 #if !defined(__linux__) && !defined(DEBUG)
@@ -77,10 +93,13 @@ struct pdfium_context {
             parser->CloseParser();
             delete(parser);
         }
-        if (codecModule != nullptr)
-            codecModule->Destroy();
-        if (moduleMgr != nullptr)
-            moduleMgr->Destroy();
+        if (pdfium_module_refs == 0) {
+            if (codecModule != nullptr)
+                codecModule->Destroy();
+            if (moduleMgr != nullptr)
+                moduleMgr->Destroy();
+            pdfium_codec_module = nullptr;
+        }
 #endif
     };
 };
@@ -199,6 +218,9 @@ void ArlingtonPDFSDK::close_pdf() {
     delete pdfium_ctx->pdf_trailer;
     pdfium_ctx->pdf_trailer = nullptr;
 
+    // All other ArlPDFObjects for this document (deleted or not)
+    arena.reset();
+
     if (pdfium_ctx->parser != nullptr) {
         pdfium_ctx->parser->CloseParser();
         delete pdfium_ctx->parser;
@@ -393,16 +415,16 @@ ArlPDFObject::ArlPDFObject(ArlPDFObject * container, void* obj, const bool can_d
 
 
 /// @brief   generates unique identifier for every object
-/// @return  for indirect objects it returns the unique identifier (object number)
-std::string ArlPDFObject::get_hash_id()
+/// @return  for indirect objects it returns the unique identifier (object and generation number)
+object_id ArlPDFObject::get_object_id()
 {
     assert(object != nullptr);
     if (((CPDF_Object*)object)->GetType() != PDFOBJ_REFERENCE) {
-        return std::to_string(obj_id.object_num) + "_" + std::to_string(obj_id.generation_num);
+        return obj_id;
     }
     else {
         CPDF_Reference* r = (CPDF_Reference*)object;
-        return std::to_string(r->GetRefObjNum()) + "_" + std::to_string(r->GetGenNum());
+        return object_id(r->GetRefObjNum(), r->GetGenNum());
     }
 }
 
@@ -419,8 +441,7 @@ void ArlPDFObject::sort_keys()
         while (pos) {
             CFX_ByteString keyName;
             (void)dict->GetNextElement(pos, keyName);
-            std::wstring key = (FX_LPCWSTR)keyName.UTF8Decode();
-            sorted_keys.push_back(key);
+            sorted_keys.emplace_back((FX_LPCSTR)keyName, keyName.GetLength());
         }
         // Sort the keys
         if (sorted_keys.size() > 1)
@@ -546,6 +567,8 @@ int ArlPDFArray::get_num_elements()
 /// @return the object at array element index
 ArlPDFObject* ArlPDFArray::get_value(const int idx)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->array_get_value++;
     assert(object != nullptr);
     assert(idx >= 0);
     assert(((CPDF_Object*)object)->GetType() == PDFOBJ_ARRAY);
@@ -562,6 +585,30 @@ ArlPDFObject* ArlPDFArray::get_value(const int idx)
 }
 
 
+/// @brief Visits every element of a PDF array object in order
+/// @param visit called with each array index and its value (nullptr if missing). Returns false to stop.
+void ArlPDFArray::for_each_element(const element_visitor& visit)
+{
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->array_for_each_element++;
+    assert(object != nullptr);
+    assert(((CPDF_Object*)object)->GetType() == PDFOBJ_ARRAY);
+    CPDF_Array* obj = ((CPDF_Array*)object);
+
+    const int num_elems = obj->GetCount();
+    for (int i = 0; i < num_elems; i++) {
+        ArlPDFObject* value = nullptr;
+        CPDF_Object* elem = obj->GetElement(i);
+        if (elem != nullptr) {
+            assert(elem->GetType() != PDFOBJ_INVALID);
+            value = new ArlPDFObject(this, elem);
+        }
+        if (!visit(i, value))
+            break;
+    }
+}
+
+
 /// @brief Returns the number of keys in a PDF dictionary
 /// @return Number of keys (>= 0)
 int ArlPDFDictionary::get_num_keys()
@@ -575,31 +622,34 @@ int ArlPDFDictionary::get_num_keys()
 
 
 /// @brief  Checks whether a PDF dictionary object has a specific key
-/// @param key the key name
+/// @param key the key name (raw bytes of the PDF name)
 /// @return true if the dictionary has the specified key
-bool ArlPDFDictionary::has_key(std::wstring key)
+bool ArlPDFDictionary::has_key(const std::string_view key)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_has_key++;
     assert(object != nullptr);
     assert(((CPDF_Object*)object)->GetType() == PDFOBJ_DICTIONARY);
     CPDF_Dictionary* obj = ((CPDF_Dictionary*)object);
 
-    bool retval = obj->KeyExist(CFX_ByteString::FromUnicode(key.c_str()));
+    bool retval = obj->KeyExist(CFX_ByteStringC(key.data(), (FX_STRSIZE)key.size()));
     return retval;
 }
 
 
 /// @brief  Gets the object associated with the key from a PDF dictionary
-/// @param key the key name
+/// @param key the key name (raw bytes of the PDF name)
 /// @return the PDF object value of key
-ArlPDFObject* ArlPDFDictionary::get_value(std::wstring key)
+ArlPDFObject* ArlPDFDictionary::get_value(const std::string_view key)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_get_value++;
     assert(object != nullptr);
     assert(((CPDF_Object*)object)->GetType() == PDFOBJ_DICTIONARY);
     ArlPDFObject* retval = nullptr;
     CPDF_Dictionary* dict = ((CPDF_Dictionary*)object);
 
-    CFX_ByteString bstr = CFX_ByteString::FromUnicode(key.c_str());
-    CPDF_Object* key_value = dict->GetElement(bstr);
+    CPDF_Object* key_value = dict->GetElement(CFX_ByteStringC(key.data(), (FX_STRSIZE)key.size()));
     if (key_value != NULL) {
         int t = key_value->GetType();
         assert(t != PDFOBJ_INVALID);
@@ -614,19 +664,63 @@ ArlPDFObject* ArlPDFDictionary::get_value(std::wstring key)
 ///
 /// @param[in] index dictionary key index
 ///
-/// @returns Key name
-std::wstring ArlPDFDictionary::get_key_name_by_index(const int index)
+/// @returns Key name (raw bytes of the PDF name) or empty. Valid until this object is deleted.
+const std::string& ArlPDFDictionary::get_key_name_by_index(const int index)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_get_key_name++;
     assert(object != nullptr);
     assert(index >= 0);
-    std::wstring     retval;
+    static const std::string no_key;
 
     sort_keys();
     // Get the i-th sorted key name, allowing for no keys in a dictionary
     if ((!sorted_keys.empty()) && (index < (int)sorted_keys.size()))
-        retval = sorted_keys[index];
+        return sorted_keys[index];
 
-    return retval;
+    return no_key;
+}
+
+
+/// @brief Visits every key of a PDF dictionary and its value. The values come from the same pass
+/// over the dictionary as the keys, so there is no look up of each key by name.
+/// @param visit  called with each key (raw bytes of the PDF name) and its value (nullptr if missing). Returns false to stop.
+/// @param sorted true for sorted key order (so output order matches other PDF SDKs), false for pdfium order
+void ArlPDFDictionary::for_each_key(const key_visitor& visit, const bool sorted)
+{
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_for_each_key++;
+    assert(object != nullptr);
+    assert(((CPDF_Object*)object)->GetType() == PDFOBJ_DICTIONARY);
+    CPDF_Dictionary* dict = ((CPDF_Dictionary*)object);
+
+    auto visit_value = [&](const std::string& key, CPDF_Object* elem) {
+        ArlPDFObject* value = nullptr;
+        if (elem != nullptr) {
+            assert(elem->GetType() != PDFOBJ_INVALID);
+            value = new ArlPDFObject(this, elem);
+        }
+        return visit(key, value);
+    };
+
+    std::vector<std::pair<std::string, CPDF_Object*>> elems;
+    if (sorted)
+        elems.reserve(dict->GetCount());
+    FX_POSITION pos = dict->GetStartPos();
+    while (pos) {
+        CFX_ByteString keyName;
+        CPDF_Object* elem = dict->GetNextElement(pos, keyName);
+        std::string key((FX_LPCSTR)keyName, keyName.GetLength());
+        if (sorted)
+            elems.emplace_back(std::move(key), elem);
+        else if (!visit_value(key, elem))
+            return;
+    }
+    if (elems.size() > 1)
+        std::sort(elems.begin(), elems.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (auto& e : elems)
+        if (!visit_value(e.first, e.second))
+            break;
 }
 
 
@@ -32,6 +32,7 @@
 #include <cassert>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 
 #include "Pdfix.h"
 #include "ArlPredicates.h"
@@ -42,7 +43,15 @@ using namespace PDFixSDK;
 
 Pdfix_statics;
 
-void* ArlingtonPDFSDK::ctx = nullptr;
+thread_local void* ArlingtonPDFSDK::ctx = nullptr;
+thread_local ArlPDFObjectArena ArlingtonPDFSDK::arena;
+thread_local ArlSDKCounters* ArlingtonPDFSDK::counters = nullptr;
+
+/// @brief The PDFix library is a process-wide singleton so it is shared by all
+/// per-thread PDFix contexts and is reference counted.
+static std::mutex   pdfix_library_mutex;
+static int          pdfix_library_refs = 0;
+static Pdfix*       pdfix_library = nullptr;
 
 struct pdfix_context {
     Pdfix*                  pdfix = nullptr;
@@ -54,8 +63,11 @@ struct pdfix_context {
     ~pdfix_context() {
         if (doc != nullptr)
             doc->Close();
-        if (pdfix != nullptr)
+        std::lock_guard<std::mutex> lock(pdfix_library_mutex);
+        if ((pdfix != nullptr) && (--pdfix_library_refs == 0)) {
             pdfix->Destroy();
+            pdfix_library = nullptr;
+        }
     }
 };
 
@@ -66,28 +78,34 @@ void ArlingtonPDFSDK::initialize()
 {
     assert(ctx == nullptr);
 
-    // initialize Pdfix
-    std::wstring email = L"PDF Assoc. SafeDocs";
-    std::wstring license_key = L"jgrrknzeuaDobhTt";
+    std::lock_guard<std::mutex> lock(pdfix_library_mutex);
+    if (pdfix_library == nullptr) {
+        // initialize Pdfix
+        std::wstring email = L"PDF Assoc. SafeDocs";
+        std::wstring license_key = L"jgrrknzeuaDobhTt";
 
-    if (!Pdfix_init(Pdfix_MODULE_NAME))
-        throw std::runtime_error("Pdfix: Initialization failed for " Pdfix_MODULE_NAME);
+        if (!Pdfix_init(Pdfix_MODULE_NAME))
+            throw std::runtime_error("Pdfix: Initialization failed for " Pdfix_MODULE_NAME);
 
-    Pdfix* pdfix = GetPdfix();
-    if (pdfix == nullptr)
-        throw std::runtime_error("Pdfix: GetPdfix failed");
+        Pdfix* pdfix = GetPdfix();
+        if (pdfix == nullptr)
+            throw std::runtime_error("Pdfix: GetPdfix failed");
 
-    if (pdfix->GetVersionMajor() != PDFIX_VERSION_MAJOR ||
-        pdfix->GetVersionMinor() != PDFIX_VERSION_MINOR ||
-        pdfix->GetVersionPatch() != PDFIX_VERSION_PATCH)
-        throw std::runtime_error("Pdfix: Incompatible version");
+        if (pdfix->GetVersionMajor() != PDFIX_VERSION_MAJOR ||
+            pdfix->GetVersionMinor() != PDFIX_VERSION_MINOR ||
+            pdfix->GetVersionPatch() != PDFIX_VERSION_PATCH)
+            throw std::runtime_error("Pdfix: Incompatible version");
 
-    if (!pdfix->GetAccountAuthorization()->Authorize(email.c_str(), license_key.c_str()))
-        throw std::runtime_error("Pdfix: Authorization failed");
+        if (!pdfix->GetAccountAuthorization()->Authorize(email.c_str(), license_key.c_str()))
+            throw std::runtime_error("Pdfix: Authorization failed");
+
+        pdfix_library = pdfix;
+    }
+    pdfix_library_refs++;
 
     // Assign to void context
     auto pdfix_ctx = new pdfix_context;
-    pdfix_ctx->pdfix = pdfix;
+    pdfix_ctx->pdfix = pdfix_library;
     ctx = pdfix_ctx;
 }
 
@@ -172,6 +190,9 @@ void ArlingtonPDFSDK::close_pdf() {
     delete pdfix_ctx->pdf_trailer;
     pdfix_ctx->pdf_trailer = nullptr;
 
+    // All other ArlPDFObjects for this document (deleted or not)
+    arena.reset();
+
     if (pdfix_ctx->doc != nullptr) {
         pdfix_ctx->doc->Close();
         pdfix_ctx->doc = nullptr;
@@ -358,10 +379,10 @@ ArlPDFObject::ArlPDFObject(ArlPDFObject * container, void* obj, const bool can_d
 
 /// @brief   generates unique identifier for every object
 /// @return  for indirect objects it returns the unique identifier (object number)
-std::string ArlPDFObject::get_hash_id()
+object_id ArlPDFObject::get_object_id()
 {
   assert(object != nullptr);
-  return std::to_string(obj_id.object_num) + "_" + std::to_string(obj_id.generation_num);
+  return obj_id;
 }
 
 
@@ -374,7 +395,7 @@ void ArlPDFObject::sort_keys()
         int numKeys = obj->GetNumKeys();
         // Get all the keys in the dictionary
         for (int i=0; i < numKeys; i++) {
-            sorted_keys.push_back(obj->GetKey(i));
+            sorted_keys.push_back(ToUtf8(obj->GetKey(i)));
         }
         // Sort the keys
         if (sorted_keys.size() > 1)
@@ -484,6 +505,8 @@ int ArlPDFArray::get_num_elements()
 /// @return the object at array element index
 ArlPDFObject* ArlPDFArray::get_value(const int idx)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->array_get_value++;
     assert(object != nullptr);
     assert(idx >= 0);
     assert(((PdsObject*)object)->GetObjectType() == kPdsArray);
@@ -497,6 +520,28 @@ ArlPDFObject* ArlPDFArray::get_value(const int idx)
 }
 
 
+/// @brief Visits every element of a PDF array object in order
+/// @param visit called with each array index and its value (nullptr if missing). Returns false to stop.
+void ArlPDFArray::for_each_element(const element_visitor& visit)
+{
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->array_for_each_element++;
+    assert(object != nullptr);
+    assert(((PdsObject*)object)->GetObjectType() == kPdsArray);
+    PdsArray* obj = (PdsArray*)object;
+
+    const int num_elems = obj->GetNumObjects();
+    for (int i = 0; i < num_elems; i++) {
+        PdsObject* elem = obj->Get(i);
+        ArlPDFObject* value = nullptr;
+        if (elem != nullptr)
+            value = new ArlPDFObject(this, elem);
+        if (!visit(i, value))
+            break;
+    }
+}
+
+
 /// @brief Returns the number of keys in a PDF dictionary
 /// @return Number of keys (>= 0)
 int ArlPDFDictionary::get_num_keys()
@@ -509,29 +554,35 @@ int ArlPDFDictionary::get_num_keys()
 }
 
 
-/// @brief  Checks whether a PDF dictionary object has a specific key
-/// @param key the key name
+/// @brief  Checks whether a PDF dictionary object has a specific key.
+/// PDFix only has a wide string API so the key is converted.
+/// @param key the key name (raw bytes of the PDF name)
 /// @return true if the dictionary has the specified key
-bool ArlPDFDictionary::has_key(std::wstring key)
+bool ArlPDFDictionary::has_key(const std::string_view key)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_has_key++;
     assert(object != nullptr);
     assert(((PdsObject*)object)->GetObjectType() == kPdsDictionary);
     PdsDictionary* obj = (PdsDictionary*)object;
-    bool retval = obj->Known(key.c_str());
+    bool retval = obj->Known(utf8ToUtf16(std::string(key)).c_str());
     return retval;
 }
 
 
-/// @brief  Gets the object associated with the key from a PDF dictionary
-/// @param key the key name
+/// @brief  Gets the object associated with the key from a PDF dictionary.
+/// PDFix only has a wide string API so the key is converted.
+/// @param key the key name (raw bytes of the PDF name)
 /// @return the PDF object value of key
-ArlPDFObject* ArlPDFDictionary::get_value(std::wstring key)
+ArlPDFObject* ArlPDFDictionary::get_value(const std::string_view key)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_get_value++;
     assert(object != nullptr);
     assert(((PdsObject*)object)->GetObjectType() == kPdsDictionary);
     PdsDictionary* obj = (PdsDictionary*)object;
 
-    PdsObject* type_key = obj->Get(key.c_str());
+    PdsObject* type_key = obj->Get(utf8ToUtf16(std::string(key)).c_str());
     ArlPDFObject* retval = nullptr;
     if (type_key != nullptr)
         retval = new ArlPDFObject(this, type_key);
@@ -542,21 +593,54 @@ ArlPDFObject* ArlPDFDictionary::get_value(std::wstring key)
 
 /// @brief Returns the key name of i-th dictionary key
 /// @param index[in] dictionary key index
-/// @return Key name
-std::wstring ArlPDFDictionary::get_key_name_by_index(const int index)
+/// @return Key name (raw bytes of the PDF name) or empty. Valid until this object is deleted.
+const std::string& ArlPDFDictionary::get_key_name_by_index(const int index)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_get_key_name++;
     assert(object != nullptr);
     assert(index >= 0);
     assert(((PdsObject*)object)->GetObjectType() == kPdsDictionary);
-
-    std::wstring retval;
+    static const std::string no_key;
 
     sort_keys();
     // Get the i-th sorted key name, allowing for no keys in a dictionary
     if ((!sorted_keys.empty()) && (index < (int)sorted_keys.size()))
-        retval = sorted_keys[index];
+        return sorted_keys[index];
 
-    return retval;
+    return no_key;
+}
+
+
+/// @brief Visits every key of a PDF dictionary and its value.
+/// PDFix has no access to values by index so each value is looked up using its (wide) key.
+/// @param visit  called with each key (raw bytes of the PDF name) and its value (nullptr if missing). Returns false to stop.
+/// @param sorted true for sorted key order (so output order matches other PDF SDKs), false for PDFix order
+void ArlPDFDictionary::for_each_key(const key_visitor& visit, const bool sorted)
+{
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_for_each_key++;
+    assert(object != nullptr);
+    assert(((PdsObject*)object)->GetObjectType() == kPdsDictionary);
+    PdsDictionary* obj = (PdsDictionary*)object;
+
+    const int num_keys = obj->GetNumKeys();
+    std::vector<std::pair<std::string, std::wstring>> keys;
+    keys.reserve(num_keys);
+    for (int i = 0; i < num_keys; i++) {
+        std::wstring key_w = obj->GetKey(i);
+        keys.emplace_back(ToUtf8(key_w), std::move(key_w));
+    }
+    if (sorted && (keys.size() > 1))
+        std::sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (auto& k : keys) {
+        PdsObject* elem = obj->Get(k.second.c_str());
+        ArlPDFObject* value = nullptr;
+        if (elem != nullptr)
+            value = new ArlPDFObject(this, elem);
+        if (!visit(k.first, value))
+            break;
+    }
 }
 
 
@@ -41,7 +41,9 @@
 
 using namespace ArlingtonPDFShim;
 
-void* ArlingtonPDFSDK::ctx = nullptr;
+thread_local void* ArlingtonPDFSDK::ctx = nullptr;
+thread_local ArlPDFObjectArena ArlingtonPDFSDK::arena;
+thread_local ArlSDKCounters* ArlingtonPDFSDK::counters = nullptr;
 
 
 struct qpdf_context {
@@ -132,6 +134,9 @@ void ArlingtonPDFSDK::close_pdf() {
 
     delete qpdf_ctx->pdf_trailer;
     qpdf_ctx->pdf_trailer = nullptr;
+
+    // All other ArlPDFObjects for this document (deleted or not)
+    arena.reset();
 }
 
 
@@ -201,10 +206,10 @@ int ArlingtonPDFSDK::get_pdf_page_count() {
 
 /// @brief   generates unique identifier for every object
 /// @return  for indirect objects it returns the unique identifier (object number)
-std::string ArlPDFObject::get_hash_id()
+object_id ArlPDFObject::get_object_id()
 {
     assert(object != nullptr);
-    return std::to_string(((QPDFObjectHandle*)object)->getObjectID()) + "_" + std::to_string(((QPDFObjectHandle*)object)->getGeneration());
+    return object_id(((QPDFObjectHandle*)object)->getObjectID(), ((QPDFObjectHandle*)object)->getGeneration());
 }
 
 
@@ -302,7 +307,7 @@ void ArlPDFObject::sort_keys()
 
         // Get all the keys in the dictionary
         for (auto& k : dict.getKeys()) {
-            sorted_keys.push_back(ToWString(k));
+            sorted_keys.push_back(k);
         }
         // Sort the keys
         if (sorted_keys.size() > 1)
@@ -410,6 +415,8 @@ int ArlPDFArray::get_num_elements()
 /// @return the object at array element index
 ArlPDFObject* ArlPDFArray::get_value(const int idx)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->array_get_value++;
     assert(object != nullptr);
     assert(idx >= 0);
     QPDFObjectHandle *obj = (QPDFObjectHandle *)object;
@@ -421,6 +428,25 @@ ArlPDFObject* ArlPDFArray::get_value(const int idx)
 }
 
 
+/// @brief Visits every element of a PDF array object in order
+/// @param  visit[in] called with each array index and its value. Returns false to stop.
+void ArlPDFArray::for_each_element(const element_visitor& visit)
+{
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->array_for_each_element++;
+    assert(object != nullptr);
+    QPDFObjectHandle *obj = (QPDFObjectHandle *)object;
+    assert(obj->isArray());
+
+    int i = 0;
+    for (auto& e : obj->getArrayAsVector()) {
+        ArlPDFObject *value = new ArlPDFObject(this, &e);
+        if (!visit(i++, value))
+            break;
+    }
+}
+
+
 /// @brief Returns the number of keys in a PDF dictionary
 /// @return Number of keys (>= 0)
 int ArlPDFDictionary::get_num_keys()
@@ -435,29 +461,32 @@ int ArlPDFDictionary::get_num_keys()
 
 
 /// @brief  Checks whether a PDF dictionary object has a specific key
-/// @param  key[in] the key name
+/// @param  key[in] the key name (raw bytes of the PDF name)
 /// @return true if the dictionary has the specified key
-bool ArlPDFDictionary::has_key(std::wstring key)
+bool ArlPDFDictionary::has_key(const std::string_view key)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_has_key++;
     assert(object != nullptr);
     QPDFObjectHandle *obj = (QPDFObjectHandle *)object;
     assert(obj->isDictionary());
-    std::string s = ToUtf8(key); 
-    bool retval = obj->hasKey(s);
+    bool retval = obj->hasKey(std::string(key));
     return retval;
 }
 
 
 /// @brief  Gets the object associated with the key from a PDF dictionary
-/// @param key the key name
+/// @param key the key name (raw bytes of the PDF name)
 /// @return the PDF object value of key
-ArlPDFObject* ArlPDFDictionary::get_value(std::wstring key)
+ArlPDFObject* ArlPDFDictionary::get_value(const std::string_view key)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_get_value++;
     assert(object != nullptr);
     QPDFObjectHandle *obj = (QPDFObjectHandle *)object;
     assert(obj->isDictionary());
     ArlPDFObject* retval = nullptr;
-    std::string s = ToUtf8(key);
+    std::string s(key);
     if (obj->hasKey(s)) {
         auto o = obj->getKey(s); 
         QPDFObjectHandle* keyobj = &o;
@@ -470,30 +499,45 @@ ArlPDFObject* ArlPDFDictionary::get_value(std::wstring key)
 
 /// @brief Returns the key name of i-th dictionary key
 /// @param index[in] dictionary key index
-/// @return Key name
-std::wstring ArlPDFDictionary::get_key_name_by_index(int index)
+/// @return Key name (raw bytes of the PDF name) or empty. Valid until this object is deleted.
+const std::string& ArlPDFDictionary::get_key_name_by_index(int index)
 {
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_get_key_name++;
     assert(object != nullptr);
     assert(index >= 0);
+    assert(((QPDFObjectHandle *)object)->isDictionary());
+    static const std::string no_key;
 
     sort_keys();
-    std::wstring retval = L"";
-    // Get the i-th sorted key name, allowing for no keys in a dictionary 
-    if ((sorted_keys.size() > 0) && (index < sorted_keys.size()))
-        retval = sorted_keys[index];
+    // Get the i-th sorted key name, allowing for no keys in a dictionary
+    if ((sorted_keys.size() > 0) && (index < (int)sorted_keys.size()))
+        return sorted_keys[index];
+
+    return no_key;
+}
 
+
+/// @brief Visits every key of a PDF dictionary and its value in a single pass over the dictionary.
+/// QPDF dictionaries are already in sorted key order.
+/// @param  visit[in]  called with each key (raw bytes of the PDF name) and its value (nullptr if missing). Returns false to stop.
+/// @param  sorted[in] true for sorted key order (so output order matches other PDF SDKs)
+void ArlPDFDictionary::for_each_key(const key_visitor& visit, const bool sorted)
+{
+    (void)sorted;
+    if (ArlingtonPDFSDK::counters != nullptr)
+        ArlingtonPDFSDK::counters->dict_for_each_key++;
+    assert(object != nullptr);
     QPDFObjectHandle *obj = (QPDFObjectHandle *)object;
     assert(obj->isDictionary());
-    auto dict = obj->getDictAsMap();
-    if (index < dict.size()) {
-        int i = 0;
-        for (const auto& [ky, val] : dict)
-            if (index == i++) {
-                retval = ToWString(ky);
-                break;
-            }
+
+    for (auto& [key, val] : obj->getDictAsMap()) {
+        ArlPDFObject* value = nullptr;
+        if (val.isInitialized())
+            value = new ArlPDFObject(this, &val);
+        if (!visit(key, value))
+            break;
     }
-    return retval;
 }
 
 
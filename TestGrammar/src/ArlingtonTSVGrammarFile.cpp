@@ -21,63 +21,465 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <iterator>
+#include <algorithm>
+#include <cassert>
+#include <regex>
 
 #include "ArlingtonTSVGrammarFile.h"
+#include "ArlTSVSpecialization.h"
+#include "LRParsePredicate.h"
+#include "utils.h"
 
-/// @brief  Parses through a TSV file line by line and loads TSV data into data_list
+
+std::map<fs::path, std::shared_ptr<const CArlingtonGrammar>>  CArlingtonGrammar::shared_grammars;
+std::mutex  CArlingtonGrammar::shared_grammars_mutex;
+
+
+/// @brief Constructor that pre-splits a raw Arlington TSV row into typed fields
+///
+/// @param[in] row   a raw row from an Arlington TSV file (at least TSV_NOTES fields)
+ArlTSVTypedRow::ArlTSVTypedRow(const ArlTSVRow& row) :
+    type_desc(row)
+{
+    key             = row[TSV_KEYNAME];
+    has_wildcard    = (key.find('*') != std::string::npos);
+    types           = split(row[TSV_TYPE], ';');
+    since_version   = row[TSV_SINCEVERSION];
+    deprecated_in   = row[TSV_DEPRECATEDIN];
+    required        = row[TSV_REQUIRED];
+    is_required     = (required == "TRUE");
+    indirect_ref    = split(row[TSV_INDIRECTREF], ';');
+    inheritable     = (row[TSV_INHERITABLE] == "TRUE");
+    default_value   = split(row[TSV_DEFAULTVALUE], ';');
+    possible_values = split(row[TSV_POSSIBLEVALUES], ';');
+    special_case    = split(row[TSV_SPECIALCASE], ';');
+    links           = split(row[TSV_LINK], ';');
+    key_sym         = ArlNoSymbol;
+}
+
+
+/// @brief Interns a name
+///
+/// @param[in] name   any Arlington name (TSV filename, Link or Key)
+///
+/// @returns the symbol for name (ArlNoSymbol for "")
+ArlSymbol CArlingtonSymbolTable::intern(const std::string& name)
+{
+    if (name.empty())
+        return ArlNoSymbol;
+    auto found = symbols.find(name);
+    if (found != symbols.end())
+        return found->second;
+    ArlSymbol sym = (ArlSymbol)names.size();
+    names.push_back(name);
+    symbols.insert(std::make_pair(name, sym));
+    return sym;
+}
+
+
+/// @brief Looks up a name without interning it
+///
+/// @param[in] name   any Arlington name (TSV filename, Link or Key)
+///
+/// @returns the symbol for name or ArlNoSymbol if it was never interned
+ArlSymbol CArlingtonSymbolTable::find(const std::string& name) const
+{
+    auto found = symbols.find(name);
+    return (found != symbols.end()) ? found->second : ArlNoSymbol;
+}
+
+
+/// @brief Returns the name of an interned symbol
+///
+/// @param[in] sym   a symbol or ArlNoSymbol
+///
+/// @returns the name ("" for ArlNoSymbol)
+const std::string& CArlingtonSymbolTable::get_name(const ArlSymbol sym) const
+{
+    static const std::string no_name;
+    if (sym == ArlNoSymbol)
+        return no_name;
+    assert((sym >= 0) && (sym < (int)names.size()));
+    return names[sym];
+}
+
+/// @brief  Memory-maps a TSV file and splits it into rows and fields (data_list) without
+/// copying any field data. The TSV file remains mapped for the lifetime of this object.
 /// @return returns false if TSV data is malformed, else returns true
 bool CArlingtonTSVGrammarFile::load()
 {
-    std::ifstream     file(tsv_file_name, std::ios::in);
-    std::string       line = "";
+    tsv_contents = std::make_shared<const CArlMappedFile>(tsv_file_name);
 
     // Check if the file exists and is OK for reading
-    if (!file.is_open() || file.bad() || file.eof()) {
-        file.close();
+    if (!tsv_contents->is_open())
         return false;
-    }
 
     // Iterate through each line (row) and split content using TAB delimiter
-    while (getline(file, line))
+    const std::string_view  text = tsv_contents->view();
+    std::string_view::size_type line_start = 0;
+    while (line_start < text.size())
     {
+        std::string_view::size_type line_end = text.find('\n', line_start);
+        if (line_end == std::string_view::npos)
+            line_end = text.size();
+        std::string_view line = text.substr(line_start, line_end - line_start);
+        line_start = line_end + 1;
+        if (!line.empty() && (line.back() == '\r'))
+            line.remove_suffix(1);
+
         ArlTSVRow                   vec;
-        std::string::size_type      prev_pos = 0;
-        std::string::size_type      pos = 0;
+        std::string_view::size_type prev_pos = 0;
+        std::string_view::size_type pos = 0;
 
-        while ((pos = line.find('\t', pos)) != std::string::npos) {
-            std::string substring(line.substr(prev_pos, pos - prev_pos));
-            vec.push_back(substring);
+        vec.reserve(TSV_NOTES + 1);
+        while ((pos = line.find('\t', pos)) != std::string_view::npos) {
+            vec.push_back(line.substr(prev_pos, pos - prev_pos));
             prev_pos = ++pos;
         }
 
-        vec.push_back(line.substr(prev_pos, pos - prev_pos)); // Last word
+        vec.push_back(line.substr(prev_pos)); // Last word
 
         // Check first header line - have to have 12 columns
-        if (data_list.empty() && (vec.size() < TSV_NOTES)) {
-            file.close();
+        if (data_list.empty() && (vec.size() < TSV_NOTES))
             return false;
-        }
 
         // Move header row separately, so data is pure
         if (header_list.empty())
-            header_list = vec;
+            header_list = std::move(vec);
         else
-            data_list.push_back(vec);
+            data_list.push_back(std::move(vec));
     } // while
 
-    // Close the TSV file
-    file.close();
-
     // Empty file?
     if (data_list.size() == 0)
         return false;
 
+    precompute();
     return true;
 }
 
+
+/// @brief Pre-splits all rows into typed fields and calculates the array layout, so that
+/// this work is not repeated for every PDF object.
+void CArlingtonTSVGrammarFile::precompute()
+{
+    typed_data_list.clear();
+    typed_data_list.reserve(data_list.size());
+    for (auto& row : data_list) {
+        if (row.size() <= TSV_LINK) {
+            // malformed row (reported by --validate) so pad a copy with empty fields
+            ArlTSVRow padded(row);
+            padded.resize(TSV_NOTES + 1);
+            typed_data_list.push_back(ArlTSVTypedRow(padded));
+        }
+        else
+            typed_data_list.push_back(ArlTSVTypedRow(row));
+    }
+
+    // Key index and wildcard descriptor. Degenerate case of a PDF key called "/*" must NOT
+    // match the Arlington dictionary wildcard so wildcards are never in the index.
+    // If a Key is duplicated (reported by --validate) then the first row wins.
+    key_index.clear();
+    key_index.reserve(typed_data_list.size());
+    for (int i = 0; i < (int)typed_data_list.size(); i++)
+        if (typed_data_list[i].key != "*")
+            key_index.emplace(std::string_view(typed_data_list[i].key), i);
+    wildcard_idx = -1;
+    if (!typed_data_list.empty() && (typed_data_list.back().key == "*"))
+        wildcard_idx = (int)typed_data_list.size() - 1;
+
+    // Array layout - use null-stream to suppress messages - should have used "--validate" first anyway
+    array_layout = ArlTSVArrayLayout();
+    std::vector<std::string> array_index_list;
+    for (auto& row : typed_data_list)
+        array_index_list.push_back(row.key);
+
+    bool ambiguous;
+    array_layout.is_valid_array = check_valid_array_definition(get_tsv_name(), array_index_list, cnull, &ambiguous);
+    if (!array_layout.is_valid_array)
+        return;
+
+    const int num_rows = (int)typed_data_list.size();
+
+    // Determine first row index that is optional (Required field != "TRUE")
+    for (int i = 0; i < num_rows; i++) {
+        if (!typed_data_list[i].is_required) {
+            array_layout.first_optional_idx = i;
+            break;
+        }
+    } // for
+
+    // Number of required elements (TSV rows) in PDF array
+    if (array_layout.first_optional_idx == -1)
+        array_layout.num_required_rows = num_rows;      // all rows required
+    else if (array_layout.first_optional_idx == 0)
+        array_layout.num_required_rows = 0;             // no rows required
+    else
+        array_layout.num_required_rows = num_rows - array_layout.first_optional_idx; // some rows required, some not
+
+    // Determine (pure) wildcard status - array repeat sets handled separately below.
+    // Pure wildcards are always the LAST row in the TSV
+    if (typed_data_list[num_rows - 1].key == "*")
+        array_layout.pure_wildcard_idx = num_rows - 1;
+
+    // For array repeat sets, rows in repeating set need to be DIGIT + '*'
+    // DIGIT is not checked here. Assumed to be valid.
+    for (int i = 0; i < num_rows; i++) {
+        if (!typed_data_list[i].has_wildcard) {
+            assert(array_layout.num_array_rows_repeats == 0);
+            assert(array_layout.first_row_to_repeat_idx < 0);
+            array_layout.num_array_rows_fixed++;
+        }
+        else { // pure wildcard ('*') or array repeat (DIGIT + '*')
+            array_layout.num_array_rows_repeats++;
+            if (array_layout.first_row_to_repeat_idx < 0)
+                array_layout.first_row_to_repeat_idx = i;
+        }
+    } // for
+
+    // Sanity check
+    assert(array_layout.num_array_rows_fixed + array_layout.num_array_rows_repeats == num_rows);
+    assert((array_layout.first_optional_idx == -1) || (array_layout.first_row_to_repeat_idx == -1) || (array_layout.first_optional_idx >= array_layout.first_row_to_repeat_idx));
+}
+
+/// @brief Hashed look up of a Key. Wildcards are never matched.
+///
+/// @param[in] key   a PDF dictionary key name or array index (as a string)
+///
+/// @returns the row index into the TSV data or -1 if key is not explicitly defined
+int CArlingtonTSVGrammarFile::find_key(const std::string_view key) const
+{
+    auto found = key_index.find(key);
+    return (found != key_index.end()) ? found->second : -1;
+}
+
+
+/// @brief Constructor. Nothing is read until load() is called.
+///
+/// @param[in] tsv_name   the Arlington TSV file
+CArlingtonTSVGrammarFile::CArlingtonTSVGrammarFile(fs::path tsv_name) :
+    tsv_file_name(tsv_name), wildcard_idx(-1)
+{
+}
+
+
+/// @brief Destructor - frees all pre-parsed predicate ASTs
+CArlingtonTSVGrammarFile::~CArlingtonTSVGrammarFile()
+{
+    for (auto& col : predicate_ast)
+        for (auto& row : col)
+            for (auto& stack : row)
+                for (auto& n : stack)
+                    delete n;
+}
+
+
+/// @brief Parses all predicates in a column for every row, in exactly the same way as
+/// PredicateProcessor used to do per PDF object. Complex fields ([];[];[]) have an outer
+/// vector entry per Arlington type. Values that PredicateProcessor does not parse have an
+/// empty stack.
+///
+/// @param[in] col   the TSV column to parse
+void CArlingtonTSVGrammarFile::compile_predicates(const ArlingtonTSVColumns col) const
+{
+    std::vector<ASTNodeMatrix>& out = predicate_ast[col];
+    out.resize(typed_data_list.size());
+    predicate_program[col].resize(typed_data_list.size());
+
+    for (int key_idx = 0; key_idx < (int)typed_data_list.size(); key_idx++) {
+        const ArlTSVTypedRow& row = typed_data_list[key_idx];
+        ASTNodeMatrix&        m = out[key_idx];
+        bool                  ok = true;
+
+        switch (col) {
+            case TSV_SINCEVERSION:
+                // "x.y" or a single predicate such as fn:Extension(...)
+                if (row.since_version.size() != 3) {
+                    ASTNode* n = new ASTNode();
+                    std::string whats_left = LRParsePredicate(row.since_version, n);
+                    assert(whats_left.size() == 0);
+                    m.push_back(ASTNodeStack(1, n));
+                }
+                break;
+
+            case TSV_REQUIRED:
+                // TRUE, FALSE or a single fn:IsRequired(...)
+                if ((row.required != "TRUE") && (row.required != "FALSE")) {
+                    ASTNode* n = new ASTNode();
+                    std::string whats_left = LRParsePredicate(row.required, n);
+                    assert(whats_left.size() == 0);
+                    m.push_back(ASTNodeStack(1, n));
+                }
+                break;
+
+            case TSV_INDIRECTREF:
+                // TRUE, FALSE, fn:MustBeDirect() or complex [];[];[] with predicates
+                if ((row.indirect_ref.size() == 1) &&
+                    ((row.indirect_ref[0] == "TRUE") || (row.indirect_ref[0] == "FALSE") || (row.indirect_ref[0] == "fn:MustBeDirect()")))
+                    break;
+                for (auto& ir : row.indirect_ref) {
+                    std::string s = ir;
+                    if (s[0] == '[')
+                        s = s.substr(1, s.size() - 2); // strip off any '[' and ']'
+                    m.push_back(ASTNodeStack());
+                    if ((s != "TRUE") && (s != "FALSE"))
+                        ok = LRParsePredicateList(s, m.back()) && ok;
+                }
+                break;
+
+            case TSV_DEFAULTVALUE:
+                // LRParsePredicate does not support PDF-arrays so ignore them
+                if ((row.default_value.size() == 1) && (row.default_value[0] == ""))
+                    break;
+                for (auto& dv : row.default_value) {
+                    std::string s = dv;
+                    if (row.default_value.size() > 1) {
+                        // complex type [];[];[], so therefore everything has [ and ], which need to be removed
+                        assert(s[0] == '[');
+                        s = s.substr(1, s.size() - 2);
+                    }
+                    m.push_back(ASTNodeStack());
+                    if (s[0] != '[')
+                        ok = LRParsePredicateList(s, m.back()) && ok;
+                }
+                break;
+
+            case TSV_POSSIBLEVALUES:
+            case TSV_SPECIALCASE:
+                {
+                    // [];[];[] where only those with predicates are parsed
+                    const std::vector<std::string>& list = (col == TSV_POSSIBLEVALUES) ? row.possible_values : row.special_case;
+                    if ((list.size() == 1) && (list[0] == ""))
+                        break;
+                    for (auto& v : list) {
+                        m.push_back(ASTNodeStack());
+                        if (v.find("fn:") != std::string::npos) {
+                            assert((v[0] == '[') && (v[v.size() - 1] == ']'));
+                            ok = LRParsePredicateList(v.substr(1, v.size() - 2), m.back()) && ok;
+                        }
+                    }
+                }
+                break;
+
+            default:
+                assert(false && "Arlington TSV column without predicates!");
+                break;
+        } // switch
+        assert(ok && "Arlington field too long and complex!");
+
+        // Compile every AST (nullptr ASTs get an empty program)
+        ArlPredicateProgramMatrix& pm = predicate_program[col][key_idx];
+        for (auto& stack : m) {
+            pm.push_back(ArlPredicateProgramStack(stack.size()));
+            for (size_t i = 0; i < stack.size(); i++)
+                if (stack[i] != nullptr)
+                    compile_program(stack[i], pm.back()[i]);
+        }
+    } // for
+}
+
+
+/// @brief Compiles an AST into a bytecode program for this TSV file. Key-values ("@key") of a
+/// single key in this TSV file are bound to the DefaultValue of that key (if any), as
+/// CPDFFile::ExecutePredicate() may need them when the key is not present in a PDF.
+///
+/// @param[in]  ast    AST. Never nullptr.
+/// @param[out] prog   the compiled program
+void CArlingtonTSVGrammarFile::compile_program(const ASTNode* ast, ArlPredicateProgram& prog) const
+{
+    CompilePredicate(ast, prog);
+
+    for (auto& instr : prog.code) {
+        if ((instr.opcode != ArlOpcode::ARLOP_KeyValue) || (instr.key_parts.size() != 1))
+            continue;
+        int key_idx = find_key(instr.key_parts[0]);
+        if ((key_idx >= 0) && (data_list[key_idx][TSV_DEFAULTVALUE] != "")) {
+            // Not all DefaultValues are valid expressions (e.g. PDF arrays) but only
+            // those of keys used in key-values are ever needed
+            ASTNode* dv = new ASTNode;
+            (void)LRParsePredicate(std::string(data_list[key_idx][TSV_DEFAULTVALUE]), dv);
+            instr.default_value.type = dv->type;
+            instr.default_value.node = dv->node;
+            instr.has_default = true;
+            delete dv;
+        }
+    }
+}
+
+
+/// @brief Interns the Key name and all Links (with predicates removed) of every row so
+/// that the PDF validator can work with symbols rather than strings.
+///
+/// @param[in,out] symbols   the symbol table of the Arlington PDF model
+void CArlingtonTSVGrammarFile::intern_symbols(CArlingtonSymbolTable& symbols)
+{
+    for (size_t i = 0; i < typed_data_list.size(); i++) {
+        ArlTSVTypedRow& row = typed_data_list[i];
+        row.key_sym = symbols.intern(row.key);
+        row.full_links.clear();
+        if (data_list[i][TSV_LINK].empty())
+            continue;
+        for (auto& type_links : split(remove_type_link_predicates(std::string(data_list[i][TSV_LINK])), ';')) {
+            assert(type_links[0] == '[');
+            std::vector<ArlSymbol> syms;
+            for (auto& l : split(type_links.substr(1, type_links.size() - 2), ',')) // strip '[' and ']'
+                syms.push_back(symbols.intern(l));
+            row.full_links.push_back(syms);
+        }
+    }
+}
+
+
+/// @brief Returns the pre-parsed predicate ASTs for a field of a row of TSV data.
+/// The ASTs are owned by the grammar file and are shared by all PDF files and threads.
+///
+/// @param[in] key_idx   the row index into the TSV data
+/// @param[in] col       the TSV column (SinceVersion, Required, IndirectRef, DefaultValue, PossibleValues or SpecialCase)
+///
+/// @returns an outer vector per Arlington type of vectors of ASTs. DO NOT FREE!
+const ASTNodeMatrix& CArlingtonTSVGrammarFile::get_predicate_ast(const int key_idx, const ArlingtonTSVColumns col) const
+{
+    assert((key_idx >= 0) && (key_idx < (int)typed_data_list.size()));
+    std::call_once(predicate_ast_once[col], [this, col]() { compile_predicates(col); });
+    return predicate_ast[col][key_idx];
+}
+
+
+/// @brief Returns the compiled predicates for a field of a row of TSV data.
+/// The programs are owned by the grammar file and are shared by all PDF files and threads.
+///
+/// @param[in] key_idx   the row index into the TSV data
+/// @param[in] col       the TSV column (SinceVersion, Required, IndirectRef, DefaultValue, PossibleValues or SpecialCase)
+///
+/// @returns an outer vector per Arlington type of vectors of programs (empty for nullptr ASTs)
+const ArlPredicateProgramMatrix& CArlingtonTSVGrammarFile::get_predicate_program(const int key_idx, const ArlingtonTSVColumns col) const
+{
+    assert((key_idx >= 0) && (key_idx < (int)typed_data_list.size()));
+    std::call_once(predicate_ast_once[col], [this, col]() { compile_predicates(col); });
+    return predicate_program[col][key_idx];
+}
+
+
+/// @brief Returns this TSV file reduced for a specific PDF version and set of extensions.
+/// Each specialization is created once, on first use, and is shared by all PDF files and threads.
+///
+/// @param[in] pdf_version   PDF version multiplied by 10
+/// @param[in] extns         supported extensions (can include the wildcard '*')
+///
+/// @returns the specialization (owned by this TSV file)
+const CArlTSVSpecialization& CArlingtonTSVGrammarFile::get_specialization(const int pdf_version, const std::vector<std::string>& extns) const
+{
+    std::lock_guard<std::mutex> lock(specializations_mutex);
+    std::unique_ptr<CArlTSVSpecialization>& spec = specializations[std::make_pair(pdf_version, extns)];
+    if (spec == nullptr)
+        spec = std::make_unique<CArlTSVSpecialization>(this, pdf_version, extns);
+    return *spec;
+}
+
+
 /// @brief  Returns the name of the TSV without folder or file extension
 /// @return just the TSV filename (no folder, no extension) as a string
-std::string CArlingtonTSVGrammarFile::get_tsv_name()
+std::string CArlingtonTSVGrammarFile::get_tsv_name() const
 {
     return tsv_file_name.stem().string();
 }
@@ -85,7 +487,7 @@ std::string CArlingtonTSVGrammarFile::get_tsv_name()
 
 /// @brief  Returns the folder containing the current TSV file
 /// @return Folder of the current TSV fie
-fs::path CArlingtonTSVGrammarFile::get_tsv_dir()
+fs::path CArlingtonTSVGrammarFile::get_tsv_dir() const
 {
     return tsv_file_name.parent_path();
 }
@@ -94,7 +496,239 @@ fs::path CArlingtonTSVGrammarFile::get_tsv_dir()
 
 /// @brief   Returns raw TSV data as a vector of vector of strings
 /// @return  internal data_list (vector of vector of strings)
-const ArlTSVmatrix& CArlingtonTSVGrammarFile::get_data()
+const ArlTSVmatrix& CArlingtonTSVGrammarFile::get_data() const
 {
     return data_list;
 }
+
+
+
+/// @brief Loads every Arlington TSV file in a folder. Files that fail to load are
+/// treated the same as missing files (i.e. empty). A compiled grammar file (see
+/// write_image()) can be used instead of a folder.
+///
+/// @param[in] tsv_folder   folder containing an Arlington TSV file set or a compiled grammar file
+CArlingtonGrammar::CArlingtonGrammar(const fs::path& tsv_folder) :
+    grammar_folder(tsv_folder), empty_grammar_file(fs::path())
+{
+    if (fs::is_regular_file(grammar_folder)) {
+        bool loaded = false;
+        try {
+            loaded = load_image(grammar_folder);
+        }
+        catch (...) {
+            loaded = false; // e.g. invalid UTF-8
+        }
+        if (loaded)
+            return;
+        // Malformed compiled grammar is the same as an empty folder
+        grammar_map.clear();
+        symbols = CArlingtonSymbolTable();
+        grammar_by_symbol.clear();
+        discriminators.clear();
+    }
+    else {
+        for (const auto& entry : fs::directory_iterator(grammar_folder)) {
+            if (entry.is_regular_file() && (entry.path().extension().string() == ".tsv")) {
+                std::unique_ptr<CArlingtonTSVGrammarFile> reader(new CArlingtonTSVGrammarFile(entry.path()));
+                if (reader->load())
+                    grammar_map.insert(std::make_pair(entry.path().stem().string(), std::move(reader)));
+            }
+        }
+    }
+
+    // TSV filenames first, then the Links hard-coded in the PoC (such as the roots of the PDF DOM)
+    // in case they are missing, then all Key and Link names
+    for (auto& g : grammar_map)
+        (void)symbols.intern(g.first);
+    for (auto& l : { "FileTrailer", "XRefStream", "Catalog", "Metadata", "FileSpecification", "_UniversalDictionary", "_UniversalArray" })
+        (void)symbols.intern(l);
+    for (auto& g : grammar_map)
+        g.second->intern_symbols(symbols);
+
+    grammar_by_symbol.assign(symbols.size(), nullptr);
+    for (auto& g : grammar_map)
+        grammar_by_symbol[symbols.find(g.first)] = g.second.get();
+
+    // Discriminators of every Link set used by any Key
+    for (auto& g : grammar_map)
+        for (auto& row : g.second->get_typed_data())
+            for (auto& linkset : row.full_links)
+                if ((linkset.size() > 1) && (discriminators.find(linkset) == discriminators.end()))
+                    add_discriminator(linkset);
+}
+
+
+/// @brief Calculates which keys of a Link set can select a single Link just from the value of
+/// the key. This is the same information as the most heavily weighted part of the scoring in
+/// CParsePDF::recommended_link_for_object() but is only calculated once per model.
+///
+/// @param[in] links   a Link set (with predicates removed) with more than one Link
+void CArlingtonGrammar::add_discriminator(const std::vector<ArlSymbol>& links)
+{
+    ArlLinkDiscriminator d;
+
+    if (links.size() <= 64) {
+        const uint64_t all_links = (links.size() == 64) ? ~(uint64_t)0 : (((uint64_t)1 << links.size()) - 1);
+
+        for (auto& k : { "Type", "Subtype", "S", "TransformMethod", "0" }) {
+            ArlDiscriminatorKey dk;
+            dk.key = k;
+            dk.is_array_index = (dk.key == "0");
+
+            bool usable = true;
+            for (size_t i = 0; (i < links.size()) && usable; i++) {
+                const CArlingtonTSVGrammarFile* f = get_grammar_file(links[i]);
+                int key_idx = f->find_key(dk.key);
+                if ((key_idx < 0) || (f->get_array_layout().is_valid_array != dk.is_array_index)) {
+                    usable = false;
+                    break;
+                }
+                // Key must allow a name with only fixed names as PossibleValues (no predicates or wildcards)
+                const ArlTSVTypedRow& row = f->get_typed_data()[key_idx];
+                auto t = std::find(row.types.begin(), row.types.end(), "name");
+                if ((t == row.types.end()) || (row.possible_values.size() != row.types.size())) {
+                    usable = false;
+                    break;
+                }
+                const std::string& pv = row.possible_values[t - row.types.begin()];
+                if ((pv.size() < 3) || (pv[0] != '[') || (pv[pv.size() - 1] != ']') || (pv.find("fn:") != std::string::npos)) {
+                    usable = false;
+                    break;
+                }
+                for (auto& v : split(pv.substr(1, pv.size() - 2), ',')) { // strip '[' and ']'
+                    if (v.empty() || (v == "*")) {
+                        usable = false;
+                        break;
+                    }
+                    dk.links_for_value[ToWString(v)] |= ((uint64_t)1 << i);
+                }
+            }
+
+            // Only useful if at least one value excludes at least one Link
+            if (usable)
+                for (auto& v : dk.links_for_value)
+                    if (v.second != all_links) {
+                        d.keys.push_back(dk);
+                        break;
+                    }
+        }
+    }
+
+    // Scoring evaluates the Required and PossibleValues fields. Memoizing the selected Link is only
+    // safe if these never look at other PDF objects ("::" paths or predicates that inspect nested
+    // objects, the PDF DOM or object identity).
+    static const std::vector<std::string> shape_only_fns = {
+        "AlwaysUnencrypted", "ArrayLength", "BeforeVersion", "BitClear", "BitSet", "BitsClear", "BitsSet",
+        "Deprecated", "Eval", "Extension", "FileSize", "Ignore", "ImplementationDependent", "InKeyMap",
+        "InNameTree", "IsMeaningful", "IsPDFTagged", "IsPDFVersion", "IsPresent", "IsRequired", "MustBeDirect",
+        "MustBeIndirect", "Not", "NotStandard14Font", "NumberOfPages", "RequiredValue", "SinceVersion", "StringLength" };
+    static const std::regex r_fn("fn:([A-Za-z0-9]+)");
+
+    d.memoizable = true;
+    for (size_t i = 0; (i < links.size()) && d.memoizable; i++) {
+        const CArlingtonTSVGrammarFile* f = get_grammar_file(links[i]);
+        for (auto& row : f->get_data()) {
+            for (auto col : { TSV_REQUIRED, TSV_POSSIBLEVALUES }) {
+                const std::string_view field = row[col];
+                if (field.find("::") != std::string_view::npos)
+                    d.memoizable = false;
+                for (std::cregex_iterator it(field.data(), field.data() + field.size(), r_fn); d.memoizable && (it != std::cregex_iterator()); ++it)
+                    d.memoizable = (std::find(shape_only_fns.begin(), shape_only_fns.end(), (*it)[1].str()) != shape_only_fns.end());
+            }
+            if (!d.memoizable)
+                break;
+        }
+    }
+
+    // Keys whose values (not just presence and type) are looked at by scoring
+    if (d.memoizable) {
+        static const std::regex r_key_ref("@([A-Za-z0-9_.\\-]+)|fn:(?:StringLength|ArrayLength)\\(([A-Za-z0-9_.\\-]+)\\)");
+        for (auto& k : d.keys)
+            d.value_keys.push_back(k.key);
+        for (auto l : links) {
+            const CArlingtonTSVGrammarFile* f = get_grammar_file(l);
+            for (auto& row : f->get_data()) {
+                const std::string_view pv = row[TSV_POSSIBLEVALUES];
+                if (pv.find_first_not_of("[];") != std::string_view::npos) {
+                    if (row[TSV_KEYNAME].find('*') != std::string_view::npos)
+                        d.all_element_values = true;
+                    else
+                        d.value_keys.push_back(std::string(row[TSV_KEYNAME]));
+                }
+                for (auto col : { TSV_REQUIRED, TSV_POSSIBLEVALUES }) {
+                    const std::string_view field = row[col];
+                    for (std::cregex_iterator it(field.data(), field.data() + field.size(), r_key_ref); it != std::cregex_iterator(); ++it)
+                        d.value_keys.push_back((*it)[1].matched ? (*it)[1].str() : (*it)[2].str());
+                }
+            }
+        }
+        std::sort(d.value_keys.begin(), d.value_keys.end());
+        d.value_keys.erase(std::unique(d.value_keys.begin(), d.value_keys.end()), d.value_keys.end());
+    }
+
+    d.id = (uint32_t)discriminators.size();
+    discriminators.insert(std::make_pair(links, d));
+}
+
+
+/// @brief Returns the discriminator of a Link set.
+///
+/// @param[in] links   a Link set (with predicates removed)
+///
+/// @returns the discriminator or nullptr if the Link set is not used in the model
+const ArlLinkDiscriminator* CArlingtonGrammar::get_discriminator(const std::vector<ArlSymbol>& links) const
+{
+    auto it = discriminators.find(links);
+    if (it == discriminators.end())
+        return nullptr;
+    return &it->second;
+}
+
+
+/// @brief Locates a single Arlington TSV grammar file. The data is not altered or validated.
+///
+/// @param[in] link   the stub name of an Arlington TSV grammar file from the TSV data (i.e. without folder or ".tsv" extension)
+///
+/// @returns the TSV file object. Never nullptr but will have no data if the Link is unknown.
+const CArlingtonTSVGrammarFile* CArlingtonGrammar::get_grammar_file(const std::string& link) const
+{
+    auto it = grammar_map.find(link);
+    if (it == grammar_map.end())
+        return &empty_grammar_file;
+    return it->second.get();
+}
+
+
+/// @brief Locates a single Arlington TSV grammar file by symbol.
+///
+/// @param[in] link   the symbol of the stub name of an Arlington TSV grammar file. Can be ArlNoSymbol.
+///
+/// @returns the TSV file object. Never nullptr but will have no data if the Link is unknown.
+const CArlingtonTSVGrammarFile* CArlingtonGrammar::get_grammar_file(const ArlSymbol link) const
+{
+    if ((link < 0) || (link >= (int)grammar_by_symbol.size()) || (grammar_by_symbol[link] == nullptr))
+        return &empty_grammar_file;
+    return grammar_by_symbol[link];
+}
+
+
+/// @brief Returns the Arlington PDF model for a folder. The model is loaded only once per
+/// process and is then shared (read-only) by all callers and threads.
+///
+/// @param[in] tsv_folder   folder containing an Arlington TSV file set
+///
+/// @returns the shared Arlington PDF model
+std::shared_ptr<const CArlingtonGrammar> CArlingtonGrammar::get_shared_grammar(const fs::path& tsv_folder)
+{
+    fs::path folder = fs::absolute(tsv_folder).lexically_normal();
+
+    std::lock_guard<std::mutex> lock(shared_grammars_mutex);
+    auto it = shared_grammars.find(folder);
+    if (it != shared_grammars.end())
+        return it->second;
+
+    std::shared_ptr<const CArlingtonGrammar> grammar = std::make_shared<const CArlingtonGrammar>(folder);
+    shared_grammars.insert(std::make_pair(folder, grammar));
+    return grammar;
+}
@@ -24,16 +24,27 @@
 #define ArlingtonTSVGrammarFile_h
 #pragma once
 
+#include "ASTNode.h"
+#include "ArlMappedFile.h"
+#include "ArlPredicateProgram.h"
+
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace fs = std::filesystem;
 
-/// @brief  Representation of row of raw Arlington TSV string data 
-typedef std::vector<std::string>                ArlTSVRow;
+/// @brief  Representation of row of raw Arlington TSV string data. Fields are views into the
+/// (memory-mapped) TSV file so are only valid while the CArlingtonTSVGrammarFile exists.
+typedef std::vector<std::string_view>           ArlTSVRow;
 
 /// @brief  Representation of raw Arlington TSV string data (rows and columns)
 typedef std::vector<ArlTSVRow>                  ArlTSVmatrix;
@@ -73,12 +84,255 @@ const std::string ArlingtonTSVFieldNames[] = {
     "Notes"
 };
 
+/// @brief An interned Arlington name (TSV filename/Link or Key name) so names can be compared and
+/// copied as integers. Symbols are only valid with the CArlingtonGrammar that created them.
+typedef int ArlSymbol;
+
+/// @brief Not a symbol (e.g. an empty Link)
+const ArlSymbol ArlNoSymbol = -1;
+
+
+/// @brief Table of interned Arlington names. Populated when a CArlingtonGrammar is loaded and immutable after that.
+class CArlingtonSymbolTable {
+private:
+    /// @brief name of each symbol, indexed by symbol
+    std::vector<std::string>                    names;
+
+    /// @brief reverse look up of names
+    std::unordered_map<std::string, ArlSymbol>  symbols;
+
+public:
+    /// @brief Returns the symbol for a name, adding it if not already present. "" is ArlNoSymbol.
+    ArlSymbol intern(const std::string& name);
+
+    /// @brief Returns the symbol for a name or ArlNoSymbol if the name was never interned
+    ArlSymbol find(const std::string& name) const;
+
+    /// @brief Returns the name of a symbol. "" for ArlNoSymbol.
+    const std::string& get_name(const ArlSymbol sym) const;
+
+    /// @brief Returns the number of symbols
+    int size() const { return (int)names.size(); };
+};
+
+
+/// @brief The Arlington types that a PDF object directly maps to (e.g. a PDF integer is "integer").
+/// Values are bit numbers in the masks of ArlTypeEntry. See v_ArlBasicTypeNames for the names.
+enum class ArlBasicType : uint8_t { Integer = 0, Number, Boolean, Name, Null, Stream, String, Array, Dictionary };
+
+/// @brief Number of ArlBasicType values
+const int ArlBasicTypeCount = 9;
+
+/// @brief Arlington type names of each ArlBasicType
+extern const std::string v_ArlBasicTypeNames[ArlBasicTypeCount];
+
+
+/// @brief Version predicate wrapping a type in the Arlington 'Type' field
+enum class ArlTypePredicate : uint8_t { None = 0, SinceVersion, Deprecated, IsPDFVersion, BeforeVersion };
+
+/// @brief Form of the Arlington 'SinceVersion' field
+enum class ArlSinceVersionForm : uint8_t {
+    Version = 0,            ///< a PDF version "x.y"
+    ExtensionVersion,       ///< fn:Extension(name,x.y)
+    Extension,              ///< fn:Extension(name)
+    EvalExtensionVersion,   ///< fn:Eval(fn:Extension(name,x.y) || a.b)
+    Unknown                 ///< anything else (invalid)
+};
+
+
+/// @brief One entry of the Arlington 'Type' field, decoded for ArlVersion
+struct ArlTypeEntry {
+    /// @brief the Arlington type with any version predicate removed
+    std::string         type;
+
+    /// @brief the version predicate (if any) and its PDF version (x 10)
+    ArlTypePredicate    predicate;
+    int                 predicate_version;
+
+    /// @brief the entry (without '[' and ']') is exactly "number"
+    bool                is_number;
+
+    /// @brief bitmasks (by ArlBasicType) of basic type names that the entry (without '[' and ']')
+    /// contains or is equal to
+    uint16_t            contains_mask;
+    uint16_t            equals_mask;
+
+    /// @brief bitmask (by ArlBasicType) of basic types that are compatible with 'type'
+    /// (e.g. an integer is compatible with bitmask, a string with date)
+    uint16_t            compatible_mask;
+};
+
+
+/// @brief The Arlington 'Type', 'SinceVersion' and 'DeprecatedIn' fields of a TSV row decoded
+/// once when the TSV file is loaded, so that ArlVersion only needs integer operations.
+/// The decoding is in ArlVersion.cpp.
+struct ArlTypeDescriptor {
+    /// @brief each entry of the 'Type' field, in order
+    std::vector<ArlTypeEntry>   types;
+
+    /// @brief the 'SinceVersion' field
+    ArlSinceVersionForm         since_form;
+
+    /// @brief PDF versions (x 10) of the 'SinceVersion' field: the version (or extension version)
+    /// and, for fn:Eval, the version without the extension
+    int                         since_version;
+    int                         since_version_no_extn;
+
+    /// @brief extension name of a predicate-based 'SinceVersion' field
+    std::string                 since_extension;
+
+    /// @brief 'DeprecatedIn' field was not empty, and its PDF version (x 10)
+    bool                        has_deprecated_in;
+    int                         deprecated_in;
+
+    explicit ArlTypeDescriptor(const ArlTSVRow& row);
+};
+
+
+/// @brief A single Arlington TSV row pre-split into typed fields when the TSV file is loaded.
+/// Complex fields ([];[];[]) are split on SEMI-COLON so they can be directly indexed by an
+/// Arlington type index. Predicates are NOT processed.
+struct ArlTSVTypedRow {
+    /// @brief Key field (dictionary key name or array index, possibly with a wildcard)
+    std::string                 key;
+
+    /// @brief Key contains a '*' (pure wildcard or array repeat set)
+    bool                        has_wildcard;
+
+    /// @brief Type field split on SEMI-COLON (may contain predicates)
+    std::vector<std::string>    types;
+
+    /// @brief SinceVersion field (a PDF version or predicate)
+    std::string                 since_version;
+
+    /// @brief DeprecatedIn field (empty or a PDF version)
+    std::string                 deprecated_in;
+
+    /// @brief Required field (TRUE, FALSE or predicate)
+    std::string                 required;
+
+    /// @brief Required field is exactly "TRUE"
+    bool                        is_required;
+
+    /// @brief IndirectReference field split on SEMI-COLON
+    std::vector<std::string>    indirect_ref;
+
+    /// @brief Inheritable field (never has predicates)
+    bool                        inheritable;
+
+    /// @brief DefaultValue field split on SEMI-COLON
+    std::vector<std::string>    default_value;
+
+    /// @brief PossibleValues field split on SEMI-COLON
+    std::vector<std::string>    possible_values;
+
+    /// @brief SpecialCase field split on SEMI-COLON
+    std::vector<std::string>    special_case;
+
+    /// @brief Link field split on SEMI-COLON
+    std::vector<std::string>    links;
+
+    /// @brief Key field as a symbol. Only set when loaded as part of a CArlingtonGrammar.
+    ArlSymbol                   key_sym;
+
+    /// @brief Link field with all predicates removed, split per type and on COMMA, as symbols.
+    /// Only set when loaded as part of a CArlingtonGrammar.
+    std::vector<std::vector<ArlSymbol>>  full_links;
+
+    /// @brief Type, SinceVersion and DeprecatedIn fields decoded for ArlVersion
+    ArlTypeDescriptor           type_desc;
+
+    ArlTSVTypedRow(const ArlTSVRow& row);
+};
+
+/// @brief  Representation of typed Arlington TSV data (rows)
+typedef std::vector<ArlTSVTypedRow>             ArlTSVTypedMatrix;
+
+
+/// @brief Layout of an Arlington TSV file when used to define a PDF array.
+/// "_idx" = a valid TSV row index 0 ... N-1 or -1 (invalid). "num_" = number of rows (0 ... N).
+struct ArlTSVArrayLayout {
+    /// @brief Keys can represent a PDF array (see check_valid_array_definition())
+    bool    is_valid_array;
+
+    /// @brief first optional row index in TSV (Required field != "TRUE")
+    int     first_optional_idx;
+
+    /// @brief row index of pure wildcard in TSV (always the last row)
+    int     pure_wildcard_idx;
+
+    /// @brief first row index of repeating set
+    int     first_row_to_repeat_idx;
+
+    /// @brief non-repeating rows (always BEFORE any repeating set)
+    int     num_array_rows_fixed;
+
+    /// @brief number of rows in repeating set
+    int     num_array_rows_repeats;
+
+    /// @brief required across all rows
+    int     num_required_rows;
+
+    ArlTSVArrayLayout() :
+        is_valid_array(false), first_optional_idx(-1), pure_wildcard_idx(-1), first_row_to_repeat_idx(-1),
+        num_array_rows_fixed(0), num_array_rows_repeats(0), num_required_rows(0)
+        { /* constructor */ };
+};
+
+
+class CArlTSVSpecialization;
+
+
 class CArlingtonTSVGrammarFile
 {
+    /// @brief Compiled grammar files (ArlGrammarImage.cpp) read and write the precomputed data directly
+    friend class CArlingtonGrammar;
+
 private:
     fs::path                    tsv_file_name;
+
+    /// @brief Contents of the TSV file (or of a compiled grammar file shared by all TSV files).
+    /// data_list and header_list are views into this.
+    std::shared_ptr<const CArlMappedFile>  tsv_contents;
+
     ArlTSVmatrix                data_list;
 
+    /// @brief data_list pre-split into typed fields
+    ArlTSVTypedMatrix           typed_data_list;
+
+    /// @brief layout if this TSV is used to define a PDF array
+    ArlTSVArrayLayout           array_layout;
+
+    /// @brief Hashed index of every Key (excluding wildcards) to its row index in typed_data_list.
+    /// Views are into typed_data_list so key lookups never allocate.
+    std::unordered_map<std::string_view, int>   key_index;
+
+    /// @brief row index of a pure dictionary wildcard ("*", always the last row) or -1
+    int                         wildcard_idx;
+
+    /// @brief Calculate typed_data_list and array_layout from data_list
+    void precompute();
+
+    /// @brief Pre-parsed (immutable) predicate ASTs, indexed by [column][row]. Each column is
+    /// parsed once, on first use, for all rows. Shape is the same as PredicateProcessor::predicate_ast.
+    mutable std::vector<ASTNodeMatrix>  predicate_ast[TSV_NOTES + 1];
+
+    /// @brief Compiled predicate_ast, indexed by [column][row]. Same shape as predicate_ast.
+    mutable std::vector<ArlPredicateProgramMatrix>  predicate_program[TSV_NOTES + 1];
+
+    /// @brief Ensures each column of predicate_ast is only parsed once, even across threads
+    mutable std::once_flag              predicate_ast_once[TSV_NOTES + 1];
+
+    /// @brief Parse all predicates in a column of the TSV data into predicate_ast and predicate_program
+    void compile_predicates(const ArlingtonTSVColumns col) const;
+
+    /// @brief Specializations of this TSV file for each PDF version and set of extensions
+    /// (see get_specialization()). Created on first use.
+    mutable std::map<std::pair<int, std::vector<std::string>>, std::unique_ptr<CArlTSVSpecialization>>  specializations;
+
+    /// @brief Protects specializations across threads
+    mutable std::mutex                  specializations_mutex;
+
 public:
     /// @brief All Arlington pre-defined types (alphabetically sorted)
     static const std::vector<std::string>  arl_all_types;
@@ -95,21 +349,166 @@ public:
     /// @brief TSV header row - public only so can validating all Arlington grammar files
     ArlTSVRow                              header_list;
 
-    CArlingtonTSVGrammarFile(fs::path tsv_name) :
-        tsv_file_name(tsv_name)
-        { /* constructor */ }
+    CArlingtonTSVGrammarFile(fs::path tsv_name);
+
+    ~CArlingtonTSVGrammarFile();
 
     /// @brief Function to fetch data from a TSV File
     bool load();
 
     /// @brief  Returns the name of the TSV file (without path or extension)
-    std::string get_tsv_name();
+    std::string get_tsv_name() const;
 
     /// @brief Returns the folder containing the TSV files (without any filename or extension)
-    fs::path    get_tsv_dir();
+    fs::path    get_tsv_dir() const;
 
     /// @brief Returns a reference to the raw TSV data from the TSV file
-    const ArlTSVmatrix& get_data();
+    const ArlTSVmatrix& get_data() const;
+
+    /// @brief Returns a reference to the typed (pre-split) TSV data from the TSV file
+    const ArlTSVTypedMatrix& get_typed_data() const { return typed_data_list; };
+
+    /// @brief Returns the layout of the TSV data when used for a PDF array
+    const ArlTSVArrayLayout& get_array_layout() const { return array_layout; };
+
+    /// @brief Returns the row index of a Key (never a wildcard) or -1 if the Key is not explicitly defined
+    int find_key(const std::string_view key) const;
+
+    /// @brief Returns the row index of a pure dictionary wildcard ("*") or -1 if there is no wildcard
+    int get_wildcard_index() const { return wildcard_idx; };
+
+    /// @brief Returns the pre-parsed predicate ASTs for a field of a row. DO NOT FREE!
+    const ASTNodeMatrix& get_predicate_ast(const int key_idx, const ArlingtonTSVColumns col) const;
+
+    /// @brief Returns the compiled predicates for a field of a row. Same shape as get_predicate_ast().
+    const ArlPredicateProgramMatrix& get_predicate_program(const int key_idx, const ArlingtonTSVColumns col) const;
+
+    /// @brief Returns this TSV file with version and extension predicates reduced for a PDF version and set of extensions
+    const CArlTSVSpecialization& get_specialization(const int pdf_version, const std::vector<std::string>& extns) const;
+
+    /// @brief Compiles an AST for this TSV file (resolving DefaultValues of key-values)
+    void compile_program(const ASTNode* ast, ArlPredicateProgram& prog) const;
+
+    /// @brief Interns all Key and Link names of this TSV file
+    void intern_symbols(CArlingtonSymbolTable& symbols);
+};
+
+
+/// @brief The possible values of one discriminating key (Type, Subtype, S, TransformMethod or
+/// array element 0) across all Links of a Link set.
+struct ArlDiscriminatorKey {
+    /// @brief Key name or "0" for the first element of a PDF array
+    std::string                                 key;
+
+    /// @brief true if key is an array index
+    bool                                        is_array_index;
+
+    /// @brief For each possible value (a PDF name), bit i set means the i-th Link of the Link set allows it
+    std::unordered_map<std::wstring, uint64_t>  links_for_value;
+};
+
+
+/// @brief Discriminating keys of a Link set (with more than one Link) so most PDF objects can
+/// select a Link without scoring every Link. Only keys that every Link defines as a PDF name with
+/// fixed (predicate-free) PossibleValues are used.
+struct ArlLinkDiscriminator {
+    std::vector<ArlDiscriminatorKey>            keys;
+
+    /// @brief true if the Link selected by scoring only depends on the shape of a PDF object (the keys or
+    /// array elements, their types and their primitive values), so the selection can be memoized.
+    /// false if any Required or PossibleValues predicate of any Link looks beyond the PDF object.
+    bool                                        memoizable;
+
+    /// @brief Sorted keys (or array indices) whose values can change the Link selected by scoring:
+    /// keys with PossibleValues, keys referenced as @Key or by fn:StringLength()/fn:ArrayLength()
+    /// in a Required or PossibleValues field, and the discriminating keys. Only calculated if memoizable.
+    std::vector<std::string>                    value_keys;
+
+    /// @brief true if a wildcard array element ("*") has PossibleValues so all array element values matter
+    bool                                        all_element_values;
+
+    /// @brief Identifies the Link set in memo keys. Unique within a CArlingtonGrammar.
+    uint32_t                                    id;
+
+    ArlLinkDiscriminator() : memoizable(false), all_element_values(false), id(0)
+        { /* constructor */ };
+};
+
+
+/// @brief Hash of a Link set
+struct ArlLinkSetHash {
+    size_t operator()(const std::vector<ArlSymbol>& links) const {
+        size_t h = links.size();
+        for (auto l : links)
+            h = (h * 31) + (size_t)l;
+        return h;
+    }
+};
+
+
+/// @brief An entire Arlington PDF model (all TSV files in a folder), loaded once.
+/// Once constructed the model is immutable so it can be safely shared across
+/// all CParsePDF instances and all threads.
+class CArlingtonGrammar
+{
+private:
+    /// @brief The folder with an Arlington TSV file set
+    fs::path        grammar_folder;
+
+    /// @brief All TSV files in the folder, keyed by Link name (TSV filename without ".tsv")
+    std::map<std::string, std::unique_ptr<CArlingtonTSVGrammarFile>>  grammar_map;
+
+    /// @brief An empty TSV file for unknown Links
+    CArlingtonTSVGrammarFile    empty_grammar_file;
+
+    /// @brief All TSV filenames, Links and Key names
+    CArlingtonSymbolTable       symbols;
+
+    /// @brief TSV files indexed by symbol (nullptr if a symbol is not a TSV filename)
+    std::vector<const CArlingtonTSVGrammarFile*>  grammar_by_symbol;
+
+    /// @brief Discriminators of all Link sets in the model that have more than one Link
+    std::unordered_map<std::vector<ArlSymbol>, ArlLinkDiscriminator, ArlLinkSetHash>  discriminators;
+
+    /// @brief Calculates the discriminator of a single Link set
+    void add_discriminator(const std::vector<ArlSymbol>& links);
+
+    /// @brief Loads everything from a compiled grammar file instead of a TSV folder (see ArlGrammarImage.h)
+    bool load_image(const fs::path& image_file);
+
+    /// @brief Process-wide cache of loaded Arlington PDF models, keyed by folder
+    static std::map<fs::path, std::shared_ptr<const CArlingtonGrammar>>  shared_grammars;
+
+    /// @brief Protects shared_grammars
+    static std::mutex           shared_grammars_mutex;
+
+public:
+    /// @brief Loads all Arlington TSV files in a folder, or a compiled grammar file
+    explicit CArlingtonGrammar(const fs::path& tsv_folder);
+
+    /// @brief Writes this Arlington PDF model as a compiled grammar file (see ArlGrammarImage.h)
+    bool write_image(const fs::path& image_file) const;
+
+    /// @brief Returns the folder containing the TSV files
+    const fs::path& get_grammar_folder() const { return grammar_folder; };
+
+    /// @brief Returns the TSV file for an Arlington Link. Never nullptr but may be empty.
+    const CArlingtonTSVGrammarFile* get_grammar_file(const std::string& link) const;
+
+    /// @brief Returns the TSV file for an Arlington Link symbol. Never nullptr but may be empty.
+    const CArlingtonTSVGrammarFile* get_grammar_file(const ArlSymbol link) const;
+
+    /// @brief Returns the symbol of a TSV filename, Link or Key name. ArlNoSymbol if unknown.
+    ArlSymbol get_symbol(const std::string& name) const { return symbols.find(name); };
+
+    /// @brief Returns the name of a symbol
+    const std::string& get_symbol_name(const ArlSymbol sym) const { return symbols.get_name(sym); };
+
+    /// @brief Returns the discriminator of a Link set or nullptr if the Link set is not used in the model
+    const ArlLinkDiscriminator* get_discriminator(const std::vector<ArlSymbol>& links) const;
+
+    /// @brief Returns the process-wide shared Arlington PDF model for a folder, loading it the first time
+    static std::shared_ptr<const CArlingtonGrammar> get_shared_grammar(const fs::path& tsv_folder);
 };
 
 #endif // ArlingtonTSVGrammarFile_h
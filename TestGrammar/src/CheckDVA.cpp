@@ -558,7 +558,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
 #ifdef DVA_TRACING
             ofs << "Reading DVA object " << ToUtf8(elem.dva[i]) << std::endl;
 #endif
-            ArlPDFDictionary * d = (ArlPDFDictionary*)map_dict->get_value(elem.dva[i]);
+            ArlPDFDictionary * d = (ArlPDFDictionary*)map_dict->get_value(ToUtf8(elem.dva[i]));
             if (d == nullptr) {
                 ofs << COLOR_ERROR << "Adobe DVA key not found: " << ToUtf8(elem.dva[i]) << COLOR_RESET;
             }
@@ -581,7 +581,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
             // If the 1st and only letter of the Arlington key is a digit convert to array index (integer)
             if ((vec[TSV_KEYNAME].size() == 1) && (std::string("0123456789").find(vec[TSV_KEYNAME][0]) != std::string::npos))  {
                 try {
-                    array_idx = std::stoi(vec[TSV_KEYNAME]);
+                    array_idx = std::stoi(std::string(vec[TSV_KEYNAME]));
                 }
                 catch (...) {
                     array_idx = -1;
@@ -596,9 +596,9 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
 
                 for (auto& d : dva_dicts) {
                     if (generic_key == nullptr)
-                        generic_key = (ArlPDFDictionary*)d->get_value(L"GenericKey");
+                        generic_key = (ArlPDFDictionary*)d->get_value("GenericKey");
                     if (inner_array == nullptr)
-                        inner_array = (ArlPDFArray*)d->get_value(L"Array");
+                        inner_array = (ArlPDFArray*)d->get_value("Array");
                 }
 
                 if ((generic_key == nullptr) && (inner_array == nullptr)) {
@@ -641,8 +641,8 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
 
                 for (auto& d : dva_dicts) {
                     if (inner_array == nullptr) {
-                        inner_array = (ArlPDFArray*)d->get_value(L"Array");
-                        array_style = (ArlPDFName*)d->get_value(L"ArrayStyle");
+                        inner_array = (ArlPDFArray*)d->get_value("Array");
+                        array_style = (ArlPDFName*)d->get_value("ArrayStyle");
                     }
                 }
 
@@ -660,7 +660,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
                 assert(array_style != nullptr);
                 inner_obj = (ArlPDFDictionary *)inner_array->get_value(array_idx);
                 assert(inner_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
-                assert(inner_obj->has_key(L"ValueType"));
+                assert(inner_obj->has_key("ValueType"));
                 delete array_style;
                 delete inner_array;
             }
@@ -668,7 +668,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
                 // Normal dictionary (named) key. Cycle through all DVA dicts looking for the precise key
                 ArlPDFObject* key = nullptr;
                 for (auto& d : dva_dicts) {
-                    key = d->get_value(ToWString(vec[TSV_KEYNAME]));
+                    key = d->get_value(vec[TSV_KEYNAME]);
                     if (key != nullptr)
                         break;
                 }
@@ -696,9 +696,9 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
             // Arlington IndirectReference can have predicates "fn:MustBeDirect(...)", "fn:MustBeDirect(...)" or be complex ([];[];[];...)
             // Linux CLI:  cut -f 6 *.tsv | sort | uniq
             // Arlington field is UPPERCASE
-            if (inner_obj->has_key(L"MustBeIndirect")) {
+            if (inner_obj->has_key("MustBeIndirect")) {
                 std::string indirect = "FALSE";
-                ArlPDFObject* indr = inner_obj->get_value(L"MustBeIndirect");
+                ArlPDFObject* indr = inner_obj->get_value("MustBeIndirect");
                 if (indr != nullptr) {
                     assert(indr->get_object_type() == PDFObjectType::ArlPDFObjTypeBoolean);
                     ArlPDFBoolean* indr_b = (ArlPDFBoolean*)indr;
@@ -715,8 +715,8 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
             // Arlington Required field can also have predicates "fn:IsRequired(...)" or be complex ([];[];[];...)
             // Linux CLI:  cut -f 5 *.tsv | sort | uniq
             // Arlington field is UPPERCASE
-            if (inner_obj->has_key(L"Required")) {
-                ArlPDFBoolean* req_b = (ArlPDFBoolean*)inner_obj->get_value(L"Required");
+            if (inner_obj->has_key("Required")) {
+                ArlPDFBoolean* req_b = (ArlPDFBoolean*)inner_obj->get_value("Required");
                 if (req_b != nullptr) {
                     assert(req_b->get_object_type() == PDFObjectType::ArlPDFObjTypeBoolean);
                     std::string required = "FALSE";
@@ -738,9 +738,9 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
 
             // Arlington SinceVersion (1.0, 1.1, ..., 2.0)
             // Linux CLI: cut -f 3 *.tsv | sort | uniq
-            if (inner_obj->has_key(L"PDFMajorVersion") && inner_obj->has_key(L"PDFMinorVersion")) {
-                ArlPDFObject* major = inner_obj->get_value(L"PDFMajorVersion");
-                ArlPDFObject* minor = inner_obj->get_value(L"PDFMinorVersion");
+            if (inner_obj->has_key("PDFMajorVersion") && inner_obj->has_key("PDFMinorVersion")) {
+                ArlPDFObject* major = inner_obj->get_value("PDFMajorVersion");
+                ArlPDFObject* minor = inner_obj->get_value("PDFMinorVersion");
                 if ((major != nullptr) && (minor != nullptr) &&
                     (major->get_object_type() == PDFObjectType::ArlPDFObjTypeNumber) &&
                     (minor->get_object_type() == PDFObjectType::ArlPDFObjTypeNumber)) {
@@ -760,7 +760,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
 
             // Check allowed Types
             {
-                ArlPDFObject *vt = inner_obj->get_value(L"ValueType");
+                ArlPDFObject *vt = inner_obj->get_value("ValueType");
                 if (vt == nullptr) {
                     ofs << COLOR_ERROR << "No ValueType defined for DVA for " << elem.all_DVA_keys() << "/" << vec[TSV_KEYNAME] << COLOR_RESET;
                 }
@@ -816,7 +816,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
                         delete obj;
                     } // for
 
-                    std::string head = "Type differences for key " + vec[TSV_KEYNAME] + "\n";
+                    std::string head = "Type differences for key " + std::string(vec[TSV_KEYNAME]) + "\n";
                     std::string our("");
                     for (auto& tpe : types_our)
                         if (tpe != "") {
@@ -851,7 +851,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
 
             // Check Arlington PossibleValue field vs DVA Bounds
             {
-                ArlPDFDictionary* bounds_dict = (ArlPDFDictionary*)inner_obj->get_value(L"Bounds");
+                ArlPDFDictionary* bounds_dict = (ArlPDFDictionary*)inner_obj->get_value("Bounds");
                 if ((bounds_dict != nullptr) && (bounds_dict->get_object_type() != PDFObjectType::ArlPDFObjTypeDictionary)) {
                     ofs << COLOR_ERROR << "Bounds is not a dictionary in DVA for " << elem.all_DVA_keys() << "/" << vec[TSV_KEYNAME] << COLOR_RESET;
                 }
@@ -862,7 +862,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
                         ofs << "Bounds not defined for key " << vec[TSV_KEYNAME] << ": Arlington " << elem.link << " has PossibleValues==" << vec[TSV_POSSIBLEVALUES] << std::endl;
                     }
                     else {
-                        ArlPDFArray* possible_array = (ArlPDFArray*)bounds_dict->get_value(L"Equals");
+                        ArlPDFArray* possible_array = (ArlPDFArray*)bounds_dict->get_value("Equals");
                         if ((possible_array != nullptr) && (possible_array->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
                             std::vector<std::string>    possible_dva;
 
@@ -944,7 +944,7 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
                                 delete obj;
                             } // for
 
-                            std::string head = "PossibleValue differences for key " + vec[TSV_KEYNAME] + "\n";
+                            std::string head = "PossibleValue differences for key " + std::string(vec[TSV_KEYNAME]) + "\n";
                             std::string our = "";
                             for (size_t j = 0; j < possible_our.size(); j++) { // split by ';'
                                 for (size_t k = 0; k < possible_our[j].size(); k++) { // split by ','
@@ -991,12 +991,12 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
 
         /// brief Checks if a key name exists in Arlington
         /// 
-        /// param[in] key key name (std::wstring)
+        /// param[in] key key name
         /// 
         /// returns true if key exists in Arlington or has a wildcard
-        auto exists_in_our = [data_list](std::wstring& key) {
+        auto exists_in_our = [data_list](const std::string& key) {
             for (auto& vec : *data_list)
-                if ((vec[TSV_KEYNAME] == ToUtf8(key)) || (vec[TSV_KEYNAME].find('*') != std::string::npos))
+                if ((vec[TSV_KEYNAME] == key) || (vec[TSV_KEYNAME].find('*') != std::string::npos))
                     return true;
             return false;
         }; // auto
@@ -1008,13 +1008,13 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
         /// param[in] in_ofs   report stream
         auto check_dict = [=](ArlPDFDictionary* dva_dict, std::ostream& in_ofs) {
             for (int i = 0; i < (dva_dict->get_num_keys()); i++) {
-                std::wstring key = dva_dict->get_key_name_by_index(i);
-                if (!exists_in_our(key) && (key != L"FormalRepOf") && (key != L"Array")
-                    && (key != L"ArrayStyle") && (key != L"FormalRepOfArray") && (key != L"OR")
-                    && (key != L"GenericKey") && (key != L"ConcatWithFormalReps")
-                    && (key != L"Metadata") && (key != L"AF")) // keys in PDF 2.0 allowed anywhere
+                const std::string& key = dva_dict->get_key_name_by_index(i);
+                if (!exists_in_our(key) && (key != "FormalRepOf") && (key != "Array")
+                    && (key != "ArrayStyle") && (key != "FormalRepOfArray") && (key != "OR")
+                    && (key != "GenericKey") && (key != "ConcatWithFormalReps")
+                    && (key != "Metadata") && (key != "AF")) // keys in PDF 2.0 allowed anywhere
                 {
-                    in_ofs << "Missing key from DVA in Arlington: " << elem.link << "/" << ToUtf8(key) << std::endl;
+                    in_ofs << "Missing key from DVA in Arlington: " << elem.link << "/" << key << std::endl;
                 }
             }
         }; // auto
@@ -1033,10 +1033,11 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
         const int dva_num_keys = map_dict->get_num_keys();
 
         for (int i = 0; i < dva_num_keys; i++) {
-            std::wstring key = map_dict->get_key_name_by_index(i);
+            const std::string& key = map_dict->get_key_name_by_index(i);
+            std::wstring key_w = ToWString(key);
 
             auto result = std::find_if(mapped.begin(), mapped.end(), 
-                            [&key](CDVAArlingtonTuple a) { return a.contains_DVA_key(key); });
+                            [&key_w](CDVAArlingtonTuple a) { return a.contains_DVA_key(key_w); });
 
             if (result == mapped.end()) {
                 // Candidate DVA key not found - exclude operators, operands, etc.
@@ -1044,8 +1045,8 @@ void process_dva_formal_rep_tree(const fs::path &tsv_dir, std::ostream& ofs, Arl
                 ArlPDFObject* obj = map_dict->get_value(key);
                 assert(obj != nullptr);
                 assert(obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
-                if (((ArlPDFDictionary*)obj)->has_key(L"FormalRepOf")) {
-                    ofs << COLOR_WARNING << "Adobe DVA comparison did not check DVA key: " << ToUtf8(key) << COLOR_RESET;
+                if (((ArlPDFDictionary*)obj)->has_key("FormalRepOf")) {
+                    ofs << COLOR_WARNING << "Adobe DVA comparison did not check DVA key: " << key << COLOR_RESET;
                     missed++;
                 }
                 delete obj;
@@ -1099,10 +1100,10 @@ void CheckDVA(ArlingtonPDFShim::ArlingtonPDFSDK &pdfsdk, const std::filesystem::
         if (pdfsdk.open_pdf(dva_file, L"")) {
             ArlPDFTrailer* trailer = pdfsdk.get_trailer();
                 if (trailer != nullptr) {
-                    ArlPDFObject* root = trailer->get_value(L"Root");
+                    ArlPDFObject* root = trailer->get_value("Root");
                         if ((root != nullptr) && (root->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
                             // Adobe DVA COS object tree starts at DocCat::FormalRepTree
-                            ArlPDFObject* formal_rep = ((ArlPDFDictionary*)root)->get_value(L"FormalRepTree");
+                            ArlPDFObject* formal_rep = ((ArlPDFDictionary*)root)->get_value("FormalRepTree");
                                 if ((formal_rep != nullptr) && (formal_rep->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
                                     ArlPDFDictionary* formal_rep_dict = (ArlPDFDictionary*)formal_rep;
                                         process_dva_formal_rep_tree(grammar_folder, ofs, formal_rep_dict, terse);
@@ -212,9 +212,9 @@ bool check_grammar(CArlingtonTSVGrammarFile& reader, std::string& arl_type, bool
         // Arrays can have repeating sets so need to check for <digit>+ASTERISK and remove ASTERISK
         key_idx++;
         if ((vc[TSV_KEYNAME].size() == 2) && isdigit(vc[TSV_KEYNAME][0]) && (vc[TSV_KEYNAME][1] == '*'))
-            keys_list.push_back(vc[TSV_KEYNAME].substr(0,1));
+            keys_list.emplace_back(vc[TSV_KEYNAME].substr(0,1));
         else
-            keys_list.push_back(vc[TSV_KEYNAME]);
+            keys_list.emplace_back(vc[TSV_KEYNAME]);
 
         for (auto& col : vc) {
             // Check brackets are all balanced
@@ -231,11 +231,11 @@ bool check_grammar(CArlingtonTSVGrammarFile& reader, std::string& arl_type, bool
             // Locate all local variables (\@xxx) to see if they are also keys in this object
             /// @todo Variables in other objects (yyy::\@xxx) are NOT checked
             const std::regex r_LocalKeyValue("[^:]@([a-zA-Z0-9_]+)");
-            auto r_begin = std::sregex_iterator(col.begin(), col.end(), r_LocalKeyValue);
-            auto r_end   = std::sregex_iterator();
+            auto r_begin = std::cregex_iterator(col.data(), col.data() + col.size(), r_LocalKeyValue);
+            auto r_end   = std::cregex_iterator();
 
-            for (std::sregex_iterator it = r_begin; it != r_end; ++it) {
-                std::smatch match = *it;
+            for (std::cregex_iterator it = r_begin; it != r_end; ++it) {
+                std::cmatch match = *it;
                 if (!FindInVector(vars_list, match[1].str()))
                     vars_list.push_back(match[1].str());
             }
@@ -271,7 +271,7 @@ bool check_grammar(CArlingtonTSVGrammarFile& reader, std::string& arl_type, bool
             }
         } // for-each col in a TSV row
 
-        PredicateProcessor validator(nullptr, data_list);
+        PredicateProcessor validator(nullptr, &reader);
         if (!validator.ValidateKeySyntax(key_idx)) {
             report_stream << COLOR_ERROR << "KeyName field validation error " << reader.get_tsv_name() << " for key " << vc[TSV_KEYNAME] << COLOR_RESET;
             retval = false;
@@ -413,7 +413,7 @@ bool check_grammar(CArlingtonTSVGrammarFile& reader, std::string& arl_type, bool
 
         // Check versioning efficiency between SinceVersion field and all version-based predicates
         if (verbose && (vc[TSV_SINCEVERSION].size() == 3)) {
-            int key_introduced_v = string_to_pdf_version(vc[TSV_SINCEVERSION]);
+            int key_introduced_v = string_to_pdf_version(std::string(vc[TSV_SINCEVERSION]));
             for (size_t i = 0; i < vc.size(); i++) {
                 int             pdf_ver;
                 std::string     s;
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////////////
 /// @file
-/// @brief A left-to-right, recursive descent regex-based parser for Arlington predicates.
+/// @brief A left-to-right, recursive descent parser for Arlington predicates with a hand-written lexer.
 ///
 /// @copyright
 /// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
@@ -25,6 +25,7 @@
 #include <iterator>
 #include <regex>
 #include <cassert>
+#include <cstring>
 #include <math.h>
 #include <algorithm>
 
@@ -84,19 +85,13 @@ const std::regex  r_Keys("([0-9]+\\*|[a-zA-Z0-9\\-\\._:\\*]+|[0-9]+|\\*)");
 
 
 
-/// @brief Recursive descent parser regex patterns - all with 'starts with' pattern ("^")
-static const std::regex   r_StartsWithPredicate("^fn:[a-zA-Z14]+\\(");
-static const std::regex   r_StartsWithKeyValue("^" + ArlKeyValue);
-static const std::regex   r_StartsWithKey("^" + ArlKey);
-static const std::regex   r_StartsWithMathComp("^" + ArlMathComp);
-static const std::regex   r_StartsWithMathOp("^" + ArlMathOp);
-static const std::regex   r_StartsWithLogicOp("^" + ArlLogicalOp);
-static const std::regex   r_StartsWithBool("^" + ArlBooleans);
-static const std::regex   r_StartsWithNum("^" + ArlNum);
-static const std::regex   r_StartsWithInt("^" + ArlInt);
-static const std::regex   r_StartsWithString("^" + ArlString);
-static const std::regex   r_StartswithType("^" + ArlPredfinedType);
-static const std::regex   r_StartswithLink("^" + ArlLink);
+/// @brief Arlington pre-defined types in the same order as the ArlPredfinedType regex alternation.
+/// Order matters as the first match wins (e.g. "name" before "name-tree").
+static const char* lex_types[] = {
+    "array", "bitmask", "boolean", "date", "dictionary", "integer", "matrix", "name", "name-tree",
+    "null", "number-tree", "number", "rectangle", "stream", "string-ascii", "string-byte",
+    "string-text", "string"
+};
 
 
 #ifdef ARL_PARSER_DEBUG
@@ -105,17 +100,193 @@ static      int call_depth = 0;
 #endif // ARL_PARSER_DEBUG
 
 
+static inline bool lex_is_alpha(const char c) { return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')); }
+static inline bool lex_is_digit(const char c) { return ((c >= '0') && (c <= '9')); }
+static inline bool lex_is_alnum(const char c) { return lex_is_alpha(c) || lex_is_digit(c); }
+
+/// @brief characters in ArlKeyBase: [a-zA-Z0-9_\.\-]
+static inline bool lex_is_keybase(const char c) { return lex_is_alnum(c) || (c == '_') || (c == '.') || (c == '-'); }
+
+/// @brief characters in keys: ArlKeyBase plus wildcard
+static inline bool lex_is_key(const char c) { return lex_is_keybase(c) || (c == '*'); }
+
+/// @brief characters in fn:[a-zA-Z14]+
+static inline bool lex_is_fn_name(const char c) { return lex_is_alpha(c) || (c == '1') || (c == '4'); }
+
+/// @brief characters forbidden after an integer or number: (?![a-zA-Z\*])
+static inline bool lex_is_num_stop(const char c) { return lex_is_alpha(c) || (c == '*'); }
+
+
+/// @brief Counts the characters matching a character class starting at pos
+static inline size_t lex_count(std::string_view s, size_t pos, bool (*is_class)(const char)) {
+    size_t n = 0;
+    while ((pos + n < s.size()) && is_class(s[pos + n]))
+        n++;
+    return n;
+}
+
+
+/// @brief Matches "[0-9]+(?![a-zA-Z\*])" at pos. If the longest run of digits is followed by a
+/// letter or ASTERISK then a regex backtracks by one digit (which then satisfies the lookahead).
+///
+/// @returns the end position of the match or std::string_view::npos
+static inline size_t lex_digits(std::string_view s, size_t pos) {
+    size_t n = lex_count(s, pos, lex_is_digit);
+    if (n == 0)
+        return std::string_view::npos;
+    if ((pos + n < s.size()) && lex_is_num_stop(s[pos + n]))
+        return (n >= 2) ? (pos + n - 1) : std::string_view::npos;
+    return pos + n;
+}
+
+
+/// @brief Lexes "^fn:[a-zA-Z14]+\(" (predicate name including opening bracket)
+size_t ArlLexPredicate(std::string_view s) {
+    if (s.compare(0, 3, "fn:") != 0)
+        return 0;
+    size_t n = lex_count(s, 3, lex_is_fn_name);
+    if ((n == 0) || (3 + n >= s.size()) || (s[3 + n] != '('))
+        return 0;
+    return 3 + n + 1;
+}
+
+
+/// @brief Lexes ArlBooleans "^(true|false)"
+size_t ArlLexBoolean(std::string_view s) {
+    if (s.compare(0, 4, "true") == 0)
+        return 4;
+    if (s.compare(0, 5, "false") == 0)
+        return 5;
+    return 0;
+}
+
+
+/// @brief Lexes ArlString "^'[^']+'" (including both SINGLE-QUOTES)
+size_t ArlLexString(std::string_view s) {
+    if (s.empty() || (s[0] != '\''))
+        return 0;
+    size_t close = s.find('\'', 1);
+    if ((close == std::string_view::npos) || (close == 1))
+        return 0;
+    return close + 1;
+}
+
+
+/// @brief Lexes ArlPredfinedType (first alternative that matches)
+size_t ArlLexType(std::string_view s) {
+    for (auto t : lex_types) {
+        size_t len = strlen(t);
+        if (s.compare(0, len, t) == 0)
+            return len;
+    }
+    return 0;
+}
+
+
+/// @brief Lexes ArlKeyValue "^(([a-zA-Z0-9]+::)*)@(ArlKeyBase|([0-9]+(\*)?)+|\*)+"
+size_t ArlLexKeyValue(std::string_view s) {
+    size_t pos = 0;
+    size_t n;
+    while (((n = lex_count(s, pos, lex_is_alnum)) > 0) && (s.compare(pos + n, 2, "::") == 0))
+        pos += n + 2;
+    if ((pos >= s.size()) || (s[pos] != '@'))
+        return 0;
+    pos++;
+    n = lex_count(s, pos, lex_is_key);
+    return (n > 0) ? (pos + n) : 0;
+}
+
+
+/// @brief Lexes ArlNum "^(\-)?[0-9]+(?![a-zA-Z\*])\.[0-9]+(?![a-zA-Z\*])"
+size_t ArlLexNumber(std::string_view s) {
+    size_t pos = (!s.empty() && (s[0] == '-')) ? 1 : 0;
+    size_t n = lex_count(s, pos, lex_is_digit);
+    if ((n == 0) || (pos + n >= s.size()) || (s[pos + n] != '.'))
+        return 0;
+    size_t end = lex_digits(s, pos + n + 1);
+    return (end == std::string_view::npos) ? 0 : end;
+}
+
+
+/// @brief Lexes ArlInt "^(\-)?[0-9]+(?![a-zA-Z\*])"
+size_t ArlLexInteger(std::string_view s) {
+    size_t pos = (!s.empty() && (s[0] == '-')) ? 1 : 0;
+    size_t end = lex_digits(s, pos);
+    return (end == std::string_view::npos) ? 0 : end;
+}
+
+
+/// @brief Lexes ArlKey "^([a-zA-Z\*]+::)*(ArlKeyBase|[0-9]+(\*)?|\*)+"
+size_t ArlLexKey(std::string_view s) {
+    size_t pos = 0;
+    size_t prev = std::string_view::npos;
+    size_t n;
+    while (((n = lex_count(s, pos, [](const char c) { return lex_is_alpha(c) || (c == '*'); })) > 0) && (s.compare(pos + n, 2, "::") == 0)) {
+        prev = pos;
+        pos += n + 2;
+    }
+    n = lex_count(s, pos, lex_is_key);
+    if (n > 0)
+        return pos + n;
+    if (prev == std::string_view::npos)
+        return 0;
+    // Backtrack one path separator - the key then ends at the "::"
+    return prev + lex_count(s, prev, lex_is_key);
+}
+
+
+/// @brief Lexes ArlMathComp "^(==|!=|>=|<=|>|<)"
+size_t ArlLexMathComp(std::string_view s) {
+    if ((s.compare(0, 2, "==") == 0) || (s.compare(0, 2, "!=") == 0) || (s.compare(0, 2, ">=") == 0) || (s.compare(0, 2, "<=") == 0))
+        return 2;
+    if (!s.empty() && ((s[0] == '>') || (s[0] == '<')))
+        return 1;
+    return 0;
+}
+
+
+/// @brief Lexes ArlMathOp "^( \* |\+| \- | mod )"
+size_t ArlLexMathOp(std::string_view s) {
+    if (s.compare(0, 3, " * ") == 0)
+        return 3;
+    if (!s.empty() && (s[0] == '+'))
+        return 1;
+    if (s.compare(0, 3, " - ") == 0)
+        return 3;
+    if (s.compare(0, 5, " mod ") == 0)
+        return 5;
+    return 0;
+}
+
+
+/// @brief Lexes ArlLogicalOp "^( && | \|\| )"
+size_t ArlLexLogicalOp(std::string_view s) {
+    if ((s.compare(0, 4, " && ") == 0) || (s.compare(0, 4, " || ") == 0))
+        return 4;
+    return 0;
+}
+
+
+/// @brief returns the first character or NUL if empty (same as std::string)
+static inline char first_char(std::string_view s) {
+    return s.empty() ? '\0' : s[0];
+}
+
+
+static std::string_view LRParsePredicateView(std::string_view s, ASTNode* root);
+
+
 /// @brief         Left-to-right recursive descent parser function that processes only operands/expressions (NOT predicates)
 ///
 /// @param[in]     s     string to parse
 /// @param[in,out] root  root node of AST
 ///
 /// @returns        remaining string that needs to be parsed
-std::string LRParseExpression(std::string s, ASTNode* root) {
+static std::string_view LRParseExpression(std::string_view s, ASTNode* root) {
     assert(root != nullptr);
     ASTNodeStack    stack;
     int             nested_expressions = 0;
-    std::smatch     m, m1;
+    size_t          len;
     ASTNodeType     m_type;
     int             loop = 100;  // avoid deadlocks due to bad predicates
 
@@ -135,7 +306,7 @@ std::string LRParseExpression(std::string s, ASTNode* root) {
         assert(!s.empty());
         m_type = ASTNodeType::ASTNT_Unknown;
 
-        while (s[0] == '(') {
+        while (first_char(s) == '(') {
             s = s.substr(1, s.size() - 1);
             assert(!s.empty());
             nested_expressions++;
@@ -144,26 +315,25 @@ std::string LRParseExpression(std::string s, ASTNode* root) {
             stack.push_back(nested_node);
         }
 
-        if (std::regex_search(s, m, r_StartsWithPredicate)) {
-            assert(m.ready());
+        if ((len = ArlLexPredicate(s)) > 0) {
             ASTNode* p = stack.back();
             assert(p->node.empty());
-            p->node = m[0];
+            p->node = s.substr(0, len);
             p->type = ASTNodeType::ASTNT_Predicate;
-            s = m.suffix().str();
+            s = s.substr(len);
             assert(!s.empty());
             // Process up to 2 optional arguments until predicate closing bracket ')'
-            if (s[0] != ')') {
+            if (first_char(s) != ')') {
                 p->arg[0] = new ASTNode(p);
-                s = LRParsePredicate(s, p->arg[0]);
+                s = LRParsePredicateView(s, p->arg[0]);
 
                 assert(s.size() > 0);
-                if (s[0] == ',') {                          // COMMA = optional 2nd argument in predicate
+                if (first_char(s) == ',') {                 // COMMA = optional 2nd argument in predicate
                     s = s.substr(1, s.size() - 1);          // Remove COMMA
                     p->arg[1] = new ASTNode(p);
-                    s = LRParsePredicate(s, p->arg[1]);
+                    s = LRParsePredicateView(s, p->arg[1]);
                 }
-                else if (s[0] != ')') {
+                else if (first_char(s) != ')') {
                     // must be an operator that is part of an expression for arg[0]...
                     s = LRParseExpression(s, p->arg[0]);
                 }
@@ -171,29 +341,29 @@ std::string LRParseExpression(std::string s, ASTNode* root) {
             assert((s.size() > 0) && (s[0] == ')'));
             s = s.substr(1, s.size() - 1);                  // Consume ')' that ends predicate
         }
-        else if ((m_type = ASTNodeType::ASTNT_ConstPDFBoolean, std::regex_search(s, m, r_StartsWithBool)) ||
-            (m_type = ASTNodeType::ASTNT_ConstString,          std::regex_search(s, m, r_StartsWithString)) ||
-            (m_type = ASTNodeType::ASTNT_Type,                 std::regex_search(s, m, r_StartswithType)) ||
-            (m_type = ASTNodeType::ASTNT_KeyValue,             std::regex_search(s, m, r_StartsWithKeyValue)) ||
-            (m_type = ASTNodeType::ASTNT_ConstNum,             std::regex_search(s, m, r_StartsWithNum)) ||
-            (m_type = ASTNodeType::ASTNT_ConstInt,             std::regex_search(s, m, r_StartsWithInt)) ||
-            (m_type = ASTNodeType::ASTNT_Key,                  std::regex_search(s, m, r_StartsWithKey))) {
-                // Variable / constant. ORDERING of above regex expressions is CRITICAL!!
+        else if ((m_type = ASTNodeType::ASTNT_ConstPDFBoolean, (len = ArlLexBoolean(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_ConstString,          (len = ArlLexString(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_Type,                 (len = ArlLexType(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_KeyValue,             (len = ArlLexKeyValue(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_ConstNum,             (len = ArlLexNumber(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_ConstInt,             (len = ArlLexInteger(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_Key,                  (len = ArlLexKey(s)) > 0)) {
+                // Variable / constant. ORDERING of above lexing is CRITICAL!!
             ASTNode* p = stack.back();
-            assert(m.ready());
             assert(p->node.empty());
             assert(m_type != ASTNodeType::ASTNT_Unknown);
-            p->node = m[0];
-            p->type = m_type;
-            if ((m_type == ASTNodeType::ASTNT_ConstString) && (p->node.at(0) == '\'') && (p->node.back() == '\'')) {
-                // If it is a string should have surrounding SINGLE-QUOTES which both need to be removed
-                p->node = p->node.substr(1, p->node.length() - 2);
+            if (m_type == ASTNodeType::ASTNT_ConstString) {
+                // Strings have surrounding SINGLE-QUOTES which both need to be removed
+                p->node = s.substr(1, len - 2);
             }
-            s = m.suffix().str();
+            else
+                p->node = s.substr(0, len);
+            p->type = m_type;
+            s = s.substr(len);
         }
 
         // Close any explicitly closed  sub-expressions
-        while ((nested_expressions > 0) && (s[0] == ')')) {
+        while ((nested_expressions > 0) && (first_char(s) == ')')) {
             assert(!s.empty());
             s = s.substr(1, s.size() - 1);
             nested_expressions--;
@@ -201,13 +371,12 @@ std::string LRParseExpression(std::string s, ASTNode* root) {
         }
 
         // Check for in-fix operator - recurse down to parse RHS
-        if ((m_type = ASTNodeType::ASTNT_MathComp,  std::regex_search(s, m1, r_StartsWithMathComp)) ||
-            (m_type = ASTNodeType::ASTNT_MathOp,    std::regex_search(s, m1, r_StartsWithMathOp)) ||
-            (m_type = ASTNodeType::ASTNT_LogicalOp, std::regex_search(s, m1, r_StartsWithLogicOp))) {
-            assert(m1.ready());
+        if ((m_type = ASTNodeType::ASTNT_MathComp,  (len = ArlLexMathComp(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_MathOp,    (len = ArlLexMathOp(s)) > 0) ||
+            (m_type = ASTNodeType::ASTNT_LogicalOp, (len = ArlLexLogicalOp(s)) > 0)) {
             assert(m_type != ASTNodeType::ASTNT_Unknown);
-            std::string op  = m1[0];
-            s = m1.suffix().str();
+            std::string_view op = s.substr(0, len);
+            s = s.substr(len);
             // top-of-stack is LHS to the operator we just encountered
             // Update top-of-stack for this operator and then add new RHS to stack
             ASTNode*    p   = stack.back();
@@ -235,10 +404,10 @@ std::string LRParseExpression(std::string s, ASTNode* root) {
                 p->arg[1] = rhs;
             }
             // Parse RHS
-            s = LRParsePredicate(s, rhs);
+            s = LRParsePredicateView(s, rhs);
         }
 
-        while ((nested_expressions > 0) && (s[0] == ')')) {         // Close any explicitly bracketed expressions
+        while ((nested_expressions > 0) && (first_char(s) == ')')) {   // Close any explicitly bracketed expressions
             assert(!s.empty());
             s = s.substr(1, s.size() - 1);
             nested_expressions--;
@@ -265,15 +434,15 @@ std::string LRParseExpression(std::string s, ASTNode* root) {
 }
 
 
-/// @brief   Performs a left-to-right recursive decent parse of a raw Arlington predicate string.
+/// @brief   Left-to-right recursive decent parse of a raw Arlington predicate string without copying.
 ///
 /// @param[in] s          a string to be parsed
 /// @param[in,out] root   an AST node that needs to be populated. Never nullptr.
 ///
-/// @returns remaining string to be parsed
-std::string LRParsePredicate(std::string s, ASTNode *root) {
+/// @returns remaining string to be parsed (a view into s)
+static std::string_view LRParsePredicateView(std::string_view s, ASTNode* root) {
     assert(root != nullptr);
-    std::smatch     m, m1;
+    size_t  len;
 
     if (s.size() == 0)
         return s;
@@ -283,25 +452,24 @@ std::string LRParsePredicate(std::string s, ASTNode *root) {
     std::cout << std::string(call_depth, ' ') << "LRParsePredicate(s-in='" << s << "', root=" << *root << ")" << std::endl;
 #endif // ARL_PARSER_DEBUG
 
-    if (std::regex_search(s, m, r_StartsWithPredicate)) {
-        assert(m.ready());
+    if ((len = ArlLexPredicate(s)) > 0) {
         assert(root->node.empty());
-        root->node = m[0];
+        root->node = s.substr(0, len);
         root->type = ASTNodeType::ASTNT_Predicate;
-        s = m.suffix().str();
+        s = s.substr(len);
         assert(!s.empty());
         // Process up to 2 optional arguments until predicate closing bracket ')'
-        if (s[0] != ')') {
+        if (first_char(s) != ')') {
             root->arg[0] = new ASTNode(root);
-            s = LRParsePredicate(s, root->arg[0]);      // arg[0] is possibly only argument
+            s = LRParsePredicateView(s, root->arg[0]);  // arg[0] is possibly only argument
 
             assert(s.size() > 0);
-            if (s[0] == ',') {                          // COMMA = optional 2nd argument in predicate
+            if (first_char(s) == ',') {                 // COMMA = optional 2nd argument in predicate
                 s = s.substr(1, s.size() - 1);          // Remove COMMA
                 root->arg[1] = new ASTNode(root);
-                s = LRParsePredicate(s, root->arg[1]);
+                s = LRParsePredicateView(s, root->arg[1]);
             }
-            else if (s[0] != ')') {
+            else if (first_char(s) != ')') {
                 // must be an operator that is part of an expression for arg[0]
                 // e.g. fn:Eval(@x==1) - encountered first '=' of "=="
                 s = LRParseExpression(s, root->arg[0]);
@@ -332,3 +500,36 @@ std::string LRParsePredicate(std::string s, ASTNode *root) {
 #endif // ARL_PARSER_DEBUG
     return s;
 }
+
+
+/// @brief   Performs a left-to-right recursive decent parse of a raw Arlington predicate string.
+///
+/// @param[in] s          a string to be parsed
+/// @param[in,out] root   an AST node that needs to be populated. Never nullptr.
+///
+/// @returns remaining string to be parsed
+std::string LRParsePredicate(std::string s, ASTNode *root) {
+    return std::string(LRParsePredicateView(s, root));
+}
+
+
+/// @brief   Parses a COMMA-separated list of raw Arlington predicates and/or values (such as
+///          the inside of one "[...]" of a complex field) into a sequence of ASTs.
+///
+/// @param[in] s          a string to be parsed
+/// @param[in,out] stack  parsed ASTs are appended. Caller is responsible for deleting.
+///
+/// @returns false if the list was too long and complex, true otherwise
+bool LRParsePredicateList(std::string s, ASTNodeStack& stack) {
+    int loop = 0;
+    do {
+        ASTNode* n = new ASTNode();
+        s = LRParsePredicate(s, n);
+        stack.push_back(n);
+        loop++;
+        while ((s.size() > 0) && ((s[0] == ',') || (s[0] == ' '))) {
+            s = s.substr(1, s.size() - 1); // skip over COMMAs and SPACEs
+        }
+    } while ((s.size() > 0) && (loop < 100));
+    return (loop < 100);
+}
@@ -25,9 +25,28 @@
 #include "ASTNode.h"
 
 #include <string>
+#include <string_view>
 
 
-/// @brief Left-to-right recursive descent parser, based on regex pattern matching
+/// @brief Hand-written lexer for the Arlington predicate grammar (see INTERNAL_GRAMMAR.md).
+/// Each function returns the length of the token at the start of s, or 0 if there is none.
+/// Matches are identical to the equivalent "^"-anchored regexes built from ArlPredicates.h.
+size_t ArlLexPredicate(std::string_view s);
+size_t ArlLexBoolean(std::string_view s);
+size_t ArlLexString(std::string_view s);
+size_t ArlLexType(std::string_view s);
+size_t ArlLexKeyValue(std::string_view s);
+size_t ArlLexNumber(std::string_view s);
+size_t ArlLexInteger(std::string_view s);
+size_t ArlLexKey(std::string_view s);
+size_t ArlLexMathComp(std::string_view s);
+size_t ArlLexMathOp(std::string_view s);
+size_t ArlLexLogicalOp(std::string_view s);
+
+/// @brief Left-to-right recursive descent parser
 std::string LRParsePredicate(std::string s, ASTNode *root);
 
+/// @brief Parses a COMMA-separated list of predicates and/or values into a vector of ASTs
+bool LRParsePredicateList(std::string s, ASTNodeStack& stack);
+
 #endif // LRParsePredicate_h
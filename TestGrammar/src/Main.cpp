@@ -29,16 +29,31 @@
 #endif
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <exception>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #if defined __linux__
 #include <cstring>
 #endif
 
+#if defined(_WIN32) || defined(WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
 #include "ArlingtonPDFShim.h"
+#include "ArlGrammarImage.h"
 #include "ArlPredicates.h"
 #include "ParseObjects.h"
 #include "CheckGrammar.h"
@@ -64,94 +79,35 @@ bool no_color = false;
 bool explicit_values_only = false;
 
 
-/// @brief Validates a single PDF file against the Arlington PDF model
-///
-/// @param[in] pdf_file_name  PDF filename for processing
-/// @param[in] tsv_folder  the folder with the Arlington TSV model files
-/// @param[in] pdfsdk      the already initiated PDF SDK library to use
-/// @param[in] ofs         already open file stream for output
-/// @param[in] terse       terse style (brief) output (will sort | uniq better under Linux CLI)
-/// @param[in] debug_mode  verbose style output (PDF-file specific information e.g. object numbers)
-/// @param[in] forced_ver  forced PDF version or empty string to use PDF
-/// @param[in] extns       list of extension names to support
-/// @param[in] pwd         password
-/// 
-/// @returns true on success. false on a fatal error
-bool process_single_pdf(
-    const fs::path& pdf_file_name, 
-    const fs::path& tsv_folder, 
-    ArlingtonPDFSDK& pdfsdk, 
-    std::ostream& ofs, 
-    const bool terse, 
-    const bool debug_mode, 
-    const std::string& forced_ver, 
-    std::vector<std::string>& extns,
-    std::wstring& pwd)
-{
-    bool retval = true;
-    try
-    {
-        ofs << "BEGIN - TestGrammar " << TestGrammar_VERSION << " " << pdfsdk.get_version_string() << std::endl;
-        ofs << "Arlington TSV data: " << fs::absolute(tsv_folder).lexically_normal() << std::endl;
-        ofs << "PDF: " << fs::absolute(pdf_file_name).lexically_normal() << std::endl;
-
-        if (pdfsdk.open_pdf(pdf_file_name, pwd)) {
-            CParsePDF parser(tsv_folder, ofs, terse, debug_mode);
-            CPDFFile  pdf(pdf_file_name, pdfsdk, forced_ver, extns);
-            std::string s;
-            ArlPDFTrailer* t = pdfsdk.get_trailer();
-            if (t != nullptr) {
-                if (t->is_xrefstm()) {
-                    ofs << COLOR_INFO << "XRefStream detected." << COLOR_RESET;
-                    s = "Trailer (as XRefStream)";
-                    parser.add_root_parse_object(t, "XRefStream", s);
-                }
-                else {
-                    ofs << COLOR_INFO << "Traditional trailer dictionary detected." << COLOR_RESET;
-                    s = "Trailer";
-                    parser.add_root_parse_object(t, "FileTrailer", s);
-                }
+/// @brief With --jobs N and reports to stdout or a single --out file, workers may run at most
+/// ArlJobsLookahead * N PDF files ahead of the oldest unfinished one. This bounds how many
+/// finished reports are kept in memory waiting to be output in input order.
+const size_t ArlJobsLookahead = 4;
 
-                parser.add_root_parse_object(pdfsdk.get_document_catalog(), "Catalog", s + "->Root (as Catalog)");
 
-                if (t->is_encrypted()) {
-                    if (t->is_unsupported_encryption()) {
-                        ofs << COLOR_INFO << "Unsupported encryption" << COLOR_RESET;
-                    }
-                    else {
-                        ofs << COLOR_INFO << "Encrypted PDF" << COLOR_RESET;
-                    }
-                }
+/// @brief A PDF file queued for validation with its report filename already resolved.
+/// All report filenames are resolved up-front, in input order, so that naming is
+/// deterministic regardless of how many --jobs are used.
+struct pdf_job {
+    /// @brief the PDF file to validate
+    fs::path    pdf_file;
 
-                retval = parser.parse_object(pdf);
-                if (retval) {
-                    ofs << COLOR_INFO << "Latest Arlington object was" << pdf.get_latest_feature_version_info() << " compared using" << (pdf.is_forced_version() ? " forced" : "") << " PDF " << pdf.pdf_version;
-                    if (extns.size() > 0) {
-                        ofs << " with extensions ";
-                        for (size_t i = 0; i < extns.size(); i++)
-                            ofs << extns[i] << ((i < (extns.size() - 1)) ? ", " : "");
-                    }
-                    ofs << COLOR_RESET;
-                }
-            }
-            else {
-                ofs << COLOR_ERROR << "failed to acquire Trailer" << COLOR_RESET;
-            }
-            pdfsdk.close_pdf();
-        }
-        else {
-            ofs << COLOR_ERROR << "failed to open PDF" << COLOR_RESET;
-        }
-    }
-    catch (std::exception& ex) {
-        ofs << COLOR_ERROR << "EXCEPTION: " << ex.what() << COLOR_RESET;
-        retval = false;
-    }
+    /// @brief the report file or empty() for stdout
+    fs::path    rptfile;
 
-    ofs << "END" << std::endl;
-    return retval;
-};
+    /// @brief open rptfile for appending rather than truncating
+    bool        append;
 
+    /// @brief excluded via --exclude so only report the exclusion
+    bool        excluded;
+
+    /// @brief rptfile is later overwritten by another job (--clobber) so the report is discarded
+    bool        superseded;
+
+    pdf_job(const fs::path& pdf, const bool excl) :
+        pdf_file(pdf), append(false), excluded(excl), superseded(false)
+        { /* constructor */ };
+};
 
 
 #if defined(_WIN32) || defined(WIN32)
@@ -196,7 +152,7 @@ int main(int argc, char* argv[]) {
 
     sarge.setDescription("Arlington PDF Model C++ P.o.C. version " TestGrammar_VERSION
         "\nChoose one of: --pdf, --checkdva or --validate.");
-    sarge.setUsage("TestGrammar --tsvdir <dir> [--force <ver>|exact] [--out <fname|dir>] [--no-color] [--clobber] [--debug] [--brief] [--extensions <extn1[,extn2]>] [--password <pwd>] [--exclude string | @textfile.txt] [--dryrun] [--allfiles] [--validate | --checkdva <formalrep> | --pdf <fname|dir|@file.txt> ]");
+    sarge.setUsage("TestGrammar --tsvdir <dir> [--force <ver>|exact|all] [--out <fname|dir>] [--no-color] [--clobber] [--debug] [--brief] [--extensions <extn1[,extn2]>] [--password <pwd>] [--exclude string | @textfile.txt] [--dryrun] [--allfiles] [--jobs <n>] [--traversal bfs|dfs] [--max-memory <MB>] [--format text|jsonl|binary] [--stats] [--compile <fname>] [--validate | --checkdva <formalrep> | --pdf <fname|dir|@file.txt> ]");
     sarge.setArgument("h", "help", "This usage message.", false);
     sarge.setArgument("b", "brief", "terse output when checking PDFs. The full PDF DOM tree is NOT output.", false);
     sarge.setArgument("c", "checkdva", "Adobe DVA formal-rep PDF file to compare against Arlington PDF model.", true);
@@ -206,8 +162,9 @@ int main(int argc, char* argv[]) {
     sarge.setArgument("m", "batchmode", "stop popup error dialog windows and redirect everything to console (Windows only, includes memory leak reports).", false);
     sarge.setArgument("o", "out", "output file or folder. Default is stdout. See --clobber for overwriting behavior.", true);
     sarge.setArgument("p", "pdf", "input PDF file, folder, or text file of PDF files/folders.", true);
-    sarge.setArgument("f", "force", "force the PDF version to the specified value (1,0, 1.1, ..., 2.0 or 'exact'). Only applicable to --pdf.", true);
-    sarge.setArgument("t", "tsvdir", "[required] folder containing Arlington PDF model TSV file set.", true);
+    sarge.setArgument("f", "force", "force the PDF version to the specified value (1,0, 1.1, ..., 2.0, 'exact' or 'all' for a verdict per PDF version). Only applicable to --pdf.", true);
+    sarge.setArgument("t", "tsvdir", "[required] folder containing Arlington PDF model TSV file set, or a compiled grammar file (see --compile).", true);
+    sarge.setArgument("",  "compile", "compile the Arlington PDF model TSV file set (--tsvdir) into a single binary grammar file that can then be used as --tsvdir.", true);
     sarge.setArgument("v", "validate", "validate the Arlington PDF model.", false);
     sarge.setArgument("e", "extensions", "a comma-separated list of extensions, or '*' for all extensions.", true);
     sarge.setArgument("",  "password", "password. Only applicable to --pdf.", true);
@@ -215,6 +172,11 @@ int main(int argc, char* argv[]) {
     sarge.setArgument("",  "dryrun", "Dry run - don't do any actual processing.", false);
     sarge.setArgument("a", "allfiles", "Process all files regardless of file extension.", false);
     sarge.setArgument("",  "explicit-values-only", "Ignore wildcards in PossibleValues.", false);
+    sarge.setArgument("j", "jobs", "number of PDF files to check concurrently (0 = number of CPU cores). Default is 1. Only applicable to --pdf. With stdout or a single output file, at most 4*N reports are held in memory to keep input order.", true);
+    sarge.setArgument("",  "traversal", "PDF DOM traversal order: 'bfs' (breadth-first) or 'dfs' (depth-first). Default is bfs. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "max-memory", "ceiling in MB on memory for queued PDF objects per PDF (0 = unlimited). When exceeded, bfs switches to dfs, which can change the Link that an object referenced from several places is validated against (and so the messages). Default is 0. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "format", "report format: 'text', 'jsonl' (JSON Lines) or 'binary'. Default is text. Only applicable to --pdf.", true);
+    sarge.setArgument("",  "stats", "report profiling statistics (time per Arlington TSV and predicate, PDF SDK calls, peak queue) for each PDF. Only applicable to --pdf.", false);
 
 #if defined(_WIN32) || defined(WIN32)
     if (!sarge.parseArguments(argc, mbcsargv)) {
@@ -251,7 +213,8 @@ int main(int argc, char* argv[]) {
 
     int             retval = 0;         // final return code to O/S
     std::string     s;                  // temp variable
-    fs::path        grammar_folder;     // folder with TSV files (required and must exist)
+    fs::path        grammar_folder;     // folder with TSV files or compiled grammar file (required and must exist)
+    bool            grammar_is_compiled = false; // true iff grammar_folder is a compiled grammar file
     fs::path        save_path;          // output file or folder. Optional. Default is "." or to stdout
     bool            save_file_is_folder = false; // true iff save_path is an existing folder
     bool            save_file_is_file   = false; // true iff save_path is a file in an existing folder (will not mkdir!)
@@ -266,11 +229,17 @@ int main(int argc, char* argv[]) {
     bool            terse = sarge.exists("brief");
     bool            dryrun = sarge.exists("dryrun");
     bool            all_files = sarge.exists("allfiles");
+    bool            show_stats = sarge.exists("stats");
     std::vector<std::string> supported_extns;       // --extensions
     bool            exclude_as_string = false;      // --exclude
     fs::path        exclusion_filename;             // --exclude
     std::vector<std::string> exclusions;            // --exclude
     unsigned int    count = 0;                      // number of files processed
+    unsigned int    num_jobs = 1;                   // --jobs
+    bool            depth_first = false;            // --traversal
+    size_t          max_memory = 0;                 // --max-memory (in bytes)
+    ArlOutputFormat output_format = ArlOutputFormat::Text; // --format
+    std::vector<pdf_job> jobs;                      // --pdf files to process (incl. exclusions)
 
 
     // Set globals (yuck, but very convenient)
@@ -303,13 +272,38 @@ int main(int argc, char* argv[]) {
         pdf_io.shutdown();
         return -1;
     }
-    if (!is_folder(s)) {
-        std::cerr << COLOR_ERROR << "-t/--tsvdir \"" << s << "\" is not a valid folder!" << COLOR_RESET;
+    if (!is_folder(s) && !is_file(s)) {
+        std::cerr << COLOR_ERROR << "-t/--tsvdir \"" << s << "\" is not a valid folder or compiled grammar file!" << COLOR_RESET;
         sarge.printHelp();
         pdf_io.shutdown();
         return -1;
     }
     grammar_folder = fs::absolute(s).lexically_normal();
+    grammar_is_compiled = is_file(grammar_folder);
+    if (grammar_is_compiled) {
+        fs::path source_folder;
+        switch (check_grammar_image(grammar_folder, source_folder)) {
+            case ArlGrammarImageStatus::NotAnImage:
+                std::cerr << COLOR_ERROR << "-t/--tsvdir \"" << s << "\" is not a compiled grammar file!" << COLOR_RESET;
+                pdf_io.shutdown();
+                return -1;
+            case ArlGrammarImageStatus::WrongVersion:
+                std::cerr << COLOR_ERROR << "-t/--tsvdir \"" << s << "\" was compiled by a different version of TestGrammar - recompile with --compile!" << COLOR_RESET;
+                pdf_io.shutdown();
+                return -1;
+            case ArlGrammarImageStatus::Corrupt:
+                std::cerr << COLOR_ERROR << "-t/--tsvdir \"" << s << "\" is a corrupt compiled grammar file - recompile with --compile!" << COLOR_RESET;
+                pdf_io.shutdown();
+                return -1;
+            case ArlGrammarImageStatus::Stale:
+                std::cerr << COLOR_ERROR << "-t/--tsvdir \"" << s << "\" is out of date with TSV files in " << source_folder << " - recompile with --compile!" << COLOR_RESET;
+                pdf_io.shutdown();
+                return -1;
+            case ArlGrammarImageStatus::SourceMissing:
+            case ArlGrammarImageStatus::OK:
+                break;
+        }
+    }
 
     // --out can be a folder or a file
     s.clear();
@@ -365,8 +359,8 @@ int main(int argc, char* argv[]) {
 
     // Optional -f/--force <version>
     if (sarge.getFlag("force", s)) {
-        if (!FindInVector(v_ArlPDFVersions, s) && (s != "exact")) {
-            std::cerr << COLOR_ERROR << "-f/--force PDF version '" << s << "' is not valid! Needs to be '1.0', '1.1', ..., '1.7', '2.0' or 'exact'." << COLOR_RESET;
+        if (!FindInVector(v_ArlPDFVersions, s) && (s != "exact") && (s != "all")) {
+            std::cerr << COLOR_ERROR << "-f/--force PDF version '" << s << "' is not valid! Needs to be '1.0', '1.1', ..., '1.7', '2.0', 'exact' or 'all'." << COLOR_RESET;
             sarge.printHelp();
             pdf_io.shutdown();
             return -1;
@@ -412,12 +406,70 @@ int main(int argc, char* argv[]) {
             }
         }
 
+    // Optional -j/--jobs <n>
+    if (sarge.getFlag("jobs", s)) {
+        try {
+            int n = std::stoi(s);
+            if (n < 0)
+                throw std::out_of_range(s);
+            num_jobs = (n == 0) ? std::max(1u, std::thread::hardware_concurrency()) : (unsigned int)n;
+        }
+        catch (...) {
+            std::cerr << COLOR_ERROR << "-j/--jobs '" << s << "' is not valid! Needs to be a non-negative integer." << COLOR_RESET;
+            sarge.printHelp();
+            pdf_io.shutdown();
+            return -1;
+        }
+    }
+
+    // Optional --traversal bfs|dfs
+    if (sarge.getFlag("traversal", s)) {
+        if ((s == "dfs") || (s == "DFS"))
+            depth_first = true;
+        else if ((s != "bfs") && (s != "BFS")) {
+            std::cerr << COLOR_ERROR << "--traversal '" << s << "' is not valid! Needs to be 'bfs' or 'dfs'." << COLOR_RESET;
+            sarge.printHelp();
+            pdf_io.shutdown();
+            return -1;
+        }
+    }
+
+    // Optional --max-memory <MB>
+    if (sarge.getFlag("max-memory", s)) {
+        try {
+            int n = std::stoi(s);
+            if (n < 0)
+                throw std::out_of_range(s);
+            max_memory = (size_t)n * 1024 * 1024;
+        }
+        catch (...) {
+            std::cerr << COLOR_ERROR << "--max-memory '" << s << "' is not valid! Needs to be a non-negative integer (MB)." << COLOR_RESET;
+            sarge.printHelp();
+            pdf_io.shutdown();
+            return -1;
+        }
+    }
+
+    // Optional --format text|jsonl|binary
+    if (sarge.getFlag("format", s)) {
+        if (s == "jsonl")
+            output_format = ArlOutputFormat::JSONLines;
+        else if (s == "binary")
+            output_format = ArlOutputFormat::Binary;
+        else if (s != "text") {
+            std::cerr << COLOR_ERROR << "--format '" << s << "' is not valid! Needs to be 'text', 'jsonl' or 'binary'." << COLOR_RESET;
+            sarge.printHelp();
+            pdf_io.shutdown();
+            return -1;
+        }
+    }
+
     // Dump all the processed command line options to screen (stdout)
     if (debug_mode) {
         std::cout << COLOR_RESET_NO_EOL;
         std::cout << "TestGrammar version:  " << TestGrammar_VERSION << std::endl;
         std::cout << "PDF SDK:              " << pdf_io.get_version_string() << std::endl;
-        std::cout << "Arlington TSV folder: " << grammar_folder << std::endl;
+        std::cout << (grammar_is_compiled ? "Arlington grammar:    " : "Arlington TSV folder: ") << grammar_folder << std::endl;
         if (save_path.empty())
             std::cout << "Output:               stdout" << std::endl;
         else
@@ -439,6 +491,14 @@ int main(int argc, char* argv[]) {
         std::cout << "Dry run:              " << (dryrun ? "on" : "off") << std::endl;
         std::cout << "All files:            " << (all_files ? "on (*.* wildcard)" : "off  (*.pdf only)") << std::endl;
         std::cout << "Brief mode:           " << (terse ? "on" : "off") << std::endl;
+        std::cout << "Jobs:                 " << num_jobs << std::endl;
+        std::cout << "Report format:        " << ((output_format == ArlOutputFormat::JSONLines) ? "JSON Lines" : ((output_format == ArlOutputFormat::Binary) ? "binary" : "text")) << std::endl;
+        std::cout << "Statistics:           " << (show_stats ? "on" : "off") << std::endl;
+        std::cout << "Traversal:            " << (depth_first ? "depth-first" : "breadth-first") << std::endl;
+        if (max_memory == 0)
+            std::cout << "Max memory:           unlimited" << std::endl;
+        else
+            std::cout << "Max memory:           " << (max_memory / (1024 * 1024)) << " MB" << std::endl;
         if (pdf_password.size() == 0)
             std::cout << "Password:             <none>" << std::endl;
         else
@@ -475,6 +535,34 @@ int main(int argc, char* argv[]) {
         std::cout << std::endl;
     }
 
+    // Compile the Arlington PDF grammar into a single binary file?
+    if (sarge.getFlag("compile", s)) {
+        if (grammar_is_compiled) {
+            std::cerr << COLOR_ERROR << "--compile requires -t/--tsvdir to be a folder of TSV files!" << COLOR_RESET;
+            pdf_io.shutdown();
+            return -1;
+        }
+        fs::path image_file = fs::absolute(s).lexically_normal();
+        if (!dryrun) {
+            CArlingtonGrammar grammar(grammar_folder);
+            if (!grammar.write_image(image_file)) {
+                std::cerr << COLOR_ERROR << "could not write compiled grammar file " << image_file << "!" << COLOR_RESET;
+                pdf_io.shutdown();
+                return -1;
+            }
+        }
+        std::cout << "Compiled " << grammar_folder << " to " << image_file << std::endl;
+        pdf_io.shutdown();
+        return 0;
+    }
+
+    // --validate and --checkdva process the TSV files themselves
+    if (grammar_is_compiled && (sarge.exists("validate") || sarge.exists("checkdva"))) {
+        std::cerr << COLOR_ERROR << "--validate and --checkdva require -t/--tsvdir to be a folder of TSV files!" << COLOR_RESET;
+        pdf_io.shutdown();
+        return -1;
+    }
+
     // Validate the Arlington PDF grammar itself?
     if (sarge.exists("validate")) {
         if (!save_path.empty()) {
@@ -529,7 +617,27 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
+    // Report filename extension and open mode
+    std::string             rpt_extn = (no_color ? ".txt" : ".ansi");
+    std::ios_base::openmode rpt_mode = std::ofstream::out;
+    if (output_format == ArlOutputFormat::JSONLines)
+        rpt_extn = ".jsonl";
+    else if (output_format == ArlOutputFormat::Binary) {
+        rpt_extn = ".bin";
+        rpt_mode |= std::ofstream::binary;
+#if defined(_WIN32) || defined(WIN32)
+        if (save_path.empty())
+            (void)_setmode(_fileno(stdout), _O_BINARY); // no CR-LF translation of binary reports to stdout
+#endif
+    }
+
+    // Keep machine-readable reports on stdout clean by sending progress messages to stderr
+    std::ostream& console = ((output_format != ArlOutputFormat::Text) && save_path.empty()) ? std::cerr : std::cout;
+
     try {
+        // Phase 1: collect all the PDF files and resolve their report filenames in input order
+        std::map<fs::path, size_t>  reserved_rptfiles;  // report filename --> index into jobs
+
         for (auto& input_file : input_list) {
             fs::recursive_directory_iterator dir_iter;
             fs::directory_entry              entry;
@@ -555,31 +663,6 @@ int main(int argc, char* argv[]) {
             try {
                 do {
                     if (entry.is_regular_file() && (all_files || iequals(entry.path().extension().string(), ".pdf"))) {
-                        fs::path  rptfile;
-                        if (!save_path.empty()) {
-                            if (save_file_is_folder) {
-                                rptfile = save_path / entry.path().stem();
-                                if (no_color)
-                                    rptfile.replace_extension(".txt");  // change .pdf to .txt for uncolorized output
-                                else
-                                    rptfile.replace_extension(".ansi"); // change .pdf to .ansi if colorized output
-                                if (!clobber) {
-                                    // if rptfile already exists then try a different filename by continuously appending underscores...
-                                    while (fs::exists(rptfile)) {
-                                        rptfile.replace_filename(rptfile.stem().string() + "_");
-                                        if (no_color)
-                                            rptfile.replace_extension(".txt");  // change .pdf to .txt for uncolorized output
-                                        else
-                                            rptfile.replace_extension(".ansi"); // change .pdf to .ansi if colorized output
-                                    }
-                                }
-                                rptfile = fs::absolute(rptfile).lexically_normal();
-                            }
-                            else { // save_file_is_file
-                                rptfile = fs::absolute(save_path).lexically_normal();
-                            }
-                        }
-
                         bool exclude_for_processing = false;
                         for (auto& excl : exclusions) {
                             s = entry.path().lexically_normal().string();
@@ -599,36 +682,44 @@ int main(int argc, char* argv[]) {
                                         exclude_for_processing = true;
                                     }
                                 }
-                                catch (...) { // const std::regex_error& e 
+                                catch (...) { // const std::regex_error& e
                                     // ignore all exceptions from regex creation and process PDF file
                                 }
                             }
                         } // for
 
-                        if (!exclude_for_processing) {
-                            std::cout << "Processing " << entry.path().lexically_normal() << " to ";
-                            if (rptfile.empty())
-                                std::cout << "stdout ";
-                            else {
-                                std::cout << rptfile << ((is_folder && !clobber) ? " (appended) " : " ");
-                                ofs.open(rptfile, std::ofstream::out | ((is_folder && !clobber) ? std::ofstream::app : std::ofstream::trunc));
-                            }
-                            count++;
-                            if (!dryrun)
-                                if (!process_single_pdf(entry.path().lexically_normal(), grammar_folder, pdf_io, (rptfile.empty() ? std::cout : ofs) , terse, debug_mode, force_version, supported_extns, pdf_password)) {
-                                    std::cout << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
-                                    retval = -1;
+                        pdf_job job(entry.path().lexically_normal(), exclude_for_processing);
+                        if (!exclude_for_processing && !save_path.empty()) {
+                            if (save_file_is_folder) {
+                                job.rptfile = save_path / entry.path().stem();
+                                job.rptfile.replace_extension(rpt_extn);    // change .pdf to .txt, .ansi, .jsonl or .bin
+                                if (!clobber) {
+                                    // if rptfile already exists (or will be created by an earlier job) then try a
+                                    // different filename by continuously appending underscores...
+                                    while (fs::exists(job.rptfile) || (reserved_rptfiles.count(job.rptfile) > 0)) {
+                                        job.rptfile.replace_filename(job.rptfile.stem().string() + "_");
+                                        job.rptfile.replace_extension(rpt_extn);
+                                    }
                                 }
-                            if (!rptfile.empty())
-                                ofs.close();
-                        }
-                        else {
-                            std::cout << COLOR_INFO << "Excluded " << entry.path().lexically_normal() << COLOR_RESET_NO_EOL;
+                                job.rptfile = fs::absolute(job.rptfile).lexically_normal();
+
+                                // --clobber: an earlier job with the same report filename gets overwritten
+                                auto earlier = reserved_rptfiles.find(job.rptfile);
+                                if (earlier != reserved_rptfiles.end())
+                                    jobs[earlier->second].superseded = true;
+                                reserved_rptfiles[job.rptfile] = jobs.size();
+                            }
+                            else { // save_file_is_file
+                                job.rptfile = fs::absolute(save_path).lexically_normal();
+                            }
+                            job.append = (is_folder && !clobber);
                         }
-                        std::cout << std::endl;
+                        if (!exclude_for_processing)
+                            count++;
+                        jobs.push_back(job);
                     }
                     else if (!entry.exists()) {
-                        std::cout << COLOR_ERROR << "Invalid PDF file/folder " << entry.path().lexically_normal() << COLOR_RESET;
+                        console << COLOR_ERROR << "Invalid PDF file/folder " << entry.path().lexically_normal() << COLOR_RESET;
                     }
 
                     if (is_folder) {
@@ -642,7 +733,158 @@ int main(int argc, char* argv[]) {
                 std::cerr << std::endl << COLOR_ERROR << "EXCEPTION " << e.what() << COLOR_RESET;
             }
         }
-        std::cout << "DONE - " << count << " files processed" << std::endl;
+
+        // Phase 2: process each PDF file
+        if (save_file_is_file) {
+            // All reports go to the same file so only open once (sequential and parallel alike)
+            auto first = std::find_if(jobs.begin(), jobs.end(), [](const pdf_job& j) { return !j.excluded; });
+            bool append = (first != jobs.end()) && first->append;
+            ofs.open(save_path, rpt_mode | (append ? std::ofstream::app : std::ofstream::trunc));
+        }
+
+        if ((num_jobs <= 1) || (jobs.size() <= 1)) {
+            for (auto& job : jobs) {
+                if (!job.excluded) {
+                    console << "Processing " << job.pdf_file << " to ";
+                    if (job.rptfile.empty())
+                        console << "stdout ";
+                    else {
+                        console << job.rptfile << (job.append ? " (appended) " : " ");
+                        if (save_file_is_folder && !job.superseded)
+                            ofs.open(job.rptfile, rpt_mode | (job.append ? std::ofstream::app : std::ofstream::trunc));
+                    }
+                    if (!dryrun)
+                        if (!process_single_pdf(job.pdf_file, grammar_folder, pdf_io, (job.rptfile.empty() ? std::cout : (job.superseded ? cnull : ofs)), terse, debug_mode, force_version, supported_extns, pdf_password, depth_first, max_memory, output_format, show_stats)) {
+                            console << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
+                            retval = -1;
+                        }
+                    if (save_file_is_folder && ofs.is_open())
+                        ofs.close();
+                }
+                else {
+                    console << COLOR_INFO << "Excluded " << job.pdf_file << COLOR_RESET_NO_EOL;
+                }
+                console << std::endl;
+            }
+        }
+        else {
+            // Each worker thread has its own PDF SDK context and its own report stream per PDF file.
+            // Reports to stdout or to the single --out file (opened once above), and all console messages,
+            // are buffered and then output in input order so that output is identical to a sequential run.
+            // Buffered reports are limited by not starting a PDF file too far ahead of the oldest unfinished one.
+            std::atomic<size_t>         next_job(0);
+            std::mutex                  output_mutex;
+            std::condition_variable     output_done;
+            const size_t                lookahead = ArlJobsLookahead * num_jobs;
+            size_t                      next_output = 0;
+            std::vector<bool>           finished(jobs.size(), false);
+            std::vector<std::string>    console_msgs(jobs.size());
+            std::vector<std::string>    reports(jobs.size());
+            const size_t                num_workers = std::min<size_t>(num_jobs, jobs.size());
+            size_t                      workers_initialized = 0;
+            bool                        init_failed = false;
+
+            auto worker = [&]() {
+                ArlingtonPDFSDK worker_sdk;     // per-thread PDF SDK context
+                bool            sdk_ok = true;
+                try {
+                    worker_sdk.initialize();
+                }
+                catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(output_mutex);
+                    std::cerr << COLOR_ERROR << "EXCEPTION " << e.what() << COLOR_RESET;
+                    sdk_ok = false;
+                }
+
+                // No PDF file is started until every worker has a PDF SDK context, so that
+                // a failure cannot silently leave PDF files unprocessed
+                {
+                    std::unique_lock<std::mutex> lock(output_mutex);
+                    if (!sdk_ok)
+                        init_failed = true;
+                    if (++workers_initialized == num_workers)
+                        output_done.notify_all();
+                    else
+                        output_done.wait(lock, [&]() { return workers_initialized == num_workers; });
+                    if (init_failed) {
+                        lock.unlock();
+                        if (sdk_ok)
+                            worker_sdk.shutdown();
+                        return;
+                    }
+                }
+
+                size_t i;
+                while ((i = next_job++) < jobs.size()) {
+                    if (!save_file_is_folder) {
+                        // The job at next_output is already running so this always makes progress
+                        std::unique_lock<std::mutex> lock(output_mutex);
+                        output_done.wait(lock, [&]() { return i < next_output + lookahead; });
+                    }
+
+                    const pdf_job&      job = jobs[i];
+                    std::ostringstream  msg;
+                    std::ostringstream  rpt;
+                    bool                ok = true;
+
+                    if (!job.excluded) {
+                        msg << "Processing " << job.pdf_file << " to ";
+                        if (job.rptfile.empty())
+                            msg << "stdout ";
+                        else
+                            msg << job.rptfile << (job.append ? " (appended) " : " ");
+
+                        if (save_file_is_folder && !job.superseded) {
+                            std::ofstream rpt_ofs(job.rptfile, rpt_mode | (job.append ? std::ofstream::app : std::ofstream::trunc));
+                            if (!dryrun)
+                                ok = process_single_pdf(job.pdf_file, grammar_folder, worker_sdk, rpt_ofs, terse, debug_mode, force_version, supported_extns, pdf_password, depth_first, max_memory, output_format, show_stats);
+                        }
+                        else if (!dryrun)
+                            ok = process_single_pdf(job.pdf_file, grammar_folder, worker_sdk, (job.superseded ? cnull : rpt), terse, debug_mode, force_version, supported_extns, pdf_password, depth_first, max_memory, output_format, show_stats);
+
+                        if (!ok)
+                            msg << COLOR_ERROR << "- FATAL ERROR!" << COLOR_RESET_NO_EOL;
+                    }
+                    else {
+                        msg << COLOR_INFO << "Excluded " << job.pdf_file << COLOR_RESET_NO_EOL;
+                    }
+
+                    std::unique_lock<std::mutex> lock(output_mutex);
+                    if (!ok)
+                        retval = -1;
+                    console_msgs[i] = msg.str();
+                    reports[i] = rpt.str();
+                    finished[i] = true;
+                    // Output everything that is now complete in input order
+                    while ((next_output < jobs.size()) && finished[next_output]) {
+                        if (save_file_is_file) {
+                            ofs << reports[next_output];
+                            console << console_msgs[next_output];
+                        }
+                        else {
+                            console << console_msgs[next_output];
+                            std::cout << reports[next_output];
+                        }
+                        console << std::endl;
+                        console_msgs[next_output].clear();
+                        reports[next_output].clear();
+                        next_output++;
+                    }
+                    lock.unlock();
+                    output_done.notify_all();
+                }
+                worker_sdk.shutdown();
+            };
+
+            std::vector<std::thread> workers;
+            for (size_t w = 0; w < num_workers; w++)
+                workers.emplace_back(worker);
+            for (auto& w : workers)
+                w.join();
+            if (init_failed)
+                throw std::runtime_error("could not initialize the PDF SDK for every --jobs worker - no PDF files were processed");
+        }
+        console << "DONE - " << count << " files processed" << std::endl;
     }
     catch (const std::exception& e) {
         retval = -1;
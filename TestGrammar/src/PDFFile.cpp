@@ -24,12 +24,11 @@
 #include "PDFFile.h"
 #include "ArlingtonPDFShim.h"
 #include "ArlPredicates.h"
-#include "LRParsePredicate.h"
 #include "utils.h"
 
 #include <cassert>
 #include <vector>
-#include <set>
+#include <unordered_set>
 #include <limits>
 #include <climits>
 #include <bitset>
@@ -46,13 +45,15 @@ namespace fs = std::filesystem;
 
 
 /// @brief Constructor. Calculates some details about the PDF file
-CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns)
-    : pdf_filename(pdf_file), pdfsdk(pdf_sdk), trailer_size(INT_MAX),
-      latest_feature_version("1.0"), deprecated(false), fully_implemented(true), exact_version_compare(false)
+CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns, ArlStats* run_stats)
+    : pdf_filename(pdf_file), pdfsdk(pdf_sdk), stats(run_stats), trailer_size(INT_MAX),
+      latest_feature_version("1.0"), deprecated(false), fully_implemented(true), exact_version_compare(false), all_versions(false)
 {
     if (forced_ver.size() > 0) {
         if (forced_ver == "exact")
             exact_version_compare = true;
+        else if (forced_ver == "all")
+            exact_version_compare = all_versions = true;
         else
             forced_version = forced_ver;
     }
@@ -69,8 +70,8 @@ CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std
     auto trailer = pdfsdk.get_trailer();
     if (trailer != nullptr) {
         // Get the trailer Size key
-        if (trailer->has_key(L"Size")) {
-            ArlPDFObject* sz = trailer->get_value(L"Size");
+        if (trailer->has_key("Size")) {
+            ArlPDFObject* sz = trailer->get_value("Size");
             if (sz != nullptr) {
                 if (((sz->get_object_type() == PDFObjectType::ArlPDFObjTypeNumber)) && ((ArlPDFNumber*)sz)->is_integer_value()) {
                     trailer_size = ((ArlPDFNumber*)sz)->get_integer_value();
@@ -82,7 +83,7 @@ CPDFFile::CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std
         // Get the Document Catalog Version, if it exists. No sanity checking is done.
         {
             auto doccat = pdfsdk.get_document_catalog();
-            ArlPDFObject* doc_cat_ver_obj = doccat->get_value(L"Version");
+            ArlPDFObject* doc_cat_ver_obj = doccat->get_value("Version");
 
             if (doc_cat_ver_obj != nullptr) {
                 if (doc_cat_ver_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeName) {
@@ -145,28 +146,29 @@ ArlPDFObject* CPDFFile::get_object_for_path(ArlPDFObject* container, const std::
     assert(container != nullptr);
     assert(arlpath.size() > 0);
 
-    std::vector<std::string> path = arlpath;
     ArlPDFObject*            obj = container;
     bool                     delete_obj = false;
     PDFObjectType            obj_type;
+    size_t                   i = 0;             // current portion of the path (not copied or erased)
 
-    auto path_len = path.size();
-    if (path[path_len - 1][0] == '@')           // Remove any '@' from last portion so it reverts to a key name / array index
-        path[path_len - 1] = path[path_len - 1].substr(1);
+    const size_t path_len = arlpath.size();
+    std::string  last_key = arlpath[path_len - 1];
+    if (last_key[0] == '@')                     // Remove any '@' from last portion so it reverts to a key name / array index
+        last_key = last_key.substr(1);
 
     // some special case handling
-    if ((path_len >= 2) && (path[0] == "trailer") && (path[1] == "Catalog")) {
+    if ((path_len >= 2) && (arlpath[0] == "trailer") && (arlpath[1] == "Catalog")) {
         obj = pdfsdk.get_document_catalog();
-        path.erase(path.begin());
-        path.erase(path.begin());
+        i = 2;
     }
-    else if ((path_len >= 1) && (path[0] == "trailer")) {
+    else if ((path_len >= 1) && (arlpath[0] == "trailer")) {
         obj = pdfsdk.get_trailer();
-        path.erase(path.begin());
+        i = 1;
     }
 
     do {
-        if (path[0] == "parent") {
+        const std::string& key = (i == path_len - 1) ? last_key : arlpath[i];
+        if (key == "parent") {
             ///  @todo  "parent::key" or "parent::parent::key" is not supported...
             if (delete_obj) 
                 delete obj;
@@ -179,8 +181,8 @@ ArlPDFObject* CPDFFile::get_object_for_path(ArlPDFObject* container, const std::
             case PDFObjectType::ArlPDFObjTypeArray:
                 {
                     ArlPDFObject* a;
-                    if (path[0] != "*") {
-                        int idx = key_to_array_index(path[0]);
+                    if (key != "*") {
+                        int idx = key_to_array_index(key);
                         a = ((ArlPDFArray*)obj)->get_value(idx);
                     }
                     else
@@ -199,11 +201,11 @@ ArlPDFObject* CPDFFile::get_object_for_path(ArlPDFObject* container, const std::
             case PDFObjectType::ArlPDFObjTypeDictionary:
                 {
                     ArlPDFObject* a;
-                    if (path[0] != "*")
-                        a = ((ArlPDFDictionary*)obj)->get_value(ToWString(path[0]));
-                    else {
-                        auto key = ((ArlPDFDictionary*)obj)->get_key_name_by_index(0);
+                    if (key != "*")
                         a = ((ArlPDFDictionary*)obj)->get_value(key);
+                    else {
+                        auto first_key = ((ArlPDFDictionary*)obj)->get_key_name_by_index(0);
+                        a = ((ArlPDFDictionary*)obj)->get_value(first_key);
                     }
                     if (a == nullptr) {
                         if (delete_obj) 
@@ -221,11 +223,11 @@ ArlPDFObject* CPDFFile::get_object_for_path(ArlPDFObject* container, const std::
                     ArlPDFDictionary* dict = ((ArlPDFStream*)obj)->get_dictionary();
                     if (dict != nullptr) {
                         ArlPDFObject* a;
-                        if (path[0] != "*")
-                            a = dict->get_value(ToWString(path[0]));
-                        else {
-                            auto key = dict->get_key_name_by_index(0);
+                        if (key != "*")
                             a = dict->get_value(key);
+                        else {
+                            auto first_key = dict->get_key_name_by_index(0);
+                            a = dict->get_value(first_key);
                         }
                         delete dict;
                         if (delete_obj)
@@ -243,14 +245,137 @@ ArlPDFObject* CPDFFile::get_object_for_path(ArlPDFObject* container, const std::
                 return nullptr;
         } // switch
         assert(obj != nullptr);
-        path.erase(path.begin()); // remove the head off the path and iterate
-    } while (path.size() > 0);
+        i++; // move to the next portion of the path and iterate
+    } while (i < path_len);
 
     assert(delete_obj); // THIS WILL MAKE MEMORY MANAGEMENT REALLY BAD!!!
     return obj;
 }
 
 
+/// @brief Gets the dictionary-map or name/number tree root mentioned by a predicate argument
+/// such as trailer::Catalog::Names::Dests or a key in the container (e.g. fn:InKeyMap, fn:InNameTree).
+/// Sets fully_implemented to false for unsupported paths.
+///
+/// @param[in]   container   PDF container dictionary (for relative keys)
+/// @param[in]   keys        the Arlington path broken down as a vector
+///
+/// @returns   the object for the path (caller deletes) or nullptr if it doesn't exist
+ArlPDFObject* CPDFFile::get_map_for_path(ArlPDFDictionary* container, const std::vector<std::string>& keys) {
+    assert(container != nullptr);
+    assert(keys.size() > 0);
+    assert(keys[keys.size() - 1][0] != '@');    // Never "@key" as the final key
+
+    if (keys[0] == "parent") {                  /// @todo Don't support "parent::"
+        fully_implemented = false;
+        return nullptr;
+    }
+
+    ArlPDFObject* map_obj = nullptr;
+
+    if (keys[0] == "trailer") {
+        // Hardcoded support for trailer and trailer::Catalog as common
+        assert(keys.size() >= 3);
+        if (keys[1] == "Catalog") {
+            auto doccat = pdfsdk.get_document_catalog();
+            map_obj = doccat->get_value(keys[2]);
+            if ((map_obj != nullptr) && (keys.size() == 4) && (map_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
+                ArlPDFObject* o1 = ((ArlPDFDictionary*)map_obj)->get_value(keys[3]);
+                delete map_obj;
+                if ((o1 == nullptr) || (o1->get_object_type() != PDFObjectType::ArlPDFObjTypeDictionary)) {
+                    delete o1;
+                    return nullptr;
+                }
+                map_obj = o1;
+            }
+        }
+        else {
+            auto t = pdfsdk.get_trailer();
+            map_obj = t->get_value(keys[1]);
+        }
+    }
+    else if (keys.size() == 1) {
+        const std::string& k = keys[0];
+        if (container->has_key(k))
+            map_obj = container->get_value(k);
+    }
+    else {
+        /// @todo TBD
+        assert(false && "unexpected Arlington path::key expression for a map or tree!");
+        fully_implemented = false;
+    }
+    return map_obj;
+}
+
+
+/// @brief Gets the index of a name tree or number tree. Indexes of indirect tree roots
+/// are cached by object ID. Direct tree roots (e.g. in Catalog::Names) are only cached
+/// if an absolute Arlington path is provided, otherwise a new index is built.
+///
+/// @param[in]   root       root node of the tree
+/// @param[in]   t          type of tree
+/// @param[in]   arl_path   absolute Arlington path of root (trailer::...) or empty
+///
+/// @returns the tree index (never nullptr)
+std::shared_ptr<const CArlTreeIndex> CPDFFile::get_tree_index(ArlPDFDictionary* root, const ArlTreeType t, const std::string& arl_path) {
+    assert(root != nullptr);
+
+    std::string cache_key = (t == ArlTreeType::NameTree) ? "name:" : "number:";
+    if (root->get_object_number() > 0) {
+        object_id id = root->get_object_id();
+        cache_key += std::to_string(id.object_num) + " " + std::to_string(id.generation_num);
+    }
+    else if ((arl_path.size() > 0) && (arl_path.rfind("trailer", 0) == 0))
+        cache_key += arl_path;
+    else
+        return std::make_shared<const CArlTreeIndex>(root, t);
+
+    auto it = tree_indexes.find(cache_key);
+    if (it != tree_indexes.end())
+        return it->second;
+
+    auto idx = std::make_shared<const CArlTreeIndex>(root, t);
+    tree_indexes.emplace(cache_key, idx);
+    return idx;
+}
+
+
+/// @brief Gets the index of a name tree or number tree at an absolute Arlington path
+/// (e.g. trailer::Catalog::Names::Dests). The path is only resolved once per PDF file.
+///
+/// @param[in]   container  PDF container dictionary (see get_map_for_path())
+/// @param[in]   t          type of tree
+/// @param[in]   arl_path   absolute Arlington path of the tree root (trailer::...)
+///
+/// @returns the tree index or nullptr if there is no such tree
+std::shared_ptr<const CArlTreeIndex> CPDFFile::get_trailer_tree_index(ArlPDFDictionary* container, const ArlTreeType t, const std::string& arl_path) {
+    assert(container != nullptr);
+    assert(arl_path.rfind("trailer", 0) == 0);
+
+    std::string cache_key = ((t == ArlTreeType::NameTree) ? "name:" : "number:") + arl_path;
+    auto it = doc_facts.trailer_trees.find(cache_key);
+    if (it != doc_facts.trailer_trees.end())
+        return it->second;
+
+    std::shared_ptr<const CArlTreeIndex> idx;
+    ArlPDFObject* root = get_map_for_path(container, split_key_path(arl_path));
+    if ((root != nullptr) && (root->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary))
+        idx = get_tree_index((ArlPDFDictionary*)root, t, arl_path);
+    delete root;
+    doc_facts.trailer_trees.emplace(cache_key, idx);
+    return idx;
+}
+
+
+/// @brief Discards all cached document facts and tree indexes (which refer to PDF objects
+/// of this PDF file) and then closes the PDF file. No predicates can be executed afterwards.
+void CPDFFile::close_pdf() {
+    doc_facts = ArlDocFacts();
+    tree_indexes.clear();
+    pdfsdk.close_pdf();
+}
+
+
 /// @brief Convert an integer or double node to numeric representation.
 /// Internally throws and catches exceptions.
 /// 
@@ -275,579 +400,554 @@ double CPDFFile::convert_node_to_double(const ASTNode* node) {
 }
 
 
-/// @brief Processes an AST-Node by recursively descending and calculating the left and right predicates.
-/// Because keys referenced in predicates can be missing in a PDF this gets complicated...
+/// @brief Executes a compiled Arlington predicate (see ArlPredicateProgram.h). Instructions are in
+/// post-order so each instruction takes its (optional) arguments from the top of a value stack and
+/// replaces them with its result. The value stack is reused across predicates, and function names
+/// and operators were resolved when compiled, so there is no string dispatch or per-instruction
+/// heap allocation.
 /// 
+/// Because keys referenced in predicates can be missing in a PDF this gets complicated...
 /// If a key is not present in a PDF then an expression referencing that key (such as "@key" or fn:Predicate(key)) 
-/// cannot be determined. In this case nullptr is returned (as an ASTNode*) representing the indeterminate nature. 
-/// If the key IS present in the PDF then predicates, formulae, comparisons, etc.
-/// can be performed and a valid ASTNode* is returned. An obvious exception to this rule is fn:IsPresent() and there
-/// are a few others (e.g. numeric predicates such as fn:XxxLength() which will return -1 on such error).
+/// cannot be determined. In this case the value is indeterminate (a stack slot of type ASTNT_Unknown, passed to
+/// predicate functions as nullptr). If the key IS present in the PDF then predicates, formulae, comparisons, etc.
+/// can be performed. An obvious exception to this rule is fn:IsPresent() and there are a few others (e.g. numeric
+/// predicates such as fn:XxxLength() which will return -1 on such error).
 /// 
-/// When doing logical operators, a nullptr operand (meaning an indeterminate result) can be further processed by 
-/// evaluating the other half of the expression for OR (" || ") - there is NO short-circuit boolean evaluation here. 
+/// When doing logical operators, an indeterminate operand can be further processed by evaluating the other
+/// half of the expression for OR (" || ") - there is NO short-circuit boolean evaluation here. 
 /// But this is not possible with AND (" && ") since both sides need to exist. Mathematical operations and comparisons 
 /// also cannot be processed if either of the operands is indeterminate.
 /// 
-/// Optional arguments vs indeterminate arguments can be identified by examining in_ast->arg[x]. If it is nullptr
-/// then the optional argument was NOT present. If in_ast->arg[x] is not nullptr, but one or both of out_left or 
+/// Optional arguments vs indeterminate arguments can be identified by examining instr.has_arg[x]. If it is false
+/// then the optional argument was NOT present. If instr.has_arg[x] is true, but one or both of out_left or 
 /// out_right variables are nullptr then this indicates indeterminism.
 ///
 /// @param[in]  container        container PDF object (e.g. the dictionary which contains 'obj' as an entry or array as element)
 /// @param[in]  obj              PDF object related to the predicate. Never nullptr.
-/// @param[in]  in_ast           input AST tree. Never nullptr.
-/// @param[in]  tsv_data         the row of TSV data that is being processed
+/// @param[in]  prog             compiled predicate. Never empty.
 /// @param[in]  key_idx          the index into the Arlington 'Key' field of the TSV data (>=0)
-/// @param[in]  type_idx         the index into the Arlington 'Type' field of 'Key' field of the TSV data  (>=0)
-/// @param[in]  depth            depth counter for recursion (visual indentation) (>=0)
+/// @param[in]  tsv_data         the TSV data that is being processed (that prog was compiled for)
 /// @param[in]  use_default_values  true if Default Values should be used when a key-value (\@Key) is not present
+/// @param[out] result           the result (only when true is returned)
 /// 
-/// @returns   Output AST (always valid) or nullptr if indeterminate 
-ASTNode* CPDFFile::ProcessPredicate(ArlPDFObject* container, ArlPDFObject* obj, const ASTNode* in_ast, const int key_idx, const ArlTSVmatrix& tsv_data, const int type_idx, int depth, const bool use_default_values)
+/// @returns   true if result is valid, false if indeterminate 
+bool CPDFFile::ExecutePredicate(ArlPDFObject* container, ArlPDFObject* obj, const ArlPredicateProgram& prog, const int key_idx, const ArlTSVmatrix& tsv_data, const bool use_default_values, ASTNode& result)
 {
     assert(container != nullptr);
     assert(obj != nullptr);
-    assert(in_ast != nullptr);
-    assert(in_ast->valid());
+    assert(prog.code.size() > 0);
     assert(key_idx >= 0);
-    assert(type_idx >= 0);
 
-    ASTNode* out = new ASTNode;
-    ASTNode* out_left = nullptr;
-    ASTNode* out_right = nullptr;
+    // reset deprecation & implementation detection
+    fully_implemented = true;
+    deprecated = false; 
 
-#ifdef PP_AST_DEBUG
-    std::cout << std::string(depth * 2, ' ') << "In:  " << *in_ast << std::endl;
-#endif
+    if ((int)vm_stack.size() < prog.max_stack)
+        vm_stack.resize(prog.max_stack);
 
-    if (depth == 0) {
-        // reset deprecation & implementation detection at the start of possible recursion
-        fully_implemented = true;
-        deprecated = false; 
-    }
+    int sp = 0; // number of values on the stack
 
-    if (in_ast->arg[0] != nullptr) {
-        bool current_processing_state = fully_implemented;
-        fully_implemented = true;
-        out_left = ProcessPredicate(container, obj, in_ast->arg[0], key_idx, tsv_data, type_idx, depth + 1, use_default_values);
-        fully_implemented = current_processing_state && fully_implemented;
-#ifdef PP_AST_DEBUG
-        if (out_left != nullptr) { std::cout << std::string(depth * 2, ' ') << " Out-Left:  " << *out_left << std::endl; }
-        // Force calls to PDF SDK to make sure everything is OK
-        (void)obj->get_object_type();
-        (void)container->get_object_type();
-#endif 
-    }
+    for (const auto& instr : prog.code) {
+        // Arguments are the top 0, 1 or 2 values. Result is calculated in the next free slot.
+        const int   base = sp - (instr.has_arg[0] ? 1 : 0) - (instr.has_arg[1] ? 1 : 0);
+        assert(base >= 0);
+        assert(sp < prog.max_stack);
+        const ASTNode* out_left = nullptr;
+        const ASTNode* out_right = nullptr;
+        if (instr.has_arg[0] && (vm_stack[base].type != ASTNodeType::ASTNT_Unknown))
+            out_left = &vm_stack[base];
+        if (instr.has_arg[1]) {
+            const ASTNode& r = vm_stack[sp - 1];
+            if (r.type != ASTNodeType::ASTNT_Unknown)
+                out_right = &r;
+        }
+        ASTNode& out = vm_stack[sp];
+        out.type = ASTNodeType::ASTNT_Unknown; // indeterminate until calculated
 
-    if (in_ast->arg[1] != nullptr) {
-        bool current_processing_state = fully_implemented;
-        fully_implemented = true;
-        out_right = ProcessPredicate(container, obj, in_ast->arg[1], key_idx, tsv_data, type_idx, depth + 1, use_default_values);
-        fully_implemented = current_processing_state && fully_implemented;
 #ifdef PP_AST_DEBUG
-        if (out_right != nullptr) { std::cout << std::string(depth * 2, ' ') << " Out-Right:  " << *out_right << std::endl; }
+        std::cout << "In:  " << instr.value << std::endl;
+        if (out_left != nullptr) { std::cout << " Out-Left:  " << *out_left << std::endl; }
+        if (out_right != nullptr) { std::cout << " Out-Right:  " << *out_right << std::endl; }
         // Force calls to PDF SDK to make sure everything is OK
         (void)obj->get_object_type();
         (void)container->get_object_type();
 #endif 
-    }
 
-    switch (in_ast->type) {
-    case ASTNodeType::ASTNT_ConstPDFBoolean:
-    case ASTNodeType::ASTNT_ConstString:
-    case ASTNodeType::ASTNT_ConstInt:
-    case ASTNodeType::ASTNT_ConstNum:
-    case ASTNodeType::ASTNT_Key:
-        // Primitive type so out = in
-        out->type = in_ast->type;
-        out->node = in_ast->node;
-        break;
+        // --stats: time predicate functions (including their PDF SDK calls)
+        ArlStatsTimer fn_timer(((stats != nullptr) && (instr.opcode == ArlOpcode::ARLOP_Function)) ? &stats->fn[(int)instr.fn] : nullptr);
 
-    case ASTNodeType::ASTNT_Predicate:
-    {
-        // Predicates can take up to 2 arguments: out_left, out_right.
-        // If there is one argument only, then assert(out_right == nullptr)
-        // Arguments have been reduced by the recursion calls above, but in some
-        // cases (PDF file errors) ASTNodes might end up as nullptr.
-        // Assertions are used where this implementation assumes the current usage 
-        // of predicates in the current Arlington PDF model
-        //
-        //    grep -Po "fn:<predicate-name>\([^\t]*\)" *
-        //
-        if (in_ast->node == "fn:AlwaysUnencrypted(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = (fn_AlwaysUnencrypted(obj) ? "true" : "false");
-        }
-        else if (in_ast->node == "fn:ArrayLength(") {
-            // 1 argument: name of key (or an integer array index) which is an array, could be indeterminate
-            assert(out_right == nullptr);
-            int len = fn_ArrayLength(container, out_left);
-            if (len >= 0) {
-                // Valid length
-                out->type = ASTNodeType::ASTNT_ConstInt;
-                out->node = std::to_string(len);
-            }
-            else {
-                // Invalid length - most likely key not present...
-                delete out;
-                out = nullptr;
-            }
-        }
-        else if (in_ast->node == "fn:ArraySortAscending(") {
-            // 2 arguments: name of key key (or an integer array index) which is the array, step size
-            assert(out_left != nullptr);
-            assert(out_right != nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = (fn_ArraySortAscending(container, out_left, out_right) ? "true" : "false");
-        }
-        else if (in_ast->node == "fn:BeforeVersion(") {
-            // 1 or 2 args: version, and optionally thing that was introduced
-            delete out;
-            if (in_ast->arg[1] == nullptr)
-                out = fn_BeforeVersion(out_left);            // 1 argument version
-            else
-                out = fn_BeforeVersion(out_left, out_right); // 2 argument version - out_right might have reduced to nullptr
+        switch (instr.opcode) {
+        case ArlOpcode::ARLOP_Const:
+            // Primitive type so out = in. Also folded version predicates (see SpecializePredicate()).
+            out.type = instr.value.type;
+            out.node = instr.value.node;
+            if (instr.sets_deprecated)
+                deprecated = true;
+            break;
 
-        }
-        else if (in_ast->node == "fn:BitClear(") {
-            // 1 argument required: bit number 1-32. NEVER indeterminate.
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_BitClear(obj, out_left) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:BitSet(") {
-            // 1 argument required: bit number 1-32. NEVER indeterminate.
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_BitSet(obj, out_left) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:BitsClear(") {
-            // 2 arguments: low bit, high bit. NEVER indeterminate.
-            assert(out_left != nullptr);
-            assert(out_right != nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_BitsClear(obj, out_left, out_right) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:BitsSet(") {
-            // 2 arguments: low bit, high bit. NEVER indeterminate.
-            assert(out_left != nullptr);
-            assert(out_right != nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_BitsSet(obj, out_left, out_right) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:DefaultValue(") {
-            // 2 arguments: condition, what the default value should be when condition is true
-            // 2nd argument is never indeterminate.
-            delete out;
-            out = fn_DefaultValue(out_left, out_right);
-        }
-        else if (in_ast->node == "fn:Deprecated(") {
-            // 1 or 2 args: version, and optionally thing that was deprecated
-            delete out;
-            if (in_ast->arg[1] == nullptr)
-                out = fn_Deprecated(out_left);            // 1 argument version
-            else
-                out = fn_Deprecated(out_left, out_right); // 2 argument version - out_right might have reduced to nullptr
-        }
-        else if (in_ast->node == "fn:Eval(") {
-            // 1 argument, which is the reduced expression. Arg can be nullptr due to things such as missing keys
-            assert(out_right == nullptr);
-            // Just strip this off...
-            if (out_left != nullptr) {
-                out->type = out_left->type;
-                out->node = out_left->node;
-            }
-            else {
-                delete out;
-                out = nullptr;
-            }
-        }
-        else if (in_ast->node == "fn:Extension(") {
-            // 1 or 2 arguments: extension name (required), optional value (when used in fields except "SinceVersion")
-            delete out;
-            if (in_ast->arg[1] == nullptr)
-                out = fn_Extension(out_left);            // 1 argument version
-            else
-                out = fn_Extension(out_left, out_right); // 2 argument version - out_right might have reduced to nullptr
-        }
-        else if (in_ast->node == "fn:FileSize(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstInt;
-            out->node = std::to_string(fn_FileSize());
-        }
-        else if (in_ast->node == "fn:FontHasLatinChars(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_FontHasLatinChars(obj) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:HasProcessColorants(") {
-            // one argument - an array object of names
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_HasProcessColorants(container, out_left) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:HasSpotColorants(") {
-            // one argument - an array object of names
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_HasSpotColorants(container, out_left) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:Ignore(") {
-            /// @todo - implement ignoring things...
-            // 1 argument which is the condition for ignoring, which can be nullptr due to reduction/indeterminism
-            assert(out_right == nullptr);
-            // just reduce to true as we will still report issues
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = "true";
-        }
-        else if (in_ast->node == "fn:ImageIsStructContentItem(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_ImageIsStructContentItem(obj) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:ImplementationDependent(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            // just return true
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = "true";
-        }
-        else if (in_ast->node == "fn:InKeyMap(") {
-            // 1 argument which is the key of the dictionary map, which can be nullptr due to reduction/indeterminism
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_InKeyMap(container, obj, out_left) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:InNameTree(") {
-            // 1 argument which is the name-tree key, which can be nullptr due to reduction/indeterminism
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_InNameTree(container, obj, out_left) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:IsAssociatedFile(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_IsAssociatedFile(obj) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:IsEncryptedWrapper(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_IsEncryptedWrapper() ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:IsFieldName(") {
-            // one argument: key-value
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_IsFieldName(obj) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:IsHexString(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_IsHexString(obj) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:IsLastInNumberFormatArray(") {
-            // 1 argument which is the key name key (or an integer array index) of an array. COULD be indeterminate.
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_IsLastInArray(container, obj, out_left) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:IsMeaningful(") {
-            // 1 argument which is a condition under which something is "meaningful"
-            assert(out_right == nullptr);
-            // everything is meaningful when we are checking
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = "true";
-        }
-        else if (in_ast->node == "fn:IsPDFTagged(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_IsPDFTagged() ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:IsPDFVersion(") {
-            // 1 or 2 args: version, and optionally thing that was introduced
-            delete out;
-            if (in_ast->arg[1] == nullptr)
-                out = fn_IsPDFVersion(out_left);            // 1 argument version
-            else
-                out = fn_IsPDFVersion(out_left, out_right); // 2 argument version - out_right might have reduced to nullptr
-        }
-        else if (in_ast->node == "fn:IsPresent(") {
-            // Need to check in_ast->arg[] to see if 1 or 2 argument version first:
-            // If 1 argument: condition that has already been reduced to true/false, or a key name, or could be 
-            // nullptr/indeterminate (e.g. missing key in an expression). In that case the result is a boolean
-            // false.
-            // If 2 arguments: 2nd argument (condition) only applies if the 1st argument resolved to true. But due
-            // to missing keys the 1st argument could have resolved to nullptr in which case the result is a nullptr.
+        case ArlOpcode::ARLOP_Function:
+            // Predicates can take up to 2 arguments: out_left, out_right.
+            // If there is one argument only, then assert(out_right == nullptr)
+            // Arguments have been reduced by earlier instructions, but in some
+            // cases (PDF file errors) they might end up as nullptr.
+            // Assertions are used where this implementation assumes the current usage 
+            // of predicates in the current Arlington PDF model
             //
-            // Note that key names here can be integers (array index), wildcard '*' or integer+'*'!! 
-            if ((in_ast->arg[0] != nullptr) && (in_ast->arg[1] != nullptr)) {
-                // 2 argument version
-                bool l = false;
-                if (out_left != nullptr) {
-                    if ((out_left->type == ASTNodeType::ASTNT_Key) || (out_left->type == ASTNodeType::ASTNT_ConstInt))
-                        l = fn_IsPresent(container, out_left->node);
-                    else {
-                        // Was probably a condition...
-                        assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-                        l = (out_left->node == "true");
+            //    grep -Po "fn:<predicate-name>\([^\t]*\)" *
+            //
+            switch (instr.fn) {
+            case ArlPredicateFn::ARLFN_AlwaysUnencrypted:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = (fn_AlwaysUnencrypted(obj) ? "true" : "false");
+                break;
+
+            case ArlPredicateFn::ARLFN_ArrayLength:
+                {
+                    // 1 argument: name of key (or an integer array index) which is an array, could be indeterminate
+                    assert(out_right == nullptr);
+                    int len = fn_ArrayLength(container, out_left);
+                    if (len >= 0) {
+                        // Valid length
+                        out.type = ASTNodeType::ASTNT_ConstInt;
+                        out.node = std::to_string(len);
                     }
+                    // else invalid length - most likely key not present...
+                }
+                break;
+
+            case ArlPredicateFn::ARLFN_ArraySortAscending:
+                // 2 arguments: name of key key (or an integer array index) which is the array, step size
+                assert(out_left != nullptr);
+                assert(out_right != nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = (fn_ArraySortAscending(container, out_left, out_right) ? "true" : "false");
+                break;
+
+            case ArlPredicateFn::ARLFN_BeforeVersion:
+                // 1 or 2 args: version, and optionally thing that was introduced
+                if (!instr.has_arg[1])
+                    (void)fn_BeforeVersion(out_left, out);            // 1 argument version
+                else
+                    (void)fn_BeforeVersion(out_left, out_right, out); // 2 argument version - out_right might have reduced to nullptr
+                break;
+
+            case ArlPredicateFn::ARLFN_BitClear:
+                // 1 argument required: bit number 1-32. NEVER indeterminate.
+                assert(out_left != nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_BitClear(obj, out_left) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_BitSet:
+                // 1 argument required: bit number 1-32. NEVER indeterminate.
+                assert(out_left != nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_BitSet(obj, out_left) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_BitsClear:
+                // 2 arguments: low bit, high bit. NEVER indeterminate.
+                assert(out_left != nullptr);
+                assert(out_right != nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_BitsClear(obj, out_left, out_right) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_BitsSet:
+                // 2 arguments: low bit, high bit. NEVER indeterminate.
+                assert(out_left != nullptr);
+                assert(out_right != nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_BitsSet(obj, out_left, out_right) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_Contains:
+                // 2 arguments: key name or integer array index and a value, but either may have been reduced
+                if (out_left == nullptr)
+                    out_right = nullptr;
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_Contains(obj, out_left, out_right) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_DefaultValue:
+                // 2 arguments: condition, what the default value should be when condition is true
+                // 2nd argument is never indeterminate.
+                (void)fn_DefaultValue(out_left, out_right, out);
+                break;
+
+            case ArlPredicateFn::ARLFN_Deprecated:
+                // 1 or 2 args: version, and optionally thing that was deprecated
+                if (!instr.has_arg[1])
+                    (void)fn_Deprecated(out_left, out);            // 1 argument version
+                else
+                    (void)fn_Deprecated(out_left, out_right, out); // 2 argument version - out_right might have reduced to nullptr
+                break;
+
+            case ArlPredicateFn::ARLFN_Eval:
+                // 1 argument, which is the reduced expression. Arg can be nullptr due to things such as missing keys
+                assert(out_right == nullptr);
+                // Just strip this off...
+                if (out_left != nullptr) {
+                    out.type = out_left->type;
+                    out.node = out_left->node;
                 }
-                if (l) {
-                    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                    out->node = "false";
-                    if (out_right != nullptr) {
-                        assert(out_right->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-                        out->node = out_right->node;
+                break;
+
+            case ArlPredicateFn::ARLFN_Extension:
+                // 1 or 2 arguments: extension name (required), optional value (when used in fields except "SinceVersion")
+                if (!instr.has_arg[1])
+                    (void)fn_Extension(out_left, out);            // 1 argument version
+                else
+                    (void)fn_Extension(out_left, out_right, out); // 2 argument version - out_right might have reduced to nullptr
+                break;
+
+            case ArlPredicateFn::ARLFN_FileSize:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstInt;
+                out.node = std::to_string(fn_FileSize());
+                break;
+
+            case ArlPredicateFn::ARLFN_FontHasLatinChars:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_FontHasLatinChars(obj) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_HasProcessColorants:
+                // one argument - an array object of names
+                assert(out_left != nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_HasProcessColorants(container, out_left) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_HasSpotColorants:
+                // one argument - an array object of names
+                assert(out_left != nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_HasSpotColorants(container, out_left) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_Ignore:
+                /// @todo - implement ignoring things...
+                // 1 argument which is the condition for ignoring, which can be nullptr due to reduction/indeterminism
+                assert(out_right == nullptr);
+                // just reduce to true as we will still report issues
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = "true";
+                break;
+
+            case ArlPredicateFn::ARLFN_ImageIsStructContentItem:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_ImageIsStructContentItem(obj) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_ImplementationDependent:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                // just return true
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = "true";
+                break;
+
+            case ArlPredicateFn::ARLFN_InKeyMap:
+                // 1 argument which is the key of the dictionary map, which can be nullptr due to reduction/indeterminism
+                assert(out_left != nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_InKeyMap(container, obj, out_left) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_InNameTree:
+                // 1 argument which is the name-tree key, which can be nullptr due to reduction/indeterminism
+                assert(out_left != nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_InNameTree(container, obj, out_left) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsAssociatedFile:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_IsAssociatedFile(obj) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsEncryptedWrapper:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_IsEncryptedWrapper() ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsFieldName:
+                // one argument: key-value
+                assert(out_left != nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_IsFieldName(obj) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsHexString:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_IsHexString(obj) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsLastInNumberFormatArray:
+                // 1 argument which is the key name key (or an integer array index) of an array. COULD be indeterminate.
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_IsLastInArray(container, obj, out_left) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsMeaningful:
+                // 1 argument which is a condition under which something is "meaningful"
+                assert(out_right == nullptr);
+                // everything is meaningful when we are checking
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = "true";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsPDFTagged:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_IsPDFTagged() ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsPDFVersion:
+                // 1 or 2 args: version, and optionally thing that was introduced
+                if (!instr.has_arg[1])
+                    (void)fn_IsPDFVersion(out_left, out);            // 1 argument version
+                else
+                    (void)fn_IsPDFVersion(out_left, out_right, out); // 2 argument version - out_right might have reduced to nullptr
+                break;
+
+            case ArlPredicateFn::ARLFN_IsPresent:
+                // Need to check instr.has_arg[] to see if 1 or 2 argument version first:
+                // If 1 argument: condition that has already been reduced to true/false, or a key name, or could be 
+                // nullptr/indeterminate (e.g. missing key in an expression). In that case the result is a boolean
+                // false.
+                // If 2 arguments: 2nd argument (condition) only applies if the 1st argument resolved to true. But due
+                // to missing keys the 1st argument could have resolved to nullptr in which case the result is a nullptr.
+                //
+                // Note that key names here can be integers (array index), wildcard '*' or integer+'*'!! 
+                if (instr.has_arg[0] && instr.has_arg[1]) {
+                    // 2 argument version
+                    bool l = false;
+                    if (out_left != nullptr) {
+                        if ((out_left->type == ASTNodeType::ASTNT_Key) || (out_left->type == ASTNodeType::ASTNT_ConstInt))
+                            l = fn_IsPresent(container, out_left->node);
+                        else {
+                            // Was probably a condition...
+                            assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
+                            l = (out_left->node == "true");
+                        }
                     }
+                    if (l) {
+                        out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                        out.node = "false";
+                        if (out_right != nullptr) {
+                            assert(out_right->type == ASTNodeType::ASTNT_ConstPDFBoolean);
+                            out.node = out_right->node;
+                        }
+                    }
+                    // else 1st argument didn't exist/wasn't true so ignore 2nd argument. NOT FALSE!!!
                 }
                 else {
-                    // 1st argument didn't exist/wasn't true so ignore 2nd argument. NOT FALSE!!!
-                    delete out;
-                    out = nullptr;
+                    // 1 argument version
+                    assert(out_right == nullptr);
+                    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                    out.node = "false";
+                    if (out_left != nullptr) {
+                        if ((out_left->type == ASTNodeType::ASTNT_Key) || (out_left->type == ASTNodeType::ASTNT_ConstInt))
+                            out.node = (fn_IsPresent(container, out_left->node) ? "true" : "false");
+                        else {
+                            assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
+                            out.node = out_left->node;
+                        }
+                    }
                 }
-            }
-            else {
-                // 1 argument version
-                assert(out_right == nullptr);
-                out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                out->node = "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_IsRequired:
+                // 1 argument: condition that has already been reduced to true/false, or could be nullptr (e.g. missing key)
                 if (out_left != nullptr) {
-                    if ((out_left->type == ASTNodeType::ASTNT_Key) || (out_left->type == ASTNodeType::ASTNT_ConstInt))
-                        out->node = (fn_IsPresent(container, out_left->node) ? "true" : "false");
-                    else {
-                        assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-                        out->node = out_left->node;
-                    }
+                    assert(out_right == nullptr);
+                    assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
+                    out.node = out_left->node;
                 }
-            }
-        }
-        else if (in_ast->node == "fn:IsRequired(") {
-            // 1 argument: condition that has already been reduced to true/false, or could be nullptr (e.g. missing key)
-            if (out_left != nullptr) {
+                else
+                    out.node = "false";
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                break;
+
+            case ArlPredicateFn::ARLFN_KeyNameIsColorant:
+                // no arguments
+                assert(out_left == nullptr);
                 assert(out_right == nullptr);
-                assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-                out->node = out_left->node;
-            }
-            else
-                out->node = "false";
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-        }
-        else if (in_ast->node == "fn:KeyNameIsColorant(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            // assume everything is a valid colorant
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = "true";
-        }
-        else if (in_ast->node == "fn:MustBeDirect(") {
-            // optional 1 argument, which is a key/array index, an expression (reduced, possibly to nothing), or nothing
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            if (in_ast->arg[0] == nullptr) {
-                // fn:MustBeDirect() - no arguments
-                out->node = "true";
-            }
-            else {
-                // there was an argument but may have been reduced to nullptr due to missing key, etc.
-                if (out_left != nullptr)
-                    out->node = fn_MustBeDirect(container, obj, out_left) ? "true" : "false";
-                else {
-                    // indeterminate... (was an argument that got reduced to nullptr)
-                    delete out;
-                    out = nullptr;
+                // assume everything is a valid colorant
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = "true";
+                break;
+
+            case ArlPredicateFn::ARLFN_MustBeDirect:
+            case ArlPredicateFn::ARLFN_MustBeIndirect:
+                // optional 1 argument, which is a key/array index, an expression (reduced, possibly to nothing), or nothing
+                assert(out_right == nullptr);
+                if (!instr.has_arg[0]) {
+                    // fn:MustBeDirect() or fn:MustBeIndirect() - no arguments
+                    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                    out.node = "true";
                 }
-            }
-        }
-        else if (in_ast->node == "fn:MustBeIndirect(") {
-            // optional 1 argument, which is a key/array index, an expression (reduced, possibly to nothing), or nothing
-            assert(out_right == nullptr); 
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            if (in_ast->arg[0] == nullptr) {
-                // fn:MustBeIndirect()  - no arguments
-                out->node = "true";
-            }
-            else {
-                // there was an argument but may have been reduced to nullptr due to missing key, etc.
-                if (out_left != nullptr)
-                    out->node = fn_MustBeDirect(container, obj, out_left) ? "false" : "true";
-                else {
-                    // indeterminate... (was an argument that got reduced to nullptr)
-                    delete out;
-                    out = nullptr;
+                else if (out_left != nullptr) {
+                    // there was an argument but may have been reduced to nullptr due to missing key, etc.
+                    bool direct = fn_MustBeDirect(container, obj, out_left);
+                    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                    if (instr.fn == ArlPredicateFn::ARLFN_MustBeDirect)
+                        out.node = direct ? "true" : "false";
+                    else
+                        out.node = direct ? "false" : "true";
                 }
-            }
-        }
-        else if (in_ast->node == "fn:NoCycle(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_NoCycle(obj, tsv_data[key_idx][TSV_KEYNAME]) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:Not(") {
-            // 1 argument: invert the condition (could have been reduced to indeterminate)
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            if (out_left != nullptr) {
-                assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-                out->node = (out_left->node == "false") ? "true" : "false";
-            }
-            else {
-                delete out;
-                out = nullptr;
-            }
-        }
-        else if (in_ast->node == "fn:NotStandard14Font(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_NotStandard14Font(obj) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:NumberOfPages(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstInt;
-            out->node = std::to_string(fn_NumberOfPages());
-        }
-        else if (in_ast->node == "fn:PageContainsStructContentItems(") {
-            // no arguments
-            assert(out_left == nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_PageContainsStructContentItems(obj) ? "true" : "false";
-        }
-        else if (in_ast->node == "fn:PageProperty(") {
-            // 2 arguments: the page, a key (NEVER an array index!) on that page. Either could be nullptr! 
-            delete out;
-            out = fn_PageProperty(container, out_left, out_right);
-        }
-        else if (in_ast->node == "fn:RectHeight(") {
-            // 1 argument: key or integer array index of the rectangle. Could be indeterminate.
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstNum;
-            out->node = std::to_string(fn_RectHeight(container, out_left));
-        }
-        else if (in_ast->node == "fn:RectWidth(") {
-            // 1 argument: key or integer array index of the rectangle. Could be indeterminate.
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstNum;
-            out->node = std::to_string(fn_RectWidth(container, out_left));
-        }
-        else if (in_ast->node == "fn:RequiredValue(") {
-            delete out;
-            out = fn_RequiredValue(obj, out_left, out_right);
-        }
-        else if (in_ast->node == "fn:SinceVersion(") {
-            // 1 or 2 args: version, and optionally thing that was introduced
-            delete out;
-            if (in_ast->arg[1] == nullptr) 
-                out = fn_SinceVersion(out_left);            // 1 argument version
-            else
-                out = fn_SinceVersion(out_left, out_right); // 2 argument version - out_right might have reduced to nullptr
-        }
-        else if (in_ast->node == "fn:StreamLength(") {
-            // 1 argument: key name or integer array index of the stream
-            assert(out_left != nullptr);
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstInt;
-            int len = fn_StreamLength(container, out_left);
-            if (len >= 0) {
-                // Valid length
-                out->type = ASTNodeType::ASTNT_ConstInt;
-                out->node = std::to_string(len);
-            }
-            else {
-                // Invalid length - most likely key not present...
-                delete out;
-                out = nullptr;
-            }
-        }
-        else if (in_ast->node == "fn:StringLength(") {
-            // 1 argument: key name or integer array index of the string
-            assert(out_right == nullptr);
-            out->type = ASTNodeType::ASTNT_ConstInt;
-            int len = fn_StringLength(container, out_left);
-            if (len >= 0) {
-                // Valid length
-                out->type = ASTNodeType::ASTNT_ConstInt;
-                out->node = std::to_string(len);
-            }
-            else {
-                // Invalid length - most likely key not present...
-                delete out;
-                out = nullptr;
-            }
-        }
-        else if (in_ast->node == "fn:Contains(") {
-            // 2 arguments: key name or integer array index and a value, but either may have been reduced
-            if (out_left == nullptr) {
-                delete out_right;
-                out_right = nullptr;
-            }
-            out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-            out->node = fn_Contains(obj, out_left, out_right) ? "true" : "false";
-        }
-        else {
-            assert(false && "unrecognized predicate function!");
-            fully_implemented = false;
-            delete out;
-            out = nullptr;
-        }
-    }
-    break;
+                // else indeterminate... (was an argument that got reduced to nullptr)
+                break;
+
+            case ArlPredicateFn::ARLFN_NoCycle:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_NoCycle(obj, tsv_data[key_idx][TSV_KEYNAME]) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_Not:
+                // 1 argument: invert the condition (could have been reduced to indeterminate)
+                assert(out_right == nullptr);
+                if (out_left != nullptr) {
+                    assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
+                    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                    out.node = (out_left->node == "false") ? "true" : "false";
+                }
+                break;
+
+            case ArlPredicateFn::ARLFN_NotStandard14Font:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_NotStandard14Font(obj) ? "true" : "false";
+                break;
 
-        case ASTNodeType::ASTNT_MathComp:
+            case ArlPredicateFn::ARLFN_NumberOfPages:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstInt;
+                out.node = std::to_string(fn_NumberOfPages());
+                break;
+
+            case ArlPredicateFn::ARLFN_PageContainsStructContentItems:
+                // no arguments
+                assert(out_left == nullptr);
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = fn_PageContainsStructContentItems(obj) ? "true" : "false";
+                break;
+
+            case ArlPredicateFn::ARLFN_PageProperty:
+                // 2 arguments: the page, a key (NEVER an array index!) on that page. Either could be nullptr! 
+                (void)fn_PageProperty(container, out_left, out_right, out);
+                break;
+
+            case ArlPredicateFn::ARLFN_RectHeight:
+                // 1 argument: key or integer array index of the rectangle. Could be indeterminate.
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstNum;
+                out.node = std::to_string(fn_RectHeight(container, out_left));
+                break;
+
+            case ArlPredicateFn::ARLFN_RectWidth:
+                // 1 argument: key or integer array index of the rectangle. Could be indeterminate.
+                assert(out_right == nullptr);
+                out.type = ASTNodeType::ASTNT_ConstNum;
+                out.node = std::to_string(fn_RectWidth(container, out_left));
+                break;
+
+            case ArlPredicateFn::ARLFN_RequiredValue:
+                (void)fn_RequiredValue(obj, out_left, out_right, out);
+                break;
+
+            case ArlPredicateFn::ARLFN_SinceVersion:
+                // 1 or 2 args: version, and optionally thing that was introduced
+                if (!instr.has_arg[1])
+                    (void)fn_SinceVersion(out_left, out);            // 1 argument version
+                else
+                    (void)fn_SinceVersion(out_left, out_right, out); // 2 argument version - out_right might have reduced to nullptr
+                break;
+
+            case ArlPredicateFn::ARLFN_StreamLength:
+            case ArlPredicateFn::ARLFN_StringLength:
+                {
+                    // 1 argument: key name or integer array index of the stream or string
+                    assert(out_right == nullptr);
+                    int len;
+                    if (instr.fn == ArlPredicateFn::ARLFN_StreamLength) {
+                        assert(out_left != nullptr);
+                        len = fn_StreamLength(container, out_left);
+                    }
+                    else
+                        len = fn_StringLength(container, out_left);
+                    if (len >= 0) {
+                        // Valid length
+                        out.type = ASTNodeType::ASTNT_ConstInt;
+                        out.node = std::to_string(len);
+                    }
+                    // else invalid length - most likely key not present...
+                }
+                break;
+
+            case ArlPredicateFn::ARLFN_Unknown:
+            default:
+                assert(false && "unrecognized predicate function!");
+                fully_implemented = false;
+                break;
+            } // switch instr.fn
+            break;
+
+        case ArlOpcode::ARLOP_MathComp:
             {
                 // Math/logic comparison operators - cannot be start of an AST!
                 // Should have 2 operands (left, right) but due to predicate reduction this can reduce to just 
-                // one in which case the output is nullptr also, since cannot make any comparison.
-                out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-
-                if ((out_left == nullptr) || (out_right == nullptr)) {
-                    delete out;
-                    out = nullptr;
+                // one in which case the output is indeterminate also, since cannot make any comparison.
+                if ((out_left == nullptr) || (out_right == nullptr))
                     break;
-                }
-                else if (in_ast->node == "==") {
-                    // equality - could be numeric, logical, string (WITHOUT single-quotes), etc.
-                    if (out_left->type == out_right->type) {
-                        out->node = (out_left->node == out_right->node) ? "true" : "false";
-                        break;
-                    }
-                    // else fallthrough and up-convert to doubles for math op
-                }
-                else if (in_ast->node == "!=") {
-                    // inequality - could be numeric, logical, etc.
+
+                if ((instr.oper == ArlOperator::ARLOPR_Equal) || (instr.oper == ArlOperator::ARLOPR_NotEqual)) {
+                    // (in)equality - could be numeric, logical, string (WITHOUT single-quotes), etc.
                     if (out_left->type == out_right->type) {
-                        out->node = (out_left->node != out_right->node) ? "true" : "false";
+                        bool eq = (out_left->node == out_right->node);
+                        out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                        out.node = (eq == (instr.oper == ArlOperator::ARLOPR_Equal)) ? "true" : "false";
                         break;
                     }
                     // else fallthrough and up-convert to doubles for math op
@@ -857,66 +957,58 @@ ASTNode* CPDFFile::ProcessPredicate(ArlPDFObject* container, ArlPDFObject* obj,
                 double left  = convert_node_to_double(out_left);
                 double right = convert_node_to_double(out_right);
 
-                if ((left == std::numeric_limits<double>::quiet_NaN()) || (right == std::numeric_limits<double>::quiet_NaN())) {
-                    delete out;
-                    out = nullptr;
+                if ((left == std::numeric_limits<double>::quiet_NaN()) || (right == std::numeric_limits<double>::quiet_NaN()))
                     break;
-                }
 
-                if (in_ast->node == "==") {
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                switch (instr.oper) {
+                case ArlOperator::ARLOPR_Equal:
                     // equality with tolerance (numeric only)
-                    out->node = (fabs(left - right) <= ArlNumberTolerance) ? "true" : "false";
-                }
-                else if (in_ast->node == "!=") {
+                    out.node = (fabs(left - right) <= ArlNumberTolerance) ? "true" : "false";
+                    break;
+                case ArlOperator::ARLOPR_NotEqual:
                     // inequality with tolerance(numeric only)
-                    out->node = (fabs(left - right) > ArlNumberTolerance) ? "true" : "false";
-                }
-                else if (in_ast->node == "<=") {
-                    // less than or equal to (numeric only)
-                    out->node = (left <= right) ? "true" : "false";
-                }
-                else if (in_ast->node == "<") {
-                    // less than (numeric only)
-                    out->node = (left < right) ? "true" : "false";
-                }
-                else if (in_ast->node == ">=") {
-                    // greater than or equal to (numeric only)
-                    out->node = (left >= right) ? "true" : "false";
-                }
-                else if (in_ast->node == ">") {
-                    // greater than (numeric)
-                    out->node = (left > right) ? "true" : "false";
-                }
-                else {
+                    out.node = (fabs(left - right) > ArlNumberTolerance) ? "true" : "false";
+                    break;
+                case ArlOperator::ARLOPR_LessEqual:
+                    out.node = (left <= right) ? "true" : "false";
+                    break;
+                case ArlOperator::ARLOPR_Less:
+                    out.node = (left < right) ? "true" : "false";
+                    break;
+                case ArlOperator::ARLOPR_GreaterEqual:
+                    out.node = (left >= right) ? "true" : "false";
+                    break;
+                case ArlOperator::ARLOPR_Greater:
+                    out.node = (left > right) ? "true" : "false";
+                    break;
+                default:
                     assert(false && "unexpected math comparison!");
-                    delete out;
-                    out = nullptr;
-                }
+                    out.type = ASTNodeType::ASTNT_Unknown;
+                    break;
+                } // switch instr.oper
             }
             break;
 
-        case ASTNodeType::ASTNT_MathOp:
-                {
+        case ArlOpcode::ARLOP_MathOp:
+            {
                 // Math operators: "+", " - ", "*", " mod " (SPACEs either side on some)
                 // Math operators should have 2 operands (left, right) but due to reductions,
                 // this can reduce to just one in which case the output is just the non-nullptr value.
                 // If both got reduced then reduce to "true".
                 if ((out_left != nullptr) && (out_right == nullptr)) {
-                    out->type = out_left->type;
-                    out->node = out_left->node;
+                    out.type = out_left->type;
+                    out.node = out_left->node;
                     break;
                 }
                 else if ((out_left == nullptr) && (out_right != nullptr)) {
-                    out->type = out_right->type;
-                    out->node = out_right->node;
-                    // swap nodes to be valid()
-                    out_left = out_right;
-                    out_right = nullptr;
+                    out.type = out_right->type;
+                    out.node = out_right->node;
                     break;
                 }
                 else if ((out_left == nullptr) && (out_right == nullptr)) {
-                    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                    out->node = "true";
+                    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                    out.node = "true";
                     break;
                 }
 
@@ -925,117 +1017,78 @@ ASTNode* CPDFFile::ProcessPredicate(ArlPDFObject* container, ArlPDFObject* obj,
                 double right = std::stod(out_right->node);
 
                 // Work out typing - integer vs number
-                if ((out_left->type == ASTNodeType::ASTNT_ConstInt) && (out_right->type == ASTNodeType::ASTNT_ConstInt))
-                    out->type = ASTNodeType::ASTNT_ConstInt;
-                else
-                    out->type = ASTNodeType::ASTNT_ConstNum;
-
-                if ((in_ast->node == "+") || (in_ast->node == " + ")) { // addition
-                    if (out->type == ASTNodeType::ASTNT_ConstInt)
-                        out->node = std::to_string(int(left + right));
-                    else
-                        out->node = std::to_string(left + right);
-                }
-                else if ((in_ast->node == "-") || (in_ast->node == " - ")) { // subtraction (NEVER unary negation)
-                    if (out->type == ASTNodeType::ASTNT_ConstInt)
-                        out->node = std::to_string(int(left - right));
-                    else
-                        out->node = std::to_string(left - right);
-                }
-                else if ((in_ast->node == "*") || (in_ast->node == " * ")) { // multiply
-                    if (out->type == ASTNodeType::ASTNT_ConstInt)
-                        out->node = std::to_string(int(left * right));
-                    else
-                        out->node = std::to_string(left * right);
-                }
-                else if (in_ast->node == " mod ") { // modulo
-                    out->type = ASTNodeType::ASTNT_ConstInt;
-                    out->node = std::to_string(int(left) % int(right));
-                }
-                else {
-                    assert(false && "unexpected math operator!");
-                    delete out;
-                    out = nullptr;
-                }
-            }
-            break;
+                bool is_int = (out_left->type == ASTNodeType::ASTNT_ConstInt) && (out_right->type == ASTNodeType::ASTNT_ConstInt);
+                out.type = is_int ? ASTNodeType::ASTNT_ConstInt : ASTNodeType::ASTNT_ConstNum;
 
-        case ASTNodeType::ASTNT_LogicalOp:
-            {
-                // Logical operators - should have 2 operands (left, right) but due to reductions,
-                // this can reduce to just one in which case the output is just the non-nullptr boolean.
-                // If both got reduced then reduce to "true".
-                if ((out_left != nullptr) && (out_right == nullptr)) {
-                    assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-                    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                    out->node = out_left->node;
+                switch (instr.oper) {
+                case ArlOperator::ARLOPR_Add:
+                    out.node = is_int ? std::to_string(int(left + right)) : std::to_string(left + right);
                     break;
-                }
-                else if ((out_left == nullptr) && (out_right != nullptr) && (out_right->type == ASTNodeType::ASTNT_ConstPDFBoolean)) {
-                    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                    out->node = out_right->node;
-                    // swap nodes
-                    out_left = out_right;
-                    out_right = nullptr;
+                case ArlOperator::ARLOPR_Subtract: // subtraction (NEVER unary negation)
+                    out.node = is_int ? std::to_string(int(left - right)) : std::to_string(left - right);
                     break;
-                }
-                else if ((out_left == nullptr) && (out_right == nullptr)) {
-                    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                    out->node = "true";
+                case ArlOperator::ARLOPR_Multiply:
+                    out.node = is_int ? std::to_string(int(left * right)) : std::to_string(left * right);
                     break;
-                }
-
-                if (((out_left == nullptr) || (out_left->type == ASTNodeType::ASTNT_ConstNum)) || (out_right->type == ASTNodeType::ASTNT_ConstNum)) {
-                    // Coming from SinceVersion field: fn:Eval(fn:Extension(PDF_VT2,1.6) || 2.0) type expression
-                    assert(in_ast->node == " || ");
-                    out->type = ASTNodeType::ASTNT_ConstNum;
-                    if (out_left != nullptr)
-                        out->node = out_left->node;
-                    else
-                        out->node = out_right->node;
-                    delete out_left;
-                    out_left = nullptr;
-                    delete out_right;
-                    out_right = nullptr;
+                case ArlOperator::ARLOPR_Modulo:
+                    out.type = ASTNodeType::ASTNT_ConstInt;
+                    out.node = std::to_string(int(left) % int(right));
                     break;
-                }
+                default:
+                    assert(false && "unexpected math operator!");
+                    out.type = ASTNodeType::ASTNT_Unknown;
+                    break;
+                } // switch instr.oper
+            }
+            break;
+
+        case ArlOpcode::ARLOP_LogicalOp:
+            // Logical operators - should have 2 operands (left, right) but due to reductions,
+            // this can reduce to just one in which case the output is just the non-nullptr boolean.
+            // If both got reduced then reduce to "true".
+            if ((out_left != nullptr) && (out_right == nullptr)) {
+                assert(out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean);
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = out_left->node;
+            }
+            else if ((out_left == nullptr) && (out_right != nullptr) && (out_right->type == ASTNodeType::ASTNT_ConstPDFBoolean)) {
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = out_right->node;
+            }
+            else if ((out_left == nullptr) && (out_right == nullptr)) {
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                out.node = "true";
+            }
+            else if ((out_left == nullptr) || (out_left->type == ASTNodeType::ASTNT_ConstNum) || (out_right->type == ASTNodeType::ASTNT_ConstNum)) {
+                // Coming from SinceVersion field: fn:Eval(fn:Extension(PDF_VT2,1.6) || 2.0) type expression
+                assert(instr.oper == ArlOperator::ARLOPR_Or);
+                out.type = ASTNodeType::ASTNT_ConstNum;
+                out.node = (out_left != nullptr) ? out_left->node : out_right->node;
+            }
+            else {
+                assert((out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean) && (out_right->type == ASTNodeType::ASTNT_ConstPDFBoolean));
+                out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+                if (instr.oper == ArlOperator::ARLOPR_And)
+                    out.node = ((out_left->node == "true") && (out_right->node == "true")) ? "true" : "false";
+                else if (instr.oper == ArlOperator::ARLOPR_Or)
+                    out.node = ((out_left->node == "true") || (out_right->node == "true")) ? "true" : "false";
                 else {
-                    assert((out_left->type == ASTNodeType::ASTNT_ConstPDFBoolean) && (out_right->type == ASTNodeType::ASTNT_ConstPDFBoolean));
-                    if (in_ast->node == " && ") {
-                        // logical AND - if only 1 arg then it is that arg
-                        out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                        out->node = ((out_left->node == "true") && (out_right->node == "true")) ? "true" : "false";
-                    }
-                    else if (in_ast->node == " || ") {
-                        // logical OR
-                        out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-                        out->node = ((out_left->node == "true") || (out_right->node == "true")) ? "true" : "false";
-                    }
-                    else {
-                        assert(false && "unexpected logical operator!");
-                        delete out;
-                        out = nullptr;
-                    }
+                    assert(false && "unexpected logical operator!");
+                    out.type = ASTNodeType::ASTNT_Unknown;
                 }
             }
             break;
 
-        case ASTNodeType::ASTNT_KeyValue: // "@keyname" - key name or integer array index ("@1")
+        case ArlOpcode::ARLOP_KeyValue: // "@keyname" - key name or integer array index ("@1")
             {
-                auto key_parts = split_key_path(in_ast->node);
-                assert(key_parts[key_parts.size() -1 ][0] == '@');
-                key_parts[key_parts.size() - 1] = key_parts[key_parts.size() - 1].substr(1);  // strip the '@' off
+                const std::vector<std::string>& key_parts = instr.key_parts;
 
                 // Object to get value from
                 ArlPDFObject* val = nullptr;
                 bool delete_val = false;
 
-                // To debug a specific predicate, uncomment and modify the following code. Add breakpoint to the 2nd line.
-                // if (key_parts[key_parts.size() - 1] == "ImageMask")
-                //    delete_val = delete_val;
-
                 // Optimize for simple self-reference (where @key and current key are the same)
-                bool self_refer = (key_parts.size() == 1) && (tsv_data[key_idx][TSV_KEYNAME] == key_parts[key_parts.size() - 1]);
+                bool self_refer = (key_parts.size() == 1) && (tsv_data[key_idx][TSV_KEYNAME] == key_parts[0]);
                 if (!self_refer) {
                     val = get_object_for_path(container, key_parts);
                     delete_val = true;
@@ -1048,72 +1101,48 @@ ASTNode* CPDFFile::ProcessPredicate(ArlPDFObject* container, ArlPDFObject* obj,
                 // this should not required - it would indicate a logical error in the PDF specification! 
                 // See Issue #30: https://github.com/pdf-association/arlington-pdf-model/issues/30#issuecomment-1276804889
                 if ((val == nullptr) && (key_parts.size() == 1)) {
-                    bool got_dv = false;
-                    if (use_default_values) {
-                        for (int i = 0; i < (int)tsv_data.size(); i++)
-                            if ((tsv_data[i][TSV_KEYNAME] == key_parts[0]) && (tsv_data[i][TSV_DEFAULTVALUE] != "")) {
-                                delete out;
-                                out = new ASTNode;
-                                std::string s = LRParsePredicate(tsv_data[i][TSV_DEFAULTVALUE], out);
-                                assert(s.size() == 0);
-                                assert(out->valid());
-                                got_dv = true;
-                                break;
-                            }
-                    }
-                    if (!got_dv) {
-                        // Return nullptr if @key doesn't exist
-                        delete out;
-                        out = nullptr;
+                    if (use_default_values && instr.has_default) {
+                        out.type = instr.default_value.type;
+                        out.node = instr.default_value.node;
                     }
+                    // else indeterminate if @key doesn't exist
                 }
-                else {
-                    ASTNode *tmp = convert_basic_object_to_ast(val);
-                    if ((tmp == nullptr) && (in_ast->node.find("parent::") == std::string::npos)) {
-                        // Return nullptr if @key doesn't exist
-                        delete out;
-                        out = nullptr;
-                    }
-                    else {
-                        assert((tmp == nullptr) || tmp->valid());
-                        delete out;
-                        out = tmp;
-                    }
-                    assert((out == nullptr) || out->valid());
+                else if (!convert_basic_object_to_ast(val, out)) {
+                    // Indeterminate if @key doesn't exist or is not a basic object
+                    out.type = ASTNodeType::ASTNT_Unknown;
                 }
                 if (delete_val)
                     delete val;
             }
             break;
 
-        case ASTNodeType::ASTNT_Unknown:
-        case ASTNodeType::ASTNT_Type:
+        case ArlOpcode::ARLOP_Invalid:
         default:
             // Likely a parsing error!
-            assert(false && "unexpected AST node while recursing!");
+            assert(false && "unexpected AST node while executing!");
             fully_implemented = false;
-            delete out;
-            out = nullptr;
             break;
-    } // switch
+        } // switch instr.opcode
 
-    if (out != nullptr) {
-        out->arg[0] = out_left;
-        out->arg[1] = out_right;
-#ifdef PP_AST_DEBUG
-        std::cout << std::string(depth * 2, ' ') << "Out: " << *out << std::endl;
-#endif
-        assert(out->valid());
-    }
-    else {
-        delete out_left;
-        delete out_right;
 #ifdef PP_AST_DEBUG
-        std::cout << std::string(depth * 2, ' ') << "Out: nullptr" << std::endl;
+        std::cout << "Out: " << out << std::endl;
 #endif 
-    }
+        assert((out.type == ASTNodeType::ASTNT_Unknown) || out.valid());
+
+        // Replace the arguments with the result (swap avoids copying strings)
+        if (base != sp) {
+            vm_stack[base].type = out.type;
+            vm_stack[base].node.swap(out.node);
+        }
+        sp = base + 1;
+    } // for
 
-    return out;
+    assert(sp == 1);
+    if (vm_stack[0].type == ASTNodeType::ASTNT_Unknown)
+        return false;
+    result.type = vm_stack[0].type;
+    result.node = vm_stack[0].node;
+    return true;
 }
 
 
@@ -1121,43 +1150,43 @@ ASTNode* CPDFFile::ProcessPredicate(ArlPDFObject* container, ArlPDFObject* obj,
 /// Complex objects (array, dictionary, stream) reduce to a boolean "true" (meaning object exists).
 /// The PDF null object reduces to the boolean "false" (meaning object doesn't exist)
 /// 
-/// @param[in] obj   PDF object. Can be nullptr.
+/// @param[in]  obj   PDF object. Can be nullptr.
+/// @param[out] out   AST-Node equivalent (only when true is returned)
 /// 
-/// @returns AST-Node equivalent data structure or nullptr.
-ASTNode* CPDFFile::convert_basic_object_to_ast(ArlPDFObject* obj) 
+/// @returns true if obj was converted into out, false otherwise.
+bool CPDFFile::convert_basic_object_to_ast(ArlPDFObject* obj, ASTNode& out) 
 {
     if (obj == nullptr)
-        return nullptr;
+        return false;
 
     PDFObjectType obj_type = obj->get_object_type();
-    ASTNode* ast_obj = new ASTNode;
 
     switch (obj_type) {
     case PDFObjectType::ArlPDFObjTypeName:
-        ast_obj->type = ASTNodeType::ASTNT_Key;
-        ast_obj->node = ToUtf8(((ArlPDFName*)obj)->get_value());
-        return ast_obj;
+        out.type = ASTNodeType::ASTNT_Key;
+        out.node = ToUtf8(((ArlPDFName*)obj)->get_value());
+        return true;
 
     case PDFObjectType::ArlPDFObjTypeNumber:
         if (((ArlPDFNumber*)obj)->is_integer_value()) {
-            ast_obj->type = ASTNodeType::ASTNT_ConstInt;
-            ast_obj->node = std::to_string(((ArlPDFNumber*)obj)->get_integer_value());
+            out.type = ASTNodeType::ASTNT_ConstInt;
+            out.node = std::to_string(((ArlPDFNumber*)obj)->get_integer_value());
         }
         else {
-            ast_obj->type = ASTNodeType::ASTNT_ConstNum;
-            ast_obj->node = std::to_string(((ArlPDFNumber*)obj)->get_value());
+            out.type = ASTNodeType::ASTNT_ConstNum;
+            out.node = std::to_string(((ArlPDFNumber*)obj)->get_value());
         }
-        return ast_obj;
+        return true;
 
     case PDFObjectType::ArlPDFObjTypeBoolean:
-        ast_obj->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-        ast_obj->node = ((ArlPDFBoolean*)obj)->get_value() ? "true" : "false";
-        return ast_obj;
+        out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+        out.node = ((ArlPDFBoolean*)obj)->get_value() ? "true" : "false";
+        return true;
 
     case PDFObjectType::ArlPDFObjTypeString:
-        ast_obj->type = ASTNodeType::ASTNT_ConstString;
-        ast_obj->node = ToUtf8(((ArlPDFString*)obj)->get_value());
-        return ast_obj;
+        out.type = ASTNodeType::ASTNT_ConstString;
+        out.node = ToUtf8(((ArlPDFString*)obj)->get_value());
+        return true;
 
     case PDFObjectType::ArlPDFObjTypeStream:
     case PDFObjectType::ArlPDFObjTypeArray:
@@ -1167,7 +1196,7 @@ ASTNode* CPDFFile::convert_basic_object_to_ast(ArlPDFObject* obj)
         break;
 
     case PDFObjectType::ArlPDFObjTypeNull:
-        // PDF null object same as not existing - return nullptr
+        // PDF null object same as not existing - return false
         break;
 
     case PDFObjectType::ArlPDFObjTypeReference:
@@ -1176,8 +1205,7 @@ ASTNode* CPDFFile::convert_basic_object_to_ast(ArlPDFObject* obj)
         assert(false && "unexpected object type for conversion to AST-Node!");
         break;
     } // switch obj_type
-    delete ast_obj;
-    return nullptr;
+    return false;
 }
 
 
@@ -1188,10 +1216,10 @@ ASTNode* CPDFFile::convert_basic_object_to_ast(ArlPDFObject* obj)
 /// @param[in] values   a set of values to match. "*" will be interpreted as wildcard and will match anything for certain kinds of PDF objects.
 ///
 /// @returns true if the key value matches something in the values set
-bool CPDFFile::check_key_value(ArlPDFDictionary* dict, const std::wstring& key, const std::vector<std::wstring> values)
+bool CPDFFile::check_key_value(ArlPDFDictionary* dict, const std::string& key, const std::vector<std::wstring> values)
 {
     assert(dict != nullptr);
-    assert(key.find(L"::") == std::string::npos);
+    assert(key.find("::") == std::string::npos);
     assert(key.find('*') == std::string::npos);
 
     ArlPDFObject* val_obj = dict->get_value(key);
@@ -1247,8 +1275,9 @@ bool CPDFFile::check_key_value(ArlPDFDictionary* dict, const std::wstring& key,
 /// Updates pdf_version field. Always returns a valid PDF version. Default version is "2.0".
 /// 
 /// @param[in,out] ofs    output stream for messages
+/// @param[in]     sink   machine-readable results sink or nullptr for text output to ofs
 /// @returns              Always a valid 3-char version string ("1.0", "1.1", ..., "2.0")
-std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
+std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs, ArlResultSink* sink)
 {
     bool hdr_ok = ((pdf_header_version.size() == 3)  && FindInVector(v_ArlPDFVersions, pdf_header_version));
     bool cat_ok = ((pdf_catalog_version.size() == 3) && FindInVector(v_ArlPDFVersions, pdf_catalog_version));
@@ -1256,14 +1285,14 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
     pdf_version.clear();
 
     if (hdr_ok)
-        ofs << COLOR_INFO << "Header is version PDF " << pdf_header_version << COLOR_RESET;
+        arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::HeaderVersion) << "Header is version PDF " << pdf_header_version << COLOR_RESET;
     else 
-        ofs << COLOR_ERROR << "Bad header is version PDF " << pdf_header_version << COLOR_RESET;
+        arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::BadHeaderVersion) << "Bad header is version PDF " << pdf_header_version << COLOR_RESET;
 
     if (cat_ok)
-        ofs << COLOR_INFO << "Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
+        arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::CatalogVersion) << "Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
     else if (pdf_catalog_version.size() > 0)
-        ofs << COLOR_ERROR << "Bad Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
+        arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::BadCatalogVersion) << "Bad Document Catalog/Version is PDF " << pdf_catalog_version << COLOR_RESET;
 
     if (hdr_ok && cat_ok) {
         // Choose latest version. Rely on ASCII for version computation
@@ -1271,7 +1300,7 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
             pdf_version = pdf_catalog_version;
         }
         else if (pdf_catalog_version[0] < pdf_header_version[0]) {
-            ofs << COLOR_ERROR << "Document Catalog major version is earlier than PDF header version! Ignoring." << COLOR_RESET;
+            arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::CatalogMajorVersionEarlier) << "Document Catalog major version is earlier than PDF header version! Ignoring." << COLOR_RESET;
             pdf_version = pdf_header_version;
         }
         else { // major version digit is the same. Check minor digit
@@ -1279,7 +1308,7 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
                 pdf_version = pdf_catalog_version;
             }
             else if (pdf_catalog_version[2] < pdf_header_version[2]) {
-                ofs << COLOR_ERROR << "Document Catalog minor version is earlier than PDF header version! Ignoring." << COLOR_RESET;
+                arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::CatalogMinorVersionEarlier) << "Document Catalog minor version is earlier than PDF header version! Ignoring." << COLOR_RESET;
                 pdf_version = pdf_header_version;
             }
             else // versions are the same so fall through
@@ -1296,27 +1325,27 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
     }
     else {
         // Both must be bad - assume latest version
-        ofs << COLOR_ERROR << "Both Document Catalog and header versions are invalid or missing. Assuming PDF 2.0." << COLOR_RESET;
+        arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::NoValidVersion) << "Both Document Catalog and header versions are invalid or missing. Assuming PDF 2.0." << COLOR_RESET;
         pdf_version = "2.0";
     }
 
     // See if XRefStream is wrong for final PDF version (i.e. before PDF 1.5)
     if (get_ptr_to_trailer()->is_xrefstm()) {
         if ((pdf_version[0] == '1') && (pdf_version[2] < '5'))
-            ofs << COLOR_ERROR << "XRefStream is present in PDF " << pdf_version << " before introduction in PDF 1.5." << COLOR_RESET;
+            arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::XRefStreamBeforePDF15) << "XRefStream is present in PDF " << pdf_version << " before introduction in PDF 1.5." << COLOR_RESET;
         else if ((pdf_header_version[0] == '1') && (pdf_header_version[2] < '5'))
-            ofs << COLOR_WARNING << "XRefStream is present in file with header %PDF-" << pdf_header_version << " and Document Catalog Version of PDF " << pdf_catalog_version << COLOR_RESET;
+            arl_message(ofs, sink, ArlSeverity::Warning, ArlMessageCode::XRefStreamWithOldHeader) << "XRefStream is present in file with header %PDF-" << pdf_header_version << " and Document Catalog Version of PDF " << pdf_catalog_version << COLOR_RESET;
     }
 
     // To reduce lots of false warnings, snap transparency-aware PDF to 1.7
     if (!exact_version_compare && (forced_version.size() == 0) && ((pdf_version == "1.4") || (pdf_version == "1.5") || (pdf_version == "1.6"))) {
-        ofs << COLOR_INFO << "Rounding up PDF " << pdf_version << " to PDF 1.7" << COLOR_RESET;
+        arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::RoundedUpVersion) << "Rounding up PDF " << pdf_version << " to PDF 1.7" << COLOR_RESET;
         pdf_version = "1.7";
     }
 
     // Hard force to any version - expect lots of messages if this is wrong!!
     if (forced_version.size() > 0) {
-        ofs << COLOR_INFO << "Command line forced to PDF " << forced_version << COLOR_RESET;
+        arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::ForcedVersion) << "Command line forced to PDF " << forced_version << COLOR_RESET;
         pdf_version = forced_version;
     }
 
@@ -1332,7 +1361,7 @@ std::string CPDFFile::check_and_get_pdf_version(std::ostream& ofs)
 /// @param[in]  ver   a valid PDF version from Arlington representing a feature we have just encountered
 /// @param[in]  arl   the Arlington TSV file of the feature we have just encountered
 /// @param[in]  key   the key (or array index) of the feature we have just encountered
-void CPDFFile::set_feature_version(const std::string& ver, const std::string& arl, const std::string& key) 
+void CPDFFile::set_feature_version(const std::string_view ver, const std::string& arl, const std::string& key) 
 {
     // Avoid processing extensions
     if ((ver.size() == 3) && FindInVector(v_ArlPDFVersions, ver)) {
@@ -1341,7 +1370,7 @@ void CPDFFile::set_feature_version(const std::string& ver, const std::string& ar
         int latest_v = string_to_pdf_version(latest_feature_version);
 
         if (pdf_v > latest_v) {
-            latest_feature_version = ver;
+            latest_feature_version = std::string(ver);
             latest_feature_arlington = arl;
             latest_feature_key = key;
         }
@@ -1708,22 +1737,22 @@ bool CPDFFile::fn_BitsSet(ArlPDFObject* obj, const ASTNode* low_bit_node, const
 /// @brief Determines if the specified extension is currently supported or not 
 /// 
 /// @param[in]  extn   the name of the extension (required)
+/// @param[out] out    "true" if the extension is being support, "false" otherwise
 /// 
-/// @returns true if the extension is being support, false otherwise
-ASTNode* CPDFFile::fn_Extension(const ASTNode * extn) {
+/// @returns true (always determinate)
+bool CPDFFile::fn_Extension(const ASTNode * extn, ASTNode& out) {
     assert(extn != nullptr);
     assert(extn->type == ASTNodeType::ASTNT_Key); // extension names look like keys
 
-    ASTNode* retval = new ASTNode;
-    retval->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-    retval->node = "false";
+    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+    out.node = "false";
 
     for (auto& e : extensions)
         if ((extn->node == e) || (e == "*")) {
-            retval->node = "true";
-            return retval;
+            out.node = "true";
+            return true;
         }
-    return retval;
+    return true;
 }
 
 
@@ -1732,23 +1761,23 @@ ASTNode* CPDFFile::fn_Extension(const ASTNode * extn) {
 /// 
 /// @param[in]  extn   the name of the extension (required)
 /// @param[in]  value  optional value that is added when the extension is supported
+/// @param[out] out    a copy of value when the extension is supported
 /// 
-/// @returns true if the extension is being support, false otherwise. Or nullptr if value 
+/// @returns true if the extension is being support, false otherwise or if value 
 /// was indeterminate (i.e. nullptr)
-ASTNode* CPDFFile::fn_Extension(const ASTNode* extn, const ASTNode* value) {
+bool CPDFFile::fn_Extension(const ASTNode* extn, const ASTNode* value, ASTNode& out) {
     assert(extn != nullptr);
     assert(extn->type == ASTNodeType::ASTNT_Key); // extension names look like keys
 
     if (value != nullptr) {
         for (auto& e : extensions)
             if ((extn->node == e) || (e == "*")) {
-                ASTNode* retval = new ASTNode;
-                retval->type = value->type;
-                retval->node = value->node;
-                return retval;
+                out.type = value->type;
+                out.node = value->node;
+                return true;
             }
     }
-    return nullptr;
+    return false;
 }
 
 
@@ -1770,14 +1799,14 @@ bool CPDFFile::fn_FontHasLatinChars(ArlPDFObject* obj)
         return false;
     }
 
-    if (!((ArlPDFDictionary*)obj)->has_key(L"Type")) {
+    if (!((ArlPDFDictionary*)obj)->has_key("Type")) {
 #ifdef PP_FN_DEBUG
         std::cout << "fn_FontHasLatinChars() dictionary did not have a /Type key!" << std::endl;
 #endif
         return false;
     }
 
-    ArlPDFObject* t = ((ArlPDFDictionary*)obj)->get_value(L"Type");
+    ArlPDFObject* t = ((ArlPDFDictionary*)obj)->get_value("Type");
     if ((t == nullptr) || (t->get_object_type() != PDFObjectType::ArlPDFObjTypeName)) {
 #ifdef PP_FN_DEBUG
         std::cout << "fn_FontHasLatinChars() dictionary /Type key was not name!" << std::endl;
@@ -1884,14 +1913,14 @@ bool CPDFFile::fn_ImageIsStructContentItem(ArlPDFObject* obj)
         return false;
     }
 
-    if (!((ArlPDFDictionary*)obj)->has_key(L"Subtype")) {
+    if (!((ArlPDFDictionary*)obj)->has_key("Subtype")) {
 #ifdef PP_FN_DEBUG
         std::cout << "fn_ImageIsStructContentItem() dictionary did not have a /Subtype key!" << std::endl;
 #endif
         return false;
     }
 
-    ArlPDFObject* t = ((ArlPDFDictionary*)obj)->get_value(L"Subtype");
+    ArlPDFObject* t = ((ArlPDFDictionary*)obj)->get_value("Subtype");
     if ((t == nullptr) || (t->get_object_type() != PDFObjectType::ArlPDFObjTypeName)) {
 #ifdef PP_FN_DEBUG
         std::cout << "fn_ImageIsStructContentItem() dictionary /Subtype key was not name!" << std::endl;
@@ -1938,71 +1967,25 @@ bool CPDFFile::fn_InKeyMap(ArlPDFObject* container, ArlPDFObject* obj, const AST
     if (container_type != PDFObjectType::ArlPDFObjTypeDictionary)
         return false;
 
-    auto container_dict = (ArlPDFDictionary*)container;
-
-    auto keys = split_key_path(map->node);
-    assert(keys[keys.size() - 1][0] != '@');    // Never "@key" as the final key
-
-    if (keys[0] == "parent") {                  /// @todo Don't support "parent::" 
-        fully_implemented = false;
-        return false;
-    }
-
-    ArlPDFObject* map_obj = nullptr;
-
-    if (keys[0] == "trailer") {
-        // Hardcoded support for trailer and trailer::Catalog as common
-        assert(keys.size() >= 3);
-        if (keys[1] == "Catalog") {
-            auto doccat = pdfsdk.get_document_catalog();
-            map_obj = doccat->get_value(ToWString(keys[2]));
-            if ((map_obj != nullptr) && (keys.size() == 4) && (map_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-                ArlPDFObject* o1 = ((ArlPDFDictionary*)map_obj)->get_value(ToWString(keys[3]));
-                if ((o1 == nullptr) || (o1->get_object_type() != PDFObjectType::ArlPDFObjTypeDictionary)) {
-                    delete o1;
-                    delete map_obj;
-                    return false;
-                }
-                delete map_obj;
-                map_obj = o1;
-            }
-        }
-        else {
-            auto t = pdfsdk.get_trailer();
-            map_obj = t->get_value(ToWString(keys[1]));
-        }
-    }
-    else if (keys.size() == 1) {
-        auto k = ToWString(keys[0]);
-        if (container_dict->has_key(k))
-            map_obj = container_dict->get_value(k);
-    }
-    else {
-        /// @todo TBD
-        assert(false && "unexpected fn_InKeyMap() Arlington path::key expression!");
-        fully_implemented = false;
-        return false;
-    }
+    ArlPDFObject* map_obj = get_map_for_path((ArlPDFDictionary*)container, split_key_path(map->node));
 
     bool retval = false;
     if ((map_obj != nullptr) && (map_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
         auto map_dict = (ArlPDFDictionary*)map_obj;
         if (obj_type == PDFObjectType::ArlPDFObjTypeName) {
             // Check to see if obj (name) is a key in map dict
-            retval = map_dict->has_key(((ArlPDFName*)obj)->get_value());
+            retval = map_dict->has_key(ToUtf8(((ArlPDFName*)obj)->get_value()));
         }
         else {
-            // Checking VALUE of all keys in map - need to iterate to locate same PDF object by hash ID
-            for (int i = 0; i < map_dict->get_num_keys(); i++) {
-                auto k1 = map_dict->get_key_name_by_index(i);
-                auto o1 = map_dict->get_value(k1);
-                if ((o1->get_hash_id() == obj->get_hash_id()) && (obj_type == o1->get_object_type())) {
-                    delete o1;
+            // Checking VALUE of all keys in map - need to iterate to locate same PDF object by object ID
+            map_dict->for_each_key([&](const std::string&, ArlPDFObject* o1) {
+                if (o1 == nullptr)
+                    return true;
+                if ((o1->get_object_id() == obj->get_object_id()) && (obj_type == o1->get_object_type()))
                     retval = true;
-                    break;
-                }
                 delete o1;
-            }
+                return !retval;
+            }, false);
         }
     }
 
@@ -2038,76 +2021,18 @@ bool CPDFFile::fn_InNameTree(ArlPDFObject* container, ArlPDFObject* obj, const A
     if (container_type != PDFObjectType::ArlPDFObjTypeDictionary)
         return false;
 
-    auto container_dict = (ArlPDFDictionary*)container;
-
-    auto keys = split_key_path(nametree->node);
-    assert(keys[keys.size() - 1][0] != '@');    // Never "@key" as the final key
-
-    if (keys[0] == "parent") {                  /// @todo Don't support "parent::" 
-        fully_implemented = false;
-        return false;
+    // Absolute paths (trailer::...) are the same tree for every container so are only resolved once
+    if (nametree->node.rfind("trailer", 0) == 0) {
+        auto index = get_trailer_tree_index((ArlPDFDictionary*)container, ArlTreeType::NameTree, nametree->node);
+        return (index != nullptr) && index->contains(((ArlPDFString*)obj)->get_value());
     }
 
-    ArlPDFObject* nametree_obj = nullptr;
-
-    if (keys[0] == "trailer") {
-        // Hardcoded support for trailer and trailer::Catalog as common
-        assert(keys.size() >= 3);
-        if (keys[1] == "Catalog") {
-            auto doccat = pdfsdk.get_document_catalog();
-            nametree_obj = doccat->get_value(ToWString(keys[2]));
-            if ((nametree_obj != nullptr) && (keys.size() == 4) && (nametree_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-                ArlPDFObject* o1 = ((ArlPDFDictionary*)nametree_obj)->get_value(ToWString(keys[3]));
-                if ((o1 == nullptr) || (o1->get_object_type() != PDFObjectType::ArlPDFObjTypeDictionary)) {
-                    delete o1;
-                    delete nametree_obj;
-                    return false;
-                }
-                delete nametree_obj;
-                nametree_obj = o1;
-            }
-        }
-        else {
-            auto t = pdfsdk.get_trailer();
-            nametree_obj = t->get_value(ToWString(keys[1]));
-        }
-    }
-    else if (keys.size() == 1) {
-        auto k = ToWString(keys[0]);
-        if (container_dict->has_key(k))
-            nametree_obj = container_dict->get_value(k);
-    }
-    else {
-        /// @todo TBD
-        assert(false && "unexpected fn_InNameTree() Arlington path::key expression!");
-        fully_implemented = false;
-        return false;
-    }
+    ArlPDFObject* nametree_obj = get_map_for_path((ArlPDFDictionary*)container, split_key_path(nametree->node));
 
     bool retval = false;
     if ((nametree_obj != nullptr) && (nametree_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-        auto obj_str = ((ArlPDFString*)obj)->get_value();
-        auto nametree_dict = (ArlPDFDictionary*)nametree_obj;
-        auto names = nametree_dict->get_value(L"Names");
-        if ((names != nullptr) && (names->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
-            /// @todo Ignore Limits and test every odd element in the array
-            auto names_arr = (ArlPDFArray*)names;
-            for (int i = 0; i < names_arr->get_num_elements(); i += 2) {
-                auto o = names_arr->get_value(i);
-                if ((o != nullptr) && (o->get_object_type() == PDFObjectType::ArlPDFObjTypeString)) {
-                    if (((ArlPDFString*)o)->get_value() == obj_str) {
-                        delete o;
-                        retval = true;
-                        break;
-                    }
-                }
-                delete o;
-            }
-        }
-        else {
-            fully_implemented = false; /// @todo implement proper name tree support
-        }
-        delete names;
+        auto index = get_tree_index((ArlPDFDictionary*)nametree_obj, ArlTreeType::NameTree, nametree->node);
+        retval = index->contains(((ArlPDFString*)obj)->get_value());
     }
 
     delete nametree_obj;
@@ -2133,30 +2058,26 @@ bool CPDFFile::fn_IsAssociatedFile(ArlPDFObject* obj)
 #endif
         return false;
     }
-    auto obj_hash = obj->get_hash_id();
 
-    // Locate 'obj' in the AF array based on matching hashes...
-    auto doccat = pdfsdk.get_document_catalog();
-    ArlPDFObject* af = doccat->get_value(L"AF");
-    if ((af != nullptr) && (af->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
-        /// walk AF array of File Specification dictionaries looking for 'obj'
-        ArlPDFArray* af_arr = (ArlPDFArray*)af;
-        for (int i = 0; i < af_arr->get_num_elements(); i++) {
-            ArlPDFObject* afile = af_arr->get_value(i);
-            if ((afile != nullptr) && (afile->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-                if (obj_hash == afile->get_hash_id()) {
-                    // Found it!
-                    delete afile;
-                    delete af;
-                    return true;
-                }
+    if (!doc_facts.associated_files_known) {
+        // Collect the IDs of all File Specification dictionaries in the AF array (once per PDF)
+        auto doccat = pdfsdk.get_document_catalog();
+        ArlPDFObject* af = doccat->get_value("AF");
+        if ((af != nullptr) && (af->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
+            ArlPDFArray* af_arr = (ArlPDFArray*)af;
+            for (int i = 0; i < af_arr->get_num_elements(); i++) {
+                ArlPDFObject* afile = af_arr->get_value(i);
+                if ((afile != nullptr) && (afile->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary))
+                    doc_facts.associated_files.insert(afile->get_object_id());
+                delete afile;
             }
-            delete afile;
         }
         delete af;
+        doc_facts.associated_files_known = true;
     }
 
-    return false;
+    // Locate 'obj' in the AF array based on matching object IDs...
+    return (doc_facts.associated_files.count(obj->get_object_id()) > 0);
 }
 
 
@@ -2169,27 +2090,30 @@ bool CPDFFile::fn_IsAssociatedFile(ArlPDFObject* obj)
 /// 4. the same FileSpec dictionary is also in DocCatalog::AF array
 bool CPDFFile::fn_IsEncryptedWrapper() 
 {
+    if (doc_facts.is_encrypted_wrapper_known)
+        return doc_facts.is_encrypted_wrapper;
+
     bool retval = false;
 
     auto doccat = pdfsdk.get_document_catalog();
-    ArlPDFObject* collection = doccat->get_value(L"Collection");
+    ArlPDFObject* collection = doccat->get_value("Collection");
     if ((collection != nullptr) && (collection->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-        ArlPDFObject* view = ((ArlPDFDictionary*)collection)->get_value(L"View");
+        ArlPDFObject* view = ((ArlPDFDictionary*)collection)->get_value("View");
         if ((view != nullptr) && (view->get_object_type() == PDFObjectType::ArlPDFObjTypeName)) {
             if (((ArlPDFName*)view)->get_value() == L"H") {
-                ArlPDFObject* names = doccat->get_value(L"Names");
+                ArlPDFObject* names = doccat->get_value("Names");
                 if ((names != nullptr) && (names->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-                    ArlPDFObject* embedded_files = ((ArlPDFDictionary*)names)->get_value(L"EmbeddedFiles");
+                    ArlPDFObject* embedded_files = ((ArlPDFDictionary*)names)->get_value("EmbeddedFiles");
                     if ((embedded_files != nullptr) && (embedded_files->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
                         /// @todo - walk EmbeddedFiles name tree
-                        ArlPDFObject* af = doccat->get_value(L"AF");
+                        ArlPDFObject* af = doccat->get_value("AF");
                         if ((af != nullptr) && (af->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
                             /// walk AF array of File Specification dictionaries
                             ArlPDFArray *af_arr = (ArlPDFArray*)af;
                             for (int i = 0; i < af_arr->get_num_elements(); i++) {
                                 ArlPDFObject* afile = af_arr->get_value(i);
                                 if ((afile != nullptr) && (afile->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-                                    ArlPDFObject* af_rel = ((ArlPDFDictionary*)afile)->get_value(L"AFRelationship");
+                                    ArlPDFObject* af_rel = ((ArlPDFDictionary*)afile)->get_value("AFRelationship");
                                     if ((af_rel != nullptr) && (af_rel->get_object_type() == PDFObjectType::ArlPDFObjTypeName)) {
                                         if (((ArlPDFName*)af_rel)->get_value() == L"EncryptedPayload") {
                                             delete af_rel;
@@ -2213,6 +2137,8 @@ bool CPDFFile::fn_IsEncryptedWrapper()
     }
     delete collection;
 
+    doc_facts.is_encrypted_wrapper_known = true;
+    doc_facts.is_encrypted_wrapper = retval;
     return retval;
 }
 
@@ -2259,7 +2185,7 @@ bool CPDFFile::fn_IsLastInArray(ArlPDFObject* container, ArlPDFObject* obj, cons
 
     // Get the last object in the array
     ArlPDFObject* last_obj = ((ArlPDFArray*)container)->get_value(arr_size - 1);
-    bool retval = (last_obj->get_hash_id() == obj->get_hash_id());
+    bool retval = (last_obj->get_object_id() == obj->get_object_id());
     delete last_obj;
     return retval;
 }
@@ -2268,13 +2194,16 @@ bool CPDFFile::fn_IsLastInArray(ArlPDFObject* container, ArlPDFObject* obj, cons
 /// @brief determine if PDF file is a Tagged PDF via DocCat::MarkInfo::Marked == true
 bool CPDFFile::fn_IsPDFTagged() 
 {
+    if (doc_facts.is_tagged_known)
+        return doc_facts.is_tagged;
+
     bool retval = false;
 
     auto doccat = pdfsdk.get_document_catalog();
     if (doccat != nullptr) {
-        ArlPDFObject* mi = doccat->get_value(L"MarkInfo");
+        ArlPDFObject* mi = doccat->get_value("MarkInfo");
         if ((mi != nullptr) && (mi->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-            ArlPDFObject* marked = ((ArlPDFDictionary*)mi)->get_value(L"Marked");
+            ArlPDFObject* marked = ((ArlPDFDictionary*)mi)->get_value("Marked");
             if ((marked != nullptr) && (marked->get_object_type() == PDFObjectType::ArlPDFObjTypeBoolean)) {
                 retval = ((ArlPDFBoolean*)marked)->get_value();
             }
@@ -2282,6 +2211,8 @@ bool CPDFFile::fn_IsPDFTagged()
         }
         delete mi;
     }
+    doc_facts.is_tagged_known = true;
+    doc_facts.is_tagged = retval;
     return retval;
 }
 
@@ -2294,7 +2225,7 @@ bool CPDFFile::fn_IsPDFTagged()
 /// @param[in]   key         an Arlington PDF key expression (could be multi-part!)
 /// 
 /// @returns true if key is present, false otherwise
-bool CPDFFile::fn_IsPresent(ArlPDFObject* container, std::string& key)
+bool CPDFFile::fn_IsPresent(ArlPDFObject* container, const std::string& key)
 {
     assert(container != nullptr);
     assert(key.size() > 0);
@@ -2347,32 +2278,30 @@ bool CPDFFile::fn_MustBeDirect(ArlPDFObject* container, ArlPDFObject* obj, const
 
 
 /// @brief Checks to make sure that there are no cycles in obj by looping through referencing 'key'.
-/// Cycles are detected by comparing object hash IDs.
+/// Cycles are detected by comparing object IDs.
 /// 
 /// @param[in]    obj    the PDF object. Must be a dictionary
 /// @param[in]    key    the key to follow which must be acyclic
 /// 
 /// @returns true if there are no cycles, false if cycles are detected or nodes are not dictionaries
-bool CPDFFile::fn_NoCycle(ArlPDFObject* obj, const std::string &key) {
+bool CPDFFile::fn_NoCycle(ArlPDFObject* obj, const std::string_view key) {
     assert(obj != nullptr);
     assert(key.size() > 0);
 
     if (obj->get_object_type() != PDFObjectType::ArlPDFObjTypeDictionary)
         return false;
 
-    std::wstring              wkey = ToWString(key);
-    std::set<std::string>     obj_hash_list;
-    ArlPDFDictionary*         node = (ArlPDFDictionary*)((ArlPDFDictionary*)obj)->get_value(wkey);
+    std::unordered_set<object_id, object_id_hash>   obj_id_list;
+    ArlPDFDictionary*         node = (ArlPDFDictionary*)((ArlPDFDictionary*)obj)->get_value(key);
 
-    obj_hash_list.insert(obj->get_hash_id());
+    obj_id_list.insert(obj->get_object_id());
     while ((node != nullptr) && (node->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-        auto node_hash = node->get_hash_id();
-        auto already_seen = obj_hash_list.insert(node_hash);
+        auto already_seen = obj_id_list.insert(node->get_object_id());
         if (already_seen.second) { // Found a matching object so a cycle is present 
             delete node;
             return false;
         }
-        ArlPDFDictionary* tmp = (ArlPDFDictionary*)node->get_value(wkey);
+        ArlPDFDictionary* tmp = (ArlPDFDictionary*)node->get_value(key);
         delete node;
         node = tmp;
     };
@@ -2399,17 +2328,30 @@ static const std::vector<std::wstring> Std14Fonts = {
     L"Courier-BoldOblique"
 };
 
-/// @brief
+/// @brief Checks if container is a Type1 font dictionary that is not one of the standard 14 fonts.
+/// Results for indirect font dictionaries are cached as several keys of a font use this predicate.
+///
+/// @param[in]   container   PDF container object (the font dictionary)
+///
+/// @returns true iff container is a non-standard 14 Type1 font
 bool CPDFFile::fn_NotStandard14Font(ArlPDFObject* container) {
     assert(container != nullptr);
 
     if (container->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary) {
-        ArlPDFDictionary* dict = (ArlPDFDictionary*)container;
-        if (check_key_value(dict, L"Type", { L"Font" }) &&
-            check_key_value(dict, L"Subtype", { L"Type1" }) &&
-            !check_key_value(dict, L"BaseFont", Std14Fonts)) {
-            return true;
+        bool indirect = (container->get_object_number() > 0);
+        if (indirect) {
+            auto it = doc_facts.not_standard14_fonts.find(container->get_object_id());
+            if (it != doc_facts.not_standard14_fonts.end())
+                return it->second;
         }
+
+        ArlPDFDictionary* dict = (ArlPDFDictionary*)container;
+        bool retval = check_key_value(dict, "Type", { L"Font" }) &&
+                      check_key_value(dict, "Subtype", { L"Type1" }) &&
+                      !check_key_value(dict, "BaseFont", Std14Fonts);
+        if (indirect)
+            doc_facts.not_standard14_fonts.emplace(container->get_object_id(), retval);
+        return retval;
     }
     return false;
 }
@@ -2423,7 +2365,7 @@ bool CPDFFile::fn_NotStandard14Font(ArlPDFObject* container) {
 /// 
 /// @param[in]   obj              the StructParent/StructParents object
 /// 
-/// @returns
+/// @returns true iff obj is a non-negative integer in the ParentTree number tree
 bool CPDFFile::fn_PageContainsStructContentItems(ArlPDFObject* obj) {
     assert(obj != nullptr);
 
@@ -2431,8 +2373,15 @@ bool CPDFFile::fn_PageContainsStructContentItems(ArlPDFObject* obj) {
         if (((ArlPDFNumber*)obj)->is_integer_value()) {
             int val = ((ArlPDFNumber*)obj)->get_integer_value();
             if (val >= 0) {
-                /// @todo - check if integer value in trailer::DocCat::StructTreeRoot::ParentTree number tree
-                fully_implemented = false;
+                // Check if integer value is in trailer::Catalog::StructTreeRoot::ParentTree number tree
+                std::shared_ptr<const CArlTreeIndex> index;
+                auto doccat = pdfsdk.get_document_catalog();
+                if (doccat != nullptr)
+                    index = get_trailer_tree_index(doccat, ArlTreeType::NumberTree, "trailer::Catalog::StructTreeRoot::ParentTree");
+
+                if (index != nullptr)
+                    return index->contains(val);
+                fully_implemented = false; // no ParentTree to check against
                 return true;
             }
             else {
@@ -2461,13 +2410,14 @@ bool CPDFFile::fn_PageContainsStructContentItems(ArlPDFObject* obj) {
 /// @param[in] container   a PDF container page object
 /// @param[in] pg          a reference to a PDF page object as an ASTNode
 /// @param[in] pg_key      a key of a PDF page object as an ASTNode
+/// @param[out] out        the value of the specified key on the specified page
 /// 
-/// @returns a new ASTNode representing the value of the specified key on the specified page or nullptr on error
-ASTNode* CPDFFile::fn_PageProperty(ArlPDFObject* container, ASTNode* pg, ASTNode* pg_key) {
+/// @returns true if out was set, false on error
+bool CPDFFile::fn_PageProperty(ArlPDFObject* container, const ASTNode* pg, const ASTNode* pg_key, ASTNode& out) {
     assert(container != nullptr);
 
     if ((pg == nullptr) || (pg_key == nullptr))
-        return nullptr;
+        return false;
 
     assert(pg->type == ASTNodeType::ASTNT_KeyValue); 
     assert(pg_key->type == ASTNodeType::ASTNT_Key);  // never an integer array index!
@@ -2478,8 +2428,8 @@ ASTNode* CPDFFile::fn_PageProperty(ArlPDFObject* container, ASTNode* pg, ASTNode
         auto pg_key_parts = split_key_path(pg_key->node);
         ArlPDFObject* pg_key_obj = get_object_for_path(container, pg_key_parts);
         if (pg_key_obj != nullptr) {
-            ASTNode* retval = convert_basic_object_to_ast(pg_key_obj);
-            if (retval == nullptr) {
+            bool retval = convert_basic_object_to_ast(pg_key_obj, out);
+            if (!retval) {
                 // Referenced page property was a complex PDF object (array, dictionary, stream) or null object
                 /// @todo - handle complex PDF object references for fn_PageProperty
             }
@@ -2492,7 +2442,7 @@ ASTNode* CPDFFile::fn_PageProperty(ArlPDFObject* container, ASTNode* pg, ASTNode
     std::cout << "fn_PageProperty() page was not a dictionary!" << std::endl;
 #endif
     delete pg_obj;
-    return nullptr;
+    return false;
 }
 
 
@@ -2604,17 +2554,17 @@ double CPDFFile::fn_RectWidth(ArlPDFObject* container, const ASTNode* key) {
 /// @param[in] obj          PDF object
 /// @param[in] condition    already reduced AST node tree that is true/false
 /// @param[in] value        can be any primitive PDF type (int, real, name, string-*, boolean)
+/// @param[out] out         value (copied!)
 /// 
-/// @returns a new ASTNode of value (copied!) or nullptr
-ASTNode* CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition, const ASTNode* value) {
+/// @returns true if out was set, false otherwise
+bool CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition, const ASTNode* value, ASTNode& out) {
     assert(obj != nullptr);
     assert(value != nullptr);
 
     if (condition == nullptr) {
-        ASTNode* retval = new ASTNode;
-        retval->type = value->type;
-        retval->node = value->node;
-        return retval;
+        out.type = value->type;
+        out.node = value->node;
+        return true;
     }
 
     assert(condition != nullptr);
@@ -2622,10 +2572,9 @@ ASTNode* CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition,
 
     if (condition->node == "false") {
         // Condition not met so value of obj can be this value (no need to check anything)
-        ASTNode* retval = new ASTNode;
-        retval->type = value->type;
-        retval->node = value->node;
-        return retval;
+        out.type = value->type;
+        out.node = value->node;
+        return true;
     }
     else {
         // Condition is met so value of obj MUST BE 'value'
@@ -2634,7 +2583,7 @@ ASTNode* CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition,
         case PDFObjectType::ArlPDFObjTypeName:
             if (value->type == ASTNodeType::ASTNT_Key) {
                 if (value->node != ToUtf8(((ArlPDFName*)obj)->get_value())) {
-                    return nullptr;
+                    return false;
                 }
             }
             break;
@@ -2642,11 +2591,11 @@ ASTNode* CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition,
         case PDFObjectType::ArlPDFObjTypeNumber:
             if ((value->type == ASTNodeType::ASTNT_ConstInt) && ((ArlPDFNumber*)obj)->is_integer_value()) {
                 if (value->node != std::to_string(((ArlPDFNumber*)obj)->get_integer_value()))
-                    return nullptr;
+                    return false;
             }
             else if (value->type == ASTNodeType::ASTNT_ConstNum) {
                 if (value->node != std::to_string(((ArlPDFNumber*)obj)->get_value()))
-                    return nullptr;
+                    return false;
             }
             break;
 
@@ -2654,10 +2603,10 @@ ASTNode* CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition,
             if (value->type == ASTNodeType::ASTNT_ConstPDFBoolean) {
                 bool b = ((ArlPDFBoolean*)obj)->get_value();
                 if ((value->node == "true") && !b) {
-                    return nullptr;
+                    return false;
                 }
                 else if ((value->node == "false") && b) {
-                    return nullptr;
+                    return false;
                 }
                 // else fall through
             }
@@ -2666,20 +2615,19 @@ ASTNode* CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition,
         case PDFObjectType::ArlPDFObjTypeString:
             if (value->type == ASTNodeType::ASTNT_ConstString) {
                 if (value->node != ToUtf8(((ArlPDFString*)obj)->get_value()))
-                    return nullptr;
+                    return false;
             }
             break;
 
         default:
             assert(false && "unexpected fn:RequiredValue value!");
-            return nullptr;
+            return false;
         } // switch obj_type
     }
 
-    ASTNode* retval = new ASTNode;
-    retval->type = value->type;
-    retval->node = value->node;
-    return retval;
+    out.type = value->type;
+    out.node = value->node;
+    return true;
 }
 
 
@@ -2688,20 +2636,20 @@ ASTNode* CPDFFile::fn_RequiredValue(ArlPDFObject* obj, const ASTNode* condition,
 /// 
 /// @param[in] condition    already reduced AST node tree that is true/false
 /// @param[in] value        can be any primitive PDF type (int, real, name, string-*, boolean)
+/// @param[out] out         value (copied!)
 /// 
-/// @returns a new ASTNode of value or nullptr if false/error
-ASTNode* CPDFFile::fn_DefaultValue(const ASTNode* condition, const ASTNode* value) {
+/// @returns true if out was set, false if condition was false
+bool CPDFFile::fn_DefaultValue(const ASTNode* condition, const ASTNode* value, ASTNode& out) {
     assert(value != nullptr);
     assert(condition != nullptr);
     assert(condition->type == ASTNodeType::ASTNT_ConstPDFBoolean);
 
     if (condition->node == "false")  // Condition was not met 
-        return nullptr;
+        return false;
 
-    ASTNode* retval = new ASTNode;
-    retval->type = value->type;
-    retval->node = value->node;
-    return retval;
+    out.type = value->type;
+    out.node = value->node;
+    return true;
 }
 
 
@@ -2721,7 +2669,7 @@ int CPDFFile::fn_StreamLength(ArlPDFObject* container, const ASTNode* key) {
     ArlPDFObject* o = get_object_for_path(container, key_parts);
     if ((o != nullptr) && (o->get_object_type() == PDFObjectType::ArlPDFObjTypeStream)) {
         ArlPDFDictionary* dict = ((ArlPDFStream*)o)->get_dictionary();
-        ArlPDFObject* len_obj = dict->get_value(L"Length");
+        ArlPDFObject* len_obj = dict->get_value("Length");
         delete dict;
         delete o;
         if ((len_obj != nullptr) && (len_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeNumber)) {
@@ -2782,9 +2730,10 @@ int CPDFFile::fn_StringLength(ArlPDFObject* container, const ASTNode* key) {
 /// 1 argument version just checks PDF version vs Arlington version.
 /// 
 /// @param[in] ver_node  version from Arlington PDF model
+/// @param[out] out      "true" or "false" depending on PDF version
 /// 
-/// @returns ASTNode with "true" or "false" depending on PDF version
-ASTNode* CPDFFile::fn_BeforeVersion(const ASTNode* ver_node) {
+/// @returns true (always determinate)
+bool CPDFFile::fn_BeforeVersion(const ASTNode* ver_node, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2795,10 +2744,9 @@ ASTNode* CPDFFile::fn_BeforeVersion(const ASTNode* ver_node) {
     int pdf_v = string_to_pdf_version(pdf_version);
     int arl_v = string_to_pdf_version(ver_node->node);
 
-    ASTNode* out = new ASTNode;
-    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-    out->node = (pdf_v < arl_v) ? "true" : "false";
-    return out;
+    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+    out.node = (pdf_v < arl_v) ? "true" : "false";
+    return true;
 }
 
 
@@ -2807,9 +2755,10 @@ ASTNode* CPDFFile::fn_BeforeVersion(const ASTNode* ver_node) {
 /// 
 /// @param[in] ver_node  version from Arlington PDF model
 /// @param[in] thing     (optional) the feature that was introduced
+/// @param[out] out      a copy of thing
 /// 
-/// @returns ASTNode or nullptr if after a PDF version
-ASTNode* CPDFFile::fn_BeforeVersion(const ASTNode* ver_node, const ASTNode* thing) {
+/// @returns true if out was set, false if after a PDF version
+bool CPDFFile::fn_BeforeVersion(const ASTNode* ver_node, const ASTNode* thing, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2821,12 +2770,11 @@ ASTNode* CPDFFile::fn_BeforeVersion(const ASTNode* ver_node, const ASTNode* thin
     int arl_v = string_to_pdf_version(ver_node->node);
 
     if ((thing != nullptr) && (pdf_v < arl_v)) {
-        ASTNode* out = new ASTNode;
-        out->type = thing->type;
-        out->node = thing->node;
-        return out;
+        out.type = thing->type;
+        out.node = thing->node;
+        return true;
     }
-    return nullptr;
+    return false;
 }
 
 
@@ -2834,9 +2782,10 @@ ASTNode* CPDFFile::fn_BeforeVersion(const ASTNode* ver_node, const ASTNode* thin
 /// 1 argument version just checks PDF version vs Arlington version.
 /// 
 /// @param[in] ver_node  version when introduced from Arlington PDF model
+/// @param[out] out      "true" or "false" depending on PDF version
 /// 
-/// @returns AST-Node node with "true" or "false"
-ASTNode* CPDFFile::fn_SinceVersion(const ASTNode* ver_node) {
+/// @returns true (always determinate)
+bool CPDFFile::fn_SinceVersion(const ASTNode* ver_node, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2847,10 +2796,9 @@ ASTNode* CPDFFile::fn_SinceVersion(const ASTNode* ver_node) {
     int pdf_v = string_to_pdf_version(pdf_version);
     int arl_v = string_to_pdf_version(ver_node->node);
 
-    ASTNode* out = new ASTNode;
-    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-    out->node = (pdf_v >= arl_v) ? "true" : "false";
-    return out;
+    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+    out.node = (pdf_v >= arl_v) ? "true" : "false";
+    return true;
 }
 
 
@@ -2860,9 +2808,10 @@ ASTNode* CPDFFile::fn_SinceVersion(const ASTNode* ver_node) {
 /// 
 /// @param[in] ver_node  version when feature 'thing' was introduced from Arlington PDF model
 /// @param[in] thing     (optional) the feature that was introduced
+/// @param[out] out      a copy of thing
 /// 
-/// @returns AST-Node tree or nullptr if before a PDF version
-ASTNode* CPDFFile::fn_SinceVersion(const ASTNode* ver_node, const ASTNode* thing) {
+/// @returns true if out was set, false if before a PDF version
+bool CPDFFile::fn_SinceVersion(const ASTNode* ver_node, const ASTNode* thing, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2874,12 +2823,11 @@ ASTNode* CPDFFile::fn_SinceVersion(const ASTNode* ver_node, const ASTNode* thing
     int arl_v = string_to_pdf_version(ver_node->node);
 
     if ((thing != nullptr) &&  (pdf_v >= arl_v)) {
-        ASTNode* out = new ASTNode;
-        out->type = thing->type;
-        out->node = thing->node;
-        return out;
+        out.type = thing->type;
+        out.node = thing->node;
+        return true;
     }
-    return nullptr;
+    return false;
 }
 
 
@@ -2888,9 +2836,10 @@ ASTNode* CPDFFile::fn_SinceVersion(const ASTNode* ver_node, const ASTNode* thing
 /// 1 argument version just checks PDF version vs Arlington version.
 /// 
 /// @param[in] ver_node  version when introduced from Arlington PDF model
+/// @param[out] out      "true" or "false" depending on PDF version
 /// 
-/// @returns AST-Node with "true" or "false" depending on PDF version
-ASTNode* CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node) {
+/// @returns true (always determinate)
+bool CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2901,10 +2850,9 @@ ASTNode* CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node) {
     int pdf_v = string_to_pdf_version(pdf_version);
     int arl_v = string_to_pdf_version(ver_node->node);
 
-    ASTNode* out = new ASTNode;
-    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-    out->node = (pdf_v == arl_v) ? "true" : "false";
-    return out;
+    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+    out.node = (pdf_v == arl_v) ? "true" : "false";
+    return true;
 }
 
 
@@ -2916,9 +2864,10 @@ ASTNode* CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node) {
 /// 
 /// @param[in] ver_node  version when feature 'thing' was introduced from Arlington PDF model
 /// @param[in] thing     (optional) the feature that was introduced
+/// @param[out] out      a copy of thing
 /// 
-/// @returns AST-Node tree or nullptr if not a specific PDF version
-ASTNode* CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node, const ASTNode* thing) {
+/// @returns true if out was set, false if not a specific PDF version
+bool CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node, const ASTNode* thing, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2929,12 +2878,11 @@ ASTNode* CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node, const ASTNode* thing
     int pdf_v = string_to_pdf_version(pdf_version);
     int arl_v = string_to_pdf_version(ver_node->node);
     if ((thing != nullptr) && (pdf_v == arl_v)) {
-        ASTNode* out = new ASTNode;
-        out->type = thing->type;
-        out->node = thing->node;
-        return out;
+        out.type = thing->type;
+        out.node = thing->node;
+        return true;
     }
-    return nullptr;
+    return false;
 }
 
 
@@ -2942,9 +2890,10 @@ ASTNode* CPDFFile::fn_IsPDFVersion(const ASTNode* ver_node, const ASTNode* thing
 /// true, else false.
 ///
 /// @param[in] dep_ver  version when deprecated from the Arlington PDF model (1st arg to predicate)
+/// @param[out] out      "true" if before a PDF version
 /// 
-/// @returns AST-Node "true" if at or after a PDF version
-ASTNode* CPDFFile::fn_Deprecated(const ASTNode* dep_ver) {
+/// @returns true (always determinate)
+bool CPDFFile::fn_Deprecated(const ASTNode* dep_ver, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2959,22 +2908,22 @@ ASTNode* CPDFFile::fn_Deprecated(const ASTNode* dep_ver) {
     if (!deprecated)
         deprecated = (pdf_v >= arl_v);
 
-    ASTNode* out = new ASTNode;
-    out->type = ASTNodeType::ASTNT_ConstPDFBoolean;
-    out->node = (pdf_v < arl_v) ? "true" : "false";
-    return out;
+    out.type = ASTNodeType::ASTNT_ConstPDFBoolean;
+    out.node = (pdf_v < arl_v) ? "true" : "false";
+    return true;
 }
 
 
 /// @brief Deprecated predicate. If PDF version is BEFORE Arlington's deprecated version, then return 
-/// whatever it was, otherwise return nullptr (meaning `thing` shouldn't exist as it has been deprecated).
+/// whatever it was, otherwise return false (meaning `thing` shouldn't exist as it has been deprecated).
 ///
 /// @param[in] dep_ver  version when deprecated from the Arlington PDF model (1st arg to predicate)
 /// @param[in] thing    thing that was deprecated (2nd arg to predicate) which itself may have been 
 ///                     a predicate and thus already reduced to an ASTNode or nullptr
+/// @param[out] out      a copy of thing
 /// 
-/// @returns AST-Node tree or nullptr if at or after a PDF version
-ASTNode* CPDFFile::fn_Deprecated(const ASTNode* dep_ver, const ASTNode* thing) {
+/// @returns true if out was set, false if at or after a PDF version
+bool CPDFFile::fn_Deprecated(const ASTNode* dep_ver, const ASTNode* thing, ASTNode& out) {
     assert(pdf_version.size() == 3);
     assert(FindInVector(v_ArlPDFVersions, pdf_version));
 
@@ -2990,19 +2939,20 @@ ASTNode* CPDFFile::fn_Deprecated(const ASTNode* dep_ver, const ASTNode* thing) {
         deprecated = (pdf_v >= arl_v);
 
     if ((pdf_v < arl_v) && (thing != nullptr)) {
-        ASTNode* out = new ASTNode;
-        out->type = thing->type;
-        out->node = thing->node;
-        return out;
+        out.type = thing->type;
+        out.node = thing->node;
+        return true;
     }
-    return nullptr;
+    return false;
 }
 
 
 /// @brief Returns the number of pages in the PDF file or -1 on error
 /// @returns Number of pages in the PDF file or -1 on error
 int CPDFFile::fn_NumberOfPages() {
-    return pdfsdk.get_pdf_page_count();
+    if (doc_facts.page_count < 0)
+        doc_facts.page_count = pdfsdk.get_pdf_page_count();
+    return doc_facts.page_count;
 }
 
 
@@ -3033,14 +2983,13 @@ bool CPDFFile::fn_Contains(ArlPDFObject* obj, const ASTNode* key, const ASTNode*
             ArlPDFArray* arr = (ArlPDFArray*)obj;
             for (int i = 0; (i < arr->get_num_elements()) && !retval; i++) {
                 ArlPDFObject* elem = arr->get_value(i);
-                ASTNode* v = convert_basic_object_to_ast(elem);
-                if (v == nullptr) {
+                ASTNode v;
+                if (!convert_basic_object_to_ast(elem, v)) {
                     // Array reference was another complex PDF object (array, dictionary, stream) or null
                     /// @todo - handle complex nested references for fn_Contains. Not currently required.
                 }
-                else if (v->type == value->type)
-                    retval = (v->node == value->node);
-                delete v;
+                else if (v.type == value->type)
+                    retval = (v.node == value->node);
                 delete elem;
             }
         }
@@ -3050,10 +2999,9 @@ bool CPDFFile::fn_Contains(ArlPDFObject* obj, const ASTNode* key, const ASTNode*
         case PDFObjectType::ArlPDFObjTypeString:
         case PDFObjectType::ArlPDFObjTypeName:
         {
-            ASTNode* v = convert_basic_object_to_ast(obj);
-            if ((v != nullptr) && (v->type == value->type))
-                retval = (v->node == value->node);
-            delete v;
+            ASTNode v;
+            if (convert_basic_object_to_ast(obj, v) && (v.type == value->type))
+                retval = (v.node == value->node);
         }
         break;
         case PDFObjectType::ArlPDFObjTypeNull:
@@ -26,17 +26,58 @@
 #pragma once
 
 #include "ASTNode.h"
+#include "ArlPredicateProgram.h"
 #include "ArlingtonPDFShim.h"
 #include "ArlingtonTSVGrammarFile.h"
+#include "ArlResults.h"
+#include "ArlStats.h"
+#include "ArlTreeIndex.h"
 
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <iostream>
 
 using namespace ArlingtonPDFShim;
 namespace fs = std::filesystem;
 
+/// @brief Document-wide facts used by predicates. Each fact is computed lazily, at most once
+/// per PDF file, and all are discarded by CPDFFile::close_pdf().
+struct ArlDocFacts {
+    /// @brief number of pages (fn:NumberOfPages) or -1 if not yet computed
+    int             page_count;
+
+    /// @brief true once is_tagged has been computed (fn:IsPDFTagged)
+    bool            is_tagged_known;
+    bool            is_tagged;
+
+    /// @brief true once is_encrypted_wrapper has been computed (fn:IsEncryptedWrapper)
+    bool            is_encrypted_wrapper_known;
+    bool            is_encrypted_wrapper;
+
+    /// @brief true once associated_files has been computed (fn:IsAssociatedFile)
+    bool            associated_files_known;
+
+    /// @brief object IDs of the File Specification dictionaries in DocCat::AF
+    std::unordered_set<object_id, object_id_hash>   associated_files;
+
+    /// @brief fn:NotStandard14Font results for indirect font dictionaries
+    std::unordered_map<object_id, bool, object_id_hash>  not_standard14_fonts;
+
+    /// @brief Indexes of name trees and number trees below trailer::, keyed by tree type and
+    /// Arlington path (e.g. "name:trailer::Catalog::Names::Dests"). nullptr if there is no such tree.
+    std::unordered_map<std::string, std::shared_ptr<const CArlTreeIndex>>  trailer_trees;
+
+    ArlDocFacts() :
+        page_count(-1), is_tagged_known(false), is_tagged(false), is_encrypted_wrapper_known(false),
+        is_encrypted_wrapper(false), associated_files_known(false)
+        { /* constructor */ };
+};
+
+
 class CPDFFile
 {
 private:
@@ -46,6 +87,9 @@ private:
     /// @brief PDF SDK object reference
     ArlingtonPDFSDK&        pdfsdk;
 
+    /// @brief Profiling counters (--stats) or nullptr
+    ArlStats*               stats;
+
     /// @brief Physical file size (in bytes). int for simplicity.
     int                     filesize_bytes;
 
@@ -61,6 +105,9 @@ private:
     /// @brief Don't round off PDF versions - do an exact version compare (--force exact)
     bool                    exact_version_compare;
 
+    /// @brief Validate against every PDF version at once (--force all). The PDF version of the file is still determined exactly.
+    bool                    all_versions;
+
     /// @brief Latest PDF version found in the PDF file (based on Arlington SinceVersion field). Initialized to "1.0".
     std::string             latest_feature_version;
 
@@ -75,17 +122,31 @@ private:
 
     /// @brief flags whether a predicate expression was fully implemented.
     /// Only ever set to false in predicate implementations.
-    /// Only initialized to true at the start of ProcessPredicate()
+    /// Only initialized to true at the start of ExecutePredicate()
     bool                    fully_implemented;
 
+    /// @brief Value stack for ExecutePredicate(), reused across predicates. Slots with
+    /// type ASTNT_Unknown are indeterminate (nullptr) values.
+    std::vector<ASTNode>    vm_stack;
+
     /// @brief the value of the trailer /Size key (i.e. maximum object number + 1)
     int                     trailer_size;
 
     /// @brief List of names of extensions being supported. Default = empty list
     std::vector<std::string>    extensions;
 
+    /// @brief Per-document cache of name tree and number tree indexes. Keyed by tree type and
+    /// object ID for indirect roots or by Arlington path for direct roots (see get_tree_index())
+    std::unordered_map<std::string, std::shared_ptr<const CArlTreeIndex>>  tree_indexes;
+
+    /// @brief Per-document cache of document-wide facts used by predicates
+    ArlDocFacts             doc_facts;
+
+    /// @brief Gets the (cached) index of a name tree or number tree at an absolute Arlington path (trailer::...)
+    std::shared_ptr<const CArlTreeIndex> get_trailer_tree_index(ArlPDFDictionary* container, const ArlTreeType t, const std::string& arl_path);
+
     /// @brief Method to check if a key value is within a prescribed set of values
-    bool check_key_value(ArlPDFDictionary* dict, const std::wstring& key, const std::vector<std::wstring> values);
+    bool check_key_value(ArlPDFDictionary* dict, const std::string& key, const std::vector<std::wstring> values);
 
     /// @brief Split an Arlington key path (e.g. Catalog::Names::Dests) into a vector of keys
     std::vector<std::string> split_key_path(std::string key);
@@ -93,24 +154,27 @@ private:
     /// @brief  Gets the object mentioned by an Arlington path
     ArlPDFObject* get_object_for_path(ArlPDFObject* parent, const std::vector<std::string>& arlpath);
 
+    /// @brief Gets the dictionary-map or name/number tree root mentioned by a predicate argument
+    ArlPDFObject* get_map_for_path(ArlPDFDictionary* container, const std::vector<std::string>& keys);
+
     /// @brief Convert a basic PDF object into an AST-Node equivalent
-    ASTNode* convert_basic_object_to_ast(ArlPDFObject *obj);
+    bool convert_basic_object_to_ast(ArlPDFObject *obj, ASTNode& out);
 
     double convert_node_to_double(const ASTNode* node);
 
     // Arlington version-based predicates come in 2 flavors: 1 and 2 arguments
     // Because the 2nd argument can be nullptr (e.g. if not in a PDF file) then need separate 
-    // implementations to disambiguate
-    ASTNode* fn_BeforeVersion(const ASTNode* ver_node);
-    ASTNode* fn_BeforeVersion(const ASTNode* ver_node, const ASTNode* thing);
-    ASTNode* fn_Deprecated(const ASTNode* dep_ver);
-    ASTNode* fn_Deprecated(const ASTNode* dep_ver, const ASTNode* thing);
-    ASTNode* fn_IsPDFVersion(const ASTNode* ver_node);
-    ASTNode* fn_IsPDFVersion(const ASTNode* ver_node, const ASTNode* thing);
-    ASTNode* fn_SinceVersion(const ASTNode* ver_node);
-    ASTNode* fn_SinceVersion(const ASTNode* ver_node, const ASTNode* thing);
-    ASTNode* fn_Extension(const ASTNode* extn);
-    ASTNode* fn_Extension(const ASTNode* extn, const ASTNode* value);
+    // implementations to disambiguate. Results are written to 'out' (false = indeterminate).
+    bool fn_BeforeVersion(const ASTNode* ver_node, ASTNode& out);
+    bool fn_BeforeVersion(const ASTNode* ver_node, const ASTNode* thing, ASTNode& out);
+    bool fn_Deprecated(const ASTNode* dep_ver, ASTNode& out);
+    bool fn_Deprecated(const ASTNode* dep_ver, const ASTNode* thing, ASTNode& out);
+    bool fn_IsPDFVersion(const ASTNode* ver_node, ASTNode& out);
+    bool fn_IsPDFVersion(const ASTNode* ver_node, const ASTNode* thing, ASTNode& out);
+    bool fn_SinceVersion(const ASTNode* ver_node, ASTNode& out);
+    bool fn_SinceVersion(const ASTNode* ver_node, const ASTNode* thing, ASTNode& out);
+    bool fn_Extension(const ASTNode* extn, ASTNode& out);
+    bool fn_Extension(const ASTNode* extn, const ASTNode* value, ASTNode& out);
 
     bool fn_AlwaysUnencrypted(ArlPDFObject* obj);
     bool fn_ArraySortAscending(ArlPDFObject* container, const ASTNode *arr_key, const ASTNode* step);
@@ -130,15 +194,15 @@ private:
     bool fn_IsHexString(ArlPDFObject* obj);
     bool fn_IsLastInArray(ArlPDFObject* container, ArlPDFObject* obj, const ASTNode* key);
     bool fn_IsPDFTagged();
-    bool fn_IsPresent(ArlPDFObject* container, std::string& key);
+    bool fn_IsPresent(ArlPDFObject* container, const std::string& key);
     bool fn_MustBeDirect(ArlPDFObject* container, ArlPDFObject* obj, const ASTNode* arg);
-    bool fn_NoCycle(ArlPDFObject* obj, const std::string& key);
+    bool fn_NoCycle(ArlPDFObject* obj, const std::string_view key);
     bool fn_NotStandard14Font(ArlPDFObject* container);
     bool fn_PageContainsStructContentItems(ArlPDFObject* obj);
     bool fn_Contains(ArlPDFObject* obj, const ASTNode* key, const ASTNode* value);
-    ASTNode* fn_PageProperty(ArlPDFObject* container, ASTNode* pg, ASTNode* pg_key);
-    ASTNode* fn_RequiredValue(ArlPDFObject* container, const ASTNode* condition, const ASTNode* value);
-    ASTNode* fn_DefaultValue(const ASTNode* condition, const ASTNode* value);
+    bool fn_PageProperty(ArlPDFObject* container, const ASTNode* pg, const ASTNode* pg_key, ASTNode& out);
+    bool fn_RequiredValue(ArlPDFObject* container, const ASTNode* condition, const ASTNode* value, ASTNode& out);
+    bool fn_DefaultValue(const ASTNode* condition, const ASTNode* value, ASTNode& out);
     double fn_RectHeight(ArlPDFObject* container, const ASTNode* key);
     double fn_RectWidth(ArlPDFObject* container, const ASTNode* key);
     int  fn_ArrayLength(ArlPDFObject* container, const ASTNode* key);
@@ -151,21 +215,27 @@ public:
     /// @brief PDF version being used (always a valid version, default is "2.0"). PUBLIC
     std::string             pdf_version;
 
-    CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns);
+    CPDFFile(const fs::path& pdf_file, ArlingtonPDFSDK& pdf_sdk, const std::string& forced_ver, const std::vector<std::string>& extns, ArlStats* run_stats = nullptr);
 
     ~CPDFFile() { /* destructor  delete doccat; */ };
 
+    /// @brief Discards all cached document facts and tree indexes, then closes the PDF file
+    void close_pdf();
+
     /// @brief Returns the PDF files trailer dictionary or nullptr on error. DO NOT FREE!
     ArlPDFTrailer* get_ptr_to_trailer() { return pdfsdk.get_trailer(); };
 
+    /// @returns the PDF filename
+    const fs::path& get_pdf_filename() const { return pdf_filename; };
+
     /// @returns the trailer /Size key or -1
     int get_trailer_size() { return trailer_size; };
 
     /// @brief PDF version to use when processing a PDF file (always a valid version)
-    std::string  check_and_get_pdf_version(std::ostream& ofs);
+    std::string  check_and_get_pdf_version(std::ostream& ofs, ArlResultSink* sink = nullptr);
 
     /// @brief Set the PDF version for an encountered feature so we can track latest version used
-    void set_feature_version(const std::string& ver, const std::string& arl, const std::string& key);
+    void set_feature_version(const std::string_view ver, const std::string& arl, const std::string& key);
 
     /// @brief returns the latest feature version encountered so far as a human readable string.
     std::string get_latest_feature_version_info();
@@ -173,11 +243,17 @@ public:
     /// @brief whether a version override is being forced by --force (could be a PDF version or 'exact')
     bool is_forced_version() { return (forced_version.size() > 0); }
 
+    /// @brief whether the PDF file is validated against every PDF version at once (--force all)
+    bool is_all_versions() { return all_versions; }
+
     /// @brief returns the list of currently support extensions. Could be an empty vector.
-    std::vector<std::string> get_extensions() { return extensions; }
+    const std::vector<std::string>& get_extensions() const { return extensions; }
+
+    /// @brief Gets the (cached) index of a name tree or number tree
+    std::shared_ptr<const CArlTreeIndex> get_tree_index(ArlPDFDictionary* root, const ArlTreeType t, const std::string& arl_path = "");
 
-    /// @brief Calculates an Arlington predicate expression
-    ASTNode* ProcessPredicate(ArlPDFObject* container, ArlPDFObject* obj, const ASTNode* in_ast, const int key_idx, const ArlTSVmatrix& tsv_data, const int type_idx, int depth, const bool use_default_values);
+    /// @brief Calculates a compiled Arlington predicate expression
+    bool ExecutePredicate(ArlPDFObject* container, ArlPDFObject* obj, const ArlPredicateProgram& prog, const int key_idx, const ArlTSVmatrix& tsv_data, const bool use_default_values, ASTNode& result);
 
     void ClearPredicateStatus() { deprecated = false; fully_implemented = true; };
     bool PredicateWasDeprecated() { return deprecated; };
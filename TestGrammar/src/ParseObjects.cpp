@@ -25,6 +25,7 @@
 #include "ArlPredicates.h"
 #include "ASTNode.h"
 #include "PredicateProcessor.h"
+#include "TestGrammarVers.h"
 #include "LRParsePredicate.h"
 #include "utils.h"
 #include "PDFFile.h"
@@ -61,25 +62,75 @@ namespace fs = std::filesystem;
 #endif
 
 
-/// @brief Locates & reads in a single Arlington TSV grammar file. The input data is not altered or validated.
+/// @brief Smallest and largest number of object numbers remembered in CParsePDF::visited (larger ones use visited_other)
+const uintmax_t ArlVisitedMinLimit = 4096;
+const uintmax_t ArlVisitedMaxLimit = 1 << 22;
+
+
+/// @brief Locates a single Arlington TSV grammar file in the shared Arlington PDF model. The data is not altered or validated.
 ///
-/// @param[in] link   the stub name of an Arlington TSV grammar file from the TSV data (i.e. without folder or ".tsv" extension)
+/// @param[in] link   the symbol of an Arlington TSV grammar file from the TSV data
 ///
-/// @returns          a row/column matrix (vector of vector) of raw strings directly from the TSV file
-const ArlTSVmatrix& CParsePDF::get_grammar(const std::string &link)
+/// @returns          the Arlington TSV grammar file (never nullptr - missing files have no data). DO NOT FREE!
+const CArlingtonTSVGrammarFile* CParsePDF::get_grammar(const ArlSymbol link)
 {
-    auto it = grammar_map.find(link);
-    if (it == grammar_map.end())
-    {
-        fs::path grammar_file = grammar_folder;
-        grammar_file /= link + ".tsv";
-        std::unique_ptr<CArlingtonTSVGrammarFile> reader(new CArlingtonTSVGrammarFile(grammar_file));
-        reader->load();
-        const ArlTSVmatrix& to_ret = reader->get_data();
-        grammar_map.insert(std::make_pair(link, std::move(reader)));
-        return to_ret;
+    return grammar->get_grammar_file(link);
+}
+
+
+/// @brief Locates an Arlington TSV grammar file reduced for the PDF version and extensions being validated.
+/// Specializations are shared by all PDF files (and threads) with the same PDF version and extensions.
+///
+/// @param[in] tsv_file   the Arlington TSV grammar file. Never nullptr.
+///
+/// @returns the specialization of tsv_file for pdf_version and the extensions of the PDF file
+const CArlTSVSpecialization& CParsePDF::get_specialization(const CArlingtonTSVGrammarFile* tsv_file)
+{
+    assert(tsv_file != nullptr);
+    auto it = specializations.find(tsv_file);
+    if (it != specializations.end())
+        return *it->second;
+    const CArlTSVSpecialization& spec = tsv_file->get_specialization(pdf_version, pdfc->get_extensions());
+    specializations[tsv_file] = &spec;
+    return spec;
+}
+
+
+/// @brief Looks up whether an indirect PDF object has already been visited
+///
+/// @param[in] id   the PDF object identifier
+///
+/// @returns        the link the object was validated with, or ArlNoSymbol if not yet visited
+ArlSymbol CParsePDF::find_visited(const object_id& id)
+{
+    if ((id.object_num > 0) && (id.object_num < (int)visited.size())) {
+        const visited_elem& v = visited[id.object_num];
+        if ((v.link == ArlNoSymbol) || (v.generation_num == id.generation_num))
+            return v.link;
     }
-    return it->second->get_data();
+    auto found = visited_other.find(id);
+    return (found != visited_other.end()) ? found->second : ArlNoSymbol;
+}
+
+
+/// @brief Remembers that an indirect PDF object was visited (validated with a specific link)
+///
+/// @param[in] id        the PDF object identifier
+/// @param[in] link      the link used to validate the object
+void CParsePDF::set_visited(const object_id& id, const ArlSymbol link)
+{
+    assert(link != ArlNoSymbol);
+    if ((id.object_num > 0) && (id.object_num < visited_limit)) {
+        if (id.object_num >= (int)visited.size())
+            visited.resize(std::min(visited_limit, std::max(id.object_num + 1, 2 * (int)visited.size())));
+        visited_elem& v = visited[id.object_num];
+        if (v.link == ArlNoSymbol) {
+            v.generation_num = id.generation_num;
+            v.link = link;
+            return;
+        }
+    }
+    visited_other.insert(std::make_pair(id, link));
 }
 
 
@@ -101,6 +152,175 @@ bool CParsePDF::check_numeric_array(ArlPDFArray* arr, const int elems_to_check)
 }
 
 
+/// @brief Tries to select a single Link for a PDF object just from the values of discriminating keys
+/// (Type, Subtype, S, TransformMethod or array element 0) using the pre-calculated discriminator of the Link set.
+///
+/// @param[in]  obj     the PDF object in question (dictionary, stream or array)
+/// @param[in]  links   vector of Arlington 'Links' (more than 1)
+/// @param[in]  d       discriminator of links or nullptr
+///
+/// @returns the only Link that allows the values of the discriminating keys of obj, or ArlNoSymbol if
+/// the values are missing or do not select exactly one Link (i.e. scoring is required)
+ArlSymbol CParsePDF::discriminate_link(ArlPDFObject* obj, const std::vector<ArlSymbol>& links, const ArlLinkDiscriminator* d) {
+    if ((d == nullptr) || d->keys.empty())
+        return ArlNoSymbol;
+
+    auto obj_type = obj->get_object_type();
+    ArlPDFDictionary* dictObj = nullptr;
+    if (obj_type == PDFObjectType::ArlPDFObjTypeDictionary)
+        dictObj = (ArlPDFDictionary*)obj;
+    else if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
+        dictObj = ((ArlPDFStream*)obj)->get_dictionary();
+    else if (obj_type != PDFObjectType::ArlPDFObjTypeArray)
+        return ArlNoSymbol;
+
+    uint64_t candidates = ~(uint64_t)0;
+    for (auto& dk : d->keys) {
+        ArlPDFObject* val = nullptr;
+        if (dk.is_array_index) {
+            if ((obj_type == PDFObjectType::ArlPDFObjTypeArray) && (((ArlPDFArray*)obj)->get_num_elements() > 0))
+                val = ((ArlPDFArray*)obj)->get_value(0);
+        }
+        else if (dictObj != nullptr)
+            val = dictObj->get_value(dk.key);
+
+        // Missing keys or values that are not names do not discriminate
+        if (val != nullptr) {
+            if (val->get_object_type() == PDFObjectType::ArlPDFObjTypeName) {
+                auto found = dk.links_for_value.find(((ArlPDFName*)val)->get_value());
+                candidates &= (found != dk.links_for_value.end()) ? found->second : 0;
+            }
+            delete val;
+        }
+        if (candidates == 0)
+            break;
+    }
+
+    if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
+        delete dictObj;
+
+    // Exactly one Link?
+    if ((candidates == 0) || ((candidates & (candidates - 1)) != 0))
+        return ArlNoSymbol;
+    int i = 0;
+    while ((candidates & ((uint64_t)1 << i)) == 0)
+        i++;
+    if (i >= (int)links.size())
+        return ArlNoSymbol;
+    return links[i];
+}
+
+
+/// @brief Appends the type and optionally the (primitive) value of a PDF object to a memo key.
+/// Strings are length-prefixed so that keys are unambiguous.
+///
+/// @param[in,out] key        the memo key being built
+/// @param[in]     val        a PDF object (key value or array element)
+/// @param[in]     with_value true if scoring looks at the value, false if only the type matters
+void CParsePDF::append_link_memo_value(std::string& key, ArlPDFObject* val, const bool with_value) {
+    auto t = val->get_object_type();
+    key += (char)('A' + (int)t);
+    key += (val->is_indirect_ref() ? '^' : '=');
+    if (!with_value)
+        return;
+
+    std::string s;
+    switch (t) {
+        case PDFObjectType::ArlPDFObjTypeBoolean:
+            key += (((ArlPDFBoolean*)val)->get_value() ? '1' : '0');
+            break;
+        case PDFObjectType::ArlPDFObjTypeNumber:
+            if (((ArlPDFNumber*)val)->is_integer_value())
+                s = std::to_string(((ArlPDFNumber*)val)->get_integer_value());
+            else {
+                char buf[32];
+                snprintf(buf, sizeof(buf), "%.17g", ((ArlPDFNumber*)val)->get_value());
+                s = buf;
+            }
+            break;
+        case PDFObjectType::ArlPDFObjTypeName:
+            s = ToUtf8(((ArlPDFName*)val)->get_value());
+            break;
+        case PDFObjectType::ArlPDFObjTypeString:
+            s = ToUtf8(((ArlPDFString*)val)->get_value());
+            break;
+        case PDFObjectType::ArlPDFObjTypeArray:
+            s = std::to_string(((ArlPDFArray*)val)->get_num_elements()); // for fn:ArrayLength()
+            break;
+        default:
+            break;
+    }
+    key += std::to_string(s.size());
+    key += ':';
+    key += s;
+}
+
+
+/// @brief Builds the memo key for selecting a Link for a PDF object: the Link set, the object type,
+/// the sorted keys (or array elements) with their types and the values of just those keys that
+/// scoring looks at (see ArlLinkDiscriminator::value_keys). Per-object values such as /Contents or
+/// /StructParent are left out so that objects of the same shape share one memo entry.
+///
+/// @param[in]  obj    the PDF object in question
+/// @param[in]  d      discriminator of the Link set. Never nullptr.
+/// @param[out] key    the memo key
+///
+/// @returns true if obj can be memoized (key is valid)
+bool CParsePDF::make_link_memo_key(ArlPDFObject* obj, const ArlLinkDiscriminator* d, std::string& key) {
+    assert(d != nullptr);
+    if (!d->memoizable)
+        return false;
+
+    auto obj_type = obj->get_object_type();
+    key.assign((const char*)&d->id, sizeof(d->id));
+    key += (char)('A' + (int)obj_type);
+
+    if (obj_type == PDFObjectType::ArlPDFObjTypeArray) {
+        ArlPDFArray* arr = (ArlPDFArray*)obj;
+        int num_elems = arr->get_num_elements();
+        if (num_elems > 64) // Not worth memoizing
+            return false;
+        for (int i = 0; i < num_elems; i++) {
+            ArlPDFObject* elem = arr->get_value(i);
+            if (elem != nullptr) {
+                bool with_value = d->all_element_values || std::binary_search(d->value_keys.begin(), d->value_keys.end(), std::to_string(i));
+                append_link_memo_value(key, elem, with_value);
+                delete elem;
+            }
+            else
+                key += '?';
+        }
+        return true;
+    }
+
+    ArlPDFDictionary* dictObj;
+    if (obj_type == PDFObjectType::ArlPDFObjTypeDictionary)
+        dictObj = (ArlPDFDictionary*)obj;
+    else if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
+        dictObj = ((ArlPDFStream*)obj)->get_dictionary();
+    else
+        return false;
+
+    // Keys in sorted order so the memo key does not depend on the PDF SDK
+    dictObj->for_each_key([&](const std::string& k, ArlPDFObject* val) {
+        key += std::to_string(k.size());
+        key += ':';
+        key += k;
+        if (val != nullptr) {
+            append_link_memo_value(key, val, std::binary_search(d->value_keys.begin(), d->value_keys.end(), k));
+            delete val;
+        }
+        else
+            key += '?';
+        return true;
+    });
+
+    if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
+        delete dictObj;
+    return true;
+}
+
+
 ///@brief  Choose a specific link for a PDF object from a provided set of Arlington links to validate further.
 /// Select a link with as many required values with matching "Possible Values" as possible.
 /// Sometimes required values are missing, are inherited, etc.
@@ -111,16 +331,41 @@ bool CParsePDF::check_numeric_array(ArlPDFArray* arr, const int elems_to_check)
 /// @param[in]  links        vector of Arlington 'Links' to try (predicates are SAFE)
 /// @param[in]  obj_name     the path of the PDF object in the PDF file
 ///
-/// @returns a single Arlington link that is the best match for the given PDF object. Or "" if no link.
-std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std::vector<std::string> links, const std::string obj_name) {
+/// @returns a single Arlington link that is the best match for the given PDF object. Or ArlNoSymbol if no link.
+ArlSymbol CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std::vector<ArlSymbol>& links, const std::string& obj_name) {
     assert(obj != nullptr);
 
     if (links.size() == 0) // Nothing to choose from
-        return "";
+        return ArlNoSymbol;
 
     if (links.size() == 1)  // Choice of 1
         return links[0];
 
+    // Most objects are selected just by the values of their discriminating keys
+    const ArlLinkDiscriminator* d = grammar->get_discriminator(links);
+    ArlSymbol discriminated = discriminate_link(obj, links, d);
+    if (discriminated != ArlNoSymbol) {
+#if defined(SCORING_DEBUG)
+        std::cout << "Discriminated " << *obj << " " << strip_leading_whitespace(obj_name) << " as " << grammar->get_symbol_name(discriminated) << std::endl;
+#endif
+        return discriminated;
+    }
+
+    // Structurally identical objects always get the same score so re-use a previous selection
+    std::string memo_key;
+    bool        memoize = (d != nullptr) && make_link_memo_key(obj, d, memo_key);
+    if (memoize) {
+        auto found = link_memo.find(memo_key);
+        if (found != link_memo.end()) {
+            link_memo_hits++;
+#if defined(SCORING_DEBUG)
+            std::cout << "Memoized " << *obj << " " << strip_leading_whitespace(obj_name) << " as " << grammar->get_symbol_name(found->second) << std::endl;
+#endif
+            return found->second;
+        }
+        link_memo_misses++;
+    }
+
     auto obj_type = obj->get_object_type();
 
     int  to_ret = -1;
@@ -129,16 +374,18 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
 #if defined(SCORING_DEBUG)
     std::cout << "Deciding for " << *obj << " " << strip_leading_whitespace(obj_name) << " (" << PDFObjectType_strings[(int)obj_type] << ") between ";
     for (auto& l : links)
-        std::cout << l << ",";
+        std::cout << grammar->get_symbol_name(l) << ",";
     std::cout << std::endl;
 #endif
 
     // Checking each Link against obj to see which one is most suitable
     for (auto i = 0; i < (int)links.size(); i++) {
 #if defined(SCORING_DEBUG)
-        std::cout << "\tScoring " << links[i] << ": ";
+        std::cout << "\tScoring " << grammar->get_symbol_name(links[i]) << ": ";
 #endif
-        const ArlTSVmatrix& data_list = get_grammar(links[i]);
+        const CArlingtonTSVGrammarFile* link_grammar = get_grammar(links[i]);
+        const ArlTSVmatrix& data_list = link_grammar->get_data();
+        const ArlTSVTypedMatrix& typed_data = link_grammar->get_typed_data();
 
 
         int key_idx = -1;
@@ -156,7 +403,8 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
 
             int num_keys_matched = 0;
             bool a_required_key_was_bad = false;
-            PredicateProcessor pp(pdfc, data_list);
+            const CArlTSVSpecialization& link_spec = get_specialization(link_grammar);
+            PredicateProcessor pp(pdfc, link_grammar, &link_spec);
             for (auto& vec : data_list) {
                 key_idx++;
                 ArlPDFObject* inner_object = nullptr;
@@ -164,7 +412,7 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
                     case PDFObjectType::ArlPDFObjTypeArray:
                         {
                             // vec[TSV_KEYNAME] should be an integer
-                            int idx = key_to_array_index(vec[TSV_KEYNAME]);
+                            int idx = key_to_array_index(typed_data[key_idx].key);
                             if ((idx >= 0) && (idx < ((ArlPDFArray*)obj)->get_num_elements()))
                                 inner_object = ((ArlPDFArray*)obj)->get_value(idx);
                         }
@@ -172,15 +420,15 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
                     case PDFObjectType::ArlPDFObjTypeDictionary:
                         {
                             ArlPDFDictionary* dictObj = (ArlPDFDictionary*)obj;
-                            if (dictObj->has_key(utf8ToUtf16(vec[TSV_KEYNAME])))
-                                inner_object = dictObj->get_value(utf8ToUtf16(vec[TSV_KEYNAME]));
+                            if (dictObj->has_key(typed_data[key_idx].key))
+                                inner_object = dictObj->get_value(typed_data[key_idx].key);
                         }
                         break;
                     case PDFObjectType::ArlPDFObjTypeStream:
                         {
                             ArlPDFDictionary* stmDictObj = ((ArlPDFStream*)obj)->get_dictionary();
-                            if (stmDictObj->has_key(utf8ToUtf16(vec[TSV_KEYNAME])))
-                                inner_object = stmDictObj->get_value(utf8ToUtf16(vec[TSV_KEYNAME]));
+                            if (stmDictObj->has_key(typed_data[key_idx].key))
+                                inner_object = stmDictObj->get_value(typed_data[key_idx].key);
                             delete stmDictObj;
                         }
                         break;
@@ -198,7 +446,7 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
                     std::wstring   str_value;  // inner_object value from PDF as string
 
                     // Get required-ness of key/array element
-                    ArlVersion inner_versioner(inner_object, vec, pdf_version, pdfc->get_extensions());
+                    const ArlVersion& inner_versioner = link_spec.get_version(key_idx, inner_object);
                     reqd_key = pp.IsRequired(obj, inner_object, key_idx, inner_versioner.get_arlington_type_index());
 
                     // Get deprecation of key/array element
@@ -303,42 +551,129 @@ std::string CParsePDF::recommended_link_for_object(ArlPDFObject* obj, const std:
     // lowest score wins
     if (to_ret >= 0) {
 #if defined(SCORING_DEBUG)
-        std::cout << "\tOutcome: " << *obj << " as " << links[to_ret] << " with score " << min_score << std::endl;
+        std::cout << "\tOutcome: " << *obj << " as " << grammar->get_symbol_name(links[to_ret]) << " with score " << min_score << std::endl;
 #endif
+        if (memoize)
+            link_memo.insert(std::make_pair(memo_key, links[to_ret]));
         return links[to_ret];
     }
 
-    output << COLOR_ERROR << "can't select any Link to validate PDF object " << strip_leading_whitespace(obj_name) << " as " << PDFObjectType_strings[(int)obj_type];
+    std::ostream& msg = message(ArlSeverity::Error, ArlMessageCode::NoLinkSelected, "", "", obj, strip_leading_whitespace(obj_name));
+    msg << "can't select any Link to validate PDF object " << strip_leading_whitespace(obj_name) << " as " << PDFObjectType_strings[(int)obj_type];
     if (debug_mode)
-        output << " (" << *obj << ")";
-    output << COLOR_RESET;
-    return "";
+        msg << " (" << *obj << ")";
+    msg << COLOR_RESET;
+    return ArlNoSymbol;
 }
 
 
-/// @brief  Recursively looks for 'key' via inheritance (i.e. through "/Parent" keys)
+/// @brief Selects a Link for each PDF object without validating anything (see test/TestGrammarBench.cpp)
 ///
-/// @param[in] obj
-/// @param[in] key        the key to find
-/// @param[in] depth      recursive depth (in case of malformed PDFs to stop infinite loops!)
+/// @param[in] pdf     the open PDF file that objs come from
+/// @param[in] objs    PDF objects to select a Link for
+/// @param[in] links   the Links to choose from (as for a single Arlington row)
+/// @param[in] cold    true to forget all previously memoized Link selections first
 ///
-/// @returns nullptr if 'key' is NOT located via inheritance, otherwise the PDF object which matches BY KEYNAME!
-ArlPDFObject* CParsePDF::find_via_inheritance(ArlPDFDictionary* obj, const std::wstring& key, const int depth) {
+/// @returns the number of PDF objects for which a Link was selected
+size_t CParsePDF::select_links(CPDFFile& pdf, const std::vector<ArlPDFObject*>& objs, const std::vector<ArlSymbol>& links, const bool cold) {
+    pdfc = &pdf;
+    pdf_version = string_to_pdf_version(pdf.pdf_version);
+    if (cold)
+        link_memo.clear();
+    size_t n = 0;
+    for (auto o : objs)
+        if (recommended_link_for_object(o, links, "") != ArlNoSymbol)
+            n++;
+    pdfc = nullptr;
+    return n;
+}
+
+
+/// @brief Resolves every key that can be inherited from a dictionary: its own keys and all keys of
+/// its ancestors (via "/Parent"). Results for indirect dictionaries are cached so each node in a
+/// tree (e.g. the page tree) is only resolved once, top-down from the highest uncached ancestor.
+///
+/// @param[in] obj   the dictionary (e.g. the Parent of a page). Not deleted.
+/// @param[in] key   the key being looked up (only used for error messages)
+///
+/// @returns the set of keys. Never nullptr.
+std::shared_ptr<const CParsePDF::inherited_keys> CParsePDF::resolve_inherited_keys(ArlPDFDictionary* obj, const std::string& key) {
     assert(obj != nullptr);
-    if (depth > 250) {
-        output << COLOR_ERROR << "recursive inheritance depth of " << depth << " exceeded for " << ToUtf8(key) << COLOR_RESET;
-        return nullptr;
+    std::vector<ArlPDFDictionary*>          chain;      // obj and its uncached ancestors (bottom-up)
+    std::unordered_set<object_id, object_id_hash>   in_chain;
+    std::shared_ptr<const inherited_keys>   resolved;   // keys of the highest cached ancestor (if any)
+
+    ArlPDFDictionary* d = obj;
+    while (d != nullptr) {
+        if (d->is_indirect_ref()) {
+            auto id = d->get_object_id();
+            auto found = inheritance_cache.find(id);
+            if (found != inheritance_cache.end()) {
+                resolved = found->second;
+                break;
+            }
+            // Circular or absurdly deep /Parent chains are only ever detected once per node as the nodes get cached
+            if (!in_chain.insert(id).second) {
+                message(ArlSeverity::Error, ArlMessageCode::InheritanceCycle, "", key, obj) << "circular Parent chain detected when inheriting " << key << COLOR_RESET;
+                break;
+            }
+        }
+        if (chain.size() > 250) {
+            message(ArlSeverity::Error, ArlMessageCode::InheritanceTooDeep, "", key, obj) << "recursive inheritance depth of " << chain.size() << " exceeded for " << key << COLOR_RESET;
+            break;
+        }
+        chain.push_back(d);
+        ArlPDFObject* parent = d->get_value("Parent");
+        if ((parent != nullptr) && (parent->get_object_type() != PDFObjectType::ArlPDFObjTypeDictionary)) {
+            delete parent;
+            parent = nullptr;
+        }
+        d = (ArlPDFDictionary*)parent;
+    } // while
+
+    if (resolved == nullptr)
+        resolved = std::make_shared<const inherited_keys>();
+
+    // Top-down: each node adds its own keys to those of its parent
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        std::shared_ptr<inherited_keys> keys = std::make_shared<inherited_keys>(*resolved);
+        (*it)->for_each_key([&](const std::string& k, ArlPDFObject* val) {
+            if (val != nullptr) {
+                keys->insert(k);
+                delete val;
+            }
+            return true;
+        }, false);
+        resolved = keys;
+        if ((*it)->is_indirect_ref())
+            inheritance_cache[(*it)->get_object_id()] = resolved;
     }
-    ArlPDFObject* parent = obj->get_value(L"Parent");
+
+    // Clean up ancestors (but not obj)
+    for (size_t i = 1; i < chain.size(); i++)
+        delete chain[i];
+    if ((d != nullptr) && (d != obj))
+        delete d;
+    return resolved;
+}
+
+
+/// @brief Checks if 'key' can be inherited (i.e. through "/Parent" keys)
+///
+/// @param[in] obj        the dictionary that does not have key
+/// @param[in] key        the key to find
+///
+/// @returns true if 'key' is located via inheritance
+bool CParsePDF::has_inherited_key(ArlPDFDictionary* obj, const std::string& key) {
+    assert(obj != nullptr);
+    ArlPDFObject* parent = obj->get_value("Parent");
+    bool found = false;
     if ((parent != nullptr) && (parent->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
-        ArlPDFDictionary* parent_dict = (ArlPDFDictionary*)parent;
-        ArlPDFObject* key_obj = parent_dict->get_value(key);
-if (key_obj == nullptr)
-key_obj = find_via_inheritance(parent_dict, key, depth + 1);
-delete parent;
-return key_obj;
+        std::shared_ptr<const inherited_keys> keys = resolve_inherited_keys((ArlPDFDictionary*)parent, key);
+        found = (keys->find(key) != keys->end());
     }
-    return nullptr;
+    delete parent;
+    return found;
 }
 
 
@@ -351,32 +686,35 @@ return key_obj;
 /// @param[in]   container     container PDF object (e.g. the dictionary which contains object as a key/value)
 /// @param[in]   object        the PDF object to check
 /// @param[in]   key_index     >= 0. Row index into TSV data for this PDF object
-/// @param[in]   tsv_data      the full Arlington PDF model data read from a TSV
-/// @param[in]   grammar_file  the name Arlington PDF model filename used for error messages
+/// @param[in]   tsv_file      the Arlington PDF model TSV file
+/// @param[in]   link          the Arlington PDF model filename (used for error messages)
 /// @param[in]   context       context (PDF DOM path)
-/// @param[in]   ofs           open output file stream (or cnull/cwnull for no output)
-void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object, const int key_index, const ArlTSVmatrix& tsv_data, const std::string& grammar_file, const std::string& context, std::ostream& ofs) {
+void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object, const int key_index, const CArlingtonTSVGrammarFile* tsv_file, const ArlSymbol link, const std::string& context) {
     assert(container != nullptr);
     assert(object != nullptr);
     assert(key_index >= 0);
+    assert(tsv_file != nullptr);
+    const ArlTSVmatrix& tsv_data = tsv_file->get_data();
+    const std::string& grammar_file = grammar->get_symbol_name(link);
     auto obj_type = object->get_object_type();
 
-    queue_elem fake_e(container, object, grammar_file, context);
+    queue_elem fake_e(container, object, link, context);
 
     // Need to cope with wildcard keys "*" or <digit>* for arrays in TSV data as key_index might be beyond rows in tsv_data[]
     int key_idx = key_index;
     if (key_index >= (int)tsv_data.size()) {
-        if (tsv_data[tsv_data.size() - 1][TSV_KEYNAME] == "*") // pure wildcard (always last row)
-            key_idx = (int)tsv_data.size() - 1;
+        if (tsv_file->get_wildcard_index() >= 0) // pure wildcard (always last row)
+            key_idx = tsv_file->get_wildcard_index();
         else
             key_idx = key_idx % ((int)tsv_data.size() - 1);
         assert((key_idx >= 0) && (key_idx < (int)tsv_data.size()));
     }
+    const std::string& key_name = tsv_file->get_typed_data()[key_idx].key;
 
     // Process version predicates properly, so if PDF version is BEFORE SinceVersion then will get a wrong type error
-    ArlVersion versioner(object, tsv_data[key_idx], pdf_version, pdfc->get_extensions());
-    std::vector<std::string>  linkset = versioner.get_appropriate_linkset(tsv_data[key_idx][TSV_LINK]);
-    std::string               arl_type = versioner.get_matched_arlington_type();
+    const CArlTSVSpecialization& spec = get_specialization(tsv_file);
+    const ArlVersion& versioner = spec.get_version(key_idx, object);
+    const std::string&        arl_type = versioner.get_matched_arlington_type();
 
 #ifdef CHECKS_DEBUG
     ofs << "Checking " << grammar_file << "/" << tsv_data[key_idx][TSV_KEYNAME] << " as " << versioner.get_object_arlington_type();
@@ -394,32 +732,32 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
             std::transform(f.begin(), f.end(), f.begin(), [](unsigned char c) { return (unsigned char)std::tolower(c); });
             bool is_array_container = (f.find("array") != std::string::npos) || (f.find("colorspace") != std::string::npos);
             if (is_array_container) {
-                show_context(fake_e);
-                ofs << COLOR_ERROR << "null object: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-                ofs << " null not listed (only " << tsv_data[key_idx][TSV_TYPE] << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                std::ostream& msg = report(fake_e, ArlSeverity::Error, ArlMessageCode::NullNotAllowed, grammar_file, key_name);
+                msg << "null object: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+                msg << " null not listed (only " << tsv_data[key_idx][TSV_TYPE] << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
                 if (debug_mode)
-                    ofs << " (" << *object << ")";
-                ofs << COLOR_RESET;
+                    msg << " (" << *object << ")";
+                msg << COLOR_RESET;
 #ifdef CHECKS_DEBUG
                 ofs << std::endl;
 #endif
             }
             else if (debug_mode) {
-                show_context(fake_e);
-                ofs << COLOR_INFO << "key " << tsv_data[key_idx][TSV_KEYNAME] << " in dictionary/stream " << grammar_file << " had a null object as value - same as not present";
-                ofs << " (" << *object << ")" << COLOR_RESET;
+                std::ostream& msg = report(fake_e, ArlSeverity::Info, ArlMessageCode::NullValue, grammar_file, key_name);
+                msg << "key " << tsv_data[key_idx][TSV_KEYNAME] << " in dictionary/stream " << grammar_file << " had a null object as value - same as not present";
+                msg << " (" << *object << ")" << COLOR_RESET;
 #ifdef CHECKS_DEBUG
                 ofs << std::endl;
 #endif
             }
         }
         else {
-            show_context(fake_e);
-            ofs << COLOR_ERROR << "wrong type: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-            ofs << " should be " << tsv_data[key_idx][TSV_TYPE] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " and is " << versioner.get_object_arlington_type();
+            std::ostream& msg = report(fake_e, ArlSeverity::Error, ArlMessageCode::WrongType, grammar_file, key_name);
+            msg << "wrong type: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+            msg << " should be " << tsv_data[key_idx][TSV_TYPE] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " and is " << versioner.get_object_arlington_type();
             if (debug_mode)
-                ofs << " (" << *object << ")";
-            ofs << COLOR_RESET;
+                msg << " (" << *object << ")";
+            msg << COLOR_RESET;
 #ifdef CHECKS_DEBUG
             ofs << std::endl;
 #endif
@@ -427,15 +765,15 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
         return;
     }
 
-    PredicateProcessor pp(pdfc, tsv_data);
+    PredicateProcessor pp(pdfc, tsv_file, &spec);
     ReferenceType ir = pp.ReduceIndirectRefRow(container, object, key_idx, versioner.get_arlington_type_index());
 
     // Also treat null object as though the key is nonexistent (i.e. don't report an error)
     if ((ir == ReferenceType::MustBeIndirect) && (!object->is_indirect_ref() &&
         (obj_type != PDFObjectType::ArlPDFObjTypeNull) && (obj_type != PDFObjectType::ArlPDFObjTypeReference))) {
-        show_context(fake_e);
-        ofs << COLOR_ERROR << "not an indirect reference as required: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") ";
-        ofs << "in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+        std::ostream& msg = report(fake_e, ArlSeverity::Error, ArlMessageCode::NotIndirect, grammar_file, key_name);
+        msg << "not an indirect reference as required: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") ";
+        msg << "in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
     }
 
     // String-ify the value of the PDF object for potential output messages
@@ -457,20 +795,17 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
                     long long ivalue = numobj->get_integer_value();
                     str_value = std::to_wstring(ivalue);
                     if ((arl_type == "bitmask") && (ivalue > 0xFFFFFFFF)) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "bitmask was not a 32-bit value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Warning, ArlMessageCode::BitmaskNot32Bit, grammar_file, key_name) << "bitmask was not a 32-bit value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                     if (((ivalue > 2147483647LL) || (ivalue < -2147483648LL)) && (pdf_version <= 17)) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "integer value exceeds PDF 1.x integer range for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Warning, ArlMessageCode::IntegerOutOfRange, grammar_file, key_name) << "integer value exceeds PDF 1.x integer range for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
                 else {
                     num_value = numobj->get_value();
                     str_value = std::to_wstring(num_value);
                     if (arl_type == "bitmask") {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "bitmask was not an integer value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Warning, ArlMessageCode::BitmaskNotInteger, grammar_file, key_name) << "bitmask was not an integer value for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
             }
@@ -479,12 +814,10 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
         case PDFObjectType::ArlPDFObjTypeName:
             str_value = ((ArlPDFName*)object)->get_value();
             if ((str_value.size() > 127) && (pdf_version <= 17)) {
-                show_context(fake_e);
-                ofs << COLOR_WARNING << "PDF 1.x names were limited to 127 bytes (was " << str_value.size() << ") for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                report(fake_e, ArlSeverity::Warning, ArlMessageCode::NameTooLong, grammar_file, key_name) << "PDF 1.x names were limited to 127 bytes (was " << str_value.size() << ") for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
             }
             if (str_value.size() == 0) {
-                show_context(fake_e);
-                ofs << COLOR_INFO << "detected an empty PDF name (\"/\" is a valid PDF name, but unusual) for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                report(fake_e, ArlSeverity::Info, ArlMessageCode::EmptyName, grammar_file, key_name) << "detected an empty PDF name (\"/\" is a valid PDF name, but unusual) for " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
             }
             break;
 
@@ -494,8 +827,7 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
                 auto t = pdfc->get_ptr_to_trailer();
                 // Warn if string starts with UTF-16LE byte-order-marker - DEPENDS ON PDF SDK!
                 if ((str_value.size() >= 2) && (str_value[0] == 255) && (str_value[1] == 254) && !t->is_unsupported_encryption()) {
-                    show_context(fake_e);
-                    ofs << COLOR_WARNING << "string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") starts with UTF-16LE byte order marker" << COLOR_RESET;
+                    report(fake_e, ArlSeverity::Warning, ArlMessageCode::StringUTF16LE, grammar_file, key_name) << "string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") starts with UTF-16LE byte order marker" << COLOR_RESET;
                 }
                 // Warn if an ASCII string contains bytes in the unprintable area of ASCII (based on C++ isprint())
                 if ((arl_type == "string-ascii") && !t->is_unsupported_encryption()) {
@@ -503,17 +835,15 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
                     for (size_t i = 0; i < str_value.size(); i++)
                         pure_ascii = pure_ascii && isprint(str_value[i]);
                     if (!pure_ascii) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "ASCII string contained at least one unprintable byte for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Warning, ArlMessageCode::StringUnprintableASCII, grammar_file, key_name) << "ASCII string contained at least one unprintable byte for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
                 // If Arlington says it is a date string then check if PDF string complies
                 if ((arl_type == "date") && (!is_valid_pdf_date_string(str_value))) {
-                    show_context(fake_e);
                     if (!t->is_unsupported_encryption())
-                        ofs << COLOR_ERROR << "invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << "): \"" << ToUtf8(str_value) << "\"" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Error, ArlMessageCode::InvalidDate, grammar_file, key_name) << "invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << "): \"" << ToUtf8(str_value) << "\"" << COLOR_RESET;
                     else
-                        ofs << COLOR_WARNING << "possibly invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - unsupported encryption" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Warning, ArlMessageCode::PossiblyInvalidDate, grammar_file, key_name) << "possibly invalid date string for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - unsupported encryption" << COLOR_RESET;
                 }
             }
             break;
@@ -524,22 +854,18 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
                 int arr_len = ((ArlPDFArray*)object)->get_num_elements();
                 if (arl_type == "rectangle") {
                     if (arr_len != 4) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "rectangle does not have exactly 4 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Warning, ArlMessageCode::RectangleNot4Elements, grammar_file, key_name) << "rectangle does not have exactly 4 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
                     }
                     if (!check_numeric_array((ArlPDFArray*)object, 4)) {
-                        show_context(fake_e);
-                        ofs << COLOR_ERROR << "rectangle does not have 4 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Error, ArlMessageCode::RectangleNotNumeric, grammar_file, key_name) << "rectangle does not have 4 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
                 if (arl_type == "matrix") {
                     if (arr_len != 6) {
-                        show_context(fake_e);
-                        ofs << COLOR_WARNING << "matrix does not have exactly 6 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Warning, ArlMessageCode::MatrixNot6Elements, grammar_file, key_name) << "matrix does not have exactly 6 elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ") - had " << arr_len << COLOR_RESET;
                     }
                     if (!check_numeric_array((ArlPDFArray*)object, 6)) {
-                        show_context(fake_e);
-                        ofs << COLOR_ERROR << "matrix does not have 6 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
+                        report(fake_e, ArlSeverity::Error, ArlMessageCode::MatrixNotNumeric, grammar_file, key_name) << "matrix does not have 6 numeric elements for key " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")" << COLOR_RESET;
                     }
                 }
             }
@@ -556,28 +882,30 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
     ofs << "SpecialCase = {" << (checks_passed ? "OK" : "not OK") << (pp.WasFullyImplemented() ? "" : ",partial implementation") << (pp.SomethingWasDeprecated() ? ",deprecated" : "") << "} ";
 #endif
     if (!checks_passed || !pp.WasFullyImplemented()) {
-        show_context(fake_e);
         // If predicates ARE fully processed then we know it is the right or wrong value.
         // If predicates are partially processed then just a warning with additional output
+        std::ostream& msg = pp.WasFullyImplemented() ?
+            report(fake_e, ArlSeverity::Error, ArlMessageCode::SpecialCaseFailed, grammar_file, key_name) :
+            report(fake_e, ArlSeverity::Warning, ArlMessageCode::SpecialCasePartial, grammar_file, key_name);
         if (!pp.WasFullyImplemented())
-            ofs << COLOR_WARNING << "special case possibly incorrect (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+            msg << "special case possibly incorrect (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
         else
-            ofs << COLOR_ERROR << "special case not correct: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-        ofs << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-        ofs << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_SPECIALCASE];
+            msg << "special case not correct: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+        msg << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+        msg << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_SPECIALCASE];
         if (FindInVector(v_ArlNonComplexTypes, versioner.get_object_arlington_type())) {
             auto t = pdfc->get_ptr_to_trailer();
             if ((versioner.get_object_arlington_type().find("string") != std::string::npos) && t->is_unsupported_encryption()) {
                 // Don't output encrypted strings
-                ofs << " - string when unsupported encryption";
+                msg << " - string when unsupported encryption";
             }
             else {
-                ofs << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(str_value);
+                msg << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(str_value);
                 if (debug_mode)
-                    ofs << " (" << *object << ")";
+                    msg << " (" << *object << ")";
             }
         }
-        ofs << COLOR_RESET;
+        msg << COLOR_RESET;
     }
 
     // Check value against Arlington PossibleValue field
@@ -587,27 +915,29 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
     ofs << "PossibleValues = {" << (checks_passed ? "OK" : "not OK") << (pp.WasFullyImplemented() ? "" : ",partial implementation") << (pp.SomethingWasDeprecated() ? ",deprecated" : "") << "} ";
 #endif
     if (!checks_passed || !pp.WasFullyImplemented()) {
-        show_context(fake_e);
         // If predicates ARE fully processed then we know it is the right or wrong value.
         // If predicates are partially processed then just a warning with additional output
+        std::ostream& msg = pp.WasFullyImplemented() ?
+            report(fake_e, ArlSeverity::Error, ArlMessageCode::PossibleValuesFailed, grammar_file, key_name) :
+            report(fake_e, ArlSeverity::Warning, ArlMessageCode::PossibleValuesPartial, grammar_file, key_name);
         if (!pp.WasFullyImplemented())
-            ofs << COLOR_WARNING << "possibly wrong value for possible values (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+            msg << "possibly wrong value for possible values (some predicates NOT supported): " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
         else
-            ofs << COLOR_ERROR << "wrong value for possible values: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
-        ofs << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_POSSIBLEVALUES] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+            msg << "wrong value for possible values: " << tsv_data[key_idx][TSV_KEYNAME] << " (" << grammar_file << ")";
+        msg << " should be: " << tsv_data[key_idx][TSV_TYPE] << " " << tsv_data[key_idx][TSV_POSSIBLEVALUES] << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
         if (FindInVector(v_ArlNonComplexTypes, versioner.get_object_arlington_type())) {
             auto t = pdfc->get_ptr_to_trailer();
             if ((versioner.get_object_arlington_type().find("string") != std::string::npos) && t->is_unsupported_encryption()) {
                 // Don't output encrypted strings
-                ofs << " - string when unsupported encryption";
+                msg << " - string when unsupported encryption";
             }
             else {
-                ofs << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(str_value);
+                msg << " and is " << versioner.get_object_arlington_type() << "==" << ToUtf8(str_value);
                 if (debug_mode)
-                    ofs << " (" << *object << ")";
+                    msg << " (" << *object << ")";
             }
         }
-        ofs << COLOR_RESET;
+        msg << COLOR_RESET;
     }
 #ifdef CHECKS_DEBUG
     ofs << std::endl;
@@ -615,20 +945,123 @@ void CParsePDF::check_everything(ArlPDFObject* container, ArlPDFObject* object,
 }
 
 
-/// @brief Processes a PDF name tree
+/// @brief Processes a PDF name tree or number tree. The tree is walked iteratively
+/// (depth-first, left-to-right) so deep or cyclic Kids arrays cannot overflow the stack.
+/// Limits, ordering and Kids cycle problems come from the tree index (see CArlTreeIndex)
+/// and are reported once against the root node.
 ///
-/// @param[in]     obj          PDF name tree object (dictionary)
+/// @param[in]     root         PDF name tree or number tree root node (dictionary)
 /// @param[in]     links        set of Arlington links (predicates are SAFE)
-/// @param[in,out] context
+/// @param[in]     path         PDF DOM path of the tree
+/// @param[in]     t            type of tree
+void CParsePDF::parse_tree(ArlPDFDictionary* root, const std::vector<ArlSymbol>& links, const path_ptr& path, const ArlTreeType t) {
+    assert(root != nullptr);
+    assert(root->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
+
+    const bool        is_name_tree = (t == ArlTreeType::NameTree);
+    const std::string context = render_path(path);
+
+    auto index = pdfc->get_tree_index(root, t);
+    for (auto& p : index->get_problems()) {
+        queue_elem fake_e(nullptr, root, ArlNoSymbol, context);
+        std::ostream& msg = report(fake_e, ArlSeverity::Error, p.code, "", "");
+        msg << p.text << " for " << strip_leading_whitespace(context);
+        if (debug_mode && (p.node.object_num > 0))
+            msg << " (obj " << p.node.object_num << " " << p.node.generation_num << ")";
+        msg << COLOR_RESET;
+    }
+
+    struct tree_frame {
+        ArlPDFDictionary*   node;
+        ArlPDFArray*        kids;
+        int                 next_kid;
+    };
+
+    std::vector<tree_frame> stack;
+    std::unordered_set<object_id, object_id_hash> visited;
+
+    // Processes the Names/Nums of a node and then queues its Kids (if any)
+    auto enter = [&](ArlPDFDictionary* node) {
+        if (node->get_object_number() > 0)
+            visited.insert(node->get_object_id());
+
+        ArlPDFObject* kids_obj = node->get_value("Kids");
+        if (is_name_tree)
+            parse_name_tree_node(node, (node == root), (kids_obj != nullptr), links, path, context);
+        else
+            parse_number_tree_node(node, (node == root), (kids_obj != nullptr), links, path, context);
+
+        tree_frame f{ node, nullptr, 0 };
+        if (kids_obj != nullptr) {
+            if (kids_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) {
+                f.kids = (ArlPDFArray*)kids_obj;
+                kids_obj = nullptr;
+            }
+            else {
+                // Error: Kids isn't array in PDF name tree or number tree
+                queue_elem fake_e(nullptr, node, ArlNoSymbol, context);
+                if (is_name_tree)
+                    report(fake_e, ArlSeverity::Error, ArlMessageCode::NameTreeKidsNotArray, "", "") << "name tree Kids object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
+                else {
+                    std::ostream& msg = report(fake_e, ArlSeverity::Error, ArlMessageCode::NumberTreeKidsNotArray, "", "");
+                    msg << "number tree Kids object was not an array for " << strip_leading_whitespace(context);
+                    if (debug_mode)
+                        msg << " (" << *kids_obj << ")";
+                    msg << COLOR_RESET;
+                }
+            }
+        }
+        delete kids_obj;
+        stack.push_back(f);
+    };
+
+    enter(root);
+    while (!stack.empty()) {
+        tree_frame& f = stack.back();
+        if ((f.kids != nullptr) && (f.next_kid < f.kids->get_num_elements())) {
+            int i = f.next_kid++;
+            ArlPDFObject* item = f.kids->get_value(i);
+            if ((item != nullptr) && (item->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary)) {
+                if ((item->get_object_number() > 0) && (visited.count(item->get_object_id()) > 0))
+                    delete item;    // cycle or shared node - reported via the tree index
+                else
+                    enter((ArlPDFDictionary*)item);  // invalidates f
+            }
+            else {
+                // Error: individual kid isn't dictionary in PDF name tree or number tree
+                queue_elem fake_e(nullptr, f.node, ArlNoSymbol, context);
+                std::ostream& msg = report(fake_e, ArlSeverity::Error, is_name_tree ? ArlMessageCode::NameTreeKidNotDictionary : ArlMessageCode::NumberTreeKidNotDictionary, "", "");
+                msg << (is_name_tree ? "name" : "number") << " tree Kids array element number #" << i << " was not a dictionary for " << strip_leading_whitespace(context);
+                if (debug_mode && (item != nullptr))
+                    msg << " (" << *item << ")";
+                msg << COLOR_RESET;
+                delete item;
+            }
+        }
+        else {
+            delete f.kids;
+            if (f.node != root)
+                delete f.node;
+            stack.pop_back();
+        }
+    }
+}
+
+
+/// @brief Processes the Names array of a PDF name tree node
+///
+/// @param[in]     obj          PDF name tree node (dictionary)
 /// @param[in]     root         true if the root node of a Name tree
-void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::string> &links, const std::string context, const bool root) {
+/// @param[in]     has_kids     true if the node has a Kids key
+/// @param[in]     links        set of Arlington links (predicates are SAFE)
+/// @param[in]     path         PDF DOM path of the tree
+/// @param[in]     context      rendered PDF DOM path of the tree
+void CParsePDF::parse_name_tree_node(ArlPDFDictionary* obj, const bool root, const bool has_kids, const std::vector<ArlSymbol>& links, const path_ptr& path, const std::string& context) {
     assert(obj != nullptr);
     assert(obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
-    ArlPDFObject *kids_obj   = obj->get_value(L"Kids");
-    ArlPDFObject *names_obj  = obj->get_value(L"Names");
-    //ArlPDFObject *limits_obj = obj->get_value(L"Limits");
+    ArlPDFObject *names_obj  = obj->get_value("Names");
 
-    queue_elem fake_e(nullptr, obj, "name-tree", context);
+    queue_elem fake_e(nullptr, obj, ArlNoSymbol, context); // "name-tree"
 
     if ((names_obj != nullptr) && (names_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray)) {
         ArlPDFArray *array_obj = (ArlPDFArray*)names_obj;
@@ -642,29 +1075,28 @@ void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::st
                 if (obj2 != nullptr) {
                     std::wstring str = ((ArlPDFString*)obj1)->get_value();
                     std::string  as = ToUtf8(str);
-                    std::string  best_link = recommended_link_for_object(obj2, links, as);
-                    if (best_link.size() > 0)
-                        add_parse_object(obj, obj2, best_link, context + "->[" + as + "]");
+                    ArlSymbol    best_link = recommended_link_for_object(obj2, links, as);
+                    if (best_link != ArlNoSymbol)
+                        add_parse_object(obj, obj2, best_link, path, "->[" + as + "]");
                     else
                         delete obj2;
 
                 }
                 else {
                     // Error: name tree Names array did not have pairs of entries (obj2 == nullptr)
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "name tree Names array element #" << i << " - missing 2nd element in a pair for " << strip_leading_whitespace(context) << COLOR_RESET;
+                    report(fake_e, ArlSeverity::Error, ArlMessageCode::NameTreeMissingValue, "", "") << "name tree Names array element #" << i << " - missing 2nd element in a pair for " << strip_leading_whitespace(context) << COLOR_RESET;
                 }
             }
             else {
                 // Error: 1st in the pair was not OK
-                show_context(fake_e);
                 if (obj1 == nullptr)
-                    output << COLOR_ERROR << "name tree Names array element #" << i << " - 1st element in a pair returned null for " << strip_leading_whitespace(context) << COLOR_RESET;
+                    report(fake_e, ArlSeverity::Error, ArlMessageCode::NameTreeNullName, "", "") << "name tree Names array element #" << i << " - 1st element in a pair returned null for " << strip_leading_whitespace(context) << COLOR_RESET;
                 else {
-                    output << COLOR_ERROR << "name tree Names array element #" << i << " - 1st element in a pair was not a string for " << strip_leading_whitespace(context);
+                    std::ostream& msg = report(fake_e, ArlSeverity::Error, ArlMessageCode::NameTreeNameNotString, "", "");
+                    msg << "name tree Names array element #" << i << " - 1st element in a pair was not a string for " << strip_leading_whitespace(context);
                     if (debug_mode)
-                        output << " (" << *obj1 << ")";
-                    output << COLOR_RESET;
+                        msg << " (" << *obj1 << ")";
+                    msg << COLOR_RESET;
                 }
             }
             delete obj1;
@@ -673,59 +1105,31 @@ void CParsePDF::parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::st
     else {
         // Table 36 Names: "Root and leaf nodes only; required in leaf nodes; present in the root node
         //                  if and only if Kids is not present"
-        if (root && (kids_obj == nullptr)) {
-            show_context(fake_e);
+        if (root && !has_kids) {
             if (names_obj == nullptr)
-                output << COLOR_ERROR << "name tree Names object was missing when Kids was also missing for " << strip_leading_whitespace(context);
+                report(fake_e, ArlSeverity::Error, ArlMessageCode::NameTreeNamesMissing, "", "") << "name tree Names object was missing when Kids was also missing for " << strip_leading_whitespace(context) << COLOR_RESET;
             else
-                output << COLOR_ERROR << "name tree Names object was not an array when Kids was also missing for " << strip_leading_whitespace(context);
-            output << COLOR_RESET;
+                report(fake_e, ArlSeverity::Error, ArlMessageCode::NameTreeNamesNotArray, "", "") << "name tree Names object was not an array when Kids was also missing for " << strip_leading_whitespace(context) << COLOR_RESET;
         }
     }
     delete names_obj;
-
-    if (kids_obj != nullptr) {
-        if (kids_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) {
-            ArlPDFArray* array_obj = (ArlPDFArray*)kids_obj;
-            for (int i = 0; i < array_obj->get_num_elements(); i++) {
-                ArlPDFObject* item = array_obj->get_value(i);
-                if ((item != nullptr) && (item->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary))
-                    parse_name_tree((ArlPDFDictionary*)item, links, context, false);
-                else {
-                    // Error: individual kid isn't dictionary in PDF name tree
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "name tree Kids array element number #" << i << " was not a dictionary for " << strip_leading_whitespace(context);
-                    if (debug_mode && (item != nullptr))
-                        output << " (" << *item << ")";
-                    output << COLOR_RESET;
-                }
-                delete item;
-            }
-        }
-        else {
-            // error: Kids isn't array in PDF name tree
-            show_context(fake_e);
-            output << COLOR_ERROR << "name tree Kids object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
-        }
-        delete kids_obj;
-    }
 }
 
 
-/// @brief Processes a PDF number tree
+/// @brief Processes the Nums array of a PDF number tree node
 ///
-/// @param[in]     obj          PDF number tree object (dictionary)
+/// @param[in]     obj          PDF number tree node (dictionary)
+/// @param[in]     root         true if the root node of a Number tree
+/// @param[in]     has_kids     true if the node has a Kids key
 /// @param[in]     links        set of Arlington links (Predicates are SAFE!)
-/// @param[in,out] context
-/// @param[in]     root         true if the root node of a Name tree
-void CParsePDF::parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::string>&links, const std::string context, const bool root) {
+/// @param[in]     path         PDF DOM path of the tree
+/// @param[in]     context      rendered PDF DOM path of the tree
+void CParsePDF::parse_number_tree_node(ArlPDFDictionary* obj, const bool root, const bool has_kids, const std::vector<ArlSymbol>& links, const path_ptr& path, const std::string& context) {
     assert(obj != nullptr);
     assert(obj->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary);
-    ArlPDFObject *kids_obj   = obj->get_value(L"Kids");
-    ArlPDFObject *nums_obj   = obj->get_value(L"Nums");
-    // ArlPDFObject *limits_obj = obj->get_value(L"Limits");
+    ArlPDFObject *nums_obj   = obj->get_value("Nums");
 
-    queue_elem fake_e(nullptr, obj, "number-tree", context);
+    queue_elem fake_e(nullptr, obj, ArlNoSymbol, context); // "number-tree"
 
     if (nums_obj != nullptr) {
         if (nums_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) {
@@ -741,80 +1145,80 @@ void CParsePDF::parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::
                         if (obj2 != nullptr) {
                             int val = ((ArlPDFNumber*)obj1)->get_integer_value();
                             std::string  as = std::to_string(val);
-                            std::string  best_link = recommended_link_for_object(obj2, links, as);
-                            if (best_link.size() > 0)
-                                add_parse_object(obj, obj2, best_link, context + "->[" + as + "]");
+                            ArlSymbol    best_link = recommended_link_for_object(obj2, links, as);
+                            if (best_link != ArlNoSymbol)
+                                add_parse_object(obj, obj2, best_link, path, "->[" + as + "]");
                             else
                                 delete obj2;
                         }
                         else {
                             // Error: every even entry in a number tree Nums array are supposed be objects
-                            show_context(fake_e);
-                            output << COLOR_ERROR << "number tree Nums array element #" << i << " was null for " << strip_leading_whitespace(context) << COLOR_RESET;
+                            report(fake_e, ArlSeverity::Error, ArlMessageCode::NumberTreeNullValue, "", "") << "number tree Nums array element #" << i << " was null for " << strip_leading_whitespace(context) << COLOR_RESET;
                         }
                     }
                     else {
                         // Error: every odd entry in a number tree Nums array are supposed be integers
-                        show_context(fake_e);
-                        output << COLOR_ERROR << "number tree Nums array element #" << i << " was not an integer for " << strip_leading_whitespace(context);
+                        std::ostream& msg = report(fake_e, ArlSeverity::Error, ArlMessageCode::NumberTreeKeyNotInteger, "", "");
+                        msg << "number tree Nums array element #" << i << " was not an integer for " << strip_leading_whitespace(context);
                         if (debug_mode)
-                            output << " (" << *obj1 << ")";
-                        output << COLOR_RESET;
+                            msg << " (" << *obj1 << ")";
+                        msg << COLOR_RESET;
                     }
-                    delete obj1;
                 }
                 else {
                     // Error: one of the pair of objects was not OK in PDF number tree
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "number tree Nums array was invalid for " << strip_leading_whitespace(context) << COLOR_RESET;
+                    report(fake_e, ArlSeverity::Error, ArlMessageCode::NumberTreeNumsInvalid, "", "") << "number tree Nums array was invalid for " << strip_leading_whitespace(context) << COLOR_RESET;
                 }
+                delete obj1;
             } // for
         }
         else {
             // Error: Nums isn't an array in PDF number tree
-            show_context(fake_e);
-            output << COLOR_ERROR << "number tree Nums object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
+            report(fake_e, ArlSeverity::Error, ArlMessageCode::NumberTreeNumsNotArray, "", "") << "number tree Nums object was not an array for " << strip_leading_whitespace(context) << COLOR_RESET;
         }
         delete nums_obj;
     }
     else {
         // Table 37 Nums: "Root and leaf nodes only; shall be required in leaf nodes;
         //                 present in the root node if and only if Kids is not present
-        if (root && (kids_obj == nullptr)) {
-            show_context(fake_e);
-            output << COLOR_ERROR << "number tree Nums object was missing when Kids was also missing for " << strip_leading_whitespace(context);
-            output << COLOR_RESET;
+        if (root && !has_kids) {
+            std::ostream& msg = report(fake_e, ArlSeverity::Error, ArlMessageCode::NumberTreeNumsMissing, "", "");
+            msg << "number tree Nums object was missing when Kids was also missing for " << strip_leading_whitespace(context);
+            msg << COLOR_RESET;
         }
     }
+}
 
-    if (kids_obj != nullptr) {
-        if (kids_obj->get_object_type() == PDFObjectType::ArlPDFObjTypeArray) {
-            ArlPDFArray* array_obj = (ArlPDFArray*)kids_obj;
-            for (int i = 0; i < array_obj->get_num_elements(); i++) {
-                ArlPDFObject* item = array_obj->get_value(i);
-                if ((item != nullptr) && (item->get_object_type() == PDFObjectType::ArlPDFObjTypeDictionary))
-                    parse_number_tree((ArlPDFDictionary*)item, links, context, false);
-                else {
-                    // Error: individual kid isn't dictionary in PDF number tree
-                    show_context(fake_e);
-                    output << COLOR_ERROR << "number tree Kids array element number #" << i << " was not a dictionary for " << strip_leading_whitespace(context);
-                    if (debug_mode && (item != nullptr))
-                        output << " (" << *item << ")";
-                    output << COLOR_RESET;
-                }
-                delete item;
-            }
-        }
-        else {
-            // Error: Kids isn't array in PDF number tree
-            show_context(fake_e);
-            output << COLOR_ERROR << "number tree Kids object was not an array for " << strip_leading_whitespace(context);
-            if (debug_mode)
-                output << " (" << *kids_obj << ")";
-            output << COLOR_RESET;
-        }
-        delete kids_obj;
+
+/// @brief Renders a PDF DOM path for display, indented according to its nesting
+///
+/// @param[in] path   PDF DOM path node
+///
+/// @returns the full PDF DOM path from the root object
+std::string CParsePDF::render_path(const path_ptr& path) {
+    assert(path != nullptr);
+    size_t len = 2 * path->indent;
+    for (const path_node* n = path.get(); n != nullptr; n = n->parent.get())
+        len += n->suffix.size();
+
+    // Fill in path components from the end, working back towards the root object
+    std::string s(len, ' ');
+    size_t pos = len;
+    for (const path_node* n = path.get(); n != nullptr; n = n->parent.get()) {
+        pos -= n->suffix.size();
+        s.replace(pos, n->suffix.size(), n->suffix);
     }
+    return s;
+}
+
+
+/// @brief Estimates the memory used by a queued PDF object
+///
+/// @param[in] e   the queued element
+///
+/// @returns estimated size in bytes
+size_t CParsePDF::queued_size(const queue_elem& e) {
+    return sizeof(queue_elem) + sizeof(path_node) + sizeof(ArlPDFTrailer) + e.path->suffix.capacity();
 }
 
 
@@ -823,9 +1227,26 @@ void CParsePDF::parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::
 /// @param[in]     container    container PDF object that contains object (nullptr for root objects)
 /// @param[in]     object       PDF object (not nullptr)
 /// @param[in]     link         Arlington link (TSV filename)
-/// @param[in,out] context      current content (PDF path)
-void CParsePDF::add_parse_object(ArlPDFObject* container, ArlPDFObject* object, const std::string& link, const std::string& context) {
-    to_process.emplace(container, object, link, context);
+/// @param[in]     parent       PDF DOM path of the container
+/// @param[in]     suffix       PDF DOM path component for object, relative to parent
+void CParsePDF::add_parse_object(ArlPDFObject* container, ArlPDFObject* object, const ArlSymbol link, const path_ptr& parent, const std::string& suffix) {
+    assert(link != ArlNoSymbol);
+    assert(parent != nullptr);
+    if ((memory_limit > 0) && !depth_first && (queued_bytes > memory_limit)) {
+        // Breadth-first queue is too wide so switch to depth-first to bound memory
+        depth_first = true;
+        if (debug_mode)
+            arl_message(output, sink, ArlSeverity::Info, ArlMessageCode::MemoryLimitExceeded) << "queued objects exceeded memory limit of " << memory_limit << " bytes - switching to depth-first traversal" << COLOR_RESET;
+    }
+
+    if (depth_first) {
+        children.emplace_back(container, object, link, std::make_shared<path_node>(parent, suffix, parent->indent), lane_bit);
+        queued_bytes += queued_size(children.back());
+    }
+    else {
+        to_process.emplace_back(container, object, link, std::make_shared<path_node>(parent, suffix, parent->indent), lane_bit);
+        queued_bytes += queued_size(to_process.back());
+    }
 }
 
 
@@ -834,17 +1255,21 @@ void CParsePDF::add_parse_object(ArlPDFObject* container, ArlPDFObject* object,
 ///
 /// @param[in]     object       PDF object (not nullptr)
 /// @param[in]     link         Arlington link (TSV filename)
-/// @param[in,out] context      current content (PDF path)
+/// @param[in]     context      PDF path of the root object
 void CParsePDF::add_root_parse_object(ArlPDFObject* object, const std::string& link, const std::string& context) {
-    to_process.emplace(nullptr, object, link, context);
+    ArlSymbol sym = grammar->get_symbol(link);
+    assert(sym != ArlNoSymbol);
+    to_process.emplace_back(nullptr, object, sym, std::make_shared<path_node>(nullptr, context, 0));
+    queued_bytes += queued_size(to_process.back());
 }
 
 
-/// @brief prints the context line to console if not already done so
+/// @brief prints the context line to console if not already done so.
+/// Nothing is output when writing machine-readable results as each message carries its own context.
 /// 
 /// @param[in] e    the element
 void CParsePDF::show_context(queue_elem &e) {
-    if (!context_shown) {
+    if (!context_shown && (sink == nullptr)) {
         output << COLOR_RESET_NO_EOL << std::setw(8) << counter << ": " << e.context;
         if (debug_mode)
             output << " (" << *e.object << ")";
@@ -855,6 +1280,164 @@ void CParsePDF::show_context(queue_elem &e) {
 
 
 
+/// @brief Starts an error, warning or info message about a PDF object. In text mode, the context line
+/// is shown first. Callers then write the message text and COLOR_RESET to the returned stream.
+///
+/// @param[in] e      the element the message is about
+/// @param[in] sev    severity
+/// @param[in] code   stable message code
+/// @param[in] tsv    Arlington TSV file (link) or empty
+/// @param[in] key    PDF key or array index or empty
+///
+/// @returns stream for the message text
+std::ostream& CParsePDF::report(queue_elem& e, const ArlSeverity sev, const ArlMessageCode code, const std::string& tsv, const std::string& key) {
+    if (sink == nullptr) {
+        show_context(e);
+        return message(sev, code);
+    }
+    return message(sev, code, tsv, key, e.object, strip_leading_whitespace(e.context));
+}
+
+
+/// @brief Starts an error, warning or info message. When validating against all PDF versions at once,
+/// the message is counted for the PDF version being validated and is prefixed with that PDF version.
+/// Callers then write the message text and COLOR_RESET to the returned stream.
+///
+/// @param[in] sev    severity
+/// @param[in] code   stable message code
+/// @param[in] tsv    Arlington TSV file (link) or empty
+/// @param[in] key    PDF key or array index or empty
+/// @param[in] obj    PDF object the message is about or nullptr
+/// @param[in] path   PDF DOM path or empty
+///
+/// @returns stream for the message text
+std::ostream& CParsePDF::message(const ArlSeverity sev, const ArlMessageCode code, const std::string& tsv, const std::string& key, ArlPDFObject* obj, const std::string& path) {
+    std::ostream& msg = arl_message(output, sink, sev, code, tsv, key, obj, path);
+    if (current_lane >= 0) {
+        lanes[current_lane].counts[(int)sev]++;
+        msg << "PDF " << pdfc->pdf_version << ": ";
+    }
+    return msg;
+}
+
+
+/// @brief Makes a PDF version the one being validated when validating against all PDF versions at once.
+/// The lane's state is swapped in and the PDF objects queued from now on are for this lane only.
+/// Does nothing when validating against a single PDF version.
+///
+/// @param[in] l   index of the lane (into v_ArlPDFVersions)
+void CParsePDF::activate_lane(const int l) {
+    if (lanes.empty())
+        return;
+    assert(current_lane < 0);
+    swap_lane(lanes[l]);
+    current_lane = l;
+    lane_bit = (ArlVersionSet)(1 << l);
+}
+
+
+/// @brief Swaps the state of the active lane back out (see activate_lane())
+void CParsePDF::deactivate_lane() {
+    if (current_lane < 0)
+        return;
+    swap_lane(lanes[current_lane]);
+    current_lane = -1;
+    lane_bit = 1;
+}
+
+
+/// @brief Exchanges all PDF version dependent state with a lane
+///
+/// @param[in,out] lane   the lane
+void CParsePDF::swap_lane(version_lane& lane) {
+    std::swap(pdf_version, lane.pdf_version);
+    std::swap(pdfc->pdf_version, lane.pdf_version_str);
+    visited.swap(lane.visited);
+    visited_other.swap(lane.visited_other);
+    inheritance_cache.swap(lane.inheritance_cache);
+    specializations.swap(lane.specializations);
+    link_memo.swap(lane.link_memo);
+}
+
+
+/// @brief Merges the PDF objects that each PDF version (lane) queued for the same PDF object when
+/// validating against all PDF versions at once. Objects queued by several lanes with the same link
+/// and PDF DOM path are queued once for all of those lanes. The order of each lane's objects is kept,
+/// so every lane traverses the PDF DOM as if it was validated on its own.
+///
+/// @param[in,out] q       to_process or children
+/// @param[in]     first   index in q of the first object queued for the PDF object
+/// @param[in]     parent  PDF DOM path of the PDF object
+template <class Q> void CParsePDF::merge_lane_children(Q& q, const size_t first, const path_node* parent) {
+    if (q.size() < first + 2)
+        return;
+
+    auto make_key = [parent](const queue_elem& e) {
+        std::string key = std::to_string(e.link) + " " + std::to_string(e.object->get_object_number());
+        for (const path_node* n = e.path.get(); (n != nullptr) && (n != parent); n = n->parent.get())
+            key += n->suffix;
+        return key;
+    };
+
+    std::vector<queue_elem>  merged;
+    std::vector<std::string> merged_keys;
+    size_t g = first;
+    while (g < q.size()) {
+        // Each lane's objects are contiguous
+        size_t g_end = g + 1;
+        while ((g_end < q.size()) && (q[g_end].versions == q[g].versions))
+            g_end++;
+
+        // Positions in merged of each key, in order
+        std::unordered_map<std::string, std::deque<size_t>> positions;
+        for (size_t i = 0; i < merged_keys.size(); i++)
+            positions[merged_keys[i]].push_back(i);
+
+        std::vector<queue_elem>  result;
+        std::vector<std::string> result_keys;
+        size_t i = 0;
+        for (; g < g_end; g++) {
+            std::string key = make_key(q[g]);
+            size_t p = merged.size();
+            auto found = positions.find(key);
+            if (found != positions.end()) {
+                while (!found->second.empty() && (found->second.front() < i))
+                    found->second.pop_front();
+                if (!found->second.empty())
+                    p = found->second.front();
+            }
+            if (p < merged.size()) {
+                for (; i < p; i++) {
+                    result.push_back(std::move(merged[i]));
+                    result_keys.push_back(std::move(merged_keys[i]));
+                }
+                merged[p].versions |= q[g].versions;
+                queued_bytes -= queued_size(q[g]);
+                if (q[g].object->is_deleteable() && (q[g].object != merged[p].object))
+                    delete q[g].object;
+                result.push_back(std::move(merged[p]));
+                result_keys.push_back(std::move(merged_keys[p]));
+                i = p + 1;
+            }
+            else {
+                result.push_back(std::move(q[g]));
+                result_keys.push_back(std::move(key));
+            }
+        }
+        for (; i < merged.size(); i++) {
+            result.push_back(std::move(merged[i]));
+            result_keys.push_back(std::move(merged_keys[i]));
+        }
+        merged.swap(result);
+        merged_keys.swap(result_keys);
+    }
+
+    q.erase(q.begin() + first, q.end());
+    for (auto& e : merged)
+        q.push_back(std::move(e));
+}
+
+
 /// @brief Iteratively parse PDF objects from the to_process queue
 ///
 /// @param[in] pdf   reference to the PDF file object
@@ -863,587 +1446,759 @@ void CParsePDF::show_context(queue_elem &e) {
 bool CParsePDF::parse_object(CPDFFile &pdf)
 {
     pdfc = &pdf;
-    std::string ver = pdfc->check_and_get_pdf_version(output); // will produce output messages
+    std::string ver = pdfc->check_and_get_pdf_version(output, sink); // will produce output messages
 
-    output << COLOR_INFO << "Processing as PDF " << ver;
+    std::ostream& msg = arl_message(output, sink, ArlSeverity::Info, ArlMessageCode::ProcessingAsVersion);
+    if (pdfc->is_all_versions())
+        msg << "Processing as every PDF version";
+    else
+        msg << "Processing as PDF " << ver;
     auto extns = pdfc->get_extensions();
     if (extns.size() > 0) {
-        output << " with extensions ";
+        msg << " with extensions ";
         for (size_t i = 0; i < extns.size(); i++)
-            output << extns[i] << ((i < (extns.size() - 1)) ? ", " : "");
+            msg << extns[i] << ((i < (extns.size() - 1)) ? ", " : "");
     }
-    output << COLOR_RESET;
+    msg << COLOR_RESET;
     pdf_version = string_to_pdf_version(ver);
+    specializations.clear();
+
+    // Real object numbers are very rarely larger than the PDF file size in bytes, so only object numbers below
+    // that (and below trailer /Size) get a slot in visited. Anything larger is still remembered in visited_other.
+    std::error_code ec;
+    uintmax_t file_size = fs::file_size(pdfc->get_pdf_filename(), ec);
+    if (ec)
+        file_size = 0;
+    visited_limit = (int)std::clamp<uintmax_t>(file_size, ArlVisitedMinLimit, ArlVisitedMaxLimit);
+    if ((pdfc->get_trailer_size() > 0) && (pdfc->get_trailer_size() < visited_limit))
+        visited_limit = pdfc->get_trailer_size();
+
+    // --force all: one lane per PDF version, with all root objects validated against every lane
+    if (pdfc->is_all_versions()) {
+        assert(v_ArlPDFVersions.size() <= 8 * sizeof(ArlVersionSet));
+        lanes.resize(v_ArlPDFVersions.size());
+        for (size_t l = 0; l < lanes.size(); l++) {
+            lanes[l].pdf_version_str = v_ArlPDFVersions[l];
+            lanes[l].pdf_version = string_to_pdf_version(v_ArlPDFVersions[l]);
+        }
+        for (auto& e : to_process)
+            e.versions = (ArlVersionSet)((1 << lanes.size()) - 1);
+    }
 
     counter = 0;
 
-    while (to_process.size() > 0) {
+    while ((to_process.size() > 0) || (children.size() > 0)) {
         context_shown = false;
 
-        queue_elem elem = to_process.front();
-        to_process.pop();
-        if (elem.link == "") {
+        // Depth-first: children of the previous object are processed next, in order
+        for (auto it = children.rbegin(); it != children.rend(); ++it)
+            to_process.push_front(std::move(*it));
+        children.clear();
+        if (stats != nullptr)
+            stats->note_queue(to_process.size(), queued_bytes);
+
+        queue_elem elem = std::move(to_process.front());
+        to_process.pop_front();
+        queued_bytes -= queued_size(elem);
+        if (elem.link == ArlNoSymbol) {
             delete elem.object;
             continue;
         }
+        const std::string& link = grammar->get_symbol_name(elem.link);
 
-        // Ensure elem.link is clean of predicates "fn:SinceVersion(x,y,...)"
-        assert(elem.link.find("fn:") == std::string::npos);
+        // Ensure link is clean of predicates "fn:SinceVersion(x,y,...)"
+        assert(link.find("fn:") == std::string::npos);
+
+        // --stats: time processing this object (until the end of this iteration)
+        ArlStatsTimer tsv_timer((stats != nullptr) ? stats->tsv_entry(elem.link) : nullptr);
 
         // To debug: look at a full DOM tree and then do conditional breakpoints on counter==X
         counter++;
+        elem.context = render_path(elem.path);
         if (!terse)
             show_context(elem);
+        elem.path->indent++;
         elem.context = "  " + elem.context; // ident for nested DOM display
 
         assert(elem.object != nullptr);
-        if (elem.object->is_indirect_ref()) {
-            auto hash = elem.object->get_hash_id();
-            auto found = mapped.find(hash);
-            if (found != mapped.end()) {
-                // "_Universal..." objects match anything so ignore them.
-                if ((found->second != elem.link) &&
-                    (((elem.link != "_UniversalDictionary") && (elem.link != "_UniversalArray")) &&
-                    ((found->second != "_UniversalDictionary") && (found->second != "_UniversalArray")))) {
-                    show_context(elem);
-                    output << COLOR_WARNING << "object ";
-                    if (debug_mode)
-                        output << *elem.object << " ";
-                    output << "identified in two different contexts. Originally: " << found->second << "; second: " << elem.link << COLOR_RESET;
-                }
-                delete elem.object;
+
+        // Validate against each PDF version that reached this object (only one unless --force all)
+        const size_t first_queued = to_process.size();
+        int  lanes_validated = 0;
+        bool ok = true;
+        for (int l = 0; ok && ((elem.versions >> l) != 0); l++) {
+            if ((elem.versions & (1 << l)) == 0)
                 continue;
+            activate_lane(l);
+            if (elem.object->is_indirect_ref()) {
+                auto id = elem.object->get_object_id();
+                auto found = find_visited(id);
+                if (found != ArlNoSymbol) {
+                    // "_Universal..." objects match anything so ignore them.
+                    if ((found != elem.link) &&
+                        (((elem.link != universal_dict_link) && (elem.link != universal_array_link)) &&
+                        ((found != universal_dict_link) && (found != universal_array_link)))) {
+                        std::ostream& msg = report(elem, ArlSeverity::Warning, ArlMessageCode::DifferentContexts, link, "");
+                        msg << "object ";
+                        if (debug_mode)
+                            msg << *elem.object << " ";
+                        msg << "identified in two different contexts. Originally: " << grammar->get_symbol_name(found) << "; second: " << link << COLOR_RESET;
+                    }
+                    deactivate_lane();
+                    continue;
+                }
+                // remember visited object with a link used for validation
+                set_visited(id, elem.link);
             }
-            // remember visited object with a link used for validation
-            mapped.insert(std::make_pair(hash, elem.link));
+            lanes_validated++;
+            ok = validate_object(elem);
+            deactivate_lane();
         }
-
-        fs::path  grammar_file = grammar_folder;
-        grammar_file /= elem.link + ".tsv";
-        const ArlTSVmatrix &tsv = get_grammar(elem.link);
-        if (tsv.size() == 0) {
-            output << COLOR_ERROR << "could not open Arlington model file " << grammar_file << COLOR_RESET;
-            // delete elem.object;
+        if (!ok)
             return false;
+
+        // Objects queued identically by several PDF versions are only validated once for all of them
+        if (lanes_validated > 1) {
+            merge_lane_children(to_process, first_queued, elem.path.get());
+            merge_lane_children(children, 0, elem.path.get());
         }
 
-        // Validating as dictionary:
-        // - going through all objects in dictionary
-        // - checking basics (Type, PossibleValue, indirect)
-        // - then check presence of required keys
-        // - then recursively calling validation for each container with link to other grammar file
-        auto obj_type = elem.object->get_object_type();
+        if (elem.object->is_deleteable())
+            delete elem.object;
+    } // while queue not empty
 
-        // Check if object number is out-of-range as per trailer /Size
-        // Allow for multiple indirections and thus negative object numbers
-        if (abs(elem.object->get_object_number()) >= pdfc->get_trailer_size()) {
-            show_context(elem);
-            output << COLOR_ERROR << "object number " << abs(elem.object->get_object_number()) << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
-        }
+#if defined(SCORING_DEBUG)
+    std::cout << "Link selection memo: " << link_memo_hits << " hits, " << link_memo_misses << " misses" << std::endl;
+#endif
+    if (stats != nullptr) {
+        stats->link_memo_hits = link_memo_hits;
+        stats->link_memo_misses = link_memo_misses;
+    }
 
-        if ((obj_type == PDFObjectType::ArlPDFObjTypeDictionary) || (obj_type == PDFObjectType::ArlPDFObjTypeStream)) {
-            ArlPDFDictionary* dictObj;
+    // --force all: verdict for each PDF version
+    for (auto& lane : lanes) {
+        std::ostream& msg = arl_message(output, sink, ArlSeverity::Info, ArlMessageCode::VersionVerdict);
+        msg << "Verdict for PDF " << lane.pdf_version_str << ": " << ((lane.counts[(int)ArlSeverity::Error] == 0) ? "PASS" : "FAIL");
+        msg << " (" << lane.counts[(int)ArlSeverity::Error] << " errors, " << lane.counts[(int)ArlSeverity::Warning] << " warnings, ";
+        msg << lane.counts[(int)ArlSeverity::Info] << " infos)" << COLOR_RESET;
+    }
+    lanes.clear();
 
-            // validate values first, then process containers
-            if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
-                dictObj = ((ArlPDFStream*)elem.object)->get_dictionary();
-            else
-                dictObj = (ArlPDFDictionary*)elem.object;
-
-            // Check for duplicate keys of the same name. Depends on underlying PDF SDK!!
-            // https://assets.devoted.com/plan-documents/2022/DH-DisenrollmentForm-2022-ENG.pdf
-            if (dictObj->has_duplicate_keys()) {
-                show_context(elem);
-                auto dup_keys = dictObj->get_duplicate_keys();
-                for (auto dup_key : dup_keys)
-                    output << COLOR_ERROR << "Duplicate dictionary key: " << dup_key << COLOR_RESET;
-            }
+    // Clean up
+    pdfc = nullptr;
+    return true;
+}
 
-            auto dict_num_keys = dictObj->get_num_keys();
-            for (int i = 0; i < dict_num_keys; i++) {
-                std::wstring key = dictObj->get_key_name_by_index(i);
-                std::string  key_utf8 = ToUtf8(key);
-                ArlPDFObject* inner_obj = dictObj->get_value(key);
-                bool kept_inner_obj = false;
-
-                // might have wrong/malformed object. Key exists, but value does not.
-                // NEVER any predicates in the Arlington 'Key' field
-                if (inner_obj != nullptr) {
-                    // Check if object number is out-of-range as per trailer /Size
-                    if (inner_obj->get_object_number() >= pdfc->get_trailer_size()) {
-                        show_context(elem);
-                        output << COLOR_ERROR << "object number " << inner_obj->get_object_number() << " of key " << key_utf8 << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
-                    }
 
-                    bool is_found = false;
-                    int key_idx = -1;
-                    for (auto& vec : tsv) {
-                        key_idx++;
-                        /// Degenerate case of a PDF key called "/*" matching the Arlington dictionary wildcard!
-                        if ((vec[TSV_KEYNAME] == key_utf8) && (vec[TSV_KEYNAME] != "*")) {
-                            is_found = true;
-                            check_everything(elem.object, inner_obj, key_idx, tsv, elem.link, elem.context, output);
-                            pdf.set_feature_version(vec[TSV_SINCEVERSION], elem.link, key_utf8);
-
-                            // Process version predicates properly (PDF version and object type aware)
-                            ArlVersion versioner(inner_obj, vec, pdf_version, pdfc->get_extensions());
-
-                            if (versioner.object_matched_arlington_type()) {
-                                std::string arl_type = versioner.get_matched_arlington_type();
-                                std::string as = elem.context + "->" + key_utf8;
-                                std::vector<std::string>  full_linkset = versioner.get_full_linkset(vec[TSV_LINK]);
-                                auto t = inner_obj->get_object_type();
-                                if (arl_type == "number-tree") {
-                                    if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "number-tree was not a dictionary for " << elem.link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
-                                    }
-                                    else // safe to cast as dict
-                                        parse_number_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as number-tree)");
-                                }
-                                else if (arl_type == "name-tree") {
-                                    if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "name-tree was not a dictionary for " << elem.link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
-                                    }
-                                    else // safe to cast as dict
-                                        parse_name_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as name-tree)");
-                                }
-                                else if (FindInVector(v_ArlComplexTypes, arl_type)) {
-                                    std::string best_link = recommended_link_for_object(inner_obj, full_linkset, as);
-                                    if (best_link.size() > 0) {
-                                        if (vec[TSV_KEYNAME] != best_link)
-                                            as = as + " (as " + best_link + ")";
-                                        add_parse_object(dictObj, inner_obj, best_link, as); // DON'T DELETE inner_obj!
-                                        kept_inner_obj = true;
-                                    }
-                                }
-                                else // Arlington primitive type (integer, name, string, etc)
-                                    assert(FindInVector(v_ArlNonComplexTypes, arl_type));
+/// @brief Validates a single PDF object against its Arlington TSV file for the PDF version being
+/// validated and queues its child PDF objects. The object is not deleted.
+///
+/// @param[in] elem   the dequeued PDF object
+///
+/// @returns true on success. false on fatal errors (not PDF errors!).
+bool CParsePDF::validate_object(queue_elem& elem)
+{
+    const std::string& link = grammar->get_symbol_name(elem.link);
+    const CArlingtonTSVGrammarFile* grammar_file = get_grammar(elem.link);
+    const ArlTSVmatrix &tsv = grammar_file->get_data();
+    const ArlTSVTypedMatrix &typed_tsv = grammar_file->get_typed_data();
+    const CArlTSVSpecialization& spec = get_specialization(grammar_file);
+    if (tsv.size() == 0) {
+        message(ArlSeverity::Error, ArlMessageCode::MissingTSVFile, link) << "could not open Arlington model file " << (grammar_folder / (link + ".tsv")) << COLOR_RESET;
+        // delete elem.object;
+        return false;
+    }
+
+    // Validating as dictionary:
+    // - going through all objects in dictionary
+    // - checking basics (Type, PossibleValue, indirect)
+    // - then check presence of required keys
+    // - then recursively calling validation for each container with link to other grammar file
+    auto obj_type = elem.object->get_object_type();
+
+    // Check if object number is out-of-range as per trailer /Size
+    // Allow for multiple indirections and thus negative object numbers
+    if (abs(elem.object->get_object_number()) >= pdfc->get_trailer_size()) {
+        report(elem, ArlSeverity::Error, ArlMessageCode::IllegalObjectNumber, link, "") << "object number " << abs(elem.object->get_object_number()) << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
+    }
+
+    if ((obj_type == PDFObjectType::ArlPDFObjTypeDictionary) || (obj_type == PDFObjectType::ArlPDFObjTypeStream)) {
+        ArlPDFDictionary* dictObj;
+
+        // validate values first, then process containers
+        if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
+            dictObj = ((ArlPDFStream*)elem.object)->get_dictionary();
+        else
+            dictObj = (ArlPDFDictionary*)elem.object;
+
+        // Check for duplicate keys of the same name. Depends on underlying PDF SDK!!
+        // https://assets.devoted.com/plan-documents/2022/DH-DisenrollmentForm-2022-ENG.pdf
+        if (dictObj->has_duplicate_keys()) {
+            auto dup_keys = dictObj->get_duplicate_keys();
+            for (auto dup_key : dup_keys)
+                report(elem, ArlSeverity::Error, ArlMessageCode::DuplicateKey, link, dup_key) << "Duplicate dictionary key: " << dup_key << COLOR_RESET;
+        }
+
+        // Keys and values in a single pass over the dictionary (sorted so output order matches other PDF SDKs)
+        dictObj->for_each_key([&](const std::string& key_utf8, ArlPDFObject* inner_obj) {
+            bool kept_inner_obj = false;
+
+            // might have wrong/malformed object. Key exists, but value does not.
+            // NEVER any predicates in the Arlington 'Key' field
+            if (inner_obj != nullptr) {
+                // Check if object number is out-of-range as per trailer /Size
+                if (inner_obj->get_object_number() >= pdfc->get_trailer_size()) {
+                    report(elem, ArlSeverity::Error, ArlMessageCode::IllegalKeyObjectNumber, link, key_utf8) << "object number " << inner_obj->get_object_number() << " of key " << key_utf8 << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
+                }
+
+                bool is_found = false;
+                // Hashed look up never matches a wildcard (degenerate case of a PDF key called "/*")
+                int key_idx = grammar_file->find_key(key_utf8);
+                if (key_idx >= 0) {
+                    const ArlTSVRow& vec = tsv[key_idx];
+                    is_found = true;
+                    check_everything(elem.object, inner_obj, key_idx, grammar_file, elem.link, elem.context);
+                    pdfc->set_feature_version(vec[TSV_SINCEVERSION], link, key_utf8);
+
+                    // Process version predicates properly (PDF version and object type aware)
+                    const ArlVersion& versioner = spec.get_version(key_idx, inner_obj);
+
+                    if (versioner.object_matched_arlington_type()) {
+                        const std::string& arl_type = versioner.get_matched_arlington_type();
+                        std::string suffix = "->" + key_utf8;
+                        std::string as = elem.context + suffix;
+                        const std::vector<ArlSymbol>& full_linkset = versioner.get_full_linkset();
+                        auto t = inner_obj->get_object_type();
+                        if (arl_type == "number-tree") {
+                            if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
+                                report(elem, ArlSeverity::Error, ArlMessageCode::NumberTreeNotDictionary, link, key_utf8) << "number-tree was not a dictionary for " << link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                             }
-                            else {
-                                // PDF object type is not according to Arlington for the exact named key!
-                                // Already reported via check_basics() above.
+                            else // safe to cast as dict
+                                parse_number_tree((ArlPDFDictionary*)inner_obj, full_linkset, std::make_shared<path_node>(elem.path, suffix + " (as number-tree)", elem.path->indent));
+                        }
+                        else if (arl_type == "name-tree") {
+                            if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
+                                report(elem, ArlSeverity::Error, ArlMessageCode::NameTreeNotDictionary, link, key_utf8) << "name-tree was not a dictionary for " << link << "/" << key_utf8 << " (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                             }
-                            // Report version mis-matches
-                            ArlVersionReason reason = versioner.get_version_reason();
-                            if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
-                                show_context(elem);
-                                bool reason_shown = false;
-                                if (reason == ArlVersionReason::After_fnBeforeVersion) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature after obsolescence in PDF";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Before_fnSinceVersion) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature before official introduction in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Is_fnDeprecated) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature that was deprecated in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
-                                    output << COLOR_INFO << "detected a dictionary key version-based feature that was only in PDF ";
-                                    reason_shown = true;
-                                }
-                                if (reason_shown) {
-                                    output << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (using PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                                    output << ") for " << elem.link << "/" << key_utf8 << COLOR_RESET;
-                                }
+                            else // safe to cast as dict
+                                parse_name_tree((ArlPDFDictionary*)inner_obj, full_linkset, std::make_shared<path_node>(elem.path, suffix + " (as name-tree)", elem.path->indent));
+                        }
+                        else if (FindInVector(v_ArlComplexTypes, arl_type)) {
+                            ArlSymbol best_link = recommended_link_for_object(inner_obj, full_linkset, as);
+                            if (best_link != ArlNoSymbol) {
+                                if (typed_tsv[key_idx].key_sym != best_link)
+                                    suffix = suffix + " (as " + grammar->get_symbol_name(best_link) + ")";
+                                add_parse_object(dictObj, inner_obj, best_link, elem.path, suffix); // DON'T DELETE inner_obj!
+                                kept_inner_obj = true;
                             }
-                            if (versioner.is_unsupported_extension())
-                                is_found = false;
-                            break;
                         }
-                    } // for-each Arlington row
-
-                    // Metadata streams are allowed anywhere since PDF 1.4
-                    if ((!is_found) && (key == L"Metadata")) {
-                        add_parse_object(dictObj, inner_obj, "Metadata", elem.context + "->Metadata");
-                        kept_inner_obj = true;
-                        show_context(elem);
-                        output << COLOR_INFO << "found a PDF 1.4 Metadata key" << COLOR_RESET;
-                        pdf.set_feature_version("1.4", "Metadata", ""); // see clause 14.3
-                        is_found = true;
+                        else // Arlington primitive type (integer, name, string, etc)
+                            assert(FindInVector(v_ArlNonComplexTypes, arl_type));
                     }
-
-                    // AF (Associated File) objects are allowed anywhere in PDF 2.0
-                    if ((!is_found) && (key == L"AF")) {
-                        add_parse_object(dictObj, inner_obj, "FileSpecification", elem.context + "->AF (as FileSpecification)");
-                        kept_inner_obj = true;
-                        show_context(elem);
-                        output << COLOR_INFO << "found a PDF 2.0 Associated File AF key" << COLOR_RESET;
-                        pdf.set_feature_version("2.0", "Associated File", "");
-                        is_found = true;
+                    else {
+                        // PDF object type is not according to Arlington for the exact named key!
+                        // Already reported via check_basics() above.
                     }
+                    // Report version mis-matches
+                    ArlVersionReason reason = versioner.get_version_reason();
+                    if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
+                        ArlMessageCode code = ArlMessageCode::KeyAfterObsolescence;
+                        std::string    text;
+                        if (reason == ArlVersionReason::After_fnBeforeVersion) {
+                            code = ArlMessageCode::KeyAfterObsolescence;
+                            text = "detected a dictionary key version-based feature after obsolescence in PDF";
+                        }
+                        else if (reason == ArlVersionReason::Before_fnSinceVersion) {
+                            code = ArlMessageCode::KeyBeforeIntroduction;
+                            text = "detected a dictionary key version-based feature before official introduction in PDF ";
+                        }
+                        else if (reason == ArlVersionReason::Is_fnDeprecated) {
+                            code = ArlMessageCode::KeyDeprecated;
+                            text = "detected a dictionary key version-based feature that was deprecated in PDF ";
+                        }
+                        else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
+                            code = ArlMessageCode::KeyOnlyInVersion;
+                            text = "detected a dictionary key version-based feature that was only in PDF ";
+                        }
+                        if (!text.empty()) {
+                            std::ostream& msg = report(elem, ArlSeverity::Info, code, link, key_utf8);
+                            msg << text << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (using PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                            msg << ") for " << link << "/" << key_utf8 << COLOR_RESET;
+                        }
+                    }
+                    if (versioner.is_unsupported_extension())
+                        is_found = false;
+                }
+
+                // Metadata streams are allowed anywhere since PDF 1.4
+                if ((!is_found) && (key_utf8 == "Metadata")) {
+                    add_parse_object(dictObj, inner_obj, grammar->get_symbol("Metadata"), elem.path, "->Metadata");
+                    kept_inner_obj = true;
+                    report(elem, ArlSeverity::Info, ArlMessageCode::MetadataKey, link, key_utf8) << "found a PDF 1.4 Metadata key" << COLOR_RESET;
+                    pdfc->set_feature_version("1.4", "Metadata", ""); // see clause 14.3
+                    is_found = true;
+                }
+
+                // AF (Associated File) objects are allowed anywhere in PDF 2.0
+                if ((!is_found) && (key_utf8 == "AF")) {
+                    add_parse_object(dictObj, inner_obj, grammar->get_symbol("FileSpecification"), elem.path, "->AF (as FileSpecification)");
+                    kept_inner_obj = true;
+                    report(elem, ArlSeverity::Info, ArlMessageCode::AssociatedFileKey, link, key_utf8) << "found a PDF 2.0 Associated File AF key" << COLOR_RESET;
+                    pdfc->set_feature_version("2.0", "Associated File", "");
+                    is_found = true;
+                }
 
-                    // we didn't find the key, there may be wildcard key ("*") that will validate.
-                    // Wildcards are always the last row so just check that.
-                    if (!is_found) {
-                        auto vec = tsv[tsv.size() - 1];
-                        if (vec[TSV_KEYNAME] == "*") {
-                            pdf.set_feature_version(vec[TSV_SINCEVERSION], elem.link, "dictionary wildcard");
-                            // Process version predicates properly (PDF version and object type aware)
-                            ArlVersion versioner(inner_obj, vec, pdf_version, pdfc->get_extensions());
-                            if (versioner.object_matched_arlington_type()) {
-                                std::string as = elem.context + "->" + key_utf8;
-                                std::string arl_type = versioner.get_matched_arlington_type();
-                                std::vector<std::string>  full_linkset = versioner.get_full_linkset(vec[TSV_LINK]);
-                                auto t = inner_obj->get_object_type();
-                                if (arl_type == "number-tree") {
-                                    if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "number-tree was not a dictionary for " << elem.link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
-                                    }
-                                    else // safe to cast to dict
-                                        parse_number_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as number-tree)");
+                // we didn't find the key, there may be wildcard key ("*") that will validate.
+                if (!is_found) {
+                    int wildcard_idx = grammar_file->get_wildcard_index();
+                    if (wildcard_idx >= 0) {
+                        const ArlTSVRow& vec = tsv[wildcard_idx];
+                        pdfc->set_feature_version(vec[TSV_SINCEVERSION], link, "dictionary wildcard");
+                        // Process version predicates properly (PDF version and object type aware)
+                        const ArlVersion& versioner = spec.get_version(wildcard_idx, inner_obj);
+                        if (versioner.object_matched_arlington_type()) {
+                            std::string suffix = "->" + key_utf8;
+                            std::string as = elem.context + suffix;
+                            const std::string& arl_type = versioner.get_matched_arlington_type();
+                            const std::vector<ArlSymbol>& full_linkset = versioner.get_full_linkset();
+                            auto t = inner_obj->get_object_type();
+                            if (arl_type == "number-tree") {
+                                if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
+                                    report(elem, ArlSeverity::Error, ArlMessageCode::NumberTreeNotDictionary, link, key_utf8) << "number-tree was not a dictionary for " << link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                                 }
-                                else if (arl_type == "name-tree") {
-                                    if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
-                                        show_context(elem);
-                                        output << COLOR_ERROR << "name-tree was not a dictionary for " << elem.link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
-                                    }
-                                    else // safe to cast to dict
-                                        parse_name_tree((ArlPDFDictionary*)inner_obj, full_linkset, as + " (as name-tree)");
+                                else // safe to cast to dict
+                                    parse_number_tree((ArlPDFDictionary*)inner_obj, full_linkset, std::make_shared<path_node>(elem.path, suffix + " (as number-tree)", elem.path->indent));
+                            }
+                            else if (arl_type == "name-tree") {
+                                if (t != PDFObjectType::ArlPDFObjTypeDictionary) {
+                                    report(elem, ArlSeverity::Error, ArlMessageCode::NameTreeNotDictionary, link, key_utf8) << "name-tree was not a dictionary for " << link << "/* (was " << PDFObjectType_strings[(int)t] << ")" << COLOR_RESET;
                                 }
-                                else if (FindInVector(v_ArlComplexTypes, arl_type)) {
-                                    std::string best_link = recommended_link_for_object(inner_obj, full_linkset, as);
-                                    if (best_link.size() > 0) {
-                                        as = as + " (as " + best_link + ")";
-                                        add_parse_object(dictObj, inner_obj, best_link, as); // DON'T DELETE inner_obj!
-                                        kept_inner_obj = true;
-                                    }
+                                else // safe to cast to dict
+                                    parse_name_tree((ArlPDFDictionary*)inner_obj, full_linkset, std::make_shared<path_node>(elem.path, suffix + " (as name-tree)", elem.path->indent));
+                            }
+                            else if (FindInVector(v_ArlComplexTypes, arl_type)) {
+                                ArlSymbol best_link = recommended_link_for_object(inner_obj, full_linkset, as);
+                                if (best_link != ArlNoSymbol) {
+                                    suffix = suffix + " (as " + grammar->get_symbol_name(best_link) + ")";
+                                    add_parse_object(dictObj, inner_obj, best_link, elem.path, suffix); // DON'T DELETE inner_obj!
+                                    kept_inner_obj = true;
                                 }
-                                else // Arlington primitive type (integer, name, number, string, etc).
-                                    assert(FindInVector(v_ArlNonComplexTypes, arl_type));
-                                is_found = true;
                             }
-                            else if (inner_obj->get_object_type() != PDFObjectType::ArlPDFObjTypeNull) {
-                                // PDF object type is not correct to Arlington for wildcard. Explicit "null" is always allowed.
-                                show_context(elem);
-                                output << COLOR_ERROR << "wrong type for dictionary wildcard for " << elem.link << "/" << ToUtf8(key);
-                                output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << ": wanted " << vec[TSV_TYPE] << ", PDF was " << versioner.get_object_arlington_type() << COLOR_RESET;
+                            else // Arlington primitive type (integer, name, number, string, etc).
+                                assert(FindInVector(v_ArlNonComplexTypes, arl_type));
+                            is_found = true;
+                        }
+                        else if (inner_obj->get_object_type() != PDFObjectType::ArlPDFObjTypeNull) {
+                            // PDF object type is not correct to Arlington for wildcard. Explicit "null" is always allowed.
+                            std::ostream& msg = report(elem, ArlSeverity::Error, ArlMessageCode::WildcardWrongType, link, key_utf8);
+                            msg << "wrong type for dictionary wildcard for " << link << "/" << key_utf8;
+                            msg << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << ": wanted " << vec[TSV_TYPE] << ", PDF was " << versioner.get_object_arlington_type() << COLOR_RESET;
+                        }
+                        // Report version mis-matches
+                        ArlVersionReason reason = versioner.get_version_reason();
+                        if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
+                            ArlMessageCode code = ArlMessageCode::WildcardAfterObsolescence;
+                            std::string    text;
+                            if (reason == ArlVersionReason::After_fnBeforeVersion) {
+                                code = ArlMessageCode::WildcardAfterObsolescence;
+                                text = "detected a dictionary wildcard version-based feature after obsolescence in PDF";
                             }
-                            // Report version mis-matches
-                            ArlVersionReason reason = versioner.get_version_reason();
-                            if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
-                                show_context(elem);
-                                bool reason_shown = false;
-                                if (reason == ArlVersionReason::After_fnBeforeVersion) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature after obsolescence in PDF";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Before_fnSinceVersion) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature before official introduction in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Is_fnDeprecated) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature that was deprecated in PDF ";
-                                    reason_shown = true;
-                                }
-                                else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
-                                    output << COLOR_INFO << "detected a dictionary wildcard version-based feature that was only in PDF ";
-                                    reason_shown = true;
-                                }
-                                if (reason_shown) {
-                                    output << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (using PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                                    output << ") for " << elem.link << "/" << key_utf8 << COLOR_RESET;
-                                }
+                            else if (reason == ArlVersionReason::Before_fnSinceVersion) {
+                                code = ArlMessageCode::WildcardBeforeIntroduction;
+                                text = "detected a dictionary wildcard version-based feature before official introduction in PDF ";
                             }
-                        } // last row was a wildcard
-                    }
-
-                    // Still didn't find the key - report as an extension
-                    if (!is_found) {
-                        show_context(elem);
-                        if (is_second_class_pdf_name(key_utf8))
-                            output << COLOR_INFO << "second class key '" << key_utf8 << "' is not defined in Arlington for ";
-                        else if (is_third_class_pdf_name(key_utf8))
-                            output << COLOR_INFO << "third class key '" << key_utf8 << "' found in ";
-                        else
-                            output << COLOR_INFO << "unknown key '" << key_utf8 << "' is not defined in Arlington for ";
-                        output << elem.link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
-                    }
+                            else if (reason == ArlVersionReason::Is_fnDeprecated) {
+                                code = ArlMessageCode::WildcardDeprecated;
+                                text = "detected a dictionary wildcard version-based feature that was deprecated in PDF ";
+                            }
+                            else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
+                                code = ArlMessageCode::WildcardOnlyInVersion;
+                                text = "detected a dictionary wildcard version-based feature that was only in PDF ";
+                            }
+                            if (!text.empty()) {
+                                std::ostream& msg = report(elem, ArlSeverity::Info, code, link, key_utf8);
+                                msg << text << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (using PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                                msg << ") for " << link << "/" << key_utf8 << COLOR_RESET;
+                            }
+                        }
+                    } // last row was a wildcard
                 }
-                else {
-                    // inner_objj == nullptr so malformed PDF or parsing limitation in PDF SDK?
-                    show_context(elem);
-                    output << COLOR_ERROR << "could not get value for key '" << key_utf8 << "' (" << elem.link << ")" << COLOR_RESET;
+
+                // Still didn't find the key - report as an extension
+                if (!is_found) {
+                    ArlMessageCode code = ArlMessageCode::UnknownKey;
+                    if (is_second_class_pdf_name(key_utf8))
+                        code = ArlMessageCode::SecondClassKey;
+                    else if (is_third_class_pdf_name(key_utf8))
+                        code = ArlMessageCode::ThirdClassKey;
+                    std::ostream& msg = report(elem, ArlSeverity::Info, code, link, key_utf8);
+                    if (code == ArlMessageCode::SecondClassKey)
+                        msg << "second class key '" << key_utf8 << "' is not defined in Arlington for ";
+                    else if (code == ArlMessageCode::ThirdClassKey)
+                        msg << "third class key '" << key_utf8 << "' found in ";
+                    else
+                        msg << "unknown key '" << key_utf8 << "' is not defined in Arlington for ";
+                    msg << link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
                 }
+            }
+            else {
+                // inner_objj == nullptr so malformed PDF or parsing limitation in PDF SDK?
+                report(elem, ArlSeverity::Error, ArlMessageCode::KeyValueMissing, link, key_utf8) << "could not get value for key '" << key_utf8 << "' (" << link << ")" << COLOR_RESET;
+            }
 
-                if (!kept_inner_obj)
-                    delete inner_obj;
-            } // for-each key in PDF object
+            if (!kept_inner_obj)
+                delete inner_obj;
+            return true;
+        }); // for-each key in PDF object
 
-            // Now process Arlington definition of the same PDF object
-            PredicateProcessor req_pp(pdfc, tsv);
-            int key_idx = -1;
-            for (auto& vec : tsv) {
-                key_idx++;
-                // Check for missing required values in object, and parents if inheritable
-                ArlVersion versioner(dictObj, vec, pdf_version, pdfc->get_extensions());
-                bool required_key = req_pp.IsRequired(elem.object, dictObj, key_idx, versioner.get_arlington_type_index());
-
-                if (required_key) {
-                    assert(vec[TSV_KEYNAME].find('*') == std::string::npos); // wildcards should NEVER be required!
-                    ArlPDFObject* inner_obj = dictObj->get_value(ToWString(vec[TSV_KEYNAME]));
-                    if (inner_obj == nullptr) {
-                        // Arlington 'Inheritable' field NEVER has predicates
-                        assert(vec[TSV_INHERITABLE].find("fn:") == std::string::npos);
-                        if (vec[TSV_INHERITABLE] == "FALSE") {
-                            show_context(elem);
+        // Now process Arlington definition of the same PDF object
+        PredicateProcessor req_pp(pdfc, grammar_file, &spec);
+        int key_idx = -1;
+        for (auto& vec : tsv) {
+            key_idx++;
+            const ArlTSVTypedRow& typed_row = typed_tsv[key_idx];
+            // Check for missing required values in object, and parents if inheritable
+            const ArlVersion& versioner = spec.get_version(key_idx, dictObj);
+            bool required_key = req_pp.IsRequired(elem.object, dictObj, key_idx, versioner.get_arlington_type_index());
+
+            if (required_key) {
+                assert(!typed_row.has_wildcard); // wildcards should NEVER be required!
+                ArlPDFObject* inner_obj = dictObj->get_value(typed_row.key);
+                if (inner_obj == nullptr) {
+                    // Arlington 'Inheritable' field NEVER has predicates
+                    assert(vec[TSV_INHERITABLE].find("fn:") == std::string::npos);
+                    if (!typed_row.inheritable) {
+                        std::ostream& msg = req_pp.WasFullyImplemented() ?
+                            report(elem, ArlSeverity::Error, ArlMessageCode::RequiredKeyMissing, link, typed_row.key) :
+                            report(elem, ArlSeverity::Warning, ArlMessageCode::RequiredKeyMayBeMissing, link, typed_row.key);
+                        if (req_pp.WasFullyImplemented())
+                            msg << "non-inheritable required key does not exist: ";
+                        else
+                            msg << "non-inheritable required key may not exist: ";
+                        msg << vec[TSV_KEYNAME] << " (" << link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                        if (debug_mode)
+                            msg << " (" << *dictObj << ")";
+                        if ((vec[TSV_REQUIRED].find("fn:") != std::string::npos) || !req_pp.WasFullyImplemented())
+                            msg << " because " << vec[TSV_REQUIRED];
+                        msg << COLOR_RESET;
+                    }
+                    else {
+                        assert(vec[TSV_INHERITABLE] == "TRUE");
+                        if (!has_inherited_key(dictObj, typed_row.key)) {
+                            std::ostream& msg = req_pp.WasFullyImplemented() ?
+                                report(elem, ArlSeverity::Error, ArlMessageCode::InheritableRequiredKeyMissing, link, typed_row.key) :
+                                report(elem, ArlSeverity::Warning, ArlMessageCode::InheritableRequiredKeyMayBeMissing, link, typed_row.key);
                             if (req_pp.WasFullyImplemented())
-                                output << COLOR_ERROR << "non-inheritable required key does not exist: ";
+                                msg << "inheritable required key does not exist: ";
                             else
-                                output << COLOR_WARNING << "non-inheritable required key may not exist: ";
-                            output << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                                msg << "inheritable required key may not exist: ";
+                            msg << vec[TSV_KEYNAME] << " (" << link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
                             if (debug_mode)
-                                output << " (" << *dictObj << ")";
+                                msg << " (" << *dictObj << ")";
                             if ((vec[TSV_REQUIRED].find("fn:") != std::string::npos) || !req_pp.WasFullyImplemented())
-                                output << " because " << vec[TSV_REQUIRED];
-                            output << COLOR_RESET;
-                        }
-                        else {
-                            assert(vec[TSV_INHERITABLE] == "TRUE");
-                            inner_obj = find_via_inheritance(dictObj, ToWString(vec[TSV_KEYNAME]));
-                            if (inner_obj == nullptr) {
-                                show_context(elem);
-                                if (req_pp.WasFullyImplemented())
-                                    output << COLOR_ERROR << "inheritable required key does not exist: ";
-                                else
-                                    output << COLOR_WARNING << "inheritable required key may not exist: ";
-                                output << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                                if (debug_mode)
-                                    output << " (" << *dictObj << ")";
-                                if ((vec[TSV_REQUIRED].find("fn:") != std::string::npos) || !req_pp.WasFullyImplemented())
-                                    output << " because " << vec[TSV_REQUIRED];
-                                output << COLOR_RESET;
-                            }
+                                msg << " because " << vec[TSV_REQUIRED];
+                            msg << COLOR_RESET;
                         }
                     }
-                    delete inner_obj;
-                }
-                else if (!req_pp.WasFullyImplemented()) {
-                    // Partial support is a warning as don't know if really required or not
-                    show_context(elem);
-                    output << COLOR_WARNING << "required key may not exist: " << vec[TSV_KEYNAME] << " (" << elem.link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
-                    if (debug_mode)
-                        output << " (" << *dictObj << ")";
-                    output << " because " << vec[TSV_REQUIRED] << COLOR_RESET;
                 }
-            } // for-each Arlington row
+                delete inner_obj;
+            }
+            else if (!req_pp.WasFullyImplemented()) {
+                // Partial support is a warning as don't know if really required or not
+                std::ostream& msg = report(elem, ArlSeverity::Warning, ArlMessageCode::RequiredKeyUnknown, link, typed_row.key);
+                msg << "required key may not exist: " << vec[TSV_KEYNAME] << " (" << link << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0);
+                if (debug_mode)
+                    msg << " (" << *dictObj << ")";
+                msg << " because " << vec[TSV_REQUIRED] << COLOR_RESET;
+            }
+        } // for-each Arlington row
 
-            if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
-                delete dictObj; // Only delete for streams
+        if (obj_type == PDFObjectType::ArlPDFObjTypeStream)
+            delete dictObj; // Only delete for streams
+    }
+    else if (obj_type == PDFObjectType::ArlPDFObjTypeArray) {
+        ArlPDFArray*    arrayObj = (ArlPDFArray*)elem.object;
+
+        // Array layout is precomputed when the TSV file is loaded
+        const ArlTSVArrayLayout& layout = grammar_file->get_array_layout();
+        if (!layout.is_valid_array) {
+            report(elem, ArlSeverity::Error, ArlMessageCode::ArrayAsDictionary, link, "") << "PDF array object encountered, but using Arlington dictionary " << link << COLOR_RESET;
+            return true;
         }
-        else if (obj_type == PDFObjectType::ArlPDFObjTypeArray) {
-            ArlPDFArray*    arrayObj = (ArlPDFArray*)elem.object;
 
-            // Use null-stream to suppress messages - should have used "--validate" first anyway
-            {
-                std::vector<std::string> array_index_list;
-                for (int i = 0; i < (int)tsv.size(); i++)
-                    array_index_list.push_back(tsv[i][TSV_KEYNAME]);
-
-                bool ambiguous;
-                if (!check_valid_array_definition(elem.link, array_index_list, cnull, &ambiguous)) {
-                    show_context(elem);
-                    output << COLOR_ERROR << "PDF array object encountered, but using Arlington dictionary " << elem.link << COLOR_RESET;
-                    delete elem.object;
-                    continue;
-                }
-            }
+        const int first_optional_idx = layout.first_optional_idx;
+        const int pure_wildcard_idx = layout.pure_wildcard_idx;
+        const int first_row_to_repeat_idx = layout.first_row_to_repeat_idx;
+        const int num_array_rows_fixed = layout.num_array_rows_fixed;
+        const int num_array_rows_repeats = layout.num_array_rows_repeats;
+        const int num_required_rows = layout.num_required_rows;
 
-            // "_idx" = a valid array index 0 ... N-1 or -1 (invalid)
-            // "num_" = size of something (0 ... N)
-            int first_optional_idx = -1;        // first optional row index in TSV
-            int pure_wildcard_idx = -1;         // row index of pure wildcard in TSV (always the last row)
-            int first_row_to_repeat_idx = -1;   // first row index of repeating set
-            int num_array_rows_fixed = 0;       // non-repeating rows (always BEFORE any repeating set)
-            int num_array_rows_repeats = 0;     // number of rows in repeating set
-            int num_required_rows = 0;          // required across all rows
-
-            // Determine first row index that is optional (Required field != "TRUE")
-            for (int i = 0; i < (int)tsv.size(); i++) {
-                if (tsv[i][TSV_REQUIRED] != "TRUE") {
-                    first_optional_idx = i;
-                    break;
-                }
-            } // for
+        int array_size = arrayObj->get_num_elements();
 
-            // Number of required elements (TSV rows) in PDF array
-            if (first_optional_idx == -1)
-                num_required_rows = (int)tsv.size();    // all rows required
-            else if (first_optional_idx == 0)
-                num_required_rows = 0;                  // no rows required
-            else
-                num_required_rows = (int)tsv.size() - first_optional_idx;   // some rows required, some not
+        // Are all required rows present?
+        if ((first_optional_idx >= 0) && (array_size < first_optional_idx)) {
+            std::ostream& msg = report(elem, ArlSeverity::Error, ArlMessageCode::ArrayMinimumLength, link, "");
+            msg << "minimum required array length incorrect for " << link;
+            msg << ": wanted " << first_optional_idx << ", got " << array_size;
+            if (debug_mode)
+                msg << " (" << *arrayObj << ")";
+            msg << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+        }
 
-            // Determine (pure) wildcard status - array repeat sets handled separately below.
-            // Pure wildcards are always the LAST row in the TSV
-            if (tsv[tsv.size() - 1][TSV_KEYNAME] == "*")
-                pure_wildcard_idx = (int)tsv.size() - 1;
+        // PDF array object must always contain sufficient required rows  
+        if (array_size < num_required_rows) {
+            report(elem, ArlSeverity::Error, ArlMessageCode::ArrayTooShort, link, "") << "array length was too short (needed " << num_required_rows << ", was " << array_size << ") for " << link << COLOR_RESET;
+        }
 
-            int array_size = arrayObj->get_num_elements();
+        // If all rows required (both fixed + repeating) AND some repeating rows, then array length less the number of fixed rows
+        // must be an exact multiple of the repeat
+        if ((num_required_rows == (int)tsv.size()) && (num_array_rows_repeats > 0) && 
+            ((((array_size - num_array_rows_fixed) % num_array_rows_repeats)) != 0) && (first_optional_idx == -1)) {
+            std::ostream& msg = report(elem, ArlSeverity::Warning, ArlMessageCode::ArrayNotMultiple, link, "");
+            msg << "array length was not an exact multiple of " << num_required_rows << " (was " << array_size << ") for " << link;
+            msg << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+        }
 
-            // Are all required rows present?
-            if ((first_optional_idx >= 0) && (array_size < first_optional_idx)) {
-                show_context(elem);
-                output << COLOR_ERROR << "minimum required array length incorrect for " << elem.link;
-                output << ": wanted " << first_optional_idx << ", got " << array_size;
-                if (debug_mode)
-                    output << " (" << *arrayObj << ")";
-                output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
-            }
+        int last_idx = -1; // Keep track of previous TSV row (so can loop for repeat sets)
+        arrayObj->for_each_element([&](const int i, ArlPDFObject* item) {
+            bool item_kept = false;
+            if (item != nullptr) {
+                int idx = -1; // initialize as invalid TSV index
 
-            // For array repeat sets, rows in repeating set need to be DIGIT + '*' 
-            // DIGIT is not checked here. Assumed to be valid.
-            for (int i = 0; i < (int)tsv.size(); i++) {
-                if (tsv[i][TSV_KEYNAME].find('*') == std::string::npos) {
-                    assert(num_array_rows_repeats == 0);
-                    assert(first_row_to_repeat_idx < 0);
-                    num_array_rows_fixed++;
-                }
-                else { // pure wildcard ('*') or array repeat (DIGIT + '*')
-                    num_array_rows_repeats++;
-                    if (first_row_to_repeat_idx < 0)
-                        first_row_to_repeat_idx = i;
+                // Check if object number is out-of-range as per trailer /Size.
+                // Allow for multiple indirections and thus negative object numbers.
+                if (item->get_object_number() >= pdfc->get_trailer_size()) {
+                    report(elem, ArlSeverity::Error, ArlMessageCode::IllegalArrayElementObjectNumber, link, std::to_string(i)) << "object number " << item->get_object_number() << " of array element " << i << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
                 }
-            } // for
 
-            // Sanity check local variables 
-            assert(num_array_rows_fixed + num_array_rows_repeats == (int)tsv.size());
-            assert((first_optional_idx == -1) || (first_row_to_repeat_idx == -1) || (first_optional_idx >= first_row_to_repeat_idx));
-
-            // PDF array object must always contain sufficient required rows  
-            if (array_size < num_required_rows) {
-                show_context(elem);
-                output << COLOR_ERROR << "array length was too short (needed " << num_required_rows << ", was " << array_size << ") for " << elem.link << COLOR_RESET;
-            }
+                // Arlington data model array repeat sets and required/optional logic
+                if ((pure_wildcard_idx != -1) && (i >= pure_wildcard_idx)) {
+                    // Adjust for pure wildcards (only ever one row, which is always the last in the TSV)
+                    idx = pure_wildcard_idx;
+                }
+                else if ((num_array_rows_repeats > 0) && (first_optional_idx == -1) && ((last_idx + 1) >= first_row_to_repeat_idx)) {
+                    // Adjust for array repeats when ALL rows are required.
+                    // If last_idx is within the repeat set then increment, otherwise cycle back to first row that repeats in the TSV
+                    if ((last_idx + 1) < (int)tsv.size())
+                        idx = last_idx + 1;
+                    else
+                        idx = first_row_to_repeat_idx;
+                }
+                else  if (((num_array_rows_repeats > 0) && (first_optional_idx != -1) && ((last_idx + 1) >= first_optional_idx))) {
+                    // For array repeat sets when only SOME rows are required (i.e. first_optional_idx != -1), need to decide if PDF object 'item' 
+                    // best matches the optional array element at/near the end of the repeat set, or if should cycle back around to match the first 
+                    // repeating set row in the TSV. 
+                    // Decide based on precise PDF object type of 'item'.
+                    auto itm_type = item->get_object_type();
+                    if (tsv[first_optional_idx][TSV_TYPE].find(ArlingtonPDFShim::PDFObjectType_strings[(int)itm_type]) != std::string::npos) {
+                        // types matched for next optional index so keep going in this repeat set
+                        idx = last_idx + 1;
+                    }
+                    else {
+                        // types did NOT match optional index, so start at beginning of repeat set again
+                        idx = first_row_to_repeat_idx;
+                    }
+                }
 
-            // If all rows required (both fixed + repeating) AND some repeating rows, then array length less the number of fixed rows
-            // must be an exact multiple of the repeat
-            if ((num_required_rows == (int)tsv.size()) && (num_array_rows_repeats > 0) && 
-                ((((array_size - num_array_rows_fixed) % num_array_rows_repeats)) != 0) && (first_optional_idx == -1)) {
-                show_context(elem);
-                output << COLOR_WARNING << "array length was not an exact multiple of " << num_required_rows << " (was " << array_size << ") for " << elem.link;
-                output << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
-            }
+                if (idx < 0) {
+                    // None of the above special case processing kicked in...
+                    idx = last_idx + 1;
+                }
 
-            int last_idx = -1; // Keep track of previous TSV row (so can loop for repeat sets)
-            for (int i = 0; i < array_size; i++) {
-                ArlPDFObject* item = arrayObj->get_value(i);
-                bool item_kept = false;
-                if (item != nullptr) {
-                    int idx = -1; // initialize as invalid TSV index
-
-                    // Check if object number is out-of-range as per trailer /Size.
-                    // Allow for multiple indirections and thus negative object numbers.
-                    if (item->get_object_number() >= pdfc->get_trailer_size()) {
-                        show_context(elem);
-                        output << COLOR_ERROR << "object number " << item->get_object_number() << " of array element " << i << " is illegal. trailer Size is " << pdfc->get_trailer_size() << COLOR_RESET;
+                // Check valid TSV range
+                assert(idx >= 0);
+                last_idx = idx;
+
+                if (idx < (int)tsv.size()) {
+                    check_everything(arrayObj, item, idx, grammar_file, elem.link, elem.context);
+                    std::string idx_s = "[" + std::to_string(i) + "]";
+                    pdfc->set_feature_version(tsv[idx][TSV_SINCEVERSION], link, idx_s);
+                    // Process version predicates properly (version aware)
+                    const ArlVersion& versioner = spec.get_version(idx, item);
+                    const std::string& arl_type = versioner.get_matched_arlington_type();
+                    if (FindInVector(v_ArlComplexTypes, arl_type)) {
+                        std::string suffix = "[" + std::to_string(i);
+                        const std::vector<ArlSymbol>& full_linkset = versioner.get_full_linkset();
+                        ArlSymbol best_link = recommended_link_for_object(item, full_linkset, elem.context + suffix + "]");
+                        if (best_link != ArlNoSymbol) {
+                            suffix = suffix + " (as " + grammar->get_symbol_name(best_link) + ")]";
+                            add_parse_object(arrayObj, item, best_link, elem.path, suffix);
+                            item_kept = true;
+                        }
                     }
 
-                    // Arlington data model array repeat sets and required/optional logic
-                    if ((pure_wildcard_idx != -1) && (i >= pure_wildcard_idx)) {
-                        // Adjust for pure wildcards (only ever one row, which is always the last in the TSV)
-                        idx = pure_wildcard_idx;
-                    }
-                    else if ((num_array_rows_repeats > 0) && (first_optional_idx == -1) && ((last_idx + 1) >= first_row_to_repeat_idx)) {
-                        // Adjust for array repeats when ALL rows are required.
-                        // If last_idx is within the repeat set then increment, otherwise cycle back to first row that repeats in the TSV
-                        if ((last_idx + 1) < (int)tsv.size())
-                            idx = last_idx + 1;
-                        else
-                            idx = first_row_to_repeat_idx;
-                    }
-                    else  if (((num_array_rows_repeats > 0) && (first_optional_idx != -1) && ((last_idx + 1) >= first_optional_idx))) {
-                        // For array repeat sets when only SOME rows are required (i.e. first_optional_idx != -1), need to decide if PDF object 'item' 
-                        // best matches the optional array element at/near the end of the repeat set, or if should cycle back around to match the first 
-                        // repeating set row in the TSV. 
-                        // Decide based on precise PDF object type of 'item'.
-                        auto itm_type = item->get_object_type();
-                        if (tsv[first_optional_idx][TSV_TYPE].find(ArlingtonPDFShim::PDFObjectType_strings[(int)itm_type]) != std::string::npos) {
-                            // types matched for next optional index so keep going in this repeat set
-                            idx = last_idx + 1;
+                    // Report version mis-matches
+                    ArlVersionReason reason = versioner.get_version_reason();
+                    if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
+                        ArlMessageCode code = ArlMessageCode::ArrayAfterObsolescence;
+                        std::string    text;
+                        if (reason == ArlVersionReason::After_fnBeforeVersion) {
+                            code = ArlMessageCode::ArrayAfterObsolescence;
+                            text = "detected an array version-based feature after obsolescence in PDF";
                         }
-                        else {
-                            // types did NOT match optional index, so start at beginning of repeat set again
-                            idx = first_row_to_repeat_idx;
+                        else if (reason == ArlVersionReason::Before_fnSinceVersion) {
+                            code = ArlMessageCode::ArrayBeforeIntroduction;
+                            text = "detected an array version-based feature before official introduction in PDF ";
+                        }
+                        else if (reason == ArlVersionReason::Is_fnDeprecated) {
+                            code = ArlMessageCode::ArrayDeprecated;
+                            text = "detected an array version-based feature that was deprecated in PDF ";
+                        }
+                        else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
+                            code = ArlMessageCode::ArrayOnlyInVersion;
+                            text = "detected an array version-based feature that was only in PDF ";
                         }
+                        if (!text.empty())
+                            report(elem, ArlSeverity::Info, code, link, std::to_string(i)) << text << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (in PDF " << (pdf_version / 10.0) << ") for " << link << "/" << i << COLOR_RESET;
                     }
+                }
+                else {
+                    std::ostream& msg = report(elem, ArlSeverity::Info, ArlMessageCode::ArrayTooLong, link, std::to_string(i));
+                    msg << "array was longer than needed (wanted " << (int)tsv.size() << ", got " << array_size;
+                    msg << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " for " << link << "/" << i+1 << COLOR_RESET;
+                }
+            }
+            if (!item_kept)
+                delete item;
+            return true;
+        }); // for-each array element
+    }
+    else {
+        report(elem, ArlSeverity::Error, ArlMessageCode::UnexpectedObjectType, link, "") << "unexpected object type " << PDFObjectType_strings[(int)obj_type] << " for " << link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+    }
+    return true;
+}
 
-                    if (idx < 0) {
-                        // None of the above special case processing kicked in...
-                        idx = last_idx + 1;
-                    }
 
-                    // Check valid TSV range
-                    assert(idx >= 0);
-                    last_idx = idx;
-
-                    if (idx < (int)tsv.size()) {
-                        check_everything(arrayObj, item, idx, tsv, elem.link, elem.context, output);
-                        std::string idx_s = "[" + std::to_string(i) + "]";
-                        pdf.set_feature_version(tsv[idx][TSV_SINCEVERSION], elem.link, idx_s);
-                        // Process version predicates properly (version aware)
-                        ArlVersion versioner(item, tsv[idx], pdf_version, pdfc->get_extensions());
-                        std::string arl_type = versioner.get_matched_arlington_type();
-                        if (FindInVector(v_ArlComplexTypes, arl_type)) {
-                            std::string as = elem.context + "[" + std::to_string(i);
-                            std::vector<std::string>  full_linkset = versioner.get_full_linkset(tsv[idx][TSV_LINK]);
-                            std::string best_link = recommended_link_for_object(item, full_linkset, as + "]");
-                            if (best_link.size() > 0) {
-                                as = as + " (as " + best_link + ")]";
-                                add_parse_object(arrayObj, item, best_link, as);
-                                item_kept = true;
-                            }
-                        }
+/// @brief Validates a single PDF file against the Arlington PDF model
+///
+/// @param[in] pdf_file_name  PDF filename for processing
+/// @param[in] tsv_folder  the folder with the Arlington TSV model files
+/// @param[in] pdfsdk      the already initiated PDF SDK library to use
+/// @param[in] ofs         already open file stream for output
+/// @param[in] terse       terse style (brief) output (will sort | uniq better under Linux CLI)
+/// @param[in] debug_mode  verbose style output (PDF-file specific information e.g. object numbers)
+/// @param[in] forced_ver  forced PDF version or empty string to use PDF
+/// @param[in] extns       list of extension names to support
+/// @param[in] pwd         password
+/// @param[in] dfs         depth-first traversal of the PDF DOM (otherwise breadth-first)
+/// @param[in] max_memory  ceiling in bytes on memory for queued PDF objects (0 = unlimited)
+/// @param[in] fmt         output format (text, JSON Lines or binary)
+/// @param[in] show_stats  collect and output profiling counters (--stats)
+/// 
+/// @returns true on success. false on a fatal error
+bool process_single_pdf(
+    const fs::path& pdf_file_name, 
+    const fs::path& tsv_folder, 
+    ArlingtonPDFSDK& pdfsdk, 
+    std::ostream& ofs, 
+    const bool terse, 
+    const bool debug_mode, 
+    const std::string& forced_ver, 
+    std::vector<std::string>& extns,
+    std::wstring& pwd,
+    const bool dfs,
+    const size_t max_memory,
+    const ArlOutputFormat fmt,
+    const bool show_stats)
+{
+    bool retval = true;
+    ArlResultSink* sink = make_result_sink(fmt, ofs);
+    ArlStats* stats = nullptr;
+    if (show_stats) {
+        stats = new ArlStats();
+        ArlingtonPDFSDK::counters = &stats->sdk;
+    }
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+        if (sink == nullptr) {
+            ofs << "BEGIN - TestGrammar " << TestGrammar_VERSION << " " << pdfsdk.get_version_string() << std::endl;
+            ofs << "Arlington TSV data: " << fs::absolute(tsv_folder).lexically_normal() << std::endl;
+            ofs << "PDF: " << fs::absolute(pdf_file_name).lexically_normal() << std::endl;
+        }
+        else
+            sink->begin_pdf(fs::absolute(pdf_file_name).lexically_normal().u8string(), TestGrammar_VERSION, pdfsdk.get_version_string(), fs::absolute(tsv_folder).lexically_normal().u8string());
+
+        if (pdfsdk.open_pdf(pdf_file_name, pwd)) {
+            ArlPDFDocumentGuard doc(pdfsdk);    // closes the PDF if anything below throws
+            CParsePDF parser(tsv_folder, ofs, terse, debug_mode, dfs, max_memory, sink, stats);
+            CPDFFile  pdf(pdf_file_name, pdfsdk, forced_ver, extns, stats);
+            std::string s;
+            ArlPDFTrailer* t = pdfsdk.get_trailer();
+            if (t != nullptr) {
+                if (t->is_xrefstm()) {
+                    arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::XRefStreamDetected) << "XRefStream detected." << COLOR_RESET;
+                    s = "Trailer (as XRefStream)";
+                    parser.add_root_parse_object(t, "XRefStream", s);
+                }
+                else {
+                    arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::TraditionalTrailerDetected) << "Traditional trailer dictionary detected." << COLOR_RESET;
+                    s = "Trailer";
+                    parser.add_root_parse_object(t, "FileTrailer", s);
+                }
 
-                        // Report version mis-matches
-                        ArlVersionReason reason = versioner.get_version_reason();
-                        if ((reason != ArlVersionReason::OK) && (reason != ArlVersionReason::Unknown)) {
-                            show_context(elem);
-                            bool reason_shown = false;
-                            if (reason == ArlVersionReason::After_fnBeforeVersion) {
-                                output << COLOR_INFO << "detected an array version-based feature after obsolescence in PDF";
-                                reason_shown = true;
-                            }
-                            else if (reason == ArlVersionReason::Before_fnSinceVersion) {
-                                output << COLOR_INFO << "detected an array version-based feature before official introduction in PDF ";
-                                reason_shown = true;
-                            }
-                            else if (reason == ArlVersionReason::Is_fnDeprecated) {
-                                output << COLOR_INFO << "detected an array version-based feature that was deprecated in PDF ";
-                                reason_shown = true;
-                            }
-                            else if (reason == ArlVersionReason::Not_fnIsPDFVersion) {
-                                output << COLOR_INFO << "detected an array version-based feature that was only in PDF ";
-                                reason_shown = true;
-                            }
-                            if (reason_shown)
-                                output << std::fixed << std::setprecision(1) << (versioner.get_reason_version() / 10.0) << " (in PDF " << (pdf_version / 10.0) << ") for " << elem.link << "/" << i << COLOR_RESET;
-                        }
+                parser.add_root_parse_object(pdfsdk.get_document_catalog(), "Catalog", s + "->Root (as Catalog)");
+
+                if (t->is_encrypted()) {
+                    if (t->is_unsupported_encryption()) {
+                        arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::UnsupportedEncryption) << "Unsupported encryption" << COLOR_RESET;
                     }
                     else {
-                        show_context(elem);
-                        output << COLOR_INFO << "array was longer than needed (wanted " << (int)tsv.size() << ", got " << array_size;
-                        output << ") in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << " for " << elem.link << "/" << i+1 << COLOR_RESET;
+                        arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::EncryptedPDF) << "Encrypted PDF" << COLOR_RESET;
+                    }
+                }
+
+                retval = parser.parse_object(pdf);
+                if (retval) {
+                    std::ostream& msg = arl_message(ofs, sink, ArlSeverity::Info, ArlMessageCode::LatestFeatureVersion);
+                    msg << "Latest Arlington object was" << pdf.get_latest_feature_version_info() << " compared using";
+                    if (pdf.is_all_versions())
+                        msg << " all PDF versions";
+                    else
+                        msg << (pdf.is_forced_version() ? " forced" : "") << " PDF " << pdf.pdf_version;
+                    if (extns.size() > 0) {
+                        msg << " with extensions ";
+                        for (size_t i = 0; i < extns.size(); i++)
+                            msg << extns[i] << ((i < (extns.size() - 1)) ? ", " : "");
                     }
+                    msg << COLOR_RESET;
                 }
-                if (!item_kept)
-                    delete item;
-            } // for-each array element
+            }
+            else {
+                arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::NoTrailer) << "failed to acquire Trailer" << COLOR_RESET;
+            }
+            pdf.close_pdf();
+            doc.release();
         }
         else {
-            show_context(elem);
-            output << COLOR_ERROR << "unexpected object type " << PDFObjectType_strings[(int)obj_type] << " for " << elem.link << " in PDF " << std::fixed << std::setprecision(1) << (pdf_version / 10.0) << COLOR_RESET;
+            arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::OpenFailed) << "failed to open PDF" << COLOR_RESET;
         }
-        if (elem.object->is_deleteable())
-            delete elem.object;
-    } // while queue not empty
+    }
+    catch (std::exception& ex) {
+        arl_message(ofs, sink, ArlSeverity::Error, ArlMessageCode::Exception) << "EXCEPTION: " << ex.what() << COLOR_RESET;
+        retval = false;
+    }
 
-    // Clean up
-    pdfc = nullptr;
-    return true;
+    if (stats != nullptr) {
+        ArlingtonPDFSDK::counters = nullptr;
+        stats->total_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        auto grammar = CArlingtonGrammar::get_shared_grammar(tsv_folder);
+        std::string json = stats->to_json(fs::absolute(pdf_file_name).lexically_normal().u8string(), *grammar);
+        if (sink == nullptr) {
+            stats->write_table(ofs, *grammar);
+            ofs << json << std::endl;
+        }
+        else
+            sink->write_stats(json);
+        delete stats;
+    }
+
+    if (sink == nullptr)
+        ofs << "END" << std::endl;
+    else {
+        sink->end_pdf(retval);
+        delete sink;
+    }
+    return retval;
 }
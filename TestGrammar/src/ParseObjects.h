@@ -29,13 +29,20 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <iostream>
-#include <queue>
+#include <deque>
+#include <vector>
+#include <memory>
 #include <cassert>
 
 #include "ArlingtonTSVGrammarFile.h"
 #include "ArlingtonPDFShim.h"
+#include "ArlTSVSpecialization.h"
 #include "ArlVersion.h"
+#include "ArlResults.h"
+#include "ArlStats.h"
 #include "PDFFile.h"
 #include "utils.h"
 
@@ -45,28 +52,100 @@ using namespace ArlingtonPDFShim;
 class CParsePDF
 {
 private:
+    /// @brief A visited indirect PDF object: generation number and the link used to validate it
+    struct visited_elem {
+        int         generation_num;
+        ArlSymbol   link;       // ArlNoSymbol if not visited
+
+        visited_elem() : generation_num(-1), link(ArlNoSymbol)
+            { /* constructor */ }
+    };
+
     /// @brief Remembering processed PDF objects (and how they were validated).
-    ///        Storing hash_id of object as key and link with which we validated the object as the value.
-    std::map<std::string, std::string>      mapped;
+    ///        Indexed by object number and grown on demand up to visited_limit, so look ups are O(1).
+    std::vector<visited_elem>                               visited;
+
+    /// @brief Visited PDF objects that do not fit in visited (large or illegal object numbers or a second generation)
+    std::unordered_map<object_id, ArlSymbol, object_id_hash>    visited_other;
+
+    /// @brief Object numbers below this are remembered in visited. The smaller of trailer /Size and a bound from
+    ///        the PDF file size, so a missing or bogus /Size or a huge object number cannot force a huge allocation.
+    int                                                     visited_limit;
+
+    /// @brief Keys that can be inherited from a dictionary (i.e. its keys and all its ancestors' keys via /Parent)
+    typedef std::unordered_set<std::string>                 inherited_keys;
+
+    /// @brief Resolved inheritable keys of each indirect intermediate node (e.g. Pages), so that inheritance
+    ///        look ups are O(1) and /Parent chains are walked (and cycles detected) once per node.
+    std::unordered_map<object_id, std::shared_ptr<const inherited_keys>, object_id_hash>  inheritance_cache;
+
+    /// @brief Links "_UniversalDictionary" and "_UniversalArray" which match anything
+    ArlSymbol                                               universal_dict_link;
+    ArlSymbol                                               universal_array_link;
+
+    /// @brief the Arlington PDF model (all TSV grammar files), shared across all CParsePDF instances
+    std::shared_ptr<const CArlingtonGrammar>    grammar;
+
+    /// @brief A node in the PDF DOM path. Queued objects share their ancestors' nodes via the parent
+    ///        pointer so that only the last path component is stored per object, rather than the
+    ///        full concatenated path string. Paths are only rendered when an object is dequeued.
+    struct path_node {
+        std::shared_ptr<path_node>  parent;     // nullptr for root objects
+        std::string                 suffix;     // this path component (e.g. "->Pages (as PageTreeNode)")
+        int                         indent;     // indent level for nested DOM display
 
-    /// @brief the Arlington PDF model (cache of loaded TSV grammar files)
-    std::map<std::string, std::unique_ptr<CArlingtonTSVGrammarFile>>  grammar_map;
+        path_node(const std::shared_ptr<path_node>& p, const std::string& s, const int i)
+            : parent(p), suffix(s), indent(i)
+            { /* constructor */ }
+
+        /// @brief Unlinks uniquely owned ancestors iteratively so very deep PDF DOMs cannot overflow the stack
+        ~path_node() {
+            while ((parent != nullptr) && (parent.use_count() == 1)) {
+                std::shared_ptr<path_node> p = std::move(parent->parent);
+                parent = std::move(p);
+            }
+        }
+    };
+
+    typedef std::shared_ptr<path_node> path_ptr;
+
+    /// @brief Set of PDF versions as a bitmask of indices into v_ArlPDFVersions (see version_lane)
+    typedef uint16_t ArlVersionSet;
 
     /// @brief Data structure for recursive processing of the ArlPDFObjects
-    /// @todo - lifetime management of recursive parent objects AND not blow out memory!
     struct queue_elem {
         ArlPDFObject* container;    // PDF container object (can be null for trailer)
         ArlPDFObject* object;       // PDF object (e.g. of a key)
-        std::string   link;         // Arlington TSV filename
-        std::string   context;      // PDF DOM path
+        ArlSymbol     link;         // Arlington TSV filename
+        path_ptr      path;         // PDF DOM path (nullptr for temporary elements)
+        std::string   context;      // rendered PDF DOM path. Empty while queued.
+        ArlVersionSet versions;     // lanes to validate against (--force all). Otherwise always 1.
+
+        queue_elem(ArlPDFObject* p, ArlPDFObject* o, const ArlSymbol l, const path_ptr& n, const ArlVersionSet v = 1)
+            : container(p), object(o), link(l), path(n), versions(v)
+            { /* constructor */ assert(object != nullptr); }
 
-        queue_elem(ArlPDFObject* p, ArlPDFObject* o, const std::string &l, const std::string &c)
-            : container(p), object(o), link(l), context(c)
-            { /* constructor */ assert(object != nullptr); assert(link.size() > 0); }
+        queue_elem(ArlPDFObject* p, ArlPDFObject* o, const ArlSymbol l, const std::string &c)
+            : container(p), object(o), link(l), context(c), versions(0)
+            { /* constructor */ assert(object != nullptr); }
     };
 
     /// @brief The list of PDF objects to process
-    std::queue<queue_elem>  to_process;
+    std::deque<queue_elem>  to_process;
+
+    /// @brief Objects queued while processing the current object when traversing depth-first.
+    ///        Moved to the front of to_process (in order) before the next object is processed.
+    std::vector<queue_elem> children;
+
+    /// @brief true for depth-first traversal of the PDF DOM, false for breadth-first
+    bool                    depth_first;
+
+    /// @brief Ceiling in bytes on the estimated memory of queued objects (0 = unlimited).
+    ///        Breadth-first traversal switches to depth-first when exceeded.
+    size_t                  memory_limit;
+
+    /// @brief Estimated memory in bytes of all currently queued objects
+    size_t                  queued_bytes;
 
     /// @brief The folder with an Arlington TSV file set
     fs::path                grammar_folder;
@@ -74,6 +153,12 @@ private:
     /// @brief Output stream to write results to. Already open
     std::ostream            &output;
 
+    /// @brief Machine-readable results sink or nullptr for text output
+    ArlResultSink*          sink;
+
+    /// @brief Profiling counters (--stats) or nullptr
+    ArlStats*               stats;
+
     /// @brief Terse output. Otherwise output can make "... | sort | uniq | ..." Linux CLI pipelines difficult
     ///        Details of specific PDF objects (such as object numbers) are not output.
     bool                    debug_mode;
@@ -91,36 +176,108 @@ private:
     /// @brief PDF version of file (multiplied by 10)
     int                     pdf_version;
 
+    /// @brief Arlington TSV files reduced for pdf_version and the extensions of the PDF file (see get_specialization())
+    std::unordered_map<const CArlingtonTSVGrammarFile*, const CArlTSVSpecialization*>  specializations;
+
     /// @brief Line counter of the PDF DOM for easier analysis and debugging
     unsigned int            counter;
 
+    /// @brief Links selected by scoring, keyed by Link set and shape of the PDF object (see make_link_memo_key())
+    std::unordered_map<std::string, ArlSymbol>  link_memo;
+
+    /// @brief Number of Link selections answered from link_memo (hits) or that had to be scored (misses)
+    unsigned int            link_memo_hits;
+    unsigned int            link_memo_misses;
+
+    /// @brief State of one PDF version when validating against all PDF versions in a single pass (--force all).
+    ///        Swapped with the members of the same name while the lane is active (see activate_lane()).
+    struct version_lane {
+        int                     pdf_version;        // PDF version (multiplied by 10)
+        std::string             pdf_version_str;    // PDF version for CPDFFile::pdf_version
+        unsigned int            counts[3];          // number of messages by severity (ArlSeverity)
+        std::vector<visited_elem>                               visited;
+        std::unordered_map<object_id, ArlSymbol, object_id_hash>    visited_other;
+        std::unordered_map<object_id, std::shared_ptr<const inherited_keys>, object_id_hash>  inheritance_cache;
+        std::unordered_map<const CArlingtonTSVGrammarFile*, const CArlTSVSpecialization*>  specializations;
+        std::unordered_map<std::string, ArlSymbol>  link_memo;
+
+        version_lane() : pdf_version(0), counts{ 0, 0, 0 }
+            { /* constructor */ }
+    };
+
+    /// @brief One lane per PDF version (v_ArlPDFVersions) for --force all. Empty when validating against a single PDF version.
+    std::vector<version_lane>   lanes;
+
+    /// @brief Index of the active lane or -1
+    int                     current_lane;
+
+    /// @brief Lanes of PDF objects queued by the PDF object being validated (bit of the active lane or 1)
+    ArlVersionSet           lane_bit;
+
+    void activate_lane(const int l);
+    void deactivate_lane();
+    void swap_lane(version_lane& lane);
+    template <class Q> void merge_lane_children(Q& q, const size_t first, const path_node* parent);
+
     void show_context(queue_elem& e);
+    std::ostream& report(queue_elem& e, const ArlSeverity sev, const ArlMessageCode code, const std::string& tsv, const std::string& key);
+    std::ostream& message(const ArlSeverity sev, const ArlMessageCode code, const std::string& tsv = "", const std::string& key = "", ArlPDFObject* obj = nullptr, const std::string& path = "");
+
+    ArlSymbol find_visited(const object_id& id);
+    void      set_visited(const object_id& id, const ArlSymbol link);
 
-    /// @brief Locates & reads in a single Arlington TSV grammar file.
-    const ArlTSVmatrix& get_grammar(const std::string& link);
+    /// @brief Locates a single Arlington TSV grammar file.
+    const CArlingtonTSVGrammarFile* get_grammar(const ArlSymbol link);
 
-    void parse_name_tree(ArlPDFDictionary* obj, const std::vector<std::string>& links, const std::string context, const bool root = true);
-    void parse_number_tree(ArlPDFDictionary* obj, const std::vector<std::string>& links, const std::string context, const bool root = true);
+    /// @brief Locates an Arlington TSV grammar file reduced for the PDF version and extensions being validated
+    const CArlTSVSpecialization& get_specialization(const CArlingtonTSVGrammarFile* tsv_file);
 
-    std::string recommended_link_for_object(ArlPDFObject* obj, const std::vector<std::string> links, const std::string obj_name);
+    void parse_tree(ArlPDFDictionary* root, const std::vector<ArlSymbol>& links, const path_ptr& path, const ArlTreeType t);
+    void parse_name_tree_node(ArlPDFDictionary* obj, const bool root, const bool has_kids, const std::vector<ArlSymbol>& links, const path_ptr& path, const std::string& context);
+    void parse_number_tree_node(ArlPDFDictionary* obj, const bool root, const bool has_kids, const std::vector<ArlSymbol>& links, const path_ptr& path, const std::string& context);
+    void parse_name_tree(ArlPDFDictionary* obj, const std::vector<ArlSymbol>& links, const path_ptr& path)
+        { parse_tree(obj, links, path, ArlTreeType::NameTree); };
+    void parse_number_tree(ArlPDFDictionary* obj, const std::vector<ArlSymbol>& links, const path_ptr& path)
+        { parse_tree(obj, links, path, ArlTreeType::NumberTree); };
+
+    ArlSymbol discriminate_link(ArlPDFObject* obj, const std::vector<ArlSymbol>& links, const ArlLinkDiscriminator* d);
+    bool make_link_memo_key(ArlPDFObject* obj, const ArlLinkDiscriminator* d, std::string& key);
+    static void append_link_memo_value(std::string& key, ArlPDFObject* val, const bool with_value);
+    ArlSymbol recommended_link_for_object(ArlPDFObject* obj, const std::vector<ArlSymbol>& links, const std::string& obj_name);
 
     bool check_numeric_array(ArlPDFArray* arr, const int elems_to_check);
-    void check_everything(ArlPDFObject* container, ArlPDFObject* obj, const int key_idx, const ArlTSVmatrix& tsv_data, const std::string& grammar_file, const std::string& context, std::ostream& ofs);
-    ArlPDFObject* find_via_inheritance(ArlPDFDictionary* obj, const std::wstring& key, const int depth = 0);
+    void check_everything(ArlPDFObject* container, ArlPDFObject* obj, const int key_idx, const CArlingtonTSVGrammarFile* tsv_file, const ArlSymbol link, const std::string& context);
+    std::shared_ptr<const inherited_keys> resolve_inherited_keys(ArlPDFDictionary* obj, const std::string& key);
+    bool has_inherited_key(ArlPDFDictionary* obj, const std::string& key);
+
+    /// @brief validates a dequeued object against the PDF version being validated
+    bool validate_object(queue_elem& elem);
 
     /// @brief add an object to be checked
-    void add_parse_object(ArlPDFObject* container, ArlPDFObject* object, const std::string& link, const std::string& context);
+    void add_parse_object(ArlPDFObject* container, ArlPDFObject* object, const ArlSymbol link, const path_ptr& parent, const std::string& suffix);
+
+    static std::string render_path(const path_ptr& path);
+    static size_t queued_size(const queue_elem& e);
 
 public:
-    CParsePDF(const fs::path& tsv_folder, std::ostream &ofs, const bool terser_output, const bool debug_output)
-        : grammar_folder(tsv_folder), output(ofs), terse(terser_output), pdfc(nullptr), counter(0), context_shown(false), debug_mode(debug_output), pdf_version(0)
-        { /* constructor */ }
+    CParsePDF(const fs::path& tsv_folder, std::ostream &ofs, const bool terser_output, const bool debug_output, const bool dfs = false, const size_t max_queue_bytes = 0, ArlResultSink* result_sink = nullptr, ArlStats* run_stats = nullptr)
+        : visited_limit(0), grammar(CArlingtonGrammar::get_shared_grammar(tsv_folder)), depth_first(dfs), memory_limit(max_queue_bytes), queued_bytes(0), grammar_folder(tsv_folder), output(ofs), sink(result_sink), stats(run_stats), debug_mode(debug_output), terse(terser_output), context_shown(false), pdfc(nullptr), pdf_version(0), counter(0), link_memo_hits(0), link_memo_misses(0), current_lane(-1), lane_bit(1)
+        { /* constructor */ universal_dict_link = grammar->get_symbol("_UniversalDictionary"); universal_array_link = grammar->get_symbol("_UniversalArray"); }
 
     /// @brief add an object to be checked
     void add_root_parse_object(ArlPDFObject* object, const std::string& link, const std::string& context);
 
     /// @brief begin analysing a PDF file from a "root" object (most likely the trailer)
     bool parse_object(CPDFFile& pdf);
+
+    /// @brief Selects a Link for each PDF object (nothing is validated). Used to time Link selection.
+    size_t select_links(CPDFFile& pdf, const std::vector<ArlPDFObject*>& objs, const std::vector<ArlSymbol>& links, const bool cold);
 };
 
+
+/// @brief Validates a single PDF file against the Arlington PDF model
+bool process_single_pdf(const fs::path& pdf_file_name, const fs::path& tsv_folder, ArlingtonPDFSDK& pdfsdk, std::ostream& ofs,
+                        const bool terse, const bool debug_mode, const std::string& forced_ver, std::vector<std::string>& extns,
+                        std::wstring& pwd, const bool dfs, const size_t max_memory, const ArlOutputFormat fmt, const bool show_stats = false);
+
 #endif // ParseObjects_h
@@ -64,7 +64,7 @@ void PredicateProcessor::EmptyPredicateAST() {
 bool PredicateProcessor::ValidateKeySyntax(const int key_idx) {
     // no predicates allowed
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_KEYNAME];
+    std::string tsv_field(tsv[key_idx][TSV_KEYNAME]);
 
     if (tsv_field.find("fn:") != std::string::npos)
         return false;
@@ -90,7 +90,7 @@ bool PredicateProcessor::ValidateKeySyntax(const int key_idx) {
 /// @returns true if the TSV data is valid. false otherwise.
 bool PredicateProcessor::ValidateTypeSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_TYPE];
+    std::string tsv_field(tsv[key_idx][TSV_TYPE]);
 
     std::vector<std::string> type_list = split(tsv_field, ';');
     if ((type_list.size() < 1) || (type_list[0].size() == 0))
@@ -110,11 +110,11 @@ bool PredicateProcessor::ValidateTypeSyntax(const int key_idx) {
             valid = !(((m[1] == "BeforeVersion") || (m[1] == "SinceVersion")) && (m[2] == "1.0"));
             if (!valid)
                 return false;
-            valid = FindInVector(v_ArlPDFVersions, m[2]);
+            valid = FindInVector(v_ArlPDFVersions, m[2].str());
             if (!valid)
                 return false;
             // m[3] = Arlington pre-defined type
-            valid = FindInVector(v_ArlAllTypes, m[3]);
+            valid = FindInVector(v_ArlAllTypes, m[3].str());
             if (!valid)
                 return false;
         }
@@ -136,7 +136,7 @@ bool PredicateProcessor::ValidateTypeSyntax(const int key_idx) {
 /// @returns true if the TSV data is valid, false otherwise
 bool PredicateProcessor::ValidateSinceVersionSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_SINCEVERSION];
+    std::string tsv_field(tsv[key_idx][TSV_SINCEVERSION]);
 
     if (tsv_field.size() == 3)
         return FindInVector(v_ArlPDFVersions, tsv_field);
@@ -168,7 +168,7 @@ bool PredicateProcessor::ValidateSinceVersionSyntax(const int key_idx) {
 /// @returns true if this row is valid for the specified by PDF version. false otherwise
 bool PredicateProcessor::IsValidForPDFVersion(ArlPDFObject* container, ArlPDFObject* obj, const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_SINCEVERSION];
+    std::string tsv_field(tsv[key_idx][TSV_SINCEVERSION]);
     pdfc->ClearPredicateStatus();
 
     // PDF version "x.y" --> convert to integer as x*10 + y
@@ -178,32 +178,21 @@ bool PredicateProcessor::IsValidForPDFVersion(ArlPDFObject* container, ArlPDFObj
         return (tsv_v <= pdf_v);
     }
     else {
-        ASTNode* ast = new ASTNode();
-        ASTNodeStack stack;
-
-        std::string whats_left = LRParsePredicate(tsv_field, ast);
-        assert(ast->valid());
-        EmptyPredicateAST();
-        stack.push_back(ast);
-        predicate_ast.push_back(stack);
-        assert(whats_left.size() == 0);
-
-        // Process the AST
-        assert(predicate_ast[0][0]->node.find("fn:") != std::string::npos);
-        assert(predicate_ast[0][0]->arg[0] != nullptr); 
-        auto eval = pdfc->ProcessPredicate(container, obj, predicate_ast[0][0], key_idx, tsv, 0, 0, false);
+        // Process the compiled predicate (always a single fn:... with arguments)
+        assert((tsv_file->get_predicate_ast(key_idx, TSV_SINCEVERSION).size() == 1) && (tsv_file->get_predicate_ast(key_idx, TSV_SINCEVERSION)[0].size() == 1));
+        assert(tsv_file->get_predicate_ast(key_idx, TSV_SINCEVERSION)[0][0]->node.find("fn:") != std::string::npos);
+        const ArlPredicateProgram& prog = get_predicate_program(key_idx, TSV_SINCEVERSION)[0][0];
+        ASTNode eval;
         bool retval = false;
-        if (eval != nullptr) {
-            if (eval->type == ASTNodeType::ASTNT_ConstNum) {
+        if (pdfc->ExecutePredicate(container, obj, prog, key_idx, tsv, false, eval)) {
+            if (eval.type == ASTNodeType::ASTNT_ConstNum) {
                 // output is a PDF version
-                int tsv_v = string_to_pdf_version(eval->node);
-                delete eval;
+                int tsv_v = string_to_pdf_version(eval.node);
                 retval = (pdf_v >= tsv_v);
             }
             else {
-                assert(eval->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-                retval = (eval->node == "true");
-                delete eval;
+                assert(eval.type == ASTNodeType::ASTNT_ConstPDFBoolean);
+                retval = (eval.node == "true");
             }
         }
         return retval;
@@ -219,7 +208,7 @@ bool PredicateProcessor::IsValidForPDFVersion(ArlPDFObject* container, ArlPDFObj
 /// @returns true if the field is valid, false otherwise
 bool PredicateProcessor::ValidateDeprecatedInSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_DEPRECATEDIN];
+    std::string tsv_field(tsv[key_idx][TSV_DEPRECATEDIN]);
 
     if (tsv_field == "")
         return true;
@@ -236,7 +225,7 @@ bool PredicateProcessor::ValidateDeprecatedInSyntax(const int key_idx) {
 /// @returns true if this row is deprecated. false otherwise
 bool PredicateProcessor::IsDeprecated(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_DEPRECATEDIN];
+    std::string tsv_field(tsv[key_idx][TSV_DEPRECATEDIN]);
 
     pdfc->ClearPredicateStatus();
 
@@ -264,7 +253,7 @@ bool PredicateProcessor::IsDeprecated(const int key_idx) {
 /// @returns true if the TSV data is valid, false otherwise
 bool PredicateProcessor::ValidateRequiredSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_REQUIRED];
+    std::string tsv_field(tsv[key_idx][TSV_REQUIRED]);
 
     if ((tsv_field == "TRUE") || (tsv_field == "FALSE")) {
         // Wildcards must have Required be FALSE
@@ -317,30 +306,24 @@ bool PredicateProcessor::IsRequired(ArlPDFObject* container, ArlPDFObject* obj,
     if (!is_valid)
         return false;
 
-    std::string tsv_field = tsv[key_idx][TSV_REQUIRED];
+    std::string tsv_field(tsv[key_idx][TSV_REQUIRED]);
     pdfc->ClearPredicateStatus();
-    EmptyPredicateAST();
 
     if (tsv_field == "TRUE")
         retval = true;
     else if ((tsv_field == "FALSE") || (type_idx < 0)) 
         retval = false;
     else {
-        ASTNode* ast = new ASTNode();
-        ASTNodeStack stack;
-
-        std::string whats_left = LRParsePredicate(tsv_field, ast);
-        stack.push_back(ast);
-        predicate_ast.push_back(stack);
-        assert(whats_left.size() == 0);
-
-        /// Process the AST using the PDF objects - expect reduction to a boolean true/false
-        ASTNode* pp = pdfc->ProcessPredicate(container, obj, predicate_ast[0][0], key_idx, tsv, type_idx, 0, false);
-        assert(pp != nullptr);
-        assert(pp->valid());
-        assert(pp->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-        retval = (pp->node == "true") ? true : false;
-        delete pp;
+        const ArlPredicateProgramMatrix& prog = get_predicate_program(key_idx, TSV_REQUIRED);
+        assert((prog.size() == 1) && (prog[0].size() == 1));
+
+        /// Process the compiled AST using the PDF objects - expect reduction to a boolean true/false
+        ASTNode pp;
+        bool ok = pdfc->ExecutePredicate(container, obj, prog[0][0], key_idx, tsv, false, pp);
+        assert(ok);
+        assert(pp.valid());
+        assert(pp.type == ASTNodeType::ASTNT_ConstPDFBoolean);
+        retval = ok && (pp.node == "true");
     }
     return retval;
 }
@@ -356,7 +339,7 @@ bool PredicateProcessor::IsRequired(ArlPDFObject* container, ArlPDFObject* obj,
 /// @returns true if the TSV data is valid, false otherwise
 bool PredicateProcessor::ValidateIndirectRefSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_INDIRECTREF];
+    std::string tsv_field(tsv[key_idx][TSV_INDIRECTREF]);
 
     if ((tsv_field == "TRUE") || (tsv_field == "FALSE") || (tsv_field == "fn:MustBeDirect()"))
         return true;
@@ -399,7 +382,7 @@ bool PredicateProcessor::ValidateIndirectRefSyntax(const int key_idx) {
 ReferenceType PredicateProcessor::ReduceIndirectRefRow(ArlPDFObject* container, ArlPDFObject* object, const int key_idx, const int type_index) {
     assert(type_index >= 0);
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_INDIRECTREF];
+    std::string tsv_field(tsv[key_idx][TSV_INDIRECTREF]);
     pdfc->ClearPredicateStatus();
 
     if (tsv_field == "TRUE") {
@@ -412,7 +395,7 @@ ReferenceType PredicateProcessor::ReduceIndirectRefRow(ArlPDFObject* container,
         return ReferenceType::MustBeDirect;
     }
     else { // a complex type [];[];[] and/or predicate expression
-        std::vector<std::string> ir_list = split(tsv_field, ';');
+        const std::vector<std::string>& ir_list = tsv_file->get_typed_data()[key_idx].indirect_ref;
         assert(type_index < (int)ir_list.size());
         std::string s = ir_list[type_index];
 
@@ -430,30 +413,12 @@ ReferenceType PredicateProcessor::ReduceIndirectRefRow(ArlPDFObject* container,
 #ifdef PP_DEBUG
         std::cout << std::endl << "IndirectRef::ReduceRow " << s << std::endl;
 #endif 
-        EmptyPredicateAST();
-        ASTNodeStack stack;
-        int loop = 0;
-        do {
-            ASTNode* n = new ASTNode();
-
-            s = LRParsePredicate(s, n);
-            stack.push_back(n);
-            loop++;
-            while ((s.size() > 0) && ((s[0] == ',') || (s[0] == ' '))) {
-                s = s.substr(1, s.size() - 1); // skip over COMMAs and SPACEs
-            }
-        } while ((s.size() > 0) && (loop < 100));
-        if (loop >= 100) {
-            assert(false && "Arlington complex type IndirectRef field too long and complex!");
-            return ReferenceType::DontCare;
-        }
-
-        predicate_ast.push_back(stack);
+        const ASTNodeStack& stack = tsv_file->get_predicate_ast(key_idx, TSV_INDIRECTREF)[type_index];
 
         // Only makes sense for 'IndirectRef' field if there is one expression and
         // this expression has an outer predicate AND results in a boolean!
         // Outer predicate must be either "fn:MustBeDirect(" or "fn:MustBeIndirect("
-        assert(predicate_ast.size() == 1); 
+        assert(stack.size() == 1); 
         assert(stack[0]->type == ASTNodeType::ASTNT_Predicate);
         assert((stack[0]->node == "fn:MustBeDirect(") || (stack[0]->node == "fn:MustBeIndirect("));
         assert(stack[0]->arg[1] == nullptr); // optional 1st argument only, never 2nd arg
@@ -462,13 +427,13 @@ ReferenceType PredicateProcessor::ReduceIndirectRefRow(ArlPDFObject* container,
         if (stack[0]->arg[0] == nullptr)
             return  (stack[0]->node == "fn:MustBeDirect(") ? ReferenceType::MustBeDirect : ReferenceType::MustBeIndirect;
 
-        // Was an argument - can still reduce to nullptr if keys not present, etc.
-        ASTNode* pp = pdfc->ProcessPredicate(container, object, stack[0], key_idx, tsv, type_index, 0, false);
-        if (pp != nullptr) {
-            assert(pp->valid() && (pp->type == ASTNodeType::ASTNT_ConstPDFBoolean));
+        // Was an argument - can still reduce to indeterminate if keys not present, etc.
+        const ArlPredicateProgram& prog = get_predicate_program(key_idx, TSV_INDIRECTREF)[type_index][0];
+        ASTNode pp;
+        if (pdfc->ExecutePredicate(container, object, prog, key_idx, tsv, false, pp)) {
+            assert(pp.valid() && (pp.type == ASTNodeType::ASTNT_ConstPDFBoolean));
             assert(pdfc->PredicateWasFullyProcessed());
-            bool b = (pp->node == "true"); // Cache answer so can delete pp
-            delete pp;
+            bool b = (pp.node == "true");
             if (stack[0]->node == "fn:MustBeIndirect(")
                 return (b ? ReferenceType::MustBeIndirect : ReferenceType::DontCare);
             else // fn:MustBeDirect
@@ -487,7 +452,7 @@ ReferenceType PredicateProcessor::ReduceIndirectRefRow(ArlPDFObject* container,
 /// @returns true if "TRUE" or "FALSE"
 bool PredicateProcessor::ValidateInheritableSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_INHERITABLE];
+    std::string tsv_field(tsv[key_idx][TSV_INHERITABLE]);
 
     return ((tsv_field == "TRUE") || (tsv_field == "FALSE"));
 }
@@ -499,7 +464,7 @@ bool PredicateProcessor::ValidateInheritableSyntax(const int key_idx) {
 /// @returns true if the row is inheritable, false otherwise
 bool PredicateProcessor::IsInheritable(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_INHERITABLE];
+    std::string tsv_field(tsv[key_idx][TSV_INHERITABLE]);
     pdfc->ClearPredicateStatus();
 
     return (tsv_field == "TRUE");
@@ -517,7 +482,7 @@ bool PredicateProcessor::IsInheritable(const int key_idx) {
 /// @returns true if syntax is valid. false otherwise
 bool PredicateProcessor::ValidateDefaultValueSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_DEFAULTVALUE];
+    std::string tsv_field(tsv[key_idx][TSV_DEFAULTVALUE]);
 
     if (tsv_field == "")
         return true;
@@ -567,11 +532,11 @@ bool PredicateProcessor::ValidateDefaultValueSyntax(const int key_idx) {
 /// @param[in]   key_idx   the index into TSV data for the key of interest
 /// @param[in]   type_idx  the index into TSV data for the Type field
 /// 
-/// @returns an ASTNode tree or nullptr if nothing or an error
-ASTNode* PredicateProcessor::GetDefaultValue(const int key_idx, const int type_idx) {
+/// @returns an ASTNode tree or nullptr if nothing or an error. DO NOT FREE!
+const ASTNode* PredicateProcessor::GetDefaultValue(const int key_idx, const int type_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
     assert(type_idx >= 0);
-    std::string tsv_field = tsv[key_idx][TSV_DEFAULTVALUE];
+    std::string tsv_field(tsv[key_idx][TSV_DEFAULTVALUE]);
 
     // Only when processing a PDF file, not when validating the grammar
     if (pdfc != nullptr)
@@ -580,45 +545,10 @@ ASTNode* PredicateProcessor::GetDefaultValue(const int key_idx, const int type_i
     if (tsv_field == "") 
         return nullptr;
 
-    std::string s;
-    ASTNodeStack stack;
-    EmptyPredicateAST();
-
-    std::vector<std::string> dv_list = split(tsv_field, ';');
-    if (tsv_field.find(";") != std::string::npos) {
-        // complex type [];[];[], so therefore everything has [ and ], which need to be removed
-        for (auto& dv : dv_list) {
-            assert(dv[0] == '[');
-            s = dv.substr(1, dv.size() - 2); 
-            dv = s;
-        }
-    }
-
-    for (auto& dv : dv_list) {
-        stack.clear();
-        int loop = 0;
-        // LRParsePredicate does not support PDF-arrays so ignore them
-        if (dv[0] != '[') {
-            do {
-                ASTNode* n = new ASTNode();
-                s = LRParsePredicate(dv, n);
-                stack.push_back(n);
-                loop++;
-                while ((s.size() > 0) && ((s[0] == ',') || (s[0] == ' '))) {
-                    s = s.substr(1, s.size() - 1); // skip over COMMAs and SPACEs
-                }
-            } while ((s.size() > 0) && (loop < 100));
-            if (loop >= 100) {
-                assert(false && "Arlington DefaultValue field too long and complex!");
-                return nullptr;
-            }
-        }
-        predicate_ast.push_back(stack);
-    } // for
-
-    // Parsed the DefaultValue, now work out which AST to return based in Type index (idx)
-    if ((type_idx < (int)predicate_ast.size()) && (!predicate_ast[type_idx].empty()))
-        return predicate_ast[type_idx][0];
+    // Work out which AST to return based in Type index (idx)
+    const ASTNodeMatrix& ast = tsv_file->get_predicate_ast(key_idx, TSV_DEFAULTVALUE);
+    if ((type_idx < (int)ast.size()) && (!ast[type_idx].empty()))
+        return ast[type_idx][0];
     else
         return nullptr;
 }
@@ -633,7 +563,7 @@ ASTNode* PredicateProcessor::GetDefaultValue(const int key_idx, const int type_i
 /// @returns true if syntax is valid. false otherwise
 bool PredicateProcessor::ValidatePossibleValuesSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_POSSIBLEVALUES];
+    std::string tsv_field(tsv[key_idx][TSV_POSSIBLEVALUES]);
 
     if (tsv_field == "")
         return true;
@@ -717,7 +647,7 @@ bool PredicateProcessor::ValidatePossibleValuesSyntax(const int key_idx) {
 /// @returns true if the PDF object matches something in the list and is thus a valid value.
 bool PredicateProcessor::IsValidValue(ArlPDFObject* object, const int key_idx, const std::string& pvalues) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_POSSIBLEVALUES];
+    std::string tsv_field(tsv[key_idx][TSV_POSSIBLEVALUES]);
     pdfc->ClearPredicateStatus();
 
     assert(pvalues.find("fn:") == std::string::npos);
@@ -836,7 +766,7 @@ bool PredicateProcessor::IsValidValue(ArlPDFObject* object, const int key_idx, c
 /// @returns   true if the TSV data is valid. false otherwise.
 bool PredicateProcessor::ValidateSpecialCaseSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_SPECIALCASE];
+    std::string tsv_field(tsv[key_idx][TSV_SPECIALCASE]);
 
     if (tsv_field == "")
         return true;
@@ -889,7 +819,7 @@ bool PredicateProcessor::ValidateSpecialCaseSyntax(const int key_idx) {
 /// @returns true if the TSV data is valid. false otherwise.
 bool PredicateProcessor::ValidateLinksSyntax(const int key_idx) {
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
-    std::string tsv_field = tsv[key_idx][TSV_LINK];
+    std::string tsv_field(tsv[key_idx][TSV_LINK]);
 
     // Nothing to do?
     if (tsv_field == "")
@@ -910,7 +840,7 @@ bool PredicateProcessor::ValidateLinksSyntax(const int key_idx) {
                     // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
                     // m[2] = extension name
                     // m[3] = Arlington link
-                    valid = FindInVector(v_ArlPDFVersions, m[1]);
+                    valid = FindInVector(v_ArlPDFVersions, m[1].str());
                     links.push_back(m[3]);     // m[2] = Arlington link
                     s = m.suffix();
                     if (s[0] == ',')
@@ -920,7 +850,7 @@ bool PredicateProcessor::ValidateLinksSyntax(const int key_idx) {
                     // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
                     // m[2] = extension name
                     // m[3] = Arlington link
-                    valid = FindInVector(v_ArlPDFVersions, m[1]);
+                    valid = FindInVector(v_ArlPDFVersions, m[1].str());
                     links.push_back(m[3]);     // m[2] = Arlington link
                     s = m.suffix();
                     if (s[0] == ',')
@@ -928,7 +858,7 @@ bool PredicateProcessor::ValidateLinksSyntax(const int key_idx) {
                 }
                 else if (std::regex_search(s, m, r_startsWithSinceVersion) && m.ready() && (m.size() == 3)) {
                     // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
-                    valid = FindInVector(v_ArlPDFVersions, m[1]);
+                    valid = FindInVector(v_ArlPDFVersions, m[1].str());
                     links.push_back(m[2]);     // m[2] = Arlington link
                     s = m.suffix();
                     if (s[0] == ',')
@@ -936,7 +866,7 @@ bool PredicateProcessor::ValidateLinksSyntax(const int key_idx) {
                 }
                 else if (std::regex_search(s, m, r_startsWithBeforeVersion) && m.ready() && (m.size() == 3)) {
                     // m[1] = PDF version "x.y" --> convert to integer as x*10 + y
-                    valid = FindInVector(v_ArlPDFVersions, m[1]);
+                    valid = FindInVector(v_ArlPDFVersions, m[1].str());
                     links.push_back(m[2]);     // m[2] = Arlington link
                     s = m.suffix();
                     if (s[0] == ',')
@@ -944,7 +874,7 @@ bool PredicateProcessor::ValidateLinksSyntax(const int key_idx) {
                 }
                 else if (std::regex_search(s, m, r_startsWithIsPDFVersion) && m.ready() && (m.size() == 3)) {
                     // m[2] = PDF version "x.y" --> convert to integer as x*10 + y
-                    valid = FindInVector(v_ArlPDFVersions, m[1]);
+                    valid = FindInVector(v_ArlPDFVersions, m[1].str());
                     links.push_back(m[2]);     // m[2] = Arlington link
                     s = m.suffix();
                     if (s[0] == ',')
@@ -952,7 +882,7 @@ bool PredicateProcessor::ValidateLinksSyntax(const int key_idx) {
                 }
                 else if (std::regex_search(s, m, r_startsWithDeprecated) && m.ready() && (m.size() == 3)) {
                     // m[2] = PDF version "x.y" --> convert to integer as x*10 + y
-                    valid = FindInVector(v_ArlPDFVersions, m[1]);
+                    valid = FindInVector(v_ArlPDFVersions, m[1].str());
                     links.push_back(m[2]);     // m[2] = Arlington link
                     s = m.suffix();
                     if (s[0] == ',')
@@ -1015,12 +945,13 @@ bool PredicateProcessor::ReducePVRow(ArlPDFObject* container, ArlPDFObject* obje
     assert(object != nullptr);
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
 
-    std::string tsv_field = tsv[key_idx][TSV_POSSIBLEVALUES];
+    std::string tsv_field(tsv[key_idx][TSV_POSSIBLEVALUES]);
     pdfc->ClearPredicateStatus();
 
     if ((tsv_field == "") || (tsv_field == "[]"))
         return true;
 
+    bool field_was_modified = false;
     if (explicit_values_only) {
         // Want to ignore wildcards in PossibleValue field so they get reported and users can see them in messages.
         // Wildcard will always be last in a list of names so COMMA will always preceed it: ",*]"
@@ -1030,6 +961,7 @@ bool PredicateProcessor::ReducePVRow(ArlPDFObject* container, ArlPDFObject* obje
         {
             // If found then erase just ",*" from the PossibleValue string, leaving the closing "]"
             tsv_field.erase(pos, 2);
+            field_was_modified = true;
         }
     }
 
@@ -1041,40 +973,39 @@ bool PredicateProcessor::ReducePVRow(ArlPDFObject* container, ArlPDFObject* obje
     if (pv_list[type_idx] == "[]")
         return true;
 
-    EmptyPredicateAST();
-    ASTNodeStack stack;
-
-    for (auto& pv : pv_list) {
-        stack.clear();
-        assert((pv[0] == '[') && (pv[pv.size() - 1] == ']'));
-        std::string s = pv.substr(1, pv.size() - 2); // strip off '[' and ']'
-        if (pv.find("fn:") != std::string::npos) {
-            int loop = 0;
-            do {
-                ASTNode* n = new ASTNode();
-                s = LRParsePredicate(s, n);
-                stack.push_back(n);
-                loop++;
-                while ((s.size() > 0) && ((s[0] == ',') || (s[0] == ' '))) {
-                    s = s.substr(1, s.size() - 1); // skip over COMMAs and SPACEs
-                }
-            } while ((s.size() > 0) && (loop < 100));
-            if (loop >= 100) {
+    const ASTNodeMatrix* pv_ast = &tsv_file->get_predicate_ast(key_idx, TSV_POSSIBLEVALUES);
+    const ArlPredicateProgramMatrix* pv_prog = &get_predicate_program(key_idx, TSV_POSSIBLEVALUES);
+    if (field_was_modified) {
+        // Pre-parsed predicates are for the unmodified field so parse and compile again
+        EmptyPredicateAST();
+        predicate_program.clear();
+        for (auto& pv : pv_list) {
+            predicate_ast.push_back(ASTNodeStack());
+            assert((pv[0] == '[') && (pv[pv.size() - 1] == ']'));
+            if ((pv.find("fn:") != std::string::npos) && !LRParsePredicateList(pv.substr(1, pv.size() - 2), predicate_ast.back())) {
                 assert(false && "Arlington complex type PossibleValues field too long and complex when reducing!");
                 return false;
             }
+            predicate_program.push_back(ArlPredicateProgramStack(predicate_ast.back().size()));
+            for (size_t i = 0; i < predicate_ast.back().size(); i++) {
+                tsv_file->compile_program(predicate_ast.back()[i], predicate_program.back()[i]);
+                if (tsv_spec != nullptr)
+                    SpecializePredicate(predicate_program.back()[i], tsv_spec->get_pdf_version(), tsv_spec->get_extensions());
+            }
         }
-        predicate_ast.push_back(stack);
+        pv_ast = &predicate_ast;
+        pv_prog = &predicate_program;
     }
 
     // There should now be a vector of ASTs or nullptr for each type of the TSV field
-    assert(predicate_ast.size() == pv_list.size());
-    assert(type_idx < (int)predicate_ast.size());
+    assert(pv_ast->size() == pv_list.size());
+    assert(type_idx < (int)pv_ast->size());
     assert(pv_list[type_idx][0] == '[');
 
     std::string s = pv_list[type_idx].substr(1, pv_list[type_idx].size() - 2); // strip off '[' and ']'
 
-    if ((predicate_ast[type_idx].size() == 0) || (predicate_ast[type_idx][0] == nullptr)) {
+    const ASTNodeStack& stack = (*pv_ast)[type_idx];
+    if ((stack.size() == 0) || (stack[0] == nullptr)) {
         // No predicates - but could be a set of COMMA-separated constants (e.g. names, integers, etc.)
         return IsValidValue(object, key_idx, s);
     }
@@ -1084,7 +1015,6 @@ bool PredicateProcessor::ReducePVRow(ArlPDFObject* container, ArlPDFObject* obje
 #ifdef PP_DEBUG
     std::cout << std::endl << "PossibleValues: " << s << std::endl;
 #endif 
-    stack = predicate_ast[type_idx];
     for (auto i = 0; i < (int)stack.size(); i++) {
         ASTNode* n = stack[i];
 
@@ -1103,15 +1033,14 @@ bool PredicateProcessor::ReducePVRow(ArlPDFObject* container, ArlPDFObject* obje
 
         case ASTNodeType::ASTNT_Predicate:
             {
-                ASTNode *pp = pdfc->ProcessPredicate(container, object, n, key_idx, tsv, type_idx, 0, false);
-                if (pp != nullptr) {
+                ASTNode pp;
+                if (pdfc->ExecutePredicate(container, object, (*pv_prog)[type_idx][i], key_idx, tsv, false, pp)) {
                     // Booleans can either be a valid value OR the result of an fn:Eval(...) calculation
-                    ASTNodeType pp_type = pp->type;
-                    bool vv = (pp->node == "true");
-                    if ((pp->type != ASTNodeType::ASTNT_ConstPDFBoolean) && (object->get_object_type() != PDFObjectType::ArlPDFObjTypeBoolean)) {
-                        vv = IsValidValue(object, key_idx, pp->node);
+                    ASTNodeType pp_type = pp.type;
+                    bool vv = (pp.node == "true");
+                    if ((pp.type != ASTNodeType::ASTNT_ConstPDFBoolean) && (object->get_object_type() != PDFObjectType::ArlPDFObjTypeBoolean)) {
+                        vv = IsValidValue(object, key_idx, pp.node);
                     }
-                    delete pp;
                     switch (pp_type) {
                         case ASTNodeType::ASTNT_ConstPDFBoolean:
                             return vv;
@@ -1123,7 +1052,7 @@ bool PredicateProcessor::ReducePVRow(ArlPDFObject* container, ArlPDFObject* obje
                                 return true;
                             break;
                         default:
-                            assert(false && "unexpected node type from ProcessPredicate!");
+                            assert(false && "unexpected node type from ExecutePredicate!");
                             return false;
                     } // switch
                 } // if 
@@ -1162,7 +1091,7 @@ bool PredicateProcessor::ReduceSCRow(ArlPDFObject* container, ArlPDFObject* obje
     assert((key_idx >= 0) && (key_idx < (int)tsv.size()));
     assert(type_idx >= 0);
 
-    std::string tsv_field = tsv[key_idx][TSV_SPECIALCASE];
+    std::string tsv_field(tsv[key_idx][TSV_SPECIALCASE]);
     pdfc->ClearPredicateStatus();
 
     if (tsv_field == "")
@@ -1180,58 +1109,32 @@ bool PredicateProcessor::ReduceSCRow(ArlPDFObject* container, ArlPDFObject* obje
     else if (sc_list[0] == "[]")
         return true;
 
-    EmptyPredicateAST();
-    ASTNodeStack stack;
-
-    for (auto& sc : sc_list) {
-        stack.clear();
-        assert((sc[0] == '[') && (sc[sc.size() - 1] == ']'));
-        std::string s = sc.substr(1, sc.size() - 2); // strip off '[' and ']'
-        if (sc.find("fn:") != std::string::npos) {
-            int loop = 0;
-            do {
-                ASTNode* n = new ASTNode();
-                s = LRParsePredicate(s, n);
-                stack.push_back(n);
-                loop++;
-                while ((s.size() > 0) && ((s[0] == ',') || (s[0] == ' '))) {
-                    s = s.substr(1, s.size() - 1); // skip over COMMAs and SPACEs
-                }
-            } while ((s.size() > 0) && (loop < 100));
-            if (loop >= 100) {
-                assert(false && "Arlington complex type SpecialCAse field too long and complex when reducing!");
-                return false;
-            }
-        }
-        predicate_ast.push_back(stack);
-    }
-
-    // There should now be a vector of ASTs or nullptr for each type of the TSV field,
-    assert(predicate_ast.size() == sc_list.size());
+    // There should be a vector of ASTs or nullptr for each type of the TSV field,
+    const ASTNodeMatrix& sc_ast = tsv_file->get_predicate_ast(key_idx, TSV_SPECIALCASE);
+    assert(sc_ast.size() == sc_list.size());
     assert(sc_list[type_idx][0] == '[');
 
     std::string s = sc_list[type_idx].substr(1, sc_list[type_idx].size() - 2); // strip off '[' and ']'
 
-    if ((predicate_ast[type_idx].size() == 0) || (predicate_ast[type_idx][0] == nullptr))
+    const ASTNodeStack& stack = sc_ast[type_idx];
+    if ((stack.size() == 0) || (stack[0] == nullptr))
         return true;
 
 #ifdef PP_DEBUG
     std::cout << "SpecialCase: " << s << std::endl;
 #endif 
-    stack = predicate_ast[type_idx];
     assert(stack.size() == 1);
     
     ASTNode* n = stack[0];
     if (n->type == ASTNodeType::ASTNT_Predicate) {
         bool valid = true;
-        ASTNode* pp = pdfc->ProcessPredicate(container, object, n, key_idx, tsv, type_idx, 0, true);
-        // SpecialCase can return nullptr only when versioning makes everything go away...
-        if (pp != nullptr) {
-            assert(pp->valid());
-            assert(pp->type == ASTNodeType::ASTNT_ConstPDFBoolean);
-            valid = (pp->node == "true");
+        ASTNode pp;
+        // SpecialCase can be indeterminate only when versioning makes everything go away...
+        if (pdfc->ExecutePredicate(container, object, get_predicate_program(key_idx, TSV_SPECIALCASE)[type_idx][0], key_idx, tsv, true, pp)) {
+            assert(pp.valid());
+            assert(pp.type == ASTNodeType::ASTNT_ConstPDFBoolean);
+            valid = (pp.node == "true");
         }
-        delete pp;
         return valid;
     }
     else {
@@ -24,6 +24,7 @@
 
 #include "ArlingtonTSVGrammarFile.h"
 #include "ArlingtonPDFShim.h"
+#include "ArlTSVSpecialization.h"
 #include "ArlVersion.h"
 #include "ASTNode.h"
 #include "PDFFile.h"
@@ -42,6 +43,13 @@ protected:
     /// @brief the PDF file class object
     CPDFFile*               pdfc;
 
+    /// @brief The Arlington TSV grammar file (which also owns the pre-parsed predicate ASTs)
+    const CArlingtonTSVGrammarFile* tsv_file;
+
+    /// @brief The Arlington TSV grammar file reduced for the PDF version and extensions being validated.
+    /// nullptr when not validating a PDF file (i.e. no PDF version).
+    const CArlTSVSpecialization*    tsv_spec;
+
     /// @brief Data from an Arlington TSV grammar file
     const ArlTSVmatrix&     tsv;
 
@@ -51,18 +59,27 @@ protected:
     /// - inner vector: supports predicates around each COMMA-separated values 
     ///   for each type (e.g. the A,B,C; nullptr and 'X','Y','Z' above)
     /// Note that PDF arrays also use '[' and ']'. PDF strings use '\''
-    /// This is a class data mainly for debugging purposes.
+    /// This is a class data mainly for debugging purposes. When processing PDF files the
+    /// pre-parsed predicates owned by the Arlington TSV grammar file are used instead.
     ASTNodeMatrix           predicate_ast;
 
+    /// @brief Compiled predicate_ast (same shape)
+    ArlPredicateProgramMatrix   predicate_program;
+
     /// @brief returns true if object contains a valid value in pvalues w.r.t. to the TSV data indexed by key_idx
     bool IsValidValue(ArlPDFObject* object, const int key_idx, const std::string& pvalues);
 
     /// @brief Recursively delete the AST and clear the predicate AST 
     void EmptyPredicateAST();
 
+    /// @brief Returns the compiled predicates for a field of a row (version-specialized if possible)
+    const ArlPredicateProgramMatrix& get_predicate_program(const int key_idx, const ArlingtonTSVColumns col) {
+        return (tsv_spec != nullptr) ? tsv_spec->get_predicate_program(key_idx, col) : tsv_file->get_predicate_program(key_idx, col);
+    };
+
 public:
-    PredicateProcessor(CPDFFile* pdfo, const ArlTSVmatrix &tsv_data) :
-        pdfc(pdfo), tsv(tsv_data)
+    PredicateProcessor(CPDFFile* pdfo, const CArlingtonTSVGrammarFile* grammar_file, const CArlTSVSpecialization* spec = nullptr) :
+        pdfc(pdfo), tsv_file(grammar_file), tsv_spec(spec), tsv(grammar_file->get_data())
         { /* constructor */ };
 
     ~PredicateProcessor() { EmptyPredicateAST(); };
@@ -90,7 +107,7 @@ public:
     bool IsInheritable(const int key_idx);
 
     bool ValidateDefaultValueSyntax(const int key_idx);
-    ASTNode* GetDefaultValue(const int key_idx, const int type_idx);
+    const ASTNode* GetDefaultValue(const int key_idx, const int type_idx);
 
     bool ValidatePossibleValuesSyntax(const int key_idx);
     bool ReducePVRow(ArlPDFObject* container, ArlPDFObject* object, const int key_idx, const int type_idx);
@@ -139,10 +139,10 @@ std::string ToUtf8(const std::wstring& wstr) {
 /// @param[in] s input string
 ///
 /// @returns   wide string equivalent  of the input string
-std::wstring ToWString(const std::string& s)
+std::wstring ToWString(const std::string_view s)
 {
     std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-    std::wstring wide = converter.from_bytes(s);
+    std::wstring wide = converter.from_bytes(s.data(), s.data() + s.size());
     return wide;
 }
 #if !defined(_MSC_VER)
@@ -240,11 +240,11 @@ bool is_file(const std::filesystem::path& p)
 ///       
 /// @param[in]  in      Arlington TSV Link or Type field that might contain predicates
 /// @returns            the Arlington "Links" field with all predicates removed
-std::string remove_type_link_predicates(const std::string& in) {
-    if (in == "")
+std::string remove_type_link_predicates(const std::string_view in) {
+    if (in.empty())
         return "";   // Common case for basic Arlington types
 
-    std::string     to_ret = in;
+    std::string     to_ret(in);
 
     // Specific order!
     to_ret = std::regex_replace(to_ret, r_sinceVersionExtension, "$3");
@@ -266,9 +266,9 @@ std::string remove_type_link_predicates(const std::string& in) {
 /// @param[in] separator  character to split
 /// 
 /// @returns a vector of strings.
-std::vector<std::string> split(const std::string& s, const char separator) {
+std::vector<std::string> split(const std::string_view s, const char separator) {
   std::vector<std::string> output;
-  std::string::size_type pos_prev = 0, pos_separator=0, pos_fn = 0, pos=0;
+  std::string_view::size_type pos_prev = 0, pos_separator=0, pos_fn = 0, pos=0;
 
   auto finish = false;
   while (!finish) {
@@ -288,17 +288,16 @@ std::vector<std::string> split(const std::string& s, const char separator) {
         else pos_fn++;
       }
       if (pos_fn == s.size())
-        pos = std::string::npos;
+        pos = std::string_view::npos;
       else
         pos = pos_fn;
     }
 
-    if (pos == std::string::npos) {
-      output.push_back(s.substr(pos_prev, pos - pos_prev)); // Last word
+    if (pos == std::string_view::npos) {
+      output.emplace_back(s.substr(pos_prev)); // Last word
       finish = true;
     } else {
-      std::string substring(s.substr(pos_prev, pos - pos_prev));
-      output.push_back(substring);
+      output.emplace_back(s.substr(pos_prev, pos - pos_prev));
       pos_prev = ++pos;
     }
   }
@@ -367,7 +366,7 @@ bool icontains(const std::string& s, const std::string& s1)
 /// @param[in] v      string to find
 ///
 /// @returns   true if 'v' is an exact to an element in 'list'. false otherwise.
-bool FindInVector(const std::vector<std::string> list, const std::string& v) {
+bool FindInVector(const std::vector<std::string>& list, const std::string_view v) {
     for (auto& li : list)
         if (v == li)
             return true;
@@ -590,7 +589,7 @@ int key_to_array_index(const std::string& key) {
 /// @param[in] vers   PDF version as a string. Should be precisely 3 chars.
 /// 
 /// @returns the PDF version x 10
-int string_to_pdf_version(const std::string& vers) {
+int string_to_pdf_version(const std::string_view vers) {
     assert(vers.size() == 3);
     assert(isdigit(vers[0]));
     assert(vers[1] == '.');
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <vector>
 
@@ -77,7 +78,7 @@ std::string  ToUtf8(const std::wstring& str);
 std::wstring utf8ToUtf16(const std::string& utf8Str);
 
 /// @brief Convert from string to a wide string
-std::wstring ToWString(const std::string& s);
+std::wstring ToWString(const std::string_view s);
 
 /// @brief Check if path is a folder
 bool is_folder(const std::filesystem::path& p);
@@ -86,10 +87,10 @@ bool is_folder(const std::filesystem::path& p);
 bool is_file(const std::filesystem::path& p);
 
 /// @brief Split Arlington-style strings into vector based on separator character
-std::vector<std::string> split(const std::string& s, const char separator);
+std::vector<std::string> split(const std::string_view s, const char separator);
 
 /// @brief Arlington brute-force predicate removal for Type and Link fields
-std::string remove_type_link_predicates(const std::string& in);
+std::string remove_type_link_predicates(const std::string_view in);
 
 /// @brief Strip leading whitespace 
 std::string strip_leading_whitespace(const std::string& str);
@@ -101,7 +102,7 @@ bool iequals(const std::string& a, const std::string& b);
 bool icontains(const std::string& s, const std::string& s1);
 
 /// @brief Finds a string in a vector of strings
-bool FindInVector(const std::vector<std::string> list, const std::string& v);
+bool FindInVector(const std::vector<std::string>& list, const std::string_view v);
 
 /// @brief Check if Arlington data represents an array
 bool check_valid_array_definition(const std::string& fname, const std::vector<std::string>& keys, std::ostream& ofs, bool* wildcard_only);
@@ -119,7 +120,7 @@ bool is_valid_pdf_date_string(const std::wstring& wdate);
 int key_to_array_index(const std::string& key);
 
 /// @brief converts a PDF version string to the integer equivalent x 10
-int string_to_pdf_version(const std::string& vers);
+int string_to_pdf_version(const std::string_view vers);
 
 /// @brief Generic whitespace trimming of left side of strings (NOT for use with TSV data!)
 std::string leftTrim(const std::string& s);
@@ -0,0 +1,320 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Differential test of the hand-written predicate lexer/parser against
+///        the original regex-based parser over every predicate in an Arlington
+///        TSV file set.
+///
+/// Usage: LRParsePredicateTest <tsv-folder>
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlPredicates.h"
+#include "ASTNode.h"
+#include "LRParsePredicate.h"
+#include "utils.h"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/// @brief Globals normally defined in Main.cpp
+bool no_color = true;
+bool explicit_values_only = false;
+
+
+/// @brief The original 'starts with' regexes used to tokenize predicates
+static const std::regex   r_StartsWithPredicate("^fn:[a-zA-Z14]+\\(");
+static const std::regex   r_StartsWithKeyValue("^" + ArlKeyValue);
+static const std::regex   r_StartsWithKey("^" + ArlKey);
+static const std::regex   r_StartsWithMathComp("^" + ArlMathComp);
+static const std::regex   r_StartsWithMathOp("^" + ArlMathOp);
+static const std::regex   r_StartsWithLogicOp("^" + ArlLogicalOp);
+static const std::regex   r_StartsWithBool("^" + ArlBooleans);
+static const std::regex   r_StartsWithNum("^" + ArlNum);
+static const std::regex   r_StartsWithInt("^" + ArlInt);
+static const std::regex   r_StartsWithString("^" + ArlString);
+static const std::regex   r_StartswithType("^" + ArlPredfinedType);
+
+
+/// @brief Each lexer function and the regex it replaces
+struct lexer_case {
+    const char*         name;
+    size_t              (*lex)(std::string_view);
+    const std::regex*   regex;
+};
+
+static const lexer_case lexer_cases[] = {
+    { "Predicate",  ArlLexPredicate,  &r_StartsWithPredicate },
+    { "Boolean",    ArlLexBoolean,    &r_StartsWithBool },
+    { "String",     ArlLexString,     &r_StartsWithString },
+    { "Type",       ArlLexType,       &r_StartswithType },
+    { "KeyValue",   ArlLexKeyValue,   &r_StartsWithKeyValue },
+    { "Number",     ArlLexNumber,     &r_StartsWithNum },
+    { "Integer",    ArlLexInteger,    &r_StartsWithInt },
+    { "Key",        ArlLexKey,        &r_StartsWithKey },
+    { "MathComp",   ArlLexMathComp,   &r_StartsWithMathComp },
+    { "MathOp",     ArlLexMathOp,     &r_StartsWithMathOp },
+    { "LogicalOp",  ArlLexLogicalOp,  &r_StartsWithLogicOp },
+};
+
+
+static std::string RegexParsePredicate(std::string s, ASTNode* root);
+
+/// @brief Reference implementation: the original regex-based LRParseExpression()
+static std::string RegexParseExpression(std::string s, ASTNode* root) {
+    ASTNodeStack    stack;
+    int             nested_expressions = 0;
+    std::smatch     m, m1;
+    ASTNodeType     m_type;
+    int             loop = 100;
+
+    if (s.empty())
+        return s;
+
+    stack.push_back(root);
+    do {
+        m_type = ASTNodeType::ASTNT_Unknown;
+        while (s[0] == '(') {
+            s = s.substr(1, s.size() - 1);
+            nested_expressions++;
+            ASTNode* nested_node = new ASTNode(stack.back());
+            stack.back()->arg[0] = nested_node;
+            stack.push_back(nested_node);
+        }
+
+        if (std::regex_search(s, m, r_StartsWithPredicate)) {
+            ASTNode* p = stack.back();
+            p->node = m[0];
+            p->type = ASTNodeType::ASTNT_Predicate;
+            s = m.suffix().str();
+            if (s[0] != ')') {
+                p->arg[0] = new ASTNode(p);
+                s = RegexParsePredicate(s, p->arg[0]);
+                if (s[0] == ',') {
+                    s = s.substr(1, s.size() - 1);
+                    p->arg[1] = new ASTNode(p);
+                    s = RegexParsePredicate(s, p->arg[1]);
+                }
+                else if (s[0] != ')') {
+                    s = RegexParseExpression(s, p->arg[0]);
+                }
+            }
+            s = s.substr(1, s.size() - 1);
+        }
+        else if ((m_type = ASTNodeType::ASTNT_ConstPDFBoolean, std::regex_search(s, m, r_StartsWithBool)) ||
+            (m_type = ASTNodeType::ASTNT_ConstString,          std::regex_search(s, m, r_StartsWithString)) ||
+            (m_type = ASTNodeType::ASTNT_Type,                 std::regex_search(s, m, r_StartswithType)) ||
+            (m_type = ASTNodeType::ASTNT_KeyValue,             std::regex_search(s, m, r_StartsWithKeyValue)) ||
+            (m_type = ASTNodeType::ASTNT_ConstNum,             std::regex_search(s, m, r_StartsWithNum)) ||
+            (m_type = ASTNodeType::ASTNT_ConstInt,             std::regex_search(s, m, r_StartsWithInt)) ||
+            (m_type = ASTNodeType::ASTNT_Key,                  std::regex_search(s, m, r_StartsWithKey))) {
+            ASTNode* p = stack.back();
+            p->node = m[0];
+            p->type = m_type;
+            if ((m_type == ASTNodeType::ASTNT_ConstString) && (p->node.at(0) == '\'') && (p->node.back() == '\''))
+                p->node = p->node.substr(1, p->node.length() - 2);
+            s = m.suffix().str();
+        }
+
+        while ((nested_expressions > 0) && (s[0] == ')')) {
+            s = s.substr(1, s.size() - 1);
+            nested_expressions--;
+            stack.pop_back();
+        }
+
+        if ((m_type = ASTNodeType::ASTNT_MathComp,  std::regex_search(s, m1, r_StartsWithMathComp)) ||
+            (m_type = ASTNodeType::ASTNT_MathOp,    std::regex_search(s, m1, r_StartsWithMathOp)) ||
+            (m_type = ASTNodeType::ASTNT_LogicalOp, std::regex_search(s, m1, r_StartsWithLogicOp))) {
+            std::string op  = m1[0];
+            s = m1.suffix().str();
+            ASTNode*    p   = stack.back();
+            ASTNode*    rhs;
+            if (p->node.empty()) {
+                p->node = op;
+                p->type = m_type;
+                rhs = new ASTNode(p);
+                p->arg[1] = rhs;
+            }
+            else {
+                ASTNode* lhs = new ASTNode(p);
+                rhs = new ASTNode(p);
+                *lhs = *p;
+                p->node   = op;
+                p->type = m_type;
+                p->arg[0] = lhs;
+                p->arg[1] = rhs;
+            }
+            s = RegexParsePredicate(s, rhs);
+        }
+
+        while ((nested_expressions > 0) && (s[0] == ')')) {
+            s = s.substr(1, s.size() - 1);
+            nested_expressions--;
+            stack.pop_back();
+        }
+        --loop;
+    }
+    while ((loop > 0) && ((nested_expressions > 0) || ((s.size() >0) && (s[0] != ',') && (s[0] != ')'))));
+    return s;
+}
+
+
+/// @brief Reference implementation: the original regex-based LRParsePredicate()
+static std::string RegexParsePredicate(std::string s, ASTNode* root) {
+    std::smatch     m;
+
+    if (s.size() == 0)
+        return s;
+
+    if (std::regex_search(s, m, r_StartsWithPredicate)) {
+        root->node = m[0];
+        root->type = ASTNodeType::ASTNT_Predicate;
+        s = m.suffix().str();
+        if (s[0] != ')') {
+            root->arg[0] = new ASTNode(root);
+            s = RegexParsePredicate(s, root->arg[0]);
+            if (s[0] == ',') {
+                s = s.substr(1, s.size() - 1);
+                root->arg[1] = new ASTNode(root);
+                s = RegexParsePredicate(s, root->arg[1]);
+            }
+            else if (s[0] != ')') {
+                s = RegexParseExpression(s, root->arg[0]);
+            }
+        }
+        s = s.substr(1, s.size() - 1);
+    }
+    else {
+        s = RegexParseExpression(s, root);
+        if (root->node.empty()) {
+            ASTNode  *tmp = root->arg[0];
+            *root = *tmp;
+            tmp->arg[0] = nullptr;
+            tmp->arg[1] = nullptr;
+            delete tmp;
+        }
+    }
+    return s;
+}
+
+
+/// @brief Parses a COMMA-separated list with a parser, returning a printable form of all ASTs
+/// and the remaining unparsed text.
+static std::string parse_list(std::string s, std::string (*parser)(std::string, ASTNode*)) {
+    std::ostringstream  out;
+    int                 loop = 0;
+    do {
+        ASTNode* n = new ASTNode();
+        s = parser(s, n);
+        out << *n << " | ";
+        delete n;
+        loop++;
+        while ((s.size() > 0) && ((s[0] == ',') || (s[0] == ' ')))
+            s = s.substr(1, s.size() - 1);
+    } while ((s.size() > 0) && (loop < 100));
+    out << "remaining='" << s << "'";
+    return out.str();
+}
+
+
+/// @brief Compares every lexer function against its regex at every position of a field
+///
+/// @returns number of mismatches
+static int check_lexers(const std::string& where, const std::string& field) {
+    int errors = 0;
+    for (size_t i = 0; i < field.size(); i++) {
+        std::string suffix = field.substr(i);
+        for (auto& lc : lexer_cases) {
+            std::smatch m;
+            size_t expected = std::regex_search(suffix, m, *lc.regex) ? (size_t)m.length(0) : 0;
+            size_t actual = lc.lex(suffix);
+            if (expected != actual) {
+                std::cout << "LEXER MISMATCH " << where << " " << lc.name << " on '" << suffix << "': regex=" << expected << ", lexer=" << actual << std::endl;
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <tsv-folder>" << std::endl;
+        return 2;
+    }
+
+    const fs::path  tsv_folder(argv[1]);
+    int             errors = 0;
+    int             num_fields = 0;
+    int             num_predicates = 0;
+
+    for (const auto& entry : fs::directory_iterator(tsv_folder)) {
+        if (entry.path().extension() != ".tsv")
+            continue;
+
+        std::ifstream   file(entry.path());
+        std::string     line;
+        bool            header = true;
+        while (std::getline(file, line)) {
+            if (header) {
+                header = false;
+                continue;
+            }
+            std::vector<std::string> row;
+            std::stringstream ss(line);
+            std::string col;
+            while (std::getline(ss, col, '\t'))
+                row.push_back(col);
+
+            // Type (1) .. Link (10) are the fields that can contain predicates
+            for (size_t c = 1; (c < row.size()) && (c <= 10); c++) {
+                const std::string where = entry.path().stem().string() + "/" + row[0] + "[" + std::to_string(c) + "]";
+                num_fields++;
+                errors += check_lexers(where, row[c]);
+
+                // Compare full ASTs of each predicate in the field (as in [a,b];[c];[d])
+                for (auto& v : split(row[c], ';')) {
+                    if (v.find("fn:") == std::string::npos)
+                        continue;
+                    std::string s = v;
+                    if ((s[0] == '[') && (s.back() == ']'))
+                        s = s.substr(1, s.size() - 2);
+                    num_predicates++;
+                    std::string expected = parse_list(s, RegexParsePredicate);
+                    std::string actual = parse_list(s, LRParsePredicate);
+                    if (expected != actual) {
+                        std::cout << "AST MISMATCH " << where << " on '" << s << "'" << std::endl;
+                        std::cout << "\tregex:  " << expected << std::endl;
+                        std::cout << "\tlexer:  " << actual << std::endl;
+                        errors++;
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << num_fields << " fields, " << num_predicates << " predicates checked in " << tsv_folder << ": " << errors << " mismatches" << std::endl;
+    return ((errors == 0) && (num_predicates > 0)) ? 0 : 1;
+}
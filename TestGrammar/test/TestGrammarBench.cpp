@@ -0,0 +1,747 @@
+///////////////////////////////////////////////////////////////////////////////
+/// @file
+/// @brief Micro- and macro-benchmarks of TestGrammar. Results are written as
+///        JSON Lines (one JSON object per benchmark) so that they can be
+///        tracked across commits.
+///
+/// Usage: TestGrammarBench --tsvdir <dir> [--out <file.jsonl>] [--label <text>]
+///                         [--filter <substr>] [--repeat <n>] [--quick]
+///
+/// @copyright
+/// Copyright 2022 PDF Association, Inc. https://www.pdfa.org
+/// SPDX-License-Identifier: Apache-2.0
+///
+/// @remark
+/// This material is based upon work supported by the Defense Advanced
+/// Research Projects Agency (DARPA) under Contract No. HR001119C0079.
+/// Any opinions, findings and conclusions or recommendations expressed
+/// in this material are those of the author(s) and do not necessarily
+/// reflect the views of the Defense Advanced Research Projects Agency
+/// (DARPA). Approved for public release.
+///
+/// @author Peter Wyatt, PDF Association
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ArlingtonPDFShim.h"
+#include "ArlingtonTSVGrammarFile.h"
+#include "ArlTSVSpecialization.h"
+#include "ArlVersion.h"
+#include "ASTNode.h"
+#include "LRParsePredicate.h"
+#include "ParseObjects.h"
+#include "PDFFile.h"
+#include "TestGrammarVers.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ArlingtonPDFShim;
+namespace fs = std::filesystem;
+
+/// @brief Globals normally defined in Main.cpp
+std::ostream  cnull(0);
+std::wostream wcnull(0);
+bool no_color = true;
+bool explicit_values_only = false;
+
+
+/// @brief Writes a minimal, valid PDF file from a list of numbered objects
+class CSyntheticPDF {
+private:
+    /// @brief Body of each object, indexed by object number - 1
+    std::vector<std::string>    objs;
+
+public:
+    /// @brief Reserves the next object number (so it can be referenced before it is defined)
+    int reserve() { objs.push_back(""); return (int)objs.size(); };
+
+    /// @brief Adds an object and returns its object number
+    int add(const std::string& body) { objs.push_back(body); return (int)objs.size(); };
+
+    /// @brief Sets the body of a reserved object
+    void set(const int num, const std::string& body) { objs[num - 1] = body; };
+
+    /// @brief Adds a stream object and returns its object number
+    int add_stream(const std::string& dict, const std::string& data) {
+        return add("<< " + dict + " /Length " + std::to_string(data.size()) + " >>\nstream\n" + data + "\nendstream");
+    }
+
+    /// @brief Writes the PDF with a traditional cross-reference table. Object 1 is the Document Catalog.
+    bool write(const fs::path& fname) const {
+        std::ofstream           ofs(fname, std::ios::binary | std::ios::trunc);
+        std::ostringstream      pdf;
+        std::vector<size_t>     offsets;
+
+        pdf << "%PDF-1.7\n%\xE2\xE3\xCF\xD3\n";
+        for (size_t i = 0; i < objs.size(); i++) {
+            offsets.push_back((size_t)pdf.tellp());
+            pdf << (i + 1) << " 0 obj\n" << objs[i] << "\nendobj\n";
+        }
+        size_t xref = (size_t)pdf.tellp();
+        pdf << "xref\n0 " << (objs.size() + 1) << "\n0000000000 65535 f \n";
+        for (auto o : offsets)
+            pdf << std::setw(10) << std::setfill('0') << o << " 00000 n \n";
+        pdf << "trailer\n<< /Size " << (objs.size() + 1) << " /Root 1 0 R >>\nstartxref\n" << xref << "\n%%EOF\n";
+        ofs << pdf.str();
+        return ofs.good();
+    }
+};
+
+
+static std::string ref(const int num) {
+    return std::to_string(num) + " 0 R";
+}
+
+
+/// @brief A page tree node or page of a synthetic PDF
+struct synthetic_node {
+    std::vector<int>    kids;       // object numbers of child nodes (empty for a page)
+    int                 parent;     // object number of parent or 0 for the root
+    int                 count;      // number of pages in this subtree
+    std::string         extra;      // other keys
+};
+
+
+/// @brief Adds a page tree to a synthetic PDF. Inheritable keys are only in the root node.
+///
+/// @param[in,out] pdf        the synthetic PDF
+/// @param[in]     nodes      page tree nodes and pages (object number to node)
+/// @param[in]     root       object number of the root node
+/// @param[in]     font       object number of a font used by all pages
+static void add_page_tree(CSyntheticPDF& pdf, std::map<int, synthetic_node>& nodes, const int root, const int font) {
+    nodes[root].extra = "/MediaBox [0 0 612 792] /Rotate 0 /Resources << /Font << /F1 " + ref(font) + " >> /ProcSet [/PDF /Text] >>";
+
+    // Count pages of each subtree (post-order, iteratively as the tree can be deep)
+    std::vector<std::pair<int, bool>> stack = { { root, false } };
+    while (!stack.empty()) {
+        auto [num, kids_done] = stack.back();
+        stack.pop_back();
+        synthetic_node& n = nodes[num];
+        if (kids_done || n.kids.empty()) {
+            n.count = n.kids.empty() ? 1 : 0;
+            for (auto k : n.kids)
+                n.count += nodes[k].count;
+        }
+        else {
+            stack.push_back({ num, true });
+            for (auto k : n.kids)
+                stack.push_back({ k, false });
+        }
+    }
+
+    for (auto& [num, n] : nodes) {
+        std::string s = "<< /Type /" + std::string(n.kids.empty() ? "Page" : "Pages");
+        if (n.parent > 0)
+            s += " /Parent " + ref(n.parent);
+        if (!n.kids.empty()) {
+            s += " /Count " + std::to_string(n.count) + " /Kids [";
+            for (auto k : n.kids)
+                s += " " + ref(k);
+            s += " ]";
+        }
+        if (!n.extra.empty())
+            s += " " + n.extra;
+        pdf.set(num, s + " >>");
+    }
+}
+
+
+/// @brief Common objects: 1 = Catalog (reserved), 2 = Pages root (reserved), 3 = font, 4 = page content
+static void add_common_objects(CSyntheticPDF& pdf) {
+    pdf.reserve();
+    pdf.reserve();
+    pdf.add("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>");
+    pdf.add_stream("", "BT /F1 24 Tf 72 712 Td (Arlington PDF Model) Tj ET");
+}
+
+
+/// @brief Adds a variety of annotations (for Link selection) and returns the Annots array
+static std::string add_annotations(CSyntheticPDF& pdf, const int page) {
+    static const char* annots[] = {
+        "/Subtype /Link /Rect [72 700 300 730] /Border [0 0 0] /Dest [PAGE /Fit]",
+        "/Subtype /Text /Rect [320 700 340 720] /Contents (A note) /Name /Comment /Open false",
+        "/Subtype /Square /Rect [72 600 200 680] /C [1 0 0] /IC [0 0 1] /Contents (A square)",
+        "/Subtype /Circle /Rect [220 600 340 680] /C [0 1 0]",
+        "/Subtype /Highlight /Rect [72 700 300 730] /QuadPoints [72 730 300 730 72 700 300 700] /C [1 1 0]",
+        "/Subtype /FreeText /Rect [72 500 300 560] /Contents (Free text) /DA (/F1 12 Tf 0 g) /Q 0",
+        "/Subtype /Line /Rect [72 400 300 480] /L [72 400 300 480] /LE [/None /OpenArrow]",
+        "/Subtype /Ink /Rect [320 400 500 480] /InkList [[320 400 400 480 500 400]]",
+        "/Subtype /Stamp /Rect [72 300 200 380] /Name /Approved",
+    };
+
+    std::string arr = "[";
+    for (auto a : annots) {
+        std::string s = a;
+        auto p = s.find("PAGE");
+        if (p != std::string::npos)
+            s.replace(p, 4, ref(page));
+        arr += " " + ref(pdf.add("<< /Type /Annot " + s + " /P " + ref(page) + " /F 4 >>"));
+    }
+    return arr + " ]";
+}
+
+
+/// @brief Synthetic PDF with many pages in a balanced page tree (fanout 16)
+static void make_pages_pdf(const fs::path& fname, const int num_pages) {
+    CSyntheticPDF               pdf;
+    std::map<int, synthetic_node> nodes;
+    const int                   fanout = 16;
+
+    add_common_objects(pdf);
+
+    std::vector<int> layer;
+    for (int i = 0; i < num_pages; i++) {
+        int p = pdf.reserve();
+        nodes[p] = { {}, 0, 0, "/Contents 4 0 R" };
+        layer.push_back(p);
+    }
+    nodes[layer[0]].extra += " /Annots " + add_annotations(pdf, layer[0]);
+
+    // Build intermediate nodes until a single layer fits under the root (object 2)
+    while ((int)layer.size() > fanout) {
+        std::vector<int> up;
+        for (size_t i = 0; i < layer.size(); i += fanout) {
+            int n = pdf.reserve();
+            nodes[n] = { {}, 0, 0, "" };
+            for (size_t k = i; (k < i + fanout) && (k < layer.size()); k++) {
+                nodes[n].kids.push_back(layer[k]);
+                nodes[layer[k]].parent = n;
+            }
+            up.push_back(n);
+        }
+        layer = up;
+    }
+    nodes[2] = { layer, 0, 0, "" };
+    for (auto k : layer)
+        nodes[k].parent = 2;
+
+    add_page_tree(pdf, nodes, 2, 3);
+    pdf.set(1, "<< /Type /Catalog /Pages 2 0 R >>");
+    pdf.write(fname);
+}
+
+
+/// @brief Synthetic PDF with a deep page tree (each level has one page) so that
+/// all pages inherit MediaBox, Resources and Rotate from the root node
+static void make_inheritance_pdf(const fs::path& fname, const int depth) {
+    CSyntheticPDF               pdf;
+    std::map<int, synthetic_node> nodes;
+
+    add_common_objects(pdf);
+
+    int node = 2;
+    nodes[node] = { {}, 0, 0, "" };
+    for (int d = 0; d < depth; d++) {
+        int p = pdf.reserve();
+        nodes[p] = { {}, node, 0, "/Contents 4 0 R" };
+        nodes[node].kids.push_back(p);
+        if (d < depth - 1) {
+            int n = pdf.reserve();
+            nodes[n] = { {}, node, 0, "" };
+            nodes[node].kids.push_back(n);
+            node = n;
+        }
+    }
+
+    add_page_tree(pdf, nodes, 2, 3);
+    pdf.set(1, "<< /Type /Catalog /Pages 2 0 R >>");
+    pdf.write(fname);
+}
+
+
+/// @brief Synthetic PDF with a single page and a large Dests name tree (fanout 32)
+static void make_name_tree_pdf(const fs::path& fname, const int num_names) {
+    CSyntheticPDF               pdf;
+    std::map<int, synthetic_node> nodes;
+    const int                   fanout = 32;
+
+    add_common_objects(pdf);
+
+    int page = pdf.reserve();
+    nodes[2] = { { page }, 0, 0, "" };
+    nodes[page] = { {}, 2, 0, "/Contents 4 0 R" };
+    add_page_tree(pdf, nodes, 2, 3);
+
+    auto name = [](const int i) {
+        std::ostringstream s;
+        s << "Dest" << std::setw(7) << std::setfill('0') << i;
+        return s.str();
+    };
+
+    // Leaf nodes with sorted keys, then intermediate nodes, each with Limits
+    struct limits { int obj; int lo; int hi; };
+    std::vector<limits> layer;
+    for (int i = 0; i < num_names; i += fanout) {
+        int hi = std::min(i + fanout, num_names) - 1;
+        std::string s = "<< /Limits [(" + name(i) + ") (" + name(hi) + ")] /Names [";
+        for (int k = i; k <= hi; k++)
+            s += " (" + name(k) + ") [" + ref(page) + " /XYZ 0 " + std::to_string(792 - (k % 700)) + " null]";
+        layer.push_back({ pdf.add(s + " ] >>"), i, hi });
+    }
+    while (layer.size() > (size_t)fanout) {
+        std::vector<limits> up;
+        for (size_t i = 0; i < layer.size(); i += fanout) {
+            size_t last = std::min(i + fanout, layer.size()) - 1;
+            std::string s = "<< /Limits [(" + name(layer[i].lo) + ") (" + name(layer[last].hi) + ")] /Kids [";
+            for (size_t k = i; k <= last; k++)
+                s += " " + ref(layer[k].obj);
+            up.push_back({ pdf.add(s + " ] >>"), layer[i].lo, layer[last].hi });
+        }
+        layer = up;
+    }
+    std::string root = "<< /Kids [";
+    for (auto& l : layer)
+        root += " " + ref(l.obj);
+    int dests = pdf.add(root + " ] >>");
+
+    pdf.set(1, "<< /Type /Catalog /Pages 2 0 R /Names << /Dests " + ref(dests) + " >> /PageMode /UseOutlines >>");
+    pdf.write(fname);
+}
+
+
+/// @brief Timing results of a single benchmark
+struct bench_result {
+    std::string             name;       // benchmark name
+    int                     param;      // scale of the benchmark (e.g. number of pages) or 0
+    size_t                  ops;        // operations per iteration (e.g. predicates parsed)
+    std::vector<double>     ns;         // wall clock nanoseconds of each iteration
+};
+
+
+/// @brief Runs and reports benchmarks
+class CBenchRunner {
+private:
+    std::ostream&               out;
+    std::string                 label;
+    std::string                 filter;
+    int                         repeat;
+    std::string                 sdk_version;
+
+    static std::string json_string(const std::string& s) {
+        std::string r = "\"";
+        for (char c : s) {
+            if ((c == '"') || (c == '\\'))
+                r += '\\';
+            if ((unsigned char)c >= 0x20)
+                r += c;
+        }
+        return r + "\"";
+    }
+
+public:
+    CBenchRunner(std::ostream& o, const std::string& l, const std::string& f, const int r, const std::string& sdk)
+        : out(o), label(l), filter(f), repeat(r), sdk_version(sdk)
+        { /* constructor */ }
+
+    /// @brief Times a benchmark. One untimed warm-up iteration is done first.
+    ///
+    /// @param[in] name   benchmark name
+    /// @param[in] param  scale of the benchmark or 0
+    /// @param[in] fn     a single iteration, returning the number of operations done
+    void run(const std::string& name, const int param, const std::function<size_t()>& fn) {
+        if (!filter.empty() && (name.find(filter) == std::string::npos))
+            return;
+
+        bench_result r{ name, param, fn(), {} };
+        for (int i = 0; i < repeat; i++) {
+            auto start = std::chrono::steady_clock::now();
+            size_t ops = fn();
+            auto end = std::chrono::steady_clock::now();
+            assert(ops == r.ops);
+            (void)ops;
+            r.ns.push_back((double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+        report(r);
+    }
+
+    void report(bench_result& r) {
+        std::sort(r.ns.begin(), r.ns.end());
+        double median = r.ns[r.ns.size() / 2];
+        double mean = 0.0;
+        for (auto t : r.ns)
+            mean += t;
+        mean = mean / r.ns.size();
+        double per_op = (r.ops > 0) ? (median / r.ops) : median;
+
+        out << std::fixed << std::setprecision(1)
+            << "{\"benchmark\":" << json_string(r.name)
+            << ",\"param\":" << r.param
+            << ",\"ops\":" << r.ops
+            << ",\"iterations\":" << r.ns.size()
+            << ",\"min_ns\":" << r.ns[0]
+            << ",\"median_ns\":" << median
+            << ",\"mean_ns\":" << mean
+            << ",\"max_ns\":" << r.ns.back()
+            << ",\"ns_per_op\":" << per_op
+            << ",\"version\":" << json_string(TestGrammar_VERSION)
+            << ",\"sdk\":" << json_string(sdk_version)
+            << ",\"label\":" << json_string(label) << "}" << std::endl;
+
+        std::cerr << std::left << std::setw(40) << (r.name + ((r.param > 0) ? ("/" + std::to_string(r.param)) : ""))
+                  << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << (median / 1e6) << " ms"
+                  << std::setw(14) << std::setprecision(1) << per_op << " ns/op"
+                  << std::setw(10) << r.ops << " ops" << std::endl;
+    }
+};
+
+
+/// @brief Every predicate in a TSV file set (fields with "fn:" split on ';' with [ ] removed)
+static std::vector<std::string> get_all_predicates(const fs::path& tsv_folder) {
+    std::vector<std::string> preds;
+    for (const auto& entry : fs::directory_iterator(tsv_folder)) {
+        if (entry.path().extension() != ".tsv")
+            continue;
+        CArlingtonTSVGrammarFile f(entry.path());
+        if (!f.load())
+            continue;
+        for (auto& row : f.get_data())
+            for (size_t c = TSV_TYPE; (c < row.size()) && (c <= TSV_LINK); c++)
+                for (auto& v : split(row[c], ';')) {
+                    if (v.find("fn:") == std::string::npos)
+                        continue;
+                    if ((v[0] == '[') && (v.back() == ']'))
+                        preds.push_back(v.substr(1, v.size() - 2));
+                    else
+                        preds.push_back(v);
+                }
+    }
+    return preds;
+}
+
+
+/// @brief Micro-benchmarks that need an open PDF (synthetic PDF with annotations)
+static void run_pdf_micro_benchmarks(CBenchRunner& bench, ArlingtonPDFSDK& pdfsdk, const fs::path& tsv_folder, const fs::path& pdf_file) {
+    std::wstring pwd;
+    if (!pdfsdk.open_pdf(pdf_file, pwd)) {
+        std::cerr << "Error: failed to open " << pdf_file << std::endl;
+        return;
+    }
+
+    ArlPDFDocumentGuard doc(pdfsdk);
+    {
+        auto                        grammar = CArlingtonGrammar::get_shared_grammar(tsv_folder);
+        std::vector<std::string>    no_extns;
+        CPDFFile                    pdf(pdf_file, pdfsdk, "", no_extns);
+        pdf.check_and_get_pdf_version(cnull);
+
+        ArlPDFDictionary*           doccat = pdfsdk.get_document_catalog();
+        ArlPDFObject*               pages = doccat->get_value("Pages");
+        ArlPDFObject*               kids = ((ArlPDFDictionary*)pages)->get_value("Kids");
+        ArlPDFObject*               page = ((ArlPDFArray*)kids)->get_value(0);
+        ArlPDFObject*               annots = ((ArlPDFDictionary*)page)->get_value("Annots");
+
+        std::vector<ArlPDFObject*>  annot_objs;
+        for (int i = 0; i < ((ArlPDFArray*)annots)->get_num_elements(); i++)
+            annot_objs.push_back(((ArlPDFArray*)annots)->get_value(i));
+
+        // Objects of different types for ArlVersion (dictionary, integer, name, array)
+        ArlPDFObject*               count = ((ArlPDFDictionary*)pages)->get_value("Count");
+        ArlPDFObject*               type = ((ArlPDFDictionary*)pages)->get_value("Type");
+        std::vector<ArlPDFObject*>  typed_objs = { doccat, count, type, kids };
+
+        // ArlVersion for every row of the TSV files of a typical document against each typed object
+        static const char* version_tsvs[] = {
+            "FileTrailer", "Catalog", "PageTreeNodeRoot", "PageTreeNode", "PageObject", "Resource", "FontType1", "Stream",
+            "AnnotLink", "AnnotText", "AnnotSquare", "AnnotCircle", "AnnotHighlight", "AnnotFreeText", "AnnotLine", "AnnotInk", "AnnotStamp"
+        };
+        bench.run("ArlVersion", 0, [&]() {
+            size_t n = 0;
+            for (auto t : version_tsvs)
+                for (auto& row : grammar->get_grammar_file(t)->get_typed_data())
+                    for (auto o : typed_objs) {
+                        ArlVersion v(o, row, 20, no_extns);
+                        n++;
+                    }
+            return n;
+        });
+        const int pdf_v = string_to_pdf_version(pdf.pdf_version);
+        bench.run("ArlVersion (specialized)", 0, [&]() {
+            size_t n = 0;
+            for (auto t : version_tsvs) {
+                const CArlingtonTSVGrammarFile* tsv = grammar->get_grammar_file(t);
+                const CArlTSVSpecialization& spec = tsv->get_specialization(pdf_v, no_extns);
+                for (int key_idx = 0; key_idx < (int)tsv->get_typed_data().size(); key_idx++)
+                    for (auto o : typed_objs) {
+                        const ArlVersion& v = spec.get_version(key_idx, o);
+                        (void)v;
+                        n++;
+                    }
+            }
+            return n;
+        });
+
+        // Compiled Required and SpecialCase predicates of Catalog, PageObject and annotations
+        struct pred_case { ArlPDFObject* container; const CArlingtonTSVGrammarFile* tsv; };
+        std::vector<pred_case> pred_cases = { { doccat, grammar->get_grammar_file("Catalog") }, { page, grammar->get_grammar_file("PageObject") } };
+        for (auto a : annot_objs) {
+            ArlPDFObject* st = ((ArlPDFDictionary*)a)->get_value("Subtype");
+            pred_cases.push_back({ a, grammar->get_grammar_file("Annot" + ToUtf8(((ArlPDFName*)st)->get_value())) });
+            delete st;
+        }
+        // Calls as made by PredicateProcessor::IsRequired() and PredicateProcessor::ReportSpecialCase()
+        struct pred_call {
+            ArlPDFObject*               container;
+            ArlPDFObject*               obj;
+            const ArlPredicateProgram*  prog;
+            const ArlPredicateProgram*  spec_prog;  // prog with version predicates folded for the PDF version
+            int                         key_idx;
+            const ArlTSVmatrix*         tsv;
+            bool                        use_default_values;
+        };
+        std::vector<pred_call>      pred_calls;
+        std::vector<ArlPDFObject*>  pred_values;
+        for (auto& pc : pred_cases) {
+            const ArlTSVmatrix& tsv = pc.tsv->get_data();
+            const CArlTSVSpecialization& spec = pc.tsv->get_specialization(pdf_v, no_extns);
+            for (int key_idx = 0; key_idx < (int)tsv.size(); key_idx++) {
+                if (tsv[key_idx][TSV_REQUIRED].find("fn:") != std::string::npos) {
+                    ArlVersion v(pc.container, pc.tsv->get_typed_data()[key_idx], 20, no_extns);
+                    if (v.get_arlington_type_index() >= 0)
+                        pred_calls.push_back({ pc.container, pc.container, &pc.tsv->get_predicate_program(key_idx, TSV_REQUIRED)[0][0],
+                                               &spec.get_predicate_program(key_idx, TSV_REQUIRED)[0][0], key_idx, &tsv, false });
+                }
+                if (tsv[key_idx][TSV_SPECIALCASE].find("fn:") != std::string::npos) {
+                    ArlPDFObject* val = ((ArlPDFDictionary*)pc.container)->get_value(tsv[key_idx][TSV_KEYNAME]);
+                    if (val == nullptr)
+                        continue;
+                    pred_values.push_back(val);
+                    ArlVersion v(val, pc.tsv->get_typed_data()[key_idx], 20, no_extns);
+                    int type_idx = v.get_arlington_type_index();
+                    const ArlPredicateProgramMatrix& progs = pc.tsv->get_predicate_program(key_idx, TSV_SPECIALCASE);
+                    if ((type_idx >= 0) && (type_idx < (int)progs.size()) && (progs[type_idx].size() > 0) && !progs[type_idx][0].code.empty())
+                        pred_calls.push_back({ pc.container, val, &progs[type_idx][0], &spec.get_predicate_program(key_idx, TSV_SPECIALCASE)[type_idx][0],
+                                               key_idx, &tsv, true });
+                }
+            }
+        }
+        bench.run("CPDFFile::ExecutePredicate", 0, [&]() {
+            for (auto& c : pred_calls) {
+                ASTNode result;
+                pdf.ClearPredicateStatus();
+                pdf.ExecutePredicate(c.container, c.obj, *c.prog, c.key_idx, *c.tsv, c.use_default_values, result);
+            }
+            return pred_calls.size();
+        });
+        bench.run("CPDFFile::ExecutePredicate (specialized)", 0, [&]() {
+            for (auto& c : pred_calls) {
+                ASTNode result;
+                pdf.ClearPredicateStatus();
+                pdf.ExecutePredicate(c.container, c.obj, *c.spec_prog, c.key_idx, *c.tsv, c.use_default_values, result);
+            }
+            return pred_calls.size();
+        });
+
+        // Key walk of each annotation dictionary as done by CParsePDF::parse_object() (fresh objects so nothing is cached)
+        bench.run("ArlPDFDictionary key walk", 0, [&]() {
+            size_t n = 0;
+            for (int i = 0; i < ((ArlPDFArray*)annots)->get_num_elements(); i++) {
+                ArlPDFDictionary* a = (ArlPDFDictionary*)((ArlPDFArray*)annots)->get_value(i);
+                for (int k = 0; k < a->get_num_keys(); k++) {
+                    ArlPDFObject* v = a->get_value(a->get_key_name_by_index(k));
+                    delete v;
+                    n++;
+                }
+                delete a;
+            }
+            return n;
+        });
+        bench.run("ArlPDFDictionary for_each_key", 0, [&]() {
+            size_t n = 0;
+            ((ArlPDFArray*)annots)->for_each_element([&](const int, ArlPDFObject* o) {
+                ((ArlPDFDictionary*)o)->for_each_key([&](const std::string&, ArlPDFObject* v) {
+                    delete v;
+                    n++;
+                    return true;
+                });
+                delete o;
+                return true;
+            });
+            return n;
+        });
+        bench.run("ArlPDFDictionary for_each_key (unsorted)", 0, [&]() {
+            size_t n = 0;
+            ((ArlPDFArray*)annots)->for_each_element([&](const int, ArlPDFObject* o) {
+                ((ArlPDFDictionary*)o)->for_each_key([&](const std::string&, ArlPDFObject* v) {
+                    delete v;
+                    n++;
+                    return true;
+                }, false);
+                delete o;
+                return true;
+            });
+            return n;
+        });
+
+        // Link selection between all annotation Links (ArrayOfAnnots "*" row)
+        const CArlingtonTSVGrammarFile* array_of_annots = grammar->get_grammar_file("ArrayOfAnnots");
+        const std::vector<ArlSymbol>& annot_links = array_of_annots->get_typed_data()[0].full_links[0];
+        CParsePDF parser(tsv_folder, cnull, true, false);
+        bench.run("recommended_link_for_object/cold", 0, [&]() {
+            return parser.select_links(pdf, annot_objs, annot_links, true);
+        });
+        bench.run("recommended_link_for_object/warm", 0, [&]() {
+            return parser.select_links(pdf, annot_objs, annot_links, false);
+        });
+
+        for (auto v : pred_values)
+            delete v;
+        for (auto a : annot_objs)
+            delete a;
+        delete type;
+        delete count;
+        delete annots;
+        delete page;
+        delete kids;
+        delete pages;
+    }
+}
+
+
+int main(int argc, char* argv[]) {
+    fs::path        tsv_folder;
+    fs::path        out_file;
+    std::string     label;
+    std::string     filter;
+    int             repeat = -1;
+    bool            quick = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if ((a == "--tsvdir") && (i + 1 < argc))
+            tsv_folder = argv[++i];
+        else if ((a == "--out") && (i + 1 < argc))
+            out_file = argv[++i];
+        else if ((a == "--label") && (i + 1 < argc))
+            label = argv[++i];
+        else if ((a == "--filter") && (i + 1 < argc))
+            filter = argv[++i];
+        else if ((a == "--repeat") && (i + 1 < argc))
+            repeat = std::max(1, atoi(argv[++i]));
+        else if (a == "--quick")
+            quick = true;
+        else {
+            std::cerr << "Usage: " << argv[0] << " --tsvdir <dir> [--out <file.jsonl>] [--label <text>] [--filter <substr>] [--repeat <n>] [--quick]" << std::endl;
+            return 2;
+        }
+    }
+    if (tsv_folder.empty() || !fs::is_directory(tsv_folder)) {
+        std::cerr << "Error: --tsvdir must be an Arlington TSV folder" << std::endl;
+        return 2;
+    }
+    if (repeat < 0)
+        repeat = quick ? 2 : 5;
+
+    std::ofstream   ofs;
+    if (!out_file.empty()) {
+        ofs.open(out_file, std::ios::out | std::ios::trunc);
+        if (!ofs.is_open()) {
+            std::cerr << "Error: could not open " << out_file << std::endl;
+            return 2;
+        }
+    }
+
+    ArlingtonPDFSDK pdfsdk;
+    pdfsdk.initialize();
+
+    CBenchRunner    bench(out_file.empty() ? std::cout : ofs, label, filter, repeat, pdfsdk.get_version_string());
+
+    // Synthetic PDFs of scaled sizes
+    const fs::path  work_dir = fs::temp_directory_path() / ("TestGrammarBench-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(work_dir);
+
+    const std::vector<int> page_scales      = quick ? std::vector<int>{ 20 }  : std::vector<int>{ 100, 1000, 10000 };
+    const std::vector<int> name_tree_scales = quick ? std::vector<int>{ 500 } : std::vector<int>{ 1000, 10000, 100000 };
+    const std::vector<int> depth_scales     = quick ? std::vector<int>{ 10 }  : std::vector<int>{ 10, 100, 500 };
+
+    // =========== micro-benchmarks ===========
+
+    std::vector<std::string> predicates = get_all_predicates(tsv_folder);
+    bench.run("LRParsePredicate", 0, [&]() {
+        for (auto& p : predicates) {
+            std::string s = p;
+            int loop = 0;
+            do {
+                ASTNode* n = new ASTNode();
+                s = LRParsePredicate(s, n);
+                delete n;
+                while ((s.size() > 0) && ((s[0] == ',') || (s[0] == ' ')))
+                    s = s.substr(1, s.size() - 1);
+            } while ((s.size() > 0) && (++loop < 100));
+        }
+        return predicates.size();
+    });
+
+    bench.run("CArlingtonTSVGrammarFile::load", 0, [&]() {
+        size_t n = 0;
+        for (const auto& entry : fs::directory_iterator(tsv_folder))
+            if (entry.path().extension() == ".tsv") {
+                CArlingtonTSVGrammarFile f(entry.path());
+                if (f.load())
+                    n++;
+            }
+        return n;
+    });
+
+    bench.run("CArlingtonGrammar", 0, [&]() {
+        CArlingtonGrammar g(tsv_folder);
+        return (size_t)1;
+    });
+
+    const fs::path grammar_image = work_dir / "arlington.bin";
+    CArlingtonGrammar(tsv_folder).write_image(grammar_image);
+    bench.run("CArlingtonGrammar (compiled)", 0, [&]() {
+        CArlingtonGrammar g(grammar_image);
+        return (size_t)1;
+    });
+
+    const fs::path annots_pdf = work_dir / "annots.pdf";
+    make_pages_pdf(annots_pdf, 1);
+    run_pdf_micro_benchmarks(bench, pdfsdk, tsv_folder, annots_pdf);
+
+    // =========== end-to-end benchmarks ===========
+
+    std::vector<std::string>    no_extns;
+    std::wstring                no_pwd;
+
+    auto run_e2e = [&](const std::string& name, const int param, const fs::path& pdf_file) {
+        bench.run(name, param, [&]() {
+            return (size_t)(process_single_pdf(pdf_file, tsv_folder, pdfsdk, cnull, true, false, "", no_extns, no_pwd, false, 0, ArlOutputFormat::Text) ? 1 : 0);
+        });
+        fs::remove(pdf_file);
+    };
+
+    for (auto n : page_scales) {
+        fs::path f = work_dir / ("pages-" + std::to_string(n) + ".pdf");
+        make_pages_pdf(f, n);
+        run_e2e("process_single_pdf/pages", n, f);
+    }
+    for (auto n : name_tree_scales) {
+        fs::path f = work_dir / ("nametree-" + std::to_string(n) + ".pdf");
+        make_name_tree_pdf(f, n);
+        run_e2e("process_single_pdf/name_tree", n, f);
+    }
+    for (auto n : depth_scales) {
+        fs::path f = work_dir / ("inheritance-" + std::to_string(n) + ".pdf");
+        make_inheritance_pdf(f, n);
+        run_e2e("process_single_pdf/inheritance", n, f);
+    }
+
+    pdfsdk.shutdown();
+    std::error_code ec;
+    fs::remove_all(work_dir, ec);
+    return 0;
+}